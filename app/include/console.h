@@ -0,0 +1,73 @@
+/**
+ * console.h - Debugger Console
+ *
+ * Reads debugger commands (see debug.h) from stdin or from a Unix socket
+ * on a background thread and hands them to the emulation thread, which runs
+ * them between frames or while stopped at a breakpoint:
+ *
+ *   ./gbe game.gb --console
+ *   ./gbe game.gb --console-socket /tmp/gbe.sock   (then: nc -U /tmp/gbe.sock)
+ *
+ * The reader thread only queues text; all emulator state is touched on the
+ * emulation thread in console_poll(), so no locking is added to the core.
+ */
+
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "gb_types.h"
+
+#define CONSOLE_LINE_MAX    128
+#define CONSOLE_QUEUE_LEN   16
+
+// Reader wake-up period, and how often a stopped emulator polls the console
+#define CONSOLE_POLL_MS     50
+
+struct console_s {
+    bool        running;
+    int         listen_fd;              // Unix socket, -1 when reading stdin
+    int         in_fd;                  // stdin or the connected client, -1 if none
+    int         out_fd;                 // Where command output goes, -1 if none
+    char        path[108];              // Socket path (unlinked on stop)
+
+    pthread_t   thread;
+    atomic_bool stop;
+    pthread_mutex_t lock;               // Guards the queue and out_fd
+
+    // Complete lines waiting for the emulation thread
+    char        queue[CONSOLE_QUEUE_LEN][CONSOLE_LINE_MAX];
+    uint32_t    head, tail;
+
+    // Reader thread only: line being assembled
+    char        partial[CONSOLE_LINE_MAX];
+    uint32_t    partial_len;
+
+    // Emulation thread only: last stop reported
+    uint32_t    stops_seen;
+};
+
+/**
+ * Start reading commands
+ *
+ * @param socket_path  Unix socket to listen on, or NULL for stdin
+ * @return             true if the reader thread is running
+ */
+bool console_start(struct console_s *c, const char *socket_path);
+
+/**
+ * Stop the reader thread and close the socket
+ */
+void console_stop(struct console_s *c);
+
+/**
+ * Run queued commands and report new stops (emulation thread)
+ *
+ * Needs a debugger attached with debug_init().
+ */
+void console_poll(struct console_s *c, struct gb_s *gb);
+
+#endif // CONSOLE_H
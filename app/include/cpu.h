@@ -38,8 +38,31 @@ uint8_t cpu_execute_cb(struct gb_s* gb);
  * Checks interrupt flags and jumps to the appropriate interrupt handler if needed.
  * 
  * @param gb    Emulator context
+ * @return      Cycles the dispatch took, 0 if none was taken
  */
-void cpu_handle_interrupts(struct gb_s* gb);
+uint16_t cpu_handle_interrupts(struct gb_s* gb);
+
+/**
+ * Recompute gb->irq_pending after IF or IE changed
+ * cpu_step() tests only that byte, so anything that writes IF or IE must
+ * call this (or cpu_irq_raise()).
+ *
+ * @param gb    Emulator context
+ */
+static inline void cpu_irq_update(struct gb_s *gb) {
+    gb->irq_pending = gb->hram_io[IO_IF] & gb->hram_io[IO_IE] & 0x1F;
+}
+
+/**
+ * Request interrupts: set @bits (*_INTR) in IF
+ *
+ * @param gb    Emulator context
+ * @param bits  Interrupt flags to set
+ */
+static inline void cpu_irq_raise(struct gb_s *gb, uint8_t bits) {
+    gb->hram_io[IO_IF] |= bits;
+    cpu_irq_update(gb);
+}
 
 // Depends on Dan's bootloader, will need to be modified later
 void cpu_init(struct gb_s* gb);
@@ -0,0 +1,158 @@
+/**
+ * debug.h - Breakpoints, Watchpoints and Debugger Commands
+ *
+ * Breakpoints and watchpoints cost nothing on pages that carry none. The MMU
+ * page table (struct mmu_map_s) sends a page through the slow path only while
+ * a watchpoint covers it, so plain WRAM/VRAM accesses keep their direct
+ * pointer; the slow path checks the page's trap flags and calls
+ * debug_watch_hit(). Breakpoints set MMU_TRAP_EXEC on their page, which
+ * cpu_step() tests once per instruction fetch (one byte load) before calling
+ * debug_exec_hit().
+ *
+ * Watchpoints match the exact address written or read: an access to the same
+ * WRAM byte through the echo area (0xE000-0xFDFF) is not reported.
+ *
+ * A hit sets gb->gb_break; the current instruction completes (for a
+ * watchpoint) or is not started (for a breakpoint), and the frontend stops
+ * stepping until debug_continue() or debug_step().
+ */
+
+#ifndef DEBUG_H
+#define DEBUG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "gb_types.h"
+
+#define DEBUG_MAX_POINTS    32      // Breakpoints and watchpoints together
+
+enum debug_stop_e {
+    DEBUG_STOP_NONE = 0,
+    DEBUG_STOP_BREAKPOINT,
+    DEBUG_STOP_WATCH_READ,
+    DEBUG_STOP_WATCH_WRITE,
+    DEBUG_STOP_STEP,
+    DEBUG_STOP_USER,                // "pause" command or a debugger interrupt
+    DEBUG_STOP_ERROR                // Emulator error (invalid opcode), PC at the fault
+};
+
+struct debug_point_s {
+    uint16_t start;
+    uint16_t end;                   // Inclusive
+    uint8_t  type;                  // MMU_TRAP_EXEC, or MMU_TRAP_READ / MMU_TRAP_WRITE
+    uint8_t  id;                    // Shown by "list", used by "delete"
+};
+
+struct debug_s {
+    struct debug_point_s points[DEBUG_MAX_POINTS];
+    uint8_t num_points;
+    uint8_t next_id;
+
+    // Why and where execution last stopped
+    enum debug_stop_e stop_reason;
+    uint8_t  stop_id;               // Point that hit
+    uint16_t stop_addr;             // Accessed address (watchpoints)
+    uint8_t  stop_value;            // Value read or written (watchpoints)
+    uint32_t stops;                 // Incremented on every stop, so a frontend reports each once
+
+    // Resuming from a breakpoint runs its instruction once without stopping
+    bool     skip;
+    uint16_t skip_pc;
+};
+
+/**
+ * Attach an empty debugger to 'gb' (after mmu_init(), which clears traps)
+ *
+ * @return  0 on success, -1 on allocation failure
+ */
+int debug_init(struct gb_s *gb);
+
+/**
+ * Remove all breakpoints/watchpoints and free the debugger
+ */
+void debug_free(struct gb_s *gb);
+
+/**
+ * Add a breakpoint at 'addr'
+ *
+ * @return  Point id, or -1 if the table is full or no debugger is attached
+ */
+int debug_add_breakpoint(struct gb_s *gb, uint16_t addr);
+
+/**
+ * Add a watchpoint on 'start'..'end' (inclusive)
+ *
+ * @param type  MMU_TRAP_READ, MMU_TRAP_WRITE or both
+ * @return      Point id, or -1 on a bad range/type or a full table
+ */
+int debug_add_watchpoint(struct gb_s *gb, uint16_t start, uint16_t end, uint8_t type);
+
+/**
+ * Delete point 'id', or every point when id is 0
+ *
+ * @return  0 on success, -1 if there is no such point
+ */
+int debug_delete(struct gb_s *gb, uint8_t id);
+
+/**
+ * Find the point with exactly this range and type
+ *
+ * @return  Point id, or -1 if there is none
+ */
+int debug_find(const struct gb_s *gb, uint16_t start, uint16_t end, uint8_t type);
+
+/**
+ * Rebuild gb->mmu.trap from the point list and refresh the page table
+ *
+ * Called whenever the list changes; call it after mmu_init()/mmu_reset(),
+ * which clear the trap flags.
+ */
+void debug_update_traps(struct gb_s *gb);
+
+/**
+ * Resume after a stop
+ */
+void debug_continue(struct gb_s *gb);
+
+/**
+ * Stop execution now for 'reason' (interrupt request, emulator error)
+ */
+void debug_stop(struct gb_s *gb, enum debug_stop_e reason);
+
+/**
+ * Execute up to 'count' instructions now, stopping early on a breakpoint or
+ * watchpoint. Leaves gb_break set (DEBUG_STOP_STEP if nothing else hit).
+ */
+void debug_step(struct gb_s *gb, uint32_t count);
+
+/**
+ * Describe the last stop, e.g. "Breakpoint 1 at $0150: LD A, $01"
+ */
+void debug_print_stop(struct gb_s *gb, FILE *out);
+
+/**
+ * Run one console command line (see "help" for the list)
+ *
+ * @param out  Receives the command's output
+ * @return     0 on success, -1 on an unknown command or bad arguments
+ */
+int debug_command(struct gb_s *gb, const char *line, FILE *out);
+
+// -------------------------------
+// Trap handlers (MMU and CPU)
+// -------------------------------
+
+/**
+ * Called by cpu_step() when the page of PC has MMU_TRAP_EXEC set
+ *
+ * @return  true if execution should stop before this instruction
+ */
+bool debug_exec_hit(struct gb_s *gb);
+
+/**
+ * Called by the MMU slow path for an access to a page with a read/write trap
+ */
+void debug_watch_hit(struct gb_s *gb, uint16_t addr, uint8_t value, bool write);
+
+#endif // DEBUG_H
@@ -0,0 +1,44 @@
+/**
+ * disasm.h - LR35902 Disassembler
+ *
+ * Generated from the opcode table in opcodes.h, so lengths and mnemonics
+ * always match what the interpreter executes. Used for error reports,
+ * profiler labels and debugging tools.
+ */
+
+#ifndef DISASM_H
+#define DISASM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "gb_types.h"
+
+/**
+ * Disassemble one instruction from raw bytes
+ *
+ * @param bytes  Instruction bytes (up to 3 are read, as the length requires)
+ * @param pc     Address of the instruction, used to resolve JR targets
+ * @param buf    Receives the text, e.g. "JR NZ, $0150"
+ * @param len    Size of buf
+ * @return       Instruction length in bytes (2 for CB-prefixed opcodes)
+ */
+uint8_t gb_disasm_bytes(const uint8_t *bytes, uint16_t pc, char *buf, size_t len);
+
+/**
+ * Disassemble the instruction at 'addr' in the emulated address space
+ *
+ * Operand bytes are fetched with mmu_peek(), so disassembling never fires a
+ * watchpoint.
+ *
+ * @return  Instruction length in bytes
+ */
+uint8_t gb_disasm(struct gb_s *gb, uint16_t addr, char *buf, size_t len);
+
+/**
+ * Operand-less name of an opcode ("LD A, (a16)"), for profiler labels
+ *
+ * @param cb  CB-prefixed opcode when prefixed is non-zero
+ */
+const char *gb_opcode_name(uint8_t opcode, uint8_t cb, int prefixed);
+
+#endif // DISASM_H
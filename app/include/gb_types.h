@@ -13,8 +13,12 @@
 #include <stdint.h>
 #include <stdbool.h>
 
-// Forward declaration
+// Forward declarations
 struct gb_s;
+struct itrace_s;
+struct debug_s;
+struct serial_link_s;
+struct gpu_bg_cache_s;
 
 // -------------------------------
 // Error and Status Enums
@@ -55,6 +59,8 @@ enum gb_init_error_e {
 // -------------------------------
 
 #define IO_JOYP     0x00    // Joypad input
+#define IO_SB       0x01    // Serial transfer data
+#define IO_SC       0x02    // Serial transfer control
 #define IO_DIV      0x04    // Divider register
 #define IO_IF       0x0F    // Interrupt flag
 #define IO_LCDC     0x40    // LCD control
@@ -88,6 +94,8 @@ enum gb_init_error_e {
 #define LCD_HEIGHT          144     // Physical screen height in pixels
 #define LCD_VERT_LINES      154     // Total scanlines including vblank, which is 10 lines
 #define LCD_LINE_CYCLES     456     // Cycles per scanline
+#define LCD_FRAME_CYCLES    (LCD_VERT_LINES * LCD_LINE_CYCLES)  // 70224 cycles per frame
+#define GB_CPU_HZ           4194304 // DMG clock, cycles per second
 
 // LCD Modes
 #define LCD_MODE_HBLANK     0
@@ -132,11 +140,29 @@ enum gb_init_error_e {
 #define SERIAL_INTR     0x08
 #define CONTROL_INTR    0x10
 
+// -------------------------------
+// Joypad Bits (gb->direct.joypad, 0 = pressed)
+// -------------------------------
+
+#define JOYPAD_A        0x01
+#define JOYPAD_B        0x02
+#define JOYPAD_SELECT   0x04
+#define JOYPAD_START    0x08
+#define JOYPAD_RIGHT    0x10
+#define JOYPAD_LEFT     0x20
+#define JOYPAD_UP       0x40
+#define JOYPAD_DOWN     0x80
+
 // -------------------------------
 // Timing Constants
 // -------------------------------
 
 #define DIV_CYCLES      256     // DIV increments every 256 cycles
+#define SERIAL_CYCLES   4096    // One serial byte on the internal clock (8 bits at 8192 Hz)
+
+// Serial control (SC) bits
+#define SC_TRANSFER         0x80    // Transfer requested / in progress
+#define SC_CLOCK_INTERNAL   0x01    // This side drives the clock (master)
 
 // -------------------------------
 // CPU Register Structure
@@ -209,9 +235,71 @@ struct cpu_registers_s {
 // -------------------------------
 
 // Timing counters
+// Everything is kept as a point on one monotonic cycle count, so nothing
+// but the count itself advances per instruction.
 struct counter_s {
-    uint16_t lcd_count; // LCD timing counter
-    uint16_t div_count; // Divider timing counter
+    uint64_t cycles;        // CPU cycles since power-on (unlike stats.cycles, never cleared)
+    uint64_t div_base;      // cycles when the divider was last 0 (see timers.h)
+    uint64_t line_start;    // cycles when the current scanline began
+    uint64_t lcd_next;      // cycles of the next LCD mode change or scanline
+    uint16_t serial_count;  // Cycles left in an internal-clock serial transfer
+    uint64_t serial_armed;  // cycles when an external-clock transfer was requested
+};
+
+// -------------------------------
+// Performance Statistics
+// -------------------------------
+
+// Counters for "is the device keeping up?" questions.
+// The core fills in the emulated-work counters; the frontend fills in host
+// time per phase. Everything is cumulative; clear with memset to restart.
+struct gb_stats_s {
+    // ----- Maintained by the core -----
+    uint64_t cycles;            // Emulated CPU cycles (4.194304 MHz)
+    uint64_t instructions;      // Instructions executed
+    uint64_t frames;            // Frames completed (entries into VBlank)
+    uint64_t halt_cycles;       // Cycles skipped while the CPU was halted
+    uint64_t lines_drawn;       // Scanlines rendered by gpu_draw_line()
+    uint64_t bg_cache_hits;     // BG/window lines read from an up-to-date tile-map cache row
+    uint64_t bg_cache_misses;   // Tile rows (8 lines) redrawn into the cache from VRAM
+
+    // ----- Host time per phase, in nanoseconds -----
+    uint64_t ppu_ns;            // gpu_draw_line(), measured by the core when time_ppu is set
+    uint64_t cpu_ns;            // Rest of run_frame() (frontend)
+    uint64_t present_ns;        // Texture upload and present (frontend)
+    uint64_t input_ns;          // Event handling and input merge (frontend)
+
+    bool time_ppu;              // Enable PPU timing (two clock reads per line)
+};
+
+// -------------------------------
+// MMU Page Table
+// - The address space is split into 256-byte pages. Pages backed by plain
+//     host memory (VRAM, WRAM, echo RAM) are read and written through a
+//     pointer; everything else (ROM, cart RAM, OAM, I/O) takes the slow path.
+// - Debug traps clear a page's pointer, so only trapped pages pay for them.
+// - Shared WRAM pages (copy-on-write, see mmu_share_wram()) are read through
+//     the pointer and written through the slow path, which copies the page in.
+// - Every write sets the page's bit in a dirty bitmap (see mmu_dirty()).
+// -------------------------------
+
+#define MMU_PAGE_SHIFT      8
+#define MMU_NUM_PAGES       256
+
+// Per-page debug trap flags
+#define MMU_TRAP_READ       0x01    // Read watchpoint on this page
+#define MMU_TRAP_WRITE      0x02    // Write watchpoint on this page
+#define MMU_TRAP_EXEC       0x04    // Breakpoint on this page
+
+#define MMU_CRAM_PAGES      128     // 256-byte pages of cart RAM (32 KB, MBC1's largest)
+
+struct mmu_map_s {
+    const uint8_t *rd[MMU_NUM_PAGES];   // Direct read pointer, NULL = slow path
+    uint8_t *wr[MMU_NUM_PAGES];         // Direct write pointer, NULL = slow path
+    uint8_t trap[MMU_NUM_PAGES];        // MMU_TRAP_* flags
+    const uint8_t *shared[WRAM_SIZE >> MMU_PAGE_SHIFT]; // WRAM page read from elsewhere until written, NULL = own
+    uint64_t dirty[MMU_NUM_PAGES / 64];         // Address pages written since mmu_dirty_clear()
+    uint64_t dirty_cram[MMU_CRAM_PAGES / 64];   // Cart RAM pages (by RAM offset) written since then
 };
 
 // -------------------------------
@@ -234,6 +322,15 @@ struct display_s {
     * @param line      Y-coordinate (0-143)
     */
     void (*lcd_draw_line)(struct gb_s* gb, const uint8_t* pixels, uint8_t line);
+
+    // Lines to render (bit n & 31 of word n >> 5), NULL = all. Set by the
+    // front-end; skipped lines cost no PPU work and never reach lcd_draw_line.
+    const uint32_t *draw_mask;
+
+    // Prerendered background maps, NULL = render from VRAM every line. Set
+    // with gpu_bg_cache_attach(); the memory belongs to the front-end.
+    struct gpu_bg_cache_s *bg_cache;
+    uint32_t vram_dirty;    // VRAM pages written since the cache last looked
     
     // Palette data
     uint8_t bg_palette[4];  // Background palette (4 colors)
@@ -290,6 +387,11 @@ struct gb_s {
     bool gb_ime     : 1;        // Interrupt master enable
     bool gb_frame   : 1;        // Frame complete flag
     bool lcd_blank  : 1;        // LCD was just enabled
+    bool gb_break   : 1;        // Stopped by a breakpoint or watchpoint
+    bool ime_delay  : 1;        // EI ran: IME goes on after the next instruction
+    bool halt_bug   : 1;        // HALT fell through: the next opcode is read twice
+
+    uint8_t irq_pending;        // IF & IE & 0x1F, kept by cpu_irq_update()
 
     // ----- Cartridge Info (MBC1 only for MVP) -----
 
@@ -310,6 +412,24 @@ struct gb_s {
     // Frame debug counter (for logging)
     uint32_t frame_debug;
 
+    // ----- Statistics -----
+
+    struct gb_stats_s stats;
+
+    // Instruction trace ring, NULL when disabled (see itrace.h)
+    struct itrace_s *itrace;
+
+    // Breakpoints and watchpoints, NULL when no debugger is set up (see debug.h)
+    struct debug_s *debug;
+
+    // Serial link cable, NULL when nothing is plugged in (see serial.h)
+    struct serial_link_s *link;
+
+    // ----- Memory Map -----
+    // Holds pointers into this struct: call mmu_remap() after copying it
+
+    struct mmu_map_s mmu;
+
     // ----- Memory Arrays -----
     
     uint8_t wram[WRAM_SIZE];        // Work RAM
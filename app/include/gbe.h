@@ -0,0 +1,318 @@
+/**
+ * gbe.h - Embeddable Emulator API
+ *
+ * A small library interface to gbe_core for programs that drive the
+ * emulator themselves, e.g. reinforcement-learning environments:
+ *
+ *   const char *why;
+ *   struct gbe_s *g = gbe_create(rom, rom_size, &why);
+ *   struct gb_state_s *start = gbe_state_new(g);
+ *   ... play to the interesting point ...
+ *   gbe_save(g, start);
+ *   for each episode:
+ *       gbe_reset(g, start);
+ *       while (...) {
+ *           gbe_step(g, joypad, 4);                     // frame-skip 4
+ *           observe(gbe_framebuffer(g), gbe_wram(g));   // no copies
+ *       }
+ *
+ * Nothing here prints, and nothing touches SDL or the HAL. Only
+ * gbe_create(), gbe_fork() and gbe_state_new() allocate, plus the optional
+ * parts on first use (gbe_set_obs(), gbe_hash()). gbe_step(), gbe_save(),
+ * gbe_reset() and gbe_copy() run without allocating (but for a fork's
+ * first writes, see below) or making system calls, so many instances can
+ * run side by side on one thread or several (instances share nothing but
+ * read-only ROM and snapshots). An instance without those optional parts
+ * takes about 45 KB, most of it the framebuffer and the core's memory
+ * (gbe_size()), so tens of thousands fit in a few GB.
+ *
+ * The ROM image is borrowed, not copied: it must stay valid and unchanged
+ * until gbe_destroy(). Instances created from one image can share it.
+ *
+ * For tree search, gbe_fork() branches instances off a snapshot
+ * copy-on-write: a fork shares the ROM and the snapshot's work RAM and
+ * cartridge RAM, and copies a 256-byte page the first time it writes it.
+ * Many rollouts from one checkpoint then cost the core and framebuffer
+ * each, plus what they modify:
+ *
+ *   gbe_save(g, node);
+ *   struct gbe_s *f = gbe_fork(g, node, &why);
+ *   for each rollout:
+ *       gbe_reset(f, node);                         // copies nothing
+ *       while (...) gbe_step(f, policy(f), 4);
+  *
+ * For training, gbe_vec_*() keeps n instances in one cache-aligned arena
+ * and steps them all per call on a persistent thread pool, writing the
+ * observations into one contiguous [n x 144 x 160] buffer:
+ *
+ *   struct gbe_vec_s *v = gbe_vec_create(rom, rom_size, 128, 0, &why);
+ *   while (training) {
+ *       gbe_vec_step(v, actions, 4, obs);     // 128 instances, 4 frames each
+ *       ...
+ *   }
+ *
+ * An observation sink (gbe_set_obs()) replaces the full framebuffer with
+ * small grayscale or shade-index frames, e.g. 84x84 or 80x72, built line
+ * by line as the PPU renders: LCD lines that map to no output row are not
+ * rendered at all, and each kept line is averaged horizontally straight
+ * into the output. The last K observations are kept for frame stacking.
+ */
+
+#ifndef GBE_H
+#define GBE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "gb_types.h"
+#include "state.h"
+
+#define GBE_FB_WIDTH    LCD_WIDTH
+#define GBE_FB_HEIGHT   LCD_HEIGHT
+#define GBE_FB_SIZE     (GBE_FB_WIDTH * GBE_FB_HEIGHT)
+
+#define GBE_OBS_MAX_STACK   16      // Most observations kept for stacking
+
+enum gbe_obs_format_e {
+    GBE_OBS_GRAY = 0,   // 0 (black) - 255 (white), averaged over each output pixel
+    GBE_OBS_INDEX       // Shade 0-3 of the pixel at each output pixel's centre
+};
+
+struct gbe_obs_config_s {
+    int width;          // 1 - GBE_FB_WIDTH
+    int height;         // 1 - GBE_FB_HEIGHT
+    enum gbe_obs_format_e format;
+    int stack;          // Observations kept, 1 - GBE_OBS_MAX_STACK
+};
+
+struct gbe_s;
+struct gbe_vec_s;
+struct ttable_s;
+
+/**
+ * Create an instance from a ROM image in memory, powered on at $0100
+ *
+ * @param rom    ROM image (borrowed, see above)
+ * @param size   Its size in bytes
+ * @param error  If not NULL, set to a description when NULL is returned
+ * @return       NULL if the ROM is rejected or memory runs out
+ */
+struct gbe_s *gbe_create(const uint8_t *rom, size_t size, const char **error);
+
+void gbe_destroy(struct gbe_s *g);
+
+/**
+ * Fork an instance off snapshot @st (NULL: @g's power-on state)
+ *
+ * The fork runs @g's ROM from @st, sharing @st's work RAM and cartridge RAM
+ * until it writes them, one 256-byte page at a time. gbe_reset() on the fork
+ * shares the new snapshot the same way and keeps the pages it had copied
+ * for reuse, so only a fork's first writes to a page allocate. @st must not
+ * change while a fork shares it, and @g must outlive the fork. Free it with
+ * gbe_destroy().
+ *
+ * @param g      Instance whose ROM and power-on state the fork uses
+ * @param st     Snapshot saved from an instance of the same ROM
+ * @param error  If not NULL, set to a description when NULL is returned
+ * @return       NULL if @st does not fit the cartridge or memory runs out
+ */
+struct gbe_s *gbe_fork(const struct gbe_s *g, const struct gb_state_s *st, const char **error);
+
+/**
+ * 256-byte pages of work and cartridge RAM a fork owns: the ones written
+ * since its last reset. For other instances, all of work RAM's.
+ */
+int gbe_fork_pages(const struct gbe_s *g);
+
+/**
+ * Run @frames frames (VBlank to VBlank) holding @joypad
+ *
+ * Only the last frame is drawn to the framebuffer, so frame-skipped frames
+ * cost no PPU time. A fork allocates when it first writes a page of
+ * cartridge RAM that has no spare (see gbe_fork()); "out of memory" stops
+ * it like an error.
+ *
+ * @param joypad  JOYPAD_* bits, 0 = pressed (as gb->direct.joypad)
+ * @return        Frames completed; fewer than @frames if the CPU hit an
+ *                invalid opcode (see gbe_error(), cleared by gbe_reset())
+ */
+int gbe_step(struct gbe_s *g, uint8_t joypad, int frames);
+
+/**
+ * Make @dst a copy of @src, as if reset to a snapshot of it
+ *
+ * The core and cartridge RAM sit at the end of an instance's memory, so
+ * this is one memcpy of them plus rebuilding the page table. @dst keeps
+ * its framebuffer contents and observation sink (whose stack starts
+ * filling again) and its core's host-owned fields (struct state_host_s:
+ * callbacks, debugger, trace, host-time statistics...).
+ *
+ * @return  0, or -1 if the instances run different ROMs or either is a fork
+ */
+int gbe_copy(struct gbe_s *dst, const struct gbe_s *src);
+
+/**
+ * Bytes of memory the instance uses, not counting ROM or snapshots
+ */
+size_t gbe_size(const struct gbe_s *g);
+
+/**
+ * Allocate a snapshot sized for this instance's cartridge RAM
+ * Free it with gbe_state_free(). Returns NULL on allocation failure.
+ */
+struct gb_state_s *gbe_state_new(const struct gbe_s *g);
+
+void gbe_state_free(struct gb_state_s *st);
+
+/**
+ * Save the current state into @st
+ */
+void gbe_save(const struct gbe_s *g, struct gb_state_s *st);
+
+/**
+ * Restore @st, or the power-on state if @st is NULL
+ * The framebuffer keeps its contents until the next gbe_step(); the
+ * observation stack starts filling again.
+ */
+void gbe_reset(struct gbe_s *g, const struct gb_state_s *st);
+
+/**
+ * Produce observations instead of full frames (NULL: back to full frames)
+ *
+ * Output row r shows LCD line (2r + 1) * 144 / (2 * height); only those
+ * lines are rendered. Output pixel x covers LCD pixels x * 160 / width up
+ * to (x + 1) * 160 / width. Width 80 takes a faster path for the 2:1
+ * average. While a sink is set, gbe_framebuffer() is not updated.
+ * Allocates, so call it outside the step loop.
+ *
+ * @return  0, or -1 for a bad config or no memory (the sink is then off)
+ */
+int gbe_set_obs(struct gbe_s *g, const struct gbe_obs_config_s *cfg);
+
+/**
+ * Bytes per observation (width * height), 0 without a sink
+ */
+size_t gbe_obs_size(const struct gbe_s *g);
+
+/**
+ * An observation, @age steps old (0 = from the last gbe_step())
+ *
+ * Until @stack steps have run since create or reset, older ages repeat
+ * the oldest observation. NULL without a sink.
+ */
+const uint8_t *gbe_obs(const struct gbe_s *g, int age);
+
+/**
+ * Copy the stack, oldest first, into @out (stack * gbe_obs_size() bytes)
+ */
+void gbe_obs_stack(const struct gbe_s *g, uint8_t *out);
+
+/**
+ * Last drawn frame: GBE_FB_HEIGHT rows of GBE_FB_WIDTH shades (0-3, after
+ * the palettes, 0 = lightest). Valid until gbe_destroy().
+ */
+const uint8_t *gbe_framebuffer(const struct gbe_s *g);
+
+/**
+ * Work RAM, WRAM_SIZE bytes at $C000. Valid until gbe_destroy().
+ * A fork first copies in every page it still shares.
+ */
+uint8_t *gbe_wram(struct gbe_s *g);
+
+/**
+ * The underlying core, for registers, HRAM/I/O and statistics
+ * Host-side fields (callbacks, display.lcd_draw_line) belong to gbe.
+ */
+struct gb_s *gbe_core(struct gbe_s *g);
+
+/**
+ * 64-bit hash of the emulated state, for spotting repeated states
+ *
+ * Equal machine states hash equal however they were reached (cycle counts
+ * and statistics are left out). Maintained incrementally: only the pages
+ * written since the last call are re-hashed (see state_hash_update()), so
+ * after a step that touched a few pages it costs well under a microsecond;
+ * the first call after create or reset hashes everything. The first call
+ * also allocates the page hashes (about 1.6 KB). Takes over the core's
+ * dirty bitmap.
+ */
+uint64_t gbe_hash(struct gbe_s *g);
+
+/**
+ * Why the last gbe_step() stopped early, or NULL
+ */
+const char *gbe_error(const struct gbe_s *g);
+
+// -------------------------------
+// Vectorized stepping
+// -------------------------------
+
+/**
+ * Create @n instances of one ROM and a pool of @threads threads to step them
+ *
+ * Instances sit in one arena of cache-line-aligned slots, each holding its
+ * core, framebuffer and cartridge RAM, so no two threads ever write the
+ * same cache line. They share one power-on snapshot.
+ *
+ * @param threads  Threads per step including the caller; 0 = one per CPU
+ *                 (never more than @n)
+ * @return         NULL if the ROM is rejected or memory runs out (@error
+ *                 as for gbe_create())
+ */
+struct gbe_vec_s *gbe_vec_create(const uint8_t *rom, size_t size, int n, int threads, const char **error);
+
+void gbe_vec_destroy(struct gbe_vec_s *v);
+
+int gbe_vec_size(const struct gbe_vec_s *v);
+
+/**
+ * Instance @i, for gbe_reset()/gbe_save()/gbe_wram() between steps
+ * Owned by the vector: do not gbe_destroy() it. NULL if out of range.
+ */
+struct gbe_s *gbe_vec_env(struct gbe_vec_s *v, int i);
+
+/**
+ * Set the same observation sink on every instance (see gbe_set_obs())
+ * @return  0, or -1 (every sink is then off)
+ */
+int gbe_vec_set_obs(struct gbe_vec_s *v, const struct gbe_obs_config_s *cfg);
+
+/**
+ * Bytes per instance in gbe_vec_step()'s @obs: GBE_FB_SIZE, or the whole
+ * observation stack when a sink is set
+ */
+size_t gbe_vec_obs_bytes(const struct gbe_vec_s *v);
+
+/**
+ * Look every instance up in @tt after each gbe_vec_step() (NULL: stop)
+ *
+ * The workers hash the instances they step (gbe_hash()) and insert them
+ * into the table concurrently; the table can be shared with other vectors
+ * and threads. gbe_vec_seen() then says which instances reached a state
+ * already there, so their rollouts can be pruned.
+ */
+void gbe_vec_set_tt(struct gbe_vec_s *v, struct ttable_s *tt);
+
+/**
+ * Results of the last gbe_vec_step() with a table: @seen[i] = 1 if instance
+ * i's state was already in it, @hashes[i] its hash (either may be NULL)
+ *
+ * @return  Number of instances whose state was already seen
+ */
+int gbe_vec_seen(const struct gbe_vec_s *v, uint8_t *seen, uint64_t *hashes);
+
+/**
+ * Step every instance @frames frames, instance i holding @actions[i]
+ *
+ * Workers claim instances one at a time, so a slow instance does not hold
+ * up a whole share. Synchronisation is one wake-up and one completion
+ * wait per call. With @obs, instance i's output goes to
+ * @obs + i * gbe_vec_obs_bytes(): the last frame drawn straight there (its
+ * own gbe_framebuffer() is left as it was), or with a sink its stack,
+ * oldest first. With NULL each instance keeps its output to itself. Must
+ * not run concurrently with anything else using these instances.
+ *
+ * @return  Number of instances that stopped early (see gbe_error())
+ */
+int gbe_vec_step(struct gbe_vec_s *v, const uint8_t *actions, int frames, uint8_t *obs);
+
+#endif // GBE_H
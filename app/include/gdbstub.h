@@ -0,0 +1,82 @@
+/**
+ * gdbstub.h - GDB Remote Serial Protocol Stub
+ *
+ * Lets GDB (or any RSP client, e.g. an IDE) debug the running game:
+ *
+ *   ./gbe game.gb --gdb 2345             (loopback TCP port)
+ *   ./gbe game.gb --gdb /tmp/gbe.gdb     (Unix socket)
+ *   (gdb) target remote localhost:2345
+ *
+ * Registers are reported as six 16-bit little-endian values in the order
+ * AF, BC, DE, HL, SP, PC (the first six registers of GDB's z80 target).
+ * Memory goes through mmu_peek()/mmu_poke(), so reading I/O registers or
+ * writing the ROM area never changes emulator state. Breakpoints (Z0/Z1)
+ * and watchpoints (Z2 write, Z3 read, Z4 access) use debug.h.
+ *
+ * Everything runs on the emulation thread from gdbstub_poll(), called once
+ * per frame and while stopped. With no client attached that is a single
+ * zero-timeout poll() of the listening socket per frame and no debugger is
+ * attached to the core, so the instruction loop is unchanged.
+ */
+
+#ifndef GDBSTUB_H
+#define GDBSTUB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "gb_types.h"
+
+// Largest packet accepted (advertised as PacketSize)
+#define GDB_PACKET_MAX      1024
+
+struct gdbstub_s {
+    int      listen_fd;             // -1 when not listening
+    int      client_fd;             // -1 when no client is attached
+    char     path[108];             // Unix socket path (unlinked on close)
+
+    bool     no_ack;                // QStartNoAckMode negotiated
+    bool     waiting;               // Client resumed us and awaits a stop reply
+    bool     own_debug;             // We attached gb->debug and must free it
+    bool     fresh;                 // Client just connected: stop the target
+
+    // Bytes received but not yet parsed
+    char     in[2 * GDB_PACKET_MAX];
+    size_t   in_len;
+};
+
+/**
+ * Set up an idle stub (not listening, no client)
+ */
+void gdbstub_init(struct gdbstub_s *s);
+
+/**
+ * Listen for a client
+ *
+ * @param where  TCP port on 127.0.0.1 (all digits) or a Unix socket path
+ * @return       true on success
+ */
+bool gdbstub_listen(struct gdbstub_s *s, const char *where);
+
+/**
+ * Use an already connected socket as the client (tests, inetd-style use)
+ *
+ * The target is stopped on the next gdbstub_poll(), as on a normal accept.
+ */
+void gdbstub_attach_fd(struct gdbstub_s *s, int fd);
+
+/**
+ * Accept clients, handle packets and send stop replies (emulation thread)
+ */
+void gdbstub_poll(struct gdbstub_s *s, struct gb_s *gb);
+
+/**
+ * Drop the client and stop listening; resumes the core if it was stopped
+ */
+void gdbstub_close(struct gdbstub_s *s, struct gb_s *gb);
+
+static inline bool gdbstub_active(const struct gdbstub_s *s) {
+    return s->listen_fd >= 0 || s->client_fd >= 0;
+}
+
+#endif // GDBSTUB_H
@@ -20,4 +20,51 @@
 
 void gpu_draw_line(struct gb_s *gb);
 
+// Prerendered background: both tile maps as 256x256 colour indices (0-3),
+// once per tile addressing mode (LCDC bit 4). A BG or window line is then a
+// wrapped copy through the palette. Tile rows are redrawn lazily: VRAM
+// writes mark their page in display.vram_dirty, and the next line drawn
+// drops the map rows that page can affect.
+struct gpu_bg_cache_s {
+    uint8_t px[2][2][256][256];     // [map][LCDC_TILE_SELECT][y][x]
+    uint32_t valid[2][2];           // Up-to-date tile rows, bit per row
+    uint16_t groups[2][32];         // Tile index groups (idx >> 4) each row uses
+};
+
+// Use @cache for @gb's background (NULL to stop). While attached, VRAM
+// writes take the MMU slow path so they can be tracked.
+void gpu_bg_cache_attach(struct gb_s *gb, struct gpu_bg_cache_s *cache);
+
+// Every VRAM page changed (state load, copy)
+static inline void gpu_bg_invalidate(struct gb_s *gb) {
+    gb->display.vram_dirty = 0xFFFFFFFFu;
+}
+
+// I/O register handlers (see mmu_io_read_fn / mmu_io_write_fn)
+uint8_t gpu_read_ly(const struct gb_s *gb);
+uint8_t gpu_read_stat(const struct gb_s *gb);
+void gpu_write_lcdc(struct gb_s *gb, uint8_t val);
+void gpu_write_stat(struct gb_s *gb, uint8_t val);
+void gpu_write_ly(struct gb_s *gb, uint8_t val);
+void gpu_write_wy(struct gb_s *gb, uint8_t val);
+void gpu_write_bgp(struct gb_s *gb, uint8_t val);
+void gpu_write_obp0(struct gb_s *gb, uint8_t val);
+void gpu_write_obp1(struct gb_s *gb, uint8_t val);
+
+// LCD timing runs off counter.cycles: cpu_step() only compares it with
+// counter.lcd_next, and LY and the STAT mode change at those events.
+
+// Cycles into the current scanline
+static inline uint32_t gpu_line_cycles(const struct gb_s *gb) {
+    return (uint32_t)(gb->counter.cycles - gb->counter.line_start);
+}
+
+// Next event for the current mode: the end of mode 2 or 3, else of the line
+static inline void gpu_lcd_schedule(struct gb_s *gb) {
+    uint8_t mode = gb->hram_io[IO_STAT] & STAT_MODE;
+    gb->counter.lcd_next = gb->counter.line_start +
+                           (mode == LCD_MODE_OAM_SCAN ? LCD_MODE2_OAM_SCAN_END :
+                            mode == LCD_MODE_LCD_DRAW ? LCD_MODE3_LCD_DRAW_END : LCD_LINE_CYCLES);
+}
+
 #endif
\ No newline at end of file
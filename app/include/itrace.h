@@ -0,0 +1,123 @@
+/**
+ * itrace.h - Instruction Trace Ring
+ *
+ * Keeps the last N executed instructions so a crash report can show how the
+ * CPU got there. Cheap enough to leave on: one 64-bit store per instruction,
+ * recorded just before it executes and bit-packed as
+ *
+ *   bits  0-15  PC of the instruction
+ *   bits 16-22  Selected ROM bank (only meaningful for PCs in 0x4000-0x7FFF)
+ *   bits 23-30  Opcode (0xCB for prefixed opcodes)
+ *   bits 31-38  A
+ *   bits 39-42  Flags (Z N H C)
+ *   bits 43-45  Register pair changed by the previous instruction (ITRACE_REG_*)
+ *   bits 46-61  New value of that pair
+ *
+ * Operand bytes are not stored; the dump disassembles them from memory (the
+ * recorded ROM bank is used for 0x4000-0x7FFF), so code in RAM that has been
+ * overwritten since may show its current bytes.
+ */
+
+#ifndef ITRACE_H
+#define ITRACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "gb_types.h"
+
+// Ring size used by the frontend; must be a power of two (8 bytes each)
+#define ITRACE_DEFAULT_ENTRIES  4096
+
+// Entries printed by the error handler
+#define ITRACE_DUMP_ON_ERROR    64
+
+// Register pair ids; the order matches struct cpu_registers_s
+enum itrace_reg_e {
+    ITRACE_REG_NONE = 0,
+    ITRACE_REG_BC,
+    ITRACE_REG_DE,
+    ITRACE_REG_HL,
+    ITRACE_REG_SP
+};
+
+struct itrace_s {
+    uint64_t *ring;
+    uint32_t  mask;             // Entries - 1
+    uint64_t  count;            // Instructions recorded (head = count & mask)
+
+    // BC, DE, HL, SP (16 bits each, in that order) as last recorded
+    uint64_t  pairs;
+};
+
+/**
+ * Enable tracing on 'gb' with a ring of 'entries' instructions
+ *
+ * @param entries  Power of two
+ * @return         0 on success, -1 on a bad size or allocation failure
+ */
+int itrace_init(struct gb_s *gb, uint32_t entries);
+
+/**
+ * Disable tracing and free the ring
+ */
+void itrace_free(struct gb_s *gb);
+
+/**
+ * Print the newest 'max' entries (oldest first), disassembled
+ */
+void itrace_dump(struct gb_s *gb, FILE *f, uint32_t max);
+
+/**
+ * Write the whole ring to a text file
+ *
+ * @return  0 on success, -1 if the file could not be written
+ */
+int itrace_write(struct gb_s *gb, const char *path);
+
+/**
+ * Decoded entry, for tools and tests
+ */
+struct itrace_entry_s {
+    uint16_t pc;
+    uint8_t  bank;              // Selected ROM bank, 0 when PC is outside 0x4000-0x7FFF
+    uint8_t  opcode;
+    uint8_t  a;
+    uint8_t  flags;             // ZNHC in bits 3-0
+    uint8_t  reg;               // enum itrace_reg_e
+    uint16_t value;
+};
+
+/**
+ * Decode the entry 'age' instructions back (0 = newest)
+ *
+ * @return  0 on success, -1 if the ring holds fewer entries
+ */
+int itrace_get(const struct gb_s *gb, uint32_t age, struct itrace_entry_s *out);
+
+// -------------------------------
+// Recording (called from cpu_step)
+// -------------------------------
+
+static inline void itrace_record(struct gb_s *gb, uint16_t pc, uint8_t opcode) {
+    struct itrace_s *t = gb->itrace;
+    const struct cpu_registers_s *r = &gb->cpu_reg;
+
+    // BC, DE, HL and SP are adjacent, so one 64-bit XOR finds a change; the
+    // lowest changed pair is recorded (usually the only one). Branch-free,
+    // since whether a pair changed is close to random from one step to the next.
+    uint64_t pairs;
+    memcpy(&pairs, &r->bc, sizeof(pairs));
+    uint64_t diff = pairs ^ t->pairs;
+    uint64_t changed = diff != 0;
+    uint32_t lane = (uint32_t)__builtin_ctzll(diff | (1ULL << 63)) >> 4;
+    uint64_t reg = changed * (lane + 1);
+    uint64_t value = ((pairs >> (lane * 16)) & 0xFFFF) * changed;
+    t->pairs ^= diff & (0xFFFFULL << (lane * 16));
+
+    t->ring[t->count++ & t->mask] = (uint64_t)pc | (uint64_t)(gb->selected_rom_bank & 0x7F) << 16 |
+                                    (uint64_t)opcode << 23 | (uint64_t)r->a << 31 |
+                                    (uint64_t)(r->f.reg >> 4) << 39 | reg << 43 | value << 46;
+}
+
+#endif // ITRACE_H
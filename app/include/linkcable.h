@@ -0,0 +1,109 @@
+/**
+ * linkcable.h - In-Process Link Cable
+ *
+ * Connects the serial ports of two emulator instances running on separate
+ * threads, one thread per side:
+ *
+ *   struct link_cable_s *cable = cable_create(gb_a, gb_b);
+ *   thread A: cable_run(cable, 0, n); ...; cable_hangup(cable, 0);
+ *   thread B: cable_run(cable, 1, n); ...; cable_hangup(cable, 1);
+ *   cable_destroy(cable);
+ *
+ * Each direction is a lock-free single-producer / single-consumer ring of
+ * messages stamped with the sender's emulated cycle count (counter.cycles):
+ * a master sends CLOCK when its transfer completes and blocks for the
+ * REPLY, which the other side sends once its own clock has reached that
+ * stamp. Nothing else is shared per instruction.
+ *
+ * Sides run freely in quanta of CABLE_QUANTUM cycles and, between quanta,
+ * publish a horizon: the earliest cycle at which they could next clock a
+ * byte out. A side waiting on the external clock never runs past its peer's
+ * horizon, so it sees every byte at the cycle it was sent and the exchange
+ * is the same whatever the host threads do. Outside transfers the only
+ * coupling is that neither side runs more than CABLE_MAX_SKEW cycles ahead
+ * of the other, which keeps a master's wait for its reply short.
+ *
+ * Two masters clocking at once both receive 0xFF.
+ */
+
+#ifndef LINKCABLE_H
+#define LINKCABLE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "gb_types.h"
+#include "serial.h"
+
+#define CABLE_QUANTUM       1024                // Cycles run between syncs
+#define CABLE_MAX_SKEW      LCD_FRAME_CYCLES    // Free-running lead over the peer
+#define CABLE_RING_LEN      8                   // Messages in flight per direction
+
+enum cable_msg_e {
+    CABLE_CLOCK,    // Master shifted out a byte
+    CABLE_REPLY     // The byte shifted back in
+};
+
+struct cable_msg_s {
+    uint64_t cycles;    // Sender's counter.cycles
+    uint8_t  byte;
+    uint8_t  kind;      // enum cable_msg_e
+};
+
+struct cable_ring_s {
+    _Alignas(64) _Atomic uint32_t head;     // Consumer index
+    _Alignas(64) _Atomic uint32_t tail;     // Producer index
+    struct cable_msg_s msg[CABLE_RING_LEN];
+};
+
+// One end of the cable; only ever touched by its own side's thread
+struct cable_end_s {
+    struct serial_link_s link;  // gb->link points here
+    struct link_cable_s *cable;
+    int      side;
+
+    bool     clock_pending;     // Peer clocked a byte we have not answered
+    uint64_t clock_at;
+    uint8_t  clock_byte;
+
+    bool     reply_ready;       // Answer to our own CLOCK
+    uint8_t  reply;
+
+    uint64_t transfers;         // Bytes exchanged as master
+    uint64_t stalls;            // Syncs that had to wait for the peer
+};
+
+struct link_cable_s {
+    struct cable_ring_s ring[2];            // ring[i] carries messages from side i
+    _Alignas(64) _Atomic uint64_t horizon[2];
+    _Atomic bool present[2];                // Side has not hung up
+    struct cable_end_s end[2];
+    struct gb_s *gb[2];
+};
+
+/**
+ * Plug two instances together (sets gb->link on both)
+ *
+ * @return  NULL on allocation failure
+ */
+struct link_cable_s *cable_create(struct gb_s *a, struct gb_s *b);
+
+/**
+ * Run one side for @cycles emulated cycles (its own thread)
+ *
+ * Stops early if the debugger stops the CPU.
+ * @return  cycles actually run
+ */
+uint64_t cable_run(struct link_cable_s *cable, int side, uint64_t cycles);
+
+/**
+ * Side is done: the peer stops waiting for it and reads 0xFF from now on
+ */
+void cable_hangup(struct link_cable_s *cable, int side);
+
+/**
+ * Unplug both instances and free the cable (after both threads are done)
+ */
+void cable_destroy(struct link_cable_s *cable);
+
+#endif // LINKCABLE_H
@@ -46,6 +46,31 @@
  */
 uint8_t mmu_read(struct gb_s *gb, uint16_t addr);
 
+/**
+ * Read a byte for a debugger or disassembler
+ * 
+ * Same value as mmu_read() but never fires a watchpoint.
+ * 
+ * @param gb    Emulator context
+ * @param addr  16-bit address to read from
+ * @return      Byte value at address
+ */
+uint8_t mmu_peek(struct gb_s *gb, uint16_t addr);
+
+/**
+ * Write a byte for a debugger
+ * 
+ * Stores into RAM, VRAM, OAM or the raw I/O/HRAM array without any side
+ * effect: ROM-area writes are ignored (they would be MBC commands), and I/O
+ * registers do not trigger DMA, DIV reset or palette updates. Never fires a
+ * watchpoint.
+ * 
+ * @param gb    Emulator context
+ * @param addr  16-bit address to write to
+ * @param val   Byte value to write
+ */
+void mmu_poke(struct gb_s *gb, uint16_t addr, uint8_t val);
+
 /**
  * Write a byte to any memory address
  * 
@@ -74,6 +99,110 @@ void mmu_write(struct gb_s *gb, uint16_t addr, uint8_t val);
  */
 void mmu_init(struct gb_s *gb);
 
+/**
+ * Rebuild the page table
+ * 
+ * Points the direct-access pages at this instance's VRAM/WRAM and applies
+ * the debug trap flags in gb->mmu.trap. Called by mmu_init(); call it again
+ * after copying a struct gb_s (the table holds pointers into the struct) or
+ * after changing trap flags.
+ * 
+ * @param gb    Emulator context
+ */
+void mmu_remap(struct gb_s *gb);
+
+// ----------------------------------
+// Dirty Pages
+// ----------------------------------
+
+/**
+ * Pages written since the last mmu_dirty_clear(), 256 bytes per bit
+ * 
+ * page[]: bit p (word p / 64, bit p % 64) for the page at $pp00 - VRAM
+ * $80-$9F, WRAM $C0-$DF (echo writes included), OAM $FE and HRAM/I/O
+ * $FF. The I/O page is always set: DIV, TIMA, LY, STAT and IF change
+ * without a write. ROM and cart RAM addresses are never set.
+ * cram[]: bit i for cart RAM bytes i * 256 to i * 256 + 255 (any bank).
+ */
+struct mmu_dirty_s {
+    uint64_t page[MMU_NUM_PAGES / 64];
+    uint64_t cram[MMU_CRAM_PAGES / 64];
+};
+
+/**
+ * Report the dirty pages
+ * 
+ * The write path keeps the bitmap with one OR per mmu_write() (OAM DMA
+ * and debugger pokes mark their pages too); this folds the echo area into
+ * WRAM and fills in @out.
+ * 
+ * @param gb    Emulator context
+ * @param out   Receives the dirty pages
+ */
+void mmu_dirty(const struct gb_s *gb, struct mmu_dirty_s *out);
+
+/**
+ * Start tracking from here (e.g. after taking a checkpoint)
+ * 
+ * @param gb    Emulator context
+ */
+void mmu_dirty_clear(struct gb_s *gb);
+
+/**
+ * Mark every page dirty, after the whole state changed at once
+ * (mmu_init() and state_load() do this)
+ * 
+ * @param gb    Emulator context
+ */
+void mmu_dirty_all(struct gb_s *gb);
+
+/**
+ * Whether bit @i of a dirty bitmap is set
+ */
+static inline bool mmu_dirty_test(const uint64_t *bits, unsigned i) {
+    return (bits[i >> 6] >> (i & 63)) & 1;
+}
+
+/**
+ * Read work RAM from elsewhere until it is written (copy-on-write)
+ * 
+ * Points every WRAM page at @wram (WRAM_SIZE bytes, e.g. a snapshot's)
+ * instead of gb->wram. Reads go straight there; the first write to a page
+ * takes the slow path, which copies the page into gb->wram and maps it
+ * back. So an instance restored this way only copies what it modifies.
+ * @wram must not change while any page is still shared; mmu_init() and
+ * state_load() end the sharing.
+ * 
+ * @param gb    Emulator context
+ * @param wram  Work RAM to share
+ */
+void mmu_share_wram(struct gb_s *gb, const uint8_t *wram);
+
+/**
+ * Copy every still-shared WRAM page in, so gb->wram holds all of work RAM
+ * 
+ * @param gb    Emulator context
+ */
+void mmu_unshare_wram(struct gb_s *gb);
+
+/**
+ * Number of WRAM pages still shared (0 - WRAM_SIZE / 256)
+ * 
+ * @param gb    Emulator context
+ */
+int mmu_wram_shared(const struct gb_s *gb);
+
+/**
+ * Current contents of WRAM page @wp (0-31), shared or own
+ * 
+ * @param gb    Emulator context
+ * @param wp    Page index within work RAM
+ * @return      256 bytes
+ */
+static inline const uint8_t *mmu_wram_page(const struct gb_s *gb, int wp) {
+    return gb->mmu.shared[wp] ? gb->mmu.shared[wp] : &gb->wram[wp << MMU_PAGE_SHIFT];
+}
+
 /**
  * Reset memory to initial state
  * 
@@ -117,6 +246,26 @@ int mmu_get_save_size(struct gb_s *gb, uint32_t *ram_size);
 void mmu_dma_transfer(struct gb_s *gb, uint8_t source_high);
 
 
+// ----------------------------------
+// I/O Register Handlers
+// ----------------------------------
+
+/* Number of I/O registers, 0xFF00 - 0xFF7F */
+#define MMU_IO_REGS     0x80
+
+/**
+ * Handlers for one I/O register
+ * 
+ * mmu_read() and mmu_write() dispatch 0xFF00 - 0xFF7F through two tables
+ * with one entry per register, listed per subsystem in memory.c. A NULL
+ * entry is plain storage in hram_io, as is HRAM; a new hardware block adds
+ * its registers there instead of another case in a switch. Reads have no
+ * side effects, so mmu_peek() uses the same table.
+ */
+typedef uint8_t (*mmu_io_read_fn)(const struct gb_s *gb);
+typedef void (*mmu_io_write_fn)(struct gb_s *gb, uint8_t val);
+
+
 // ----------------------------------
 // Memory Region Constants
 // ----------------------------------
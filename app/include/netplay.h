@@ -0,0 +1,174 @@
+/**
+ * netplay.h - Rollback Netplay over UDP
+ *
+ * Two players, each with their own Game Boy, joined by a link cable. Every
+ * peer emulates both machines (player 1 = instance 0, player 2 = instance 1)
+ * on one thread through a serial_wire_s, so the only thing sent over the
+ * network is each player's joypad byte per frame.
+ *
+ *   - Input delay: a local input sampled on frame f is applied on frame
+ *     f + delay (both peers must use the same delay).
+ *   - Prediction: a remote input not yet received is assumed to repeat the
+ *     last one received.
+ *   - Rollback: a snapshot of both machines is taken at the start of each
+ *     frame (state.h). When a remote input arrives that differs from what
+ *     was predicted, both machines are restored to that frame and the
+ *     frames since are run again with the real input and no pixel output.
+ *   - At most NETPLAY_MAX_ROLLBACK frames are run on prediction; beyond that
+ *     netplay_frame() waits for the peer instead of advancing.
+ *
+ * Frames are fixed slices of LCD_FRAME_CYCLES, aligned to instance 0's
+ * VBlank when netplay starts, so both peers cut frames at the same cycles.
+ *
+ * Packets carry all inputs the peer has not acknowledged, so a lost packet
+ * is covered by the next one. Every NETPLAY_HASH_INTERVAL confirmed frames
+ * the peers also exchange a hash of both machines to detect a desync.
+ * Latency and loss can be injected on the sending side for testing.
+ */
+
+#ifndef NETPLAY_H
+#define NETPLAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gb_types.h"
+#include "serial.h"
+#include "state.h"
+
+#define NETPLAY_MAX_ROLLBACK    8       // Frames run ahead of the peer's input
+#define NETPLAY_DEFAULT_DELAY   2       // Frames of input delay
+#define NETPLAY_HISTORY         16      // Frame snapshots kept (> NETPLAY_MAX_ROLLBACK)
+#define NETPLAY_INPUT_RING      128     // Inputs kept per player
+#define NETPLAY_SEND_WINDOW     64      // Most inputs carried by one packet
+#define NETPLAY_HASH_INTERVAL   16      // Frames between desync checks
+#define NETPLAY_HASH_RING       8       // Own hashes kept for the peer's to match
+#define NETPLAY_QUEUE_LEN       256     // Packets held back by injected latency
+#define NETPLAY_RESEND_MS       16      // Resend unacknowledged input while idle
+#define NETPLAY_PACKET_MAX      (36 + NETPLAY_SEND_WINDOW)
+
+struct netplay_stats_s {
+    uint64_t frames;            // Frames advanced
+    uint64_t stalls;            // netplay_frame() calls that waited for the peer
+    uint64_t rollbacks;
+    uint64_t resim_frames;      // Frames run again by rollbacks
+    uint32_t max_rollback;      // Longest rollback, in frames
+    uint64_t max_rollback_ns;   // Longest rollback, host time
+    uint64_t packets_sent;
+    uint64_t packets_received;
+    uint64_t packets_dropped;   // By injected loss
+    uint64_t packets_rejected;  // Wrong ROM, delay or format
+    uint64_t hashes_checked;
+    uint64_t desyncs;
+};
+
+struct netplay_delayed_s {
+    int64_t  due_ns;
+    uint16_t len;
+    uint8_t  data[NETPLAY_PACKET_MAX];
+};
+
+struct netplay_s {
+    int      fd;                // Connected UDP socket, -1 when closed
+    int      local;             // Our player's instance (0 or 1)
+    int      delay;             // Input delay in frames
+
+    // Both machines, stepped together
+    struct gb_s *gb[2];
+    uint8_t *cart_ram[2];
+    size_t   cart_ram_size;
+    struct serial_wire_s wire;
+    void   (*lcd_draw_line)(struct gb_s *gb, const uint8_t *pixels, uint8_t line);
+    uint64_t base_cycles;       // Frame f ends at base_cycles + f * LCD_FRAME_CYCLES
+    uint32_t rom_id;            // Header and global checksums, must match the peer's
+
+    uint32_t frame;             // Next frame to run
+    uint32_t local_frames;      // Our inputs are known for frames < local_frames
+    uint32_t remote_frames;     // Peer's inputs are known for frames < remote_frames
+    uint32_t peer_ack;          // Peer has our inputs for frames < peer_ack
+    uint32_t rollback_to;       // Earliest mispredicted frame (valid if rollback)
+    bool     rollback;
+
+    uint8_t  input[2][NETPLAY_INPUT_RING];
+    uint8_t  used[NETPLAY_HISTORY];     // Remote input each frame ran with
+    struct gb_state_s (*state)[2];      // [NETPLAY_HISTORY]: both machines at the start of each frame
+
+    // Desync check: our hashes of confirmed frames, and the peer's latest
+    uint32_t hash_next;
+    uint32_t hash_frame[NETPLAY_HASH_RING];
+    uint64_t hash[NETPLAY_HASH_RING];
+    uint32_t peer_hash_frame;
+    uint64_t peer_hash;
+    bool     peer_hash_checked;
+
+    // Injected network conditions (outgoing packets)
+    int      latency_ms;
+    int      loss_pct;
+    uint32_t rng;
+    struct netplay_delayed_s queue[NETPLAY_QUEUE_LEN];
+    uint32_t queue_head, queue_tail;
+    int64_t  last_send_ns;
+
+    struct netplay_stats_s stats;
+};
+
+/**
+ * Idle netplay with default options (set delay, latency_ms, loss_pct after)
+ */
+void netplay_init(struct netplay_s *np);
+
+/**
+ * Open the UDP socket
+ *
+ * @param bind_port  Local port to receive on
+ * @param peer       "host:port" of the other player
+ * @return           true on success
+ */
+bool netplay_connect(struct netplay_s *np, const char *bind_port, const char *peer);
+
+/**
+ * Use an already connected datagram socket (tests)
+ */
+void netplay_attach_fd(struct netplay_s *np, int fd);
+
+/**
+ * Start a session
+ *
+ * Both instances must hold the same state on both peers (e.g. a copy of one
+ * freshly booted machine). They are wired together and run to instance 0's
+ * next VBlank, where frame 0 starts.
+ *
+ * @param gb             The two machines, player 1 first
+ * @param cart_ram       Each machine's cartridge RAM (NULL entries if none)
+ * @param cart_ram_size  Bytes of cartridge RAM per machine
+ * @param local          Our player: 0 or 1
+ * @return               0 on success, -1 on allocation failure
+ */
+int netplay_start(struct netplay_s *np, struct gb_s *gb[2], uint8_t *cart_ram[2],
+                  size_t cart_ram_size, int local);
+
+/**
+ * Receive packets, roll back if a prediction was wrong, flush delayed sends
+ */
+void netplay_poll(struct netplay_s *np);
+
+/**
+ * Run one frame with our joypad byte (JOYPAD_* bits, 0 = pressed)
+ *
+ * Only our machine draws. Returns false, without using @input, when too
+ * far ahead of the peer; call again next frame.
+ */
+bool netplay_frame(struct netplay_s *np, uint8_t input);
+
+/**
+ * True when every frame run so far has both players' real input
+ */
+static inline bool netplay_confirmed(const struct netplay_s *np) {
+    return np->remote_frames >= np->frame && !np->rollback;
+}
+
+/**
+ * Close the socket and free the snapshots (the machines stay wired)
+ */
+void netplay_close(struct netplay_s *np);
+
+#endif // NETPLAY_H
@@ -0,0 +1,77 @@
+/**
+ * osd.h - On-Screen Performance Overlay
+ *
+ * Draws FPS, emulation speed (% of a real DMG), the background cache hit
+ * rate (when a cache is attached) and a graph of recent host
+ * frame times directly into the XRGB1555 frame buffer, using a tiny built-in
+ * 3x5 font so no font files or SDL_ttf are needed on the BeagleBone.
+ *
+ * The graph shows busy time per frame (input + CPU + PPU + present, not the
+ * pacer's sleep). The marker line is the 16.74 ms frame budget: bars above
+ * it mean the device is not keeping up.
+ */
+
+#ifndef OSD_H
+#define OSD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gb_types.h"
+
+// Number of frames shown in the frame-time graph (one pixel column each)
+#define OSD_GRAPH_LEN       64
+
+// Graph height in pixels; the budget marker sits at half height
+#define OSD_GRAPH_HEIGHT    16
+
+// FPS / speed readouts are recomputed this often
+#define OSD_UPDATE_NS       500000000LL
+
+struct osd_s {
+    bool     enabled;
+
+    // Frame-time history (ring buffer)
+    uint32_t frame_ns[OSD_GRAPH_LEN];
+    uint32_t head;                  // Next slot to write
+
+    // Readouts, refreshed every OSD_UPDATE_NS
+    double   fps;                   // Frames presented per host second
+    double   speed_pct;             // Emulated cycles per second vs 4.194304 MHz
+    double   bg_hit_pct;            // BG cache lookups that hit, < 0 when unused
+
+    // Snapshot at the start of the current measurement window
+    int64_t  window_start_ns;
+    uint64_t window_frames;
+    uint64_t window_cycles;
+    uint64_t window_bg_hits;
+    uint64_t window_bg_misses;
+};
+
+/**
+ * Reset the overlay state
+ *
+ * @param osd       Overlay state
+ * @param enabled   Whether the overlay starts visible
+ */
+void osd_init(struct osd_s *osd, bool enabled);
+
+/**
+ * Record one presented frame
+ *
+ * @param osd       Overlay state
+ * @param stats     Core statistics (frames, cycles and BG cache counts are read)
+ * @param now_ns    Current CLOCK_MONOTONIC time
+ * @param busy_ns   Host time spent on this frame, excluding pacing sleep
+ */
+void osd_frame(struct osd_s *osd, const struct gb_stats_s *stats,
+               int64_t now_ns, int64_t busy_ns);
+
+/**
+ * Draw the overlay into an XRGB1555 frame buffer (no-op when disabled)
+ *
+ * @param osd       Overlay state
+ * @param fb        Frame buffer, LCD_WIDTH x LCD_HEIGHT pixels
+ */
+void osd_draw(const struct osd_s *osd, uint16_t fb[LCD_HEIGHT][LCD_WIDTH]);
+
+#endif // OSD_H
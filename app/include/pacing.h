@@ -0,0 +1,124 @@
+/**
+ * pacing.h - Frame Pacing Engine
+ *
+ * Paces emulated frames against CLOCK_MONOTONIC using absolute
+ * clock_nanosleep() deadlines, independent of the display refresh rate.
+ *
+ * The Game Boy produces 4194304 / 70224 = ~59.7275 frames per second, so
+ * relying on a 60 Hz vsync runs games ~0.5% fast. The pacer keeps its own
+ * deadline chain (no accumulated rounding drift), re-anchors when the host
+ * falls badly behind instead of bursting frames to catch up, and records
+ * frame-time jitter so pacing quality can be verified on the BeagleBone.
+ */
+
+#ifndef PACING_H
+#define PACING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Native DMG refresh rate: CPU clock / cycles per frame (154 lines * 456 cycles)
+#define PACING_DMG_HZ           (4194304.0 / 70224.0)
+
+// If we are this many periods behind the deadline, re-anchor instead of catching up
+#define PACING_MAX_LAG_FRAMES   3
+
+// A frame whose period differs from the target by more than this is "off-target"
+#define PACING_JITTER_LIMIT_NS  1000000
+
+// -------------------------------
+// Jitter Statistics
+// -------------------------------
+
+struct pacing_stats_s {
+    uint64_t frames;            // Frames paced since the last stats reset
+    uint64_t late_frames;       // Frames whose deadline had already passed
+    uint64_t off_target;        // Frames with |period - target| > PACING_JITTER_LIMIT_NS
+    uint64_t resyncs;           // Times the deadline chain was re-anchored
+
+    double   target_ns;         // Current target period
+    double   mean_ns;           // Mean measured frame period
+    double   stddev_ns;         // Standard deviation of the frame period
+    int64_t  min_ns;            // Shortest measured frame period
+    int64_t  max_ns;            // Longest measured frame period
+    int64_t  max_wake_late_ns;  // Worst wake-up latency past a deadline
+};
+
+// -------------------------------
+// Pacer State
+// -------------------------------
+
+struct pacing_s {
+    double   target_hz;         // Configured frame rate
+    double   period_ns;         // Frame period derived from target_hz
+    bool     enabled;           // When false, pacing_wait() only records stats
+
+    int64_t  deadline_ns;       // Absolute CLOCK_MONOTONIC deadline of the next frame
+    double   deadline_frac;     // Sub-nanosecond remainder carried between frames
+    int64_t  last_wake_ns;      // Wake-up time of the previous frame (0 = none)
+
+    // Running statistics (Welford's algorithm for mean/variance)
+    uint64_t frames;
+    uint64_t late_frames;
+    uint64_t off_target;
+    uint64_t resyncs;
+    double   mean_ns;
+    double   m2_ns;
+    int64_t  min_ns;
+    int64_t  max_ns;
+    int64_t  max_wake_late_ns;
+};
+
+/**
+ * Initialize the pacer
+ *
+ * @param p         Pacer state
+ * @param target_hz Frame rate to pace to (use PACING_DMG_HZ for native speed)
+ */
+void pacing_init(struct pacing_s *p, double target_hz);
+
+/**
+ * Change the target frame rate, keeping the current deadline chain
+ *
+ * @param p         Pacer state
+ * @param target_hz New frame rate (values <= 0 are ignored)
+ */
+void pacing_set_rate(struct pacing_s *p, double target_hz);
+
+/**
+ * Re-anchor the deadline chain at the current time
+ * Call after a pause so the pacer does not try to make up for lost frames.
+ *
+ * @param p     Pacer state
+ */
+void pacing_reset(struct pacing_s *p);
+
+/**
+ * Sleep until the next frame deadline and advance the chain
+ * Call once per emulated frame, after the frame has been presented.
+ *
+ * @param p     Pacer state
+ */
+void pacing_wait(struct pacing_s *p);
+
+/**
+ * Copy the current jitter statistics
+ *
+ * @param p     Pacer state
+ * @param out   Filled with the statistics gathered since the last reset
+ */
+void pacing_get_stats(const struct pacing_s *p, struct pacing_stats_s *out);
+
+/**
+ * Clear the jitter statistics without touching the deadline chain
+ *
+ * @param p     Pacer state
+ */
+void pacing_clear_stats(struct pacing_s *p);
+
+/**
+ * Read CLOCK_MONOTONIC in nanoseconds
+ */
+int64_t pacing_now_ns(void);
+
+#endif // PACING_H
@@ -0,0 +1,54 @@
+/**
+ * palette.h - Host Colours for the LCD
+ *
+ * The PPU hands each line over as DMG shades 0-3 (BGP/OBP0/OBP1 already
+ * applied), so the front-end keeps the frame in that indexed form and turns
+ * it into XRGB1555 once per frame when presenting: a four-entry table
+ * lookup over all 23,040 pixels. Changing the host palette only changes the
+ * table.
+ */
+
+#ifndef PALETTE_H
+#define PALETTE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// A named set of host colours for shades 0-3 (lightest first), 0xRRGGBB
+struct palette_s {
+    const char *name;
+    uint32_t    rgb[4];
+};
+
+// Built-in palettes, the first is the default
+extern const struct palette_s palette_presets[];
+extern const int palette_num_presets;
+
+/**
+ * Parse a palette from the command line
+ *
+ * @param spec  A preset name, or four colours "RRGGBB,RRGGBB,RRGGBB,RRGGBB"
+ * @param rgb   Receives the colours
+ * @return      0 on success, -1 if @spec is not understood
+ */
+int palette_parse(const char *spec, uint32_t rgb[4]);
+
+/**
+ * Build the lookup table for palette_convert()
+ *
+ * @param rgb   Colours for shades 0-3, 0xRRGGBB
+ * @param lut   Receives the same colours as XRGB1555
+ */
+void palette_lut_1555(const uint32_t rgb[4], uint16_t lut[4]);
+
+/**
+ * Convert @n shades (bits 0-1 of each byte) to XRGB1555
+ *
+ * @param shades    Indexed pixels, as passed to lcd_draw_line()
+ * @param out       Receives @n pixels
+ * @param n         Pixel count
+ * @param lut       Table from palette_lut_1555()
+ */
+void palette_convert(const uint8_t *shades, uint16_t *out, size_t n, const uint16_t lut[4]);
+
+#endif /* PALETTE_H */
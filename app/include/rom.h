@@ -9,6 +9,8 @@
 #ifndef ROM_H
 #define ROM_H
  
+#include <stdbool.h>
+#include <stddef.h>
 #include "gb_types.h"
 
 #define DEBUG_ROM 1 // Debug macro that prints lots of info about ROM
@@ -38,6 +40,47 @@
 //  */
 // bool gb_rom_select_bank(struct gb_s* gb, uint8_t bank);
 
+// Reasons a ROM image is rejected
+enum rom_error_e {
+    ROM_OK = 0,
+    ROM_ERR_TOO_SMALL,      // Shorter than the two fixed banks
+    ROM_ERR_LOGO,           // Nintendo logo does not match
+    ROM_ERR_SGB,            // Super GameBoy cartridge
+    ROM_ERR_ROM_SIZE,       // Unknown ROM size code
+    ROM_ERR_CART_TYPE       // Mapper other than none / MBC1
+};
+
+// What the cartridge header says
+struct rom_info_s {
+    uint8_t cart_type;      // Header byte 0x0147
+    uint8_t mbc;            // 0 = none, 1 = MBC1
+    bool    cart_ram;       // Cartridge has RAM
+    bool    cgb;            // CGB-compatible (runs in DMG mode)
+    uint8_t num_rom_banks;
+    uint8_t num_ram_banks;
+    size_t  cart_ram_size;  // Bytes of cartridge RAM to allocate (0 for none)
+};
+
+/**
+ * Check and decode a ROM header, without printing anything
+ * @param rom   ROM image
+ * @param size  Its size in bytes
+ * @param info  Filled in (zeroed on error)
+ * @return      ROM_OK or the reason the image is rejected
+ */
+enum rom_error_e rom_parse_header(const uint8_t *rom, size_t size, struct rom_info_s *info);
+
+/**
+ * One-line description of a rom_error_e
+ */
+const char *rom_error_str(enum rom_error_e err);
+
+/**
+ * Apply the cartridge info to @gb and power it on (mmu_init + cpu_init)
+ * The ROM and cart RAM callbacks must already be set.
+ */
+void rom_setup(struct gb_s *gb, const struct rom_info_s *info);
+
 /** 
  *  Bootloader function to initialize and return a pointer to the main emulator context.
  *  @param rom_path Path to the ROM file to load.
@@ -51,6 +94,20 @@ struct gb_s* bootloader(char* rom_path);
  */
 void bootloader_cleanup(void);
 
+/**
+ * Touch every page of the loaded ROM and cart RAM
+ * Used by real-time mode so the emulation loop never takes a first-touch
+ * page fault on cartridge memory.
+ */
+void bootloader_prefault(void);
+
+/**
+ * The loaded cartridge RAM, for save states
+ * @param size  Set to its size in bytes (0 if the cartridge has none)
+ * @return      NULL if the cartridge has none
+ */
+uint8_t *bootloader_cart_ram(size_t *size);
+
 
 
 
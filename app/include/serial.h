@@ -0,0 +1,81 @@
+/**
+ * serial.h - Serial Port (Link Cable)
+ *
+ * SB (0xFF01) holds the byte to send and, once a transfer is done, the byte
+ * received. Writing SC (0xFF02) with bit 7 set starts a transfer:
+ *
+ *   SC = 0x81   internal clock: this side is the master and shifts the byte
+ *               out over SERIAL_CYCLES, then the transfer completes
+ *   SC = 0x80   external clock: this side waits for the other end to clock
+ *               a byte in, however long that takes
+ *
+ * On completion SB holds the received byte, SC bit 7 clears and the serial
+ * interrupt is requested. With no cable (gb->link == NULL) a master receives
+ * 0xFF and an external-clock transfer never finishes, as on hardware.
+ *
+ * What is on the other end of the cable is a serial_link_s backend: a
+ * serial_wire_s joins two instances stepped by one thread (below), and
+ * linkcable.h joins two instances running on their own threads.
+ */
+
+#ifndef SERIAL_H
+#define SERIAL_H
+
+#include <stdint.h>
+#include "gb_types.h"
+
+struct serial_link_s {
+    /**
+     * Internal clock: the master has shifted out @out; return the byte the
+     * other end shifted back in. Called once per transfer on completion.
+     */
+    uint8_t (*transfer)(struct serial_link_s *link, struct gb_s *gb, uint8_t out);
+
+    /**
+     * External clock: called after every instruction while waiting. The
+     * backend finishes the transfer with serial_complete() when the other
+     * end clocks a byte in. May be NULL.
+     */
+    void (*poll)(struct serial_link_s *link, struct gb_s *gb);
+};
+
+// Two instances on one thread; see serial_wire_run()
+struct serial_wire_s {
+    struct serial_wire_end_s {
+        struct serial_link_s link;  // gb->link points here
+        struct gb_s *peer;
+    } end[2];
+};
+
+/**
+ * Handle a write to SC (from mmu_write)
+ */
+void serial_write_sc(struct gb_s *gb, uint8_t val);
+
+/**
+ * Advance a transfer in progress by @cycles (from cpu_step, SC bit 7 set)
+ */
+void serial_step(struct gb_s *gb, uint16_t cycles);
+
+/**
+ * Finish the current transfer: SB = @in, clear SC bit 7, request the
+ * serial interrupt
+ */
+void serial_complete(struct gb_s *gb, uint8_t in);
+
+/**
+ * Plug @a and @b into @w (sets gb->link on both)
+ */
+void serial_wire_connect(struct serial_wire_s *w, struct gb_s *a, struct gb_s *b);
+
+/**
+ * Step both instances of a wire until each has reached @until (counter.cycles)
+ *
+ * Always steps whichever is behind, so a master's byte reaches the peer
+ * within one instruction of the cycle it was sent on and the result depends
+ * only on the two starting states. Stops early if either CPU is stopped by
+ * the debugger.
+ */
+void serial_wire_run(struct serial_wire_s *w, uint64_t until);
+
+#endif // SERIAL_H
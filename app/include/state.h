@@ -0,0 +1,149 @@
+/**
+ * state.h - Save States
+ *
+ * In-memory snapshots of an emulator instance, cheap enough to take every
+ * frame: a snapshot is one copy of struct gb_s plus the cartridge RAM.
+ *
+ * Host-owned fields (struct state_host_s) are not part of the state and
+ * survive a load. The ROM is not saved;
+ * a snapshot must be loaded into an instance running the same ROM. A load
+ * marks every page dirty (see mmu_dirty()).
+ */
+
+#ifndef STATE_H
+#define STATE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "gb_types.h"
+
+// Pages of an incremental hash: VRAM, WRAM, OAM, HRAM/I/O, cart RAM
+#define STATE_HASH_PAGES    (2 * (VRAM_SIZE >> MMU_PAGE_SHIFT) + 2 + MMU_CRAM_PAGES)
+
+// Fields of struct gb_s that belong to the host, not to the emulated
+// machine: the callbacks and draw mask, the BG cache, the
+// trace/debugger/link attachments, direct.priv, the host-time statistics,
+// gb_break and the page-table traps. Code that copies one gb_s over
+// another saves them first and restores them after, so a field added here
+// is kept by every such copy.
+struct state_host_s {
+    uint8_t (*rom_read)(struct gb_s*, const uint32_t);
+    uint8_t (*cart_ram_read)(struct gb_s*, const uint32_t);
+    void (*cart_ram_write)(struct gb_s*, const uint32_t, const uint8_t);
+    void (*error)(struct gb_s*, const enum gb_error_e, const uint16_t);
+    void (*lcd_draw_line)(struct gb_s*, const uint8_t*, uint8_t);
+    const uint32_t *draw_mask;
+    struct gpu_bg_cache_s *bg_cache;
+    struct itrace_s *itrace;
+    struct debug_s *debug;
+    struct serial_link_s *link;
+    void *priv;
+    uint64_t ppu_ns, cpu_ns, present_ns, input_ns;
+    bool time_ppu;
+    bool brk;
+    uint8_t trap[MMU_NUM_PAGES];
+};
+
+struct gb_state_s {
+    struct gb_s gb;             // Emulated state (host-owned fields ignored)
+    uint8_t    *cart_ram;       // Copy of cartridge RAM, NULL if none
+    size_t      cart_ram_size;
+};
+
+/**
+ * Allocate room for a snapshot
+ *
+ * @param cart_ram_size  Bytes of cartridge RAM to save with it (0 for none)
+ * @return               0 on success, -1 on allocation failure
+ */
+int state_init(struct gb_state_s *st, size_t cart_ram_size);
+
+void state_free(struct gb_state_s *st);
+
+/**
+ * Save the host-owned fields of @gb into @h
+ */
+void state_host_save(struct state_host_s *h, const struct gb_s *gb);
+
+/**
+ * Put the host-owned fields back into @gb (the page table is not remapped)
+ */
+void state_host_restore(struct gb_s *gb, const struct state_host_s *h);
+
+/**
+ * Make @dst a detached copy of @src's emulated state
+ *
+ * Every host-owned field of @dst is cleared (no callbacks, attachments or
+ * traps) and its page table rebuilt; set the callbacks before running it.
+ */
+void state_clone(struct gb_s *dst, const struct gb_s *src);
+
+/**
+ * Take a snapshot of @gb; @cart_ram holds st->cart_ram_size bytes (or NULL)
+ */
+void state_save(struct gb_state_s *st, const struct gb_s *gb, const uint8_t *cart_ram);
+
+/**
+ * Restore @gb (and @cart_ram, if given) from a snapshot
+ */
+void state_load(struct gb_s *gb, const struct gb_state_s *st, uint8_t *cart_ram);
+
+/**
+ * Restore @gb from a snapshot, sharing its work RAM copy-on-write
+ *
+ * As state_load() without cartridge RAM, but WRAM pages are read from @st
+ * and copied in only when first written (see mmu_share_wram()), so loading
+ * costs in proportion to what the instance goes on to modify. @st must
+ * not change while @gb still shares it: until the next load, mmu_init() or
+ * mmu_unshare_wram().
+ */
+void state_load_shared(struct gb_s *gb, const struct gb_state_s *st);
+
+/**
+ * 64-bit FNV-1a hash of the emulated state, to check two instances agree
+ *
+ * Covers what the incremental hash below does, so clearing the statistics
+ * on one instance does not change it.
+ */
+uint64_t state_hash(const struct gb_s *gb, const uint8_t *cart_ram, size_t cart_ram_size);
+
+// -------------------------------
+// Incremental Hash
+// -------------------------------
+// For spotting repeated states in a search: a 64-bit hash of the machine
+// (CPU, banking, timers, PPU counters and all RAM) that leaves out cycle
+// counts and statistics, so the same state reached by different paths
+// hashes the same. Each 256-byte page has its own hash and the state's is
+// their XOR with the registers', so an update re-hashes only the pages the
+// dirty bitmap reports. Values are only comparable on one host.
+
+struct state_hasher_s {
+    uint64_t page[STATE_HASH_PAGES];    // Hash of each page as last seen
+    uint64_t pages;                     // XOR of page[]
+    int cram_pages;                     // Cart RAM pages hashed, -1 before the first update
+};
+
+/**
+ * Start over: the next update hashes every page
+ */
+void state_hasher_init(struct state_hasher_s *h);
+
+/**
+ * Hash the state, re-hashing only the pages written since the last update
+ *
+ * Takes and clears gb's dirty bitmap (see mmu_dirty()), so nothing else
+ * may clear it between updates.
+ *
+ * @param cram        Cart RAM by page: cram[i] holds bytes i * 256 to
+ *                    i * 256 + 255 (e.g. cart_ram + i * 256)
+ * @param cram_pages  Number of pages (0 - MMU_CRAM_PAGES)
+ */
+uint64_t state_hash_update(struct state_hasher_s *h, struct gb_s *gb, const uint8_t *const cram[], int cram_pages);
+
+/**
+ * The same hash computed from scratch, without a hasher
+ */
+uint64_t state_hash_full(const struct gb_s *gb, const uint8_t *const cram[], int cram_pages);
+
+#endif // STATE_H
@@ -1,5 +1,10 @@
 /**
  * timers.h - Timer Subsystem Interface
+ *
+ * The divider is not counted per instruction. DIV is the high byte of a
+ * 16-bit counter that runs at the CPU clock, so it is derived on demand
+ * from counter.cycles; a write to DIV only records when the counter
+ * restarted from 0 (counter.div_base). hram_io[IO_DIV] is not used.
  */
 
 #ifndef GB_TIMERS_H
@@ -8,18 +13,32 @@
 #include "gb_types.h"
 
 /**
- * Update timers for given number of CPU cycles
- * 
- * @param gb        Emulator context
- * @param cycles    Number of CPU cycles that have passed
+ * The 16-bit divider: cycles since DIV was last reset, wrapping
+ */
+static inline uint16_t timers_divider(const struct gb_s *gb) {
+    return (uint16_t)(gb->counter.cycles - gb->counter.div_base);
+}
+
+/**
+ * Value of DIV (0xFF04)
+ */
+uint8_t timers_read_div(const struct gb_s *gb);
+
+/**
+ * A CPU write to DIV: any value resets the divider to 0
+ */
+void timers_write_div(struct gb_s *gb, uint8_t val);
+
+/**
+ * Make DIV read @val, the divider just past an increment (debuggers)
  */
-void timers_step(struct gb_s *gb, uint16_t cycles);
+void timers_set_div(struct gb_s *gb, uint8_t val);
 
 /**
- * Reset timers to initial state
- * 
+ * Reset timers to the post-boot state
+ *
  * @param gb        Emulator context
  */
 void timers_reset(struct gb_s *gb);
 
-#endif /* GB_TIMERS_H */
\ No newline at end of file
+#endif /* GB_TIMERS_H */
@@ -0,0 +1,95 @@
+/**
+ * trace.h - Optional Chrome/Perfetto Trace Instrumentation
+ *
+ * Scoped spans around the emulation phases, viewable in chrome://tracing or
+ * ui.perfetto.dev:
+ *
+ *   void run_frame(...) {
+ *       TRACE_SCOPE("run_frame");
+ *       ...
+ *   }   // span ends here
+ *
+ * Built only with -DGBE_TRACE=ON. Otherwise every macro and function below
+ * compiles to nothing, so spans can stay in hot paths.
+ *
+ * Each thread records into its own lock-free ring buffer (single producer,
+ * single consumer); a background thread drains the rings and writes Chrome
+ * trace JSON, so the emulation thread never blocks on file I/O. Events that
+ * arrive while a ring is full are dropped and counted.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef GBE_TRACE
+
+// Events per thread ring (power of two); ~1.5 MB at 24 bytes per event
+#define TRACE_RING_SIZE     65536
+
+// How often the flusher thread drains the rings
+#define TRACE_FLUSH_NS      50000000L
+
+struct trace_scope_s {
+    const char *name;
+    uint64_t    start_ns;
+};
+
+/**
+ * Open 'path' and start the flusher thread
+ *
+ * @param path  Output file (Chrome trace JSON)
+ * @return      true on success
+ */
+bool trace_init(const char *path);
+
+/**
+ * Drain all rings, finish the JSON file and stop the flusher thread
+ * Prints the number of dropped events, if any.
+ */
+void trace_shutdown(void);
+
+/**
+ * Name the calling thread in the trace (e.g. "emulation", "input")
+ */
+void trace_thread_name(const char *name);
+
+/**
+ * Record a complete span for the calling thread
+ * No-op until trace_init() has succeeded.
+ *
+ * @param name      Span name (must be a string literal or otherwise outlive the trace)
+ * @param start_ns  CLOCK_MONOTONIC start time from trace_now_ns()
+ */
+void trace_span(const char *name, uint64_t start_ns);
+
+/**
+ * Read CLOCK_MONOTONIC in nanoseconds
+ */
+uint64_t trace_now_ns(void);
+
+static inline void trace_scope_end(struct trace_scope_s *scope) {
+    trace_span(scope->name, scope->start_ns);
+}
+
+#define TRACE_CAT_(a, b)    a##b
+#define TRACE_CAT(a, b)     TRACE_CAT_(a, b)
+
+// Span from this line to the end of the enclosing block
+#define TRACE_SCOPE(name) \
+    struct trace_scope_s TRACE_CAT(trace_scope_, __LINE__) \
+        __attribute__((cleanup(trace_scope_end))) = { (name), trace_now_ns() }
+
+#else // !GBE_TRACE
+
+#define TRACE_SCOPE(name)   do { } while (0)
+
+static inline bool trace_init(const char *path) { (void)path; return false; }
+static inline void trace_shutdown(void) { }
+static inline void trace_thread_name(const char *name) { (void)name; }
+
+#endif // GBE_TRACE
+
+#endif // TRACE_H
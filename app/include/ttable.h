@@ -0,0 +1,61 @@
+/**
+ * ttable.h - Transposition Table
+ *
+ * A fixed-size set of 64-bit state hashes (see state_hash_update()) that
+ * many threads can fill at once, so a batch search can prune rollouts that
+ * reach a state another rollout has already seen:
+ *
+ *   struct ttable_s *seen = ttable_create(1 << 20);
+ *   ... on any worker:
+ *   if (ttable_insert(seen, gbe_hash(g))) prune();
+ *
+ * Open addressing with linear probing over one array of atomic keys; an
+ * insert is one compare-and-swap on an empty slot, a lookup takes no locks.
+ * Keys are never removed. When all probes for a key are taken the key is
+ * not stored (ttable_dropped() counts these), so size the table for the
+ * states a search expects to see.
+ */
+
+#ifndef TTABLE_H
+#define TTABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Slots tried per key before giving up
+#define TTABLE_PROBES   16
+
+struct ttable_s;
+
+/**
+ * Allocate a table of at least @entries slots (rounded up to a power of two)
+ * @return  NULL on allocation failure
+ */
+struct ttable_s *ttable_create(size_t entries);
+
+void ttable_destroy(struct ttable_s *t);
+
+/**
+ * Add @key (thread-safe)
+ * @return  true if it was already in the table
+ */
+bool ttable_insert(struct ttable_s *t, uint64_t key);
+
+/**
+ * Whether @key is in the table (thread-safe)
+ */
+bool ttable_contains(const struct ttable_s *t, uint64_t key);
+
+/**
+ * Keys stored, and keys not stored because their probes were full
+ */
+size_t ttable_count(const struct ttable_s *t);
+size_t ttable_dropped(const struct ttable_s *t);
+
+/**
+ * Empty the table; not safe while other threads use it
+ */
+void ttable_clear(struct ttable_s *t);
+
+#endif // TTABLE_H
@@ -0,0 +1,239 @@
+/**
+ * console.c - Debugger Console
+ *
+ * Background line reader (stdin or one Unix-socket client at a time) and
+ * the emulation-thread side that runs the queued commands.
+ */
+
+#include "console.h"
+#include "debug.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static const char PROMPT[] = "(gbe) ";
+
+// Send to the current client; never blocks the emulation thread for long
+// and never raises SIGPIPE when the client has gone
+static void send_out(struct console_s *c, const char *text, size_t len) {
+    pthread_mutex_lock(&c->lock);
+    if (c->out_fd >= 0) {
+        if (c->listen_fd >= 0) {
+            (void)send(c->out_fd, text, len, MSG_NOSIGNAL | MSG_DONTWAIT);
+        } else {
+            (void)write(c->out_fd, text, len);
+        }
+    }
+    pthread_mutex_unlock(&c->lock);
+}
+
+static void push_line(struct console_s *c, const char *line) {
+    pthread_mutex_lock(&c->lock);
+    if (c->tail - c->head < CONSOLE_QUEUE_LEN) {
+        snprintf(c->queue[c->tail % CONSOLE_QUEUE_LEN], CONSOLE_LINE_MAX, "%s", line);
+        c->tail++;
+    }
+    pthread_mutex_unlock(&c->lock);
+}
+
+static bool pop_line(struct console_s *c, char *line) {
+    bool ok = false;
+    pthread_mutex_lock(&c->lock);
+    if (c->head != c->tail) {
+        memcpy(line, c->queue[c->head % CONSOLE_QUEUE_LEN], CONSOLE_LINE_MAX);
+        c->head++;
+        ok = true;
+    }
+    pthread_mutex_unlock(&c->lock);
+    return ok;
+}
+
+static void set_client(struct console_s *c, int fd) {
+    pthread_mutex_lock(&c->lock);
+    if (c->in_fd >= 0 && c->listen_fd >= 0) {
+        close(c->in_fd);
+    }
+    c->in_fd = fd;
+    c->out_fd = fd;
+    c->partial_len = 0;
+    pthread_mutex_unlock(&c->lock);
+}
+
+// -------------------------------
+// Reader thread
+// -------------------------------
+
+static void *reader_main(void *arg) {
+    struct console_s *c = arg;
+    char buf[256];
+
+    while (!atomic_load(&c->stop)) {
+        /* Socket mode: wait for a client */
+        if (c->in_fd < 0) {
+            struct pollfd pfd = { .fd = c->listen_fd, .events = POLLIN };
+            if (poll(&pfd, 1, CONSOLE_POLL_MS) > 0) {
+                int fd = accept(c->listen_fd, NULL, NULL);
+                if (fd >= 0) {
+                    set_client(c, fd);
+                    static const char banner[] = "gbe debugger, type help\n";
+                    send_out(c, banner, sizeof(banner) - 1);
+                    send_out(c, PROMPT, sizeof(PROMPT) - 1);
+                }
+            }
+            continue;
+        }
+
+        struct pollfd pfd = { .fd = c->in_fd, .events = POLLIN };
+        if (poll(&pfd, 1, CONSOLE_POLL_MS) <= 0) {
+            continue;
+        }
+
+        ssize_t n = read(c->in_fd, buf, sizeof(buf));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            if (c->listen_fd < 0) break;    // stdin closed
+            set_client(c, -1);              // Client left; accept the next one
+            continue;
+        }
+
+        for (ssize_t i = 0; i < n; i++) {
+            if (buf[i] == '\n') {
+                c->partial[c->partial_len] = '\0';
+                push_line(c, c->partial);
+                c->partial_len = 0;
+            } else if (c->partial_len < CONSOLE_LINE_MAX - 1) {
+                c->partial[c->partial_len++] = buf[i];
+            }
+        }
+    }
+    return NULL;
+}
+
+// -------------------------------
+// Start / stop
+// -------------------------------
+
+static int listen_unix(const char *path) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Console socket path too long: %s\n", path);
+        return -1;
+    }
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("console: socket");
+        return -1;
+    }
+    unlink(path);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, 1) != 0) {
+        perror("console: bind");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool console_start(struct console_s *c, const char *socket_path) {
+    memset(c, 0, sizeof(*c));
+    c->listen_fd = -1;
+    c->in_fd = -1;
+    c->out_fd = -1;
+    atomic_init(&c->stop, false);
+
+    if (socket_path) {
+        c->listen_fd = listen_unix(socket_path);
+        if (c->listen_fd < 0) return false;
+        snprintf(c->path, sizeof(c->path), "%s", socket_path);
+    } else {
+        c->in_fd = STDIN_FILENO;
+        c->out_fd = STDOUT_FILENO;
+    }
+
+    pthread_mutex_init(&c->lock, NULL);
+    if (pthread_create(&c->thread, NULL, reader_main, c) != 0) {
+        fprintf(stderr, "Failed to start console thread\n");
+        pthread_mutex_destroy(&c->lock);
+        if (c->listen_fd >= 0) {
+            close(c->listen_fd);
+            unlink(c->path);
+        }
+        return false;
+    }
+
+    c->running = true;
+    if (socket_path) {
+        printf("✓ Debugger listening on %s\n", socket_path);
+    } else {
+        printf("✓ Debugger console on stdin (type help)\n");
+    }
+    return true;
+}
+
+void console_stop(struct console_s *c) {
+    if (!c->running) return;
+
+    atomic_store(&c->stop, true);
+    pthread_join(c->thread, NULL);
+
+    if (c->listen_fd >= 0) {
+        set_client(c, -1);
+        close(c->listen_fd);
+        unlink(c->path);
+    }
+    pthread_mutex_destroy(&c->lock);
+    c->running = false;
+}
+
+// -------------------------------
+// Emulation thread
+// -------------------------------
+
+void console_poll(struct console_s *c, struct gb_s *gb) {
+    char line[CONSOLE_LINE_MAX];
+    char *text = NULL;
+    size_t len = 0;
+
+    if (!gb->debug) return;
+
+    /* Nothing to do on most frames: skip the stream setup */
+    pthread_mutex_lock(&c->lock);
+    bool pending = c->head != c->tail;
+    pthread_mutex_unlock(&c->lock);
+    if (!pending && !(gb->gb_break && gb->debug->stops != c->stops_seen)) {
+        return;
+    }
+
+    /* Commands and stop reports are collected, then sent in one go */
+    FILE *out = open_memstream(&text, &len);
+    if (!out) return;
+
+    bool prompt = false;
+    while (pop_line(c, line)) {
+        debug_command(gb, line, out);
+        prompt = true;
+    }
+
+    if (gb->gb_break && gb->debug->stops != c->stops_seen) {
+        debug_print_stop(gb, out);
+        prompt = true;
+    }
+    c->stops_seen = gb->debug->stops;
+
+    if (prompt) {
+        fputs(PROMPT, out);
+    }
+    fclose(out);
+
+    if (len > 0) {
+        send_out(c, text, len);
+    }
+    free(text);
+}
@@ -12,10 +12,15 @@
 #include "gb_types.h"
 #include "memory.h"
 #include "gpu.h"
+#include "opcodes.h"
+#include "itrace.h"
+#include "debug.h"
+#include "serial.h"
 
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 
 // Cycle counts for each opcode (0x00-0xFF)
 // Directly mirrors the timing of the original hardware.
@@ -25,43 +30,36 @@
 //   or make the emulator incompatible.
 // Usage: When the emulator fetches and executes an opcode, it looks up the number 
 //   of cycles required using OPCODE_CYCLES[opcode] and advances the emulation 
-//   clock by that value.
-static const uint8_t OPCODE_CYCLES[256] = {
-    4,12, 8, 8, 4, 4, 8, 4,20, 8, 8, 8, 4, 4, 8, 4,  /* 0x00-0x0F */
-    4,12, 8, 8, 4, 4, 8, 4,12, 8, 8, 8, 4, 4, 8, 4,  /* 0x10-0x1F */
-    8,12, 8, 8, 4, 4, 8, 4, 8, 8, 8, 8, 4, 4, 8, 4,  /* 0x20-0x2F */
-    8,12, 8, 8,12,12,12, 4, 8, 8, 8, 8, 4, 4, 8, 4,  /* 0x30-0x3F */
-    4, 4, 4, 4, 4, 4, 8, 4, 4, 4, 4, 4, 4, 4, 8, 4,  /* 0x40-0x4F */
-    4, 4, 4, 4, 4, 4, 8, 4, 4, 4, 4, 4, 4, 4, 8, 4,  /* 0x50-0x5F */
-    4, 4, 4, 4, 4, 4, 8, 4, 4, 4, 4, 4, 4, 4, 8, 4,  /* 0x60-0x6F */
-    8, 8, 8, 8, 8, 8, 4, 8, 4, 4, 4, 4, 4, 4, 8, 4,  /* 0x70-0x7F */
-    4, 4, 4, 4, 4, 4, 8, 4, 4, 4, 4, 4, 4, 4, 8, 4,  /* 0x80-0x8F */
-    4, 4, 4, 4, 4, 4, 8, 4, 4, 4, 4, 4, 4, 4, 8, 4,  /* 0x90-0x9F */
-    4, 4, 4, 4, 4, 4, 8, 4, 4, 4, 4, 4, 4, 4, 8, 4,  /* 0xA0-0xAF */
-    4, 4, 4, 4, 4, 4, 8, 4, 4, 4, 4, 4, 4, 4, 8, 4,  /* 0xB0-0xBF */
-    8,12,12,16,12,16, 8,16, 8,16,12, 8,12,24, 8,16,  /* 0xC0-0xCF */
-    8,12,12, 0,12,16, 8,16, 8,16,12, 0,12, 0, 8,16,  /* 0xD0-0xDF */
-   12,12, 8, 0, 0,16, 8,16,16, 4,16, 0, 0, 0, 8,16,  /* 0xE0-0xEF */
-   12,12, 8, 4, 0,16, 8,16,12, 8,16, 4, 0, 0, 8,16   /* 0xF0-0xFF */
-};
+//   clock by that value. Conditional branches that are taken use 
+//   OPCODE_CYCLES_TAKEN[opcode] instead.
+// Both are generated from OPCODE_TABLE (opcodes.h), shared with the disassembler.
+#define OPCODE_CYCLES_ROW(op, mn, len, cyc, taken, fl, acc)       [op] = cyc,
+#define OPCODE_TAKEN_ROW(op, mn, len, cyc, taken, fl, acc)        [op] = taken,
+static const uint8_t OPCODE_CYCLES[256] = { OPCODE_TABLE(OPCODE_CYCLES_ROW) };
+static const uint8_t OPCODE_CYCLES_TAKEN[256] = { OPCODE_TABLE(OPCODE_TAKEN_ROW) };
+
+// Host monotonic time, used only when gb->stats.time_ppu is set
+static uint64_t host_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
 
 
 // -------------------------------
 // Interrupt Handling
 // -------------------------------
 
-void cpu_handle_interrupts(struct gb_s* gb) {
+uint16_t cpu_handle_interrupts(struct gb_s* gb) {
     
     // Check if interrupts are enabled and if any are pending
     if (!gb->gb_ime)
-        return;
+        return 0;
     
-    uint8_t if_flag = gb->hram_io[IO_IF];
-    uint8_t ie_flag = gb->hram_io[IO_IE];
-    uint8_t interrupts = if_flag & ie_flag & 0x1F;
+    uint8_t interrupts = gb->irq_pending;
     
     if (interrupts == 0)
-        return;
+        return 0;
     
     // Disable interrupts
     gb->gb_ime = false;
@@ -87,6 +85,10 @@ void cpu_handle_interrupts(struct gb_s* gb) {
         gb->cpu_reg.pc.reg = 0x0060;
         gb->hram_io[IO_IF] &= ~0x10;
     }
+    cpu_irq_update(gb);
+
+    // Two wait states, the push and the jump
+    return 20;
 }
 
 // -------------------------------
@@ -98,8 +100,8 @@ void cpu_handle_interrupts(struct gb_s* gb) {
 // -------------------------------
 
 uint8_t cpu_execute_cb(struct gb_s *gb) {
-    uint8_t cycles = 8;
     uint8_t cbop = mmu_read(gb, gb->cpu_reg.pc.reg++);
+    uint8_t cycles = OPCODE_CB_CYCLES(cbop);
     uint8_t reg_idx = cbop & 0x7;
     uint8_t bit = (cbop >> 3) & 0x7;
     uint8_t op_type = cbop >> 6;
@@ -116,7 +118,6 @@ uint8_t cpu_execute_cb(struct gb_s *gb) {
         case 5: val = gb->cpu_reg.hl.bytes.l; break;
         case 6: 
             val = mmu_read(gb, gb->cpu_reg.hl.reg);
-            cycles = 16; /* (HL) operations take longer */
             break;
         case 7: val = gb->cpu_reg.a; break;
     }
@@ -188,7 +189,6 @@ uint8_t cpu_execute_cb(struct gb_s *gb) {
             gb->cpu_reg.f.f_bits.n = 0;
             gb->cpu_reg.f.f_bits.h = 1;
             writeback = false;
-            cycles = (reg_idx == 6) ? 12 : 8;
             break;
         case 2: /* RES */
             val &= ~(1 << bit);
@@ -228,6 +228,120 @@ void gb_write(struct gb_s* gb, uint32_t addr, const uint8_t val){
 }
 
 
+// -------------------------------
+// LCD Timing
+// -------------------------------
+
+// One LCD event: a new scanline, or the end of mode 2 or 3. In between,
+// LY and the STAT mode stay as they are, so cpu_step() only compares
+// counter.cycles with counter.lcd_next.
+static void lcd_event(struct gb_s *gb) {
+    /* New Scanline. HBlank -> VBlank or OAM Scan */
+    if(gpu_line_cycles(gb) >= LCD_LINE_CYCLES){
+
+        gb->counter.line_start += LCD_LINE_CYCLES;
+
+        /* Next line, back to 0 after the last VBlank line */
+        gb->hram_io[IO_LY] = gb->hram_io[IO_LY] + 1 < LCD_VERT_LINES ? gb->hram_io[IO_LY] + 1 : 0;
+
+        /* LYC Update */
+        if(gb->hram_io[IO_LY] == gb->hram_io[IO_LYC]){
+            gb->hram_io[IO_STAT] |= STAT_LYC_COINC;
+
+            if(gb->hram_io[IO_STAT] & STAT_LYC_INTR) cpu_irq_raise(gb, LCDC_INTR);
+        } else {
+            gb->hram_io[IO_STAT] &= 0xFB;
+        }
+
+        /* Check if LCD should be in Mode 1 (VBLANK) state */
+        if(gb->hram_io[IO_LY] == LCD_HEIGHT){
+            gb->hram_io[IO_STAT] = (gb->hram_io[IO_STAT] & ~STAT_MODE) | LCD_MODE_VBLANK;
+            gb->gb_frame = true;
+            cpu_irq_raise(gb, VBLANK_INTR);
+            gb->lcd_blank = false;
+
+            if(gb->hram_io[IO_STAT] & STAT_MODE_1_INTR) cpu_irq_raise(gb, LCDC_INTR);
+
+            gb->frame_debug++;   // increment once per frame
+            gb->stats.frames++;
+
+        /* Start of normal Line (not in VBLANK) */
+        } else if(gb->hram_io[IO_LY] < LCD_HEIGHT){ 
+            if(gb->hram_io[IO_LY] == 0){
+                /* Clear Screen */
+                gb->display.WY = gb->hram_io[IO_WY];
+                gb->display.window_clear = 0;
+            }
+
+            /* OAM Search occurs at the start of the line. */
+            gb->hram_io[IO_STAT] = (gb->hram_io[IO_STAT] & ~STAT_MODE) | LCD_MODE_OAM_SCAN;
+
+            if(gb->hram_io[IO_STAT] & STAT_MODE_2_INTR) cpu_irq_raise(gb, LCDC_INTR);
+        }
+
+    // Go from Mode 3 (LCD Draw) to Mode 0 (HBLANK).
+    // Bugfix: Moved gpu_draw_line() callback to the correct place in the code.
+    //   The gpu_draw_line() function doesn't do the actual PPU math;
+    //   it assumes that the PPU has already rendered that scanline into pixels[160].
+    } else if((gb->hram_io[IO_STAT] & STAT_MODE) == LCD_MODE_LCD_DRAW  && 
+                gpu_line_cycles(gb) >= LCD_MODE3_LCD_DRAW_END){ 
+        gb->hram_io[IO_STAT] = (gb->hram_io[IO_STAT] & ~STAT_MODE) | LCD_MODE_HBLANK;
+
+        if(!gb->lcd_blank){
+            if(gb->stats.time_ppu){
+                uint64_t t0 = host_now_ns();
+                gpu_draw_line(gb);
+                gb->stats.ppu_ns += host_now_ns() - t0;
+            } else {
+                gpu_draw_line(gb);
+            }
+        }
+
+        if(gb->hram_io[IO_STAT] & STAT_MODE_0_INTR) cpu_irq_raise(gb, LCDC_INTR);
+
+    /* Go from Mode 2 (OAM Scan) to Mode 3 (LCD Draw). */
+    } else if((gb->hram_io[IO_STAT] & STAT_MODE) == LCD_MODE_OAM_SCAN &&
+                gpu_line_cycles(gb) >= LCD_MODE2_OAM_SCAN_END){
+        gb->hram_io[IO_STAT] = (gb->hram_io[IO_STAT] & ~STAT_MODE) | LCD_MODE_LCD_DRAW;
+        // Remove gpu_draw_line() from here
+    }
+
+    gpu_lcd_schedule(gb);
+}
+
+/* Advance the clock and whatever is due by @cycles */
+static inline void cpu_tick(struct gb_s *gb, uint16_t cycles) {
+    gb->stats.cycles += cycles;
+    gb->counter.cycles += cycles;
+
+    /* Serial transfer in progress */
+    if(gb->hram_io[IO_SC] & SC_TRANSFER){
+        serial_step(gb, cycles);
+    }
+
+    /* LCD Timing: nothing to do until the next mode change or scanline */
+    if(gb->counter.cycles >= gb->counter.lcd_next){
+        lcd_event(gb);
+    }
+}
+
+/*
+ * Cycles a halted CPU can sleep through: up to the next LCD event or the
+ * end of an internally clocked transfer, since only those raise IF here.
+ * A transfer on the external clock is polled at the usual rate.
+ */
+static uint16_t halt_idle(struct gb_s *gb) {
+    uint64_t idle = gb->counter.lcd_next - gb->counter.cycles;
+
+    if(gb->hram_io[IO_SC] & SC_TRANSFER){
+        idle = (gb->hram_io[IO_SC] & SC_CLOCK_INTERNAL) && gb->counter.serial_count < idle ?
+               gb->counter.serial_count : 4;
+    }
+    if(idle < 4) idle = 4;
+    if(idle > LCD_LINE_CYCLES) idle = LCD_LINE_CYCLES;
+    return (uint16_t)((idle + 3) & ~3u);
+}
+
 // -------------------------------
 // Main CPU Step Function
 // -------------------------------
@@ -235,19 +349,59 @@ void gb_write(struct gb_s* gb, uint32_t addr, const uint8_t val){
 uint16_t cpu_step(struct gb_s *gb) {
     uint16_t cycles;
     uint8_t opcode;
+    uint16_t pc;
+    uint16_t pc_step = 1;
     
-    /* Handle interrupts first */
-    cpu_handle_interrupts(gb);
+    /* One test covers the slow paths: interrupts, HALT, EI and the HALT bug */
+    if (gb->irq_pending | gb->gb_halt | gb->ime_delay | gb->halt_bug) {
+        if (gb->irq_pending) {
+            /* Any enabled request wakes the CPU, IME or not */
+            gb->gb_halt = false;
+            cycles = cpu_handle_interrupts(gb);
+            if (cycles) {
+                cpu_tick(gb, cycles);
+                return cycles;
+            }
+        }
+        if (gb->gb_halt) {
+            cycles = halt_idle(gb);
+            gb->stats.halt_cycles += cycles;
+            cpu_tick(gb, cycles);
+            return cycles;
+        }
+        /* EI takes effect after the instruction that follows it */
+        if (gb->ime_delay) {
+            gb->ime_delay = false;
+            gb->gb_ime = true;
+        }
+        /* HALT bug: PC fails to advance past the next opcode */
+        if (gb->halt_bug) {
+            gb->halt_bug = false;
+            pc_step = 0;
+        }
+    }
+
+    /* Breakpoint page: stop before the instruction runs (0 cycles) */
+    if ((gb->mmu.trap[gb->cpu_reg.pc.reg >> MMU_PAGE_SHIFT] & MMU_TRAP_EXEC) && debug_exec_hit(gb)) {
+        return 0;
+    }
     
     /* Fetch opcode */
-    opcode = mmu_read(gb, gb->cpu_reg.pc.reg++);
+    pc = gb->cpu_reg.pc.reg;
+    opcode = mmu_read(gb, pc);
+    gb->cpu_reg.pc.reg += pc_step;
     cycles = OPCODE_CYCLES[opcode];
+
+    /* Record it before executing, so a faulting opcode is in the trace too */
+    if (gb->itrace) {
+        itrace_record(gb, pc, opcode);
+    }
     
     /* Execute opcode */
     switch (opcode) {
         /* ====== 0x0X: Misc/Control ====== */
         case 0x00: /* NOP */ break;
-        case 0x10: /* STOP */ break;
+        case 0x10: /* STOP */ gb->cpu_reg.pc.reg++; break; /* Skip the padding byte */
         
         /* ====== 0x0X-0x3X: 16-bit loads ====== */
         case 0x01: /* LD BC, nn */
@@ -457,7 +611,7 @@ uint16_t cpu_step(struct gb_s *gb) {
             if (!gb->cpu_reg.f.f_bits.z) {
                 int8_t offset = (int8_t)mmu_read(gb, gb->cpu_reg.pc.reg++);
                 gb->cpu_reg.pc.reg += offset;
-                cycles += 4;
+                cycles = OPCODE_CYCLES_TAKEN[opcode];
             } else {
                 gb->cpu_reg.pc.reg++;
             }
@@ -466,7 +620,7 @@ uint16_t cpu_step(struct gb_s *gb) {
             if (gb->cpu_reg.f.f_bits.z) {
                 int8_t offset = (int8_t)mmu_read(gb, gb->cpu_reg.pc.reg++);
                 gb->cpu_reg.pc.reg += offset;
-                cycles += 4;
+                cycles = OPCODE_CYCLES_TAKEN[opcode];
             } else {
                 gb->cpu_reg.pc.reg++;
             }
@@ -475,7 +629,7 @@ uint16_t cpu_step(struct gb_s *gb) {
             if (!gb->cpu_reg.f.f_bits.c) {
                 int8_t offset = (int8_t)mmu_read(gb, gb->cpu_reg.pc.reg++);
                 gb->cpu_reg.pc.reg += offset;
-                cycles += 4;
+                cycles = OPCODE_CYCLES_TAKEN[opcode];
             } else {
                 gb->cpu_reg.pc.reg++;
             }
@@ -484,7 +638,7 @@ uint16_t cpu_step(struct gb_s *gb) {
             if (gb->cpu_reg.f.f_bits.c) {
                 int8_t offset = (int8_t)mmu_read(gb, gb->cpu_reg.pc.reg++);
                 gb->cpu_reg.pc.reg += offset;
-                cycles += 4;
+                cycles = OPCODE_CYCLES_TAKEN[opcode];
             } else {
                 gb->cpu_reg.pc.reg++;
             }
@@ -558,7 +712,11 @@ uint16_t cpu_step(struct gb_s *gb) {
         case 0x73: mmu_write(gb, gb->cpu_reg.hl.reg, gb->cpu_reg.de.bytes.e); break;
         case 0x74: mmu_write(gb, gb->cpu_reg.hl.reg, gb->cpu_reg.hl.bytes.h); break;
         case 0x75: mmu_write(gb, gb->cpu_reg.hl.reg, gb->cpu_reg.hl.bytes.l); break;
-        case 0x76: /* HALT */ gb->gb_halt = true; break;
+        case 0x76: /* HALT */
+            /* With IME off and a request already pending it does not halt */
+            if (!gb->gb_ime && gb->irq_pending) gb->halt_bug = true;
+            else gb->gb_halt = true;
+            break;
         case 0x77: mmu_write(gb, gb->cpu_reg.hl.reg, gb->cpu_reg.a); break;
         
         /* A register destinations */
@@ -666,28 +824,28 @@ uint16_t cpu_step(struct gb_s *gb) {
             if (!gb->cpu_reg.f.f_bits.z) {
                 gb->cpu_reg.pc.bytes.c = mmu_read(gb, gb->cpu_reg.sp.reg++);
                 gb->cpu_reg.pc.bytes.p = mmu_read(gb, gb->cpu_reg.sp.reg++);
-                cycles += 12;
+                cycles = OPCODE_CYCLES_TAKEN[opcode];
             }
             break;
         case 0xC8: /* RET Z */
             if (gb->cpu_reg.f.f_bits.z) {
                 gb->cpu_reg.pc.bytes.c = mmu_read(gb, gb->cpu_reg.sp.reg++);
                 gb->cpu_reg.pc.bytes.p = mmu_read(gb, gb->cpu_reg.sp.reg++);
-                cycles += 12;
+                cycles = OPCODE_CYCLES_TAKEN[opcode];
             }
             break;
         case 0xD0: /* RET NC */
             if (!gb->cpu_reg.f.f_bits.c) {
                 gb->cpu_reg.pc.bytes.c = mmu_read(gb, gb->cpu_reg.sp.reg++);
                 gb->cpu_reg.pc.bytes.p = mmu_read(gb, gb->cpu_reg.sp.reg++);
-                cycles += 12;
+                cycles = OPCODE_CYCLES_TAKEN[opcode];
             }
             break;
         case 0xD8: /* RET C */
             if (gb->cpu_reg.f.f_bits.c) {
                 gb->cpu_reg.pc.bytes.c = mmu_read(gb, gb->cpu_reg.sp.reg++);
                 gb->cpu_reg.pc.bytes.p = mmu_read(gb, gb->cpu_reg.sp.reg++);
-                cycles += 12;
+                cycles = OPCODE_CYCLES_TAKEN[opcode];
             }
             break;
         case 0xC9: /* RET */
@@ -730,7 +888,7 @@ uint16_t cpu_step(struct gb_s *gb) {
                 uint8_t lo = mmu_read(gb, gb->cpu_reg.pc.reg++);
                 uint8_t hi = mmu_read(gb, gb->cpu_reg.pc.reg);
                 gb->cpu_reg.pc.reg = (hi << 8) | lo;
-                cycles += 4;
+                cycles = OPCODE_CYCLES_TAKEN[opcode];
             } else {
                 gb->cpu_reg.pc.reg += 2;
             }
@@ -740,7 +898,7 @@ uint16_t cpu_step(struct gb_s *gb) {
                 uint8_t lo = mmu_read(gb, gb->cpu_reg.pc.reg++);
                 uint8_t hi = mmu_read(gb, gb->cpu_reg.pc.reg);
                 gb->cpu_reg.pc.reg = (hi << 8) | lo;
-                cycles += 4;
+                cycles = OPCODE_CYCLES_TAKEN[opcode];
             } else {
                 gb->cpu_reg.pc.reg += 2;
             }
@@ -750,7 +908,7 @@ uint16_t cpu_step(struct gb_s *gb) {
                 uint8_t lo = mmu_read(gb, gb->cpu_reg.pc.reg++);
                 uint8_t hi = mmu_read(gb, gb->cpu_reg.pc.reg);
                 gb->cpu_reg.pc.reg = (hi << 8) | lo;
-                cycles += 4;
+                cycles = OPCODE_CYCLES_TAKEN[opcode];
             } else {
                 gb->cpu_reg.pc.reg += 2;
             }
@@ -760,7 +918,7 @@ uint16_t cpu_step(struct gb_s *gb) {
                 uint8_t lo = mmu_read(gb, gb->cpu_reg.pc.reg++);
                 uint8_t hi = mmu_read(gb, gb->cpu_reg.pc.reg);
                 gb->cpu_reg.pc.reg = (hi << 8) | lo;
-                cycles += 4;
+                cycles = OPCODE_CYCLES_TAKEN[opcode];
             } else {
                 gb->cpu_reg.pc.reg += 2;
             }
@@ -784,7 +942,7 @@ uint16_t cpu_step(struct gb_s *gb) {
                 mmu_write(gb, --gb->cpu_reg.sp.reg, gb->cpu_reg.pc.bytes.p);
                 mmu_write(gb, --gb->cpu_reg.sp.reg, gb->cpu_reg.pc.bytes.c);
                 gb->cpu_reg.pc.reg = (hi << 8) | lo;
-                cycles += 12;
+                cycles = OPCODE_CYCLES_TAKEN[opcode];
             } else {
                 gb->cpu_reg.pc.reg += 2;
             }
@@ -796,7 +954,7 @@ uint16_t cpu_step(struct gb_s *gb) {
                 mmu_write(gb, --gb->cpu_reg.sp.reg, gb->cpu_reg.pc.bytes.p);
                 mmu_write(gb, --gb->cpu_reg.sp.reg, gb->cpu_reg.pc.bytes.c);
                 gb->cpu_reg.pc.reg = (hi << 8) | lo;
-                cycles += 12;
+                cycles = OPCODE_CYCLES_TAKEN[opcode];
             } else {
                 gb->cpu_reg.pc.reg += 2;
             }
@@ -808,7 +966,7 @@ uint16_t cpu_step(struct gb_s *gb) {
                 mmu_write(gb, --gb->cpu_reg.sp.reg, gb->cpu_reg.pc.bytes.p);
                 mmu_write(gb, --gb->cpu_reg.sp.reg, gb->cpu_reg.pc.bytes.c);
                 gb->cpu_reg.pc.reg = (hi << 8) | lo;
-                cycles += 12;
+                cycles = OPCODE_CYCLES_TAKEN[opcode];
             } else {
                 gb->cpu_reg.pc.reg += 2;
             }
@@ -820,7 +978,7 @@ uint16_t cpu_step(struct gb_s *gb) {
                 mmu_write(gb, --gb->cpu_reg.sp.reg, gb->cpu_reg.pc.bytes.p);
                 mmu_write(gb, --gb->cpu_reg.sp.reg, gb->cpu_reg.pc.bytes.c);
                 gb->cpu_reg.pc.reg = (hi << 8) | lo;
-                cycles += 12;
+                cycles = OPCODE_CYCLES_TAKEN[opcode];
             } else {
                 gb->cpu_reg.pc.reg += 2;
             }
@@ -1005,9 +1163,10 @@ uint16_t cpu_step(struct gb_s *gb) {
         /* Interrupt control */
         case 0xF3: /* DI */
             gb->gb_ime = false;
+            gb->ime_delay = false;
             break;
         case 0xFB: /* EI */
-            gb->gb_ime = true;
+            if (!gb->gb_ime) gb->ime_delay = true;
             break;
         
         /* CB prefix */
@@ -1024,78 +1183,8 @@ uint16_t cpu_step(struct gb_s *gb) {
             break;
     }
 
-    /* DIV register timing */
-    gb->counter.div_count += cycles;
-
-    while(gb->counter.div_count >= DIV_CYCLES){
-        gb->hram_io[IO_DIV]++;
-        gb->counter.div_count -= DIV_CYCLES;
-    }
-
-    /* LCD Timing */
-    gb->counter.lcd_count += cycles;
-
-    /* New Scanline. HBlank -> VBlank or OAM Scan */
-    if(gb->counter.lcd_count >= LCD_LINE_CYCLES){
-
-        gb->counter.lcd_count -= LCD_LINE_CYCLES;
-
-        /* Next line */
-        gb->hram_io[IO_LY]++;
-
-        /* LYC Update */
-        if(gb->hram_io[IO_LY] == gb->hram_io[IO_LYC]){
-            gb->hram_io[IO_STAT] |= STAT_LYC_COINC;
-
-            if(gb->hram_io[IO_STAT] & STAT_LYC_INTR) gb->hram_io[IO_IF] |= LCDC_INTR;
-        } else {
-            gb->hram_io[IO_STAT] &= 0xFB;
-        }
-
-        /* Check if LCD should be in Mode 1 (VBLANK) state */
-        if(gb->hram_io[IO_LY] == LCD_HEIGHT){
-            gb->hram_io[IO_STAT] = (gb->hram_io[IO_STAT] & ~STAT_MODE) | LCD_MODE_VBLANK;
-            gb->gb_frame = true;
-            gb->hram_io[IO_IF] |= VBLANK_INTR;
-            gb->lcd_blank = false;
-
-            if(gb->hram_io[IO_STAT] & STAT_MODE_1_INTR) gb->hram_io[IO_IF] |= LCDC_INTR;
-
-            gb->frame_debug++;   // increment once per frame
-
-        /* Start of normal Line (not in VBLANK) */
-        } else if(gb->hram_io[IO_LY] < LCD_HEIGHT){ 
-            if(gb->hram_io[IO_LY] == 0){
-                /* Clear Screen */
-                gb->display.WY = gb->hram_io[IO_WY];
-                gb->display.window_clear = 0;
-            }
-
-            /* OAM Search occurs at the start of the line. */
-            gb->hram_io[IO_STAT] = (gb->hram_io[IO_STAT] & ~STAT_MODE) | LCD_MODE_OAM_SCAN;
-
-            if(gb->hram_io[IO_STAT] & STAT_MODE_2_INTR) gb->hram_io[IO_IF] |= LCDC_INTR;
-        }
-
-    // Go from Mode 3 (LCD Draw) to Mode 0 (HBLANK).
-    // Bugfix: Moved gpu_draw_line() callback to the correct place in the code.
-    //   The gpu_draw_line() function doesn't do the actual PPU math;
-    //   it assumes that the PPU has already rendered that scanline into pixels[160].
-    } else if((gb->hram_io[IO_STAT] & STAT_MODE) == LCD_MODE_LCD_DRAW  && 
-                gb->counter.lcd_count >= LCD_MODE3_LCD_DRAW_END){ 
-        gb->hram_io[IO_STAT] = (gb->hram_io[IO_STAT] & ~STAT_MODE) | LCD_MODE_HBLANK;
-
-        if(!gb->lcd_blank) gpu_draw_line(gb);
-
-        if(gb->hram_io[IO_STAT] & STAT_MODE_0_INTR) gb->hram_io[IO_IF] |= LCDC_INTR;
-
-    /* Go from Mode 2 (OAM Scan) to Mode 3 (LCD Draw). */
-    } else if((gb->hram_io[IO_STAT] & STAT_MODE) == LCD_MODE_OAM_SCAN &&
-                gb->counter.lcd_count >= LCD_MODE2_OAM_SCAN_END){
-        gb->hram_io[IO_STAT] = (gb->hram_io[IO_STAT] & ~STAT_MODE) | LCD_MODE_LCD_DRAW;
-        // Remove gpu_draw_line() from here
-    }
-
+    gb->stats.instructions++;
+    cpu_tick(gb, cycles);
 
     return cycles;
 }
@@ -1117,6 +1206,8 @@ void cpu_init(struct gb_s* gb) {
     
     gb->gb_halt = false;
     gb->gb_ime = true;
+    gb->ime_delay = false;
+    gb->halt_bug = false;
 }
 
 void cpu_reset(struct gb_s* gb) {
@@ -1124,4 +1215,6 @@ void cpu_reset(struct gb_s* gb) {
     gb->cpu_reg.pc.reg = 0x0000;
     gb->gb_halt = false;
     gb->gb_ime = false;
+    gb->ime_delay = false;
+    gb->halt_bug = false;
 }
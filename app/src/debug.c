@@ -0,0 +1,406 @@
+/**
+ * debug.c - Breakpoints, Watchpoints and Debugger Commands
+ *
+ * Keeps the point list, turns it into per-page trap flags for the MMU and
+ * implements the text commands used by the frontend console.
+ */
+
+#include "debug.h"
+#include "cpu.h"
+#include "disasm.h"
+#include "itrace.h"
+#include "memory.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+void debug_update_traps(struct gb_s *gb) {
+    struct debug_s *d = gb->debug;
+
+    memset(gb->mmu.trap, 0, sizeof(gb->mmu.trap));
+    for (uint8_t i = 0; d && i < d->num_points; i++) {
+        const struct debug_point_s *p = &d->points[i];
+        for (uint32_t page = p->start >> MMU_PAGE_SHIFT; page <= (uint32_t)(p->end >> MMU_PAGE_SHIFT); page++) {
+            gb->mmu.trap[page] |= p->type;
+        }
+    }
+    mmu_remap(gb);
+}
+
+static int add_point(struct gb_s *gb, uint16_t start, uint16_t end, uint8_t type) {
+    struct debug_s *d = gb->debug;
+    if (!d || d->num_points >= DEBUG_MAX_POINTS) {
+        return -1;
+    }
+
+    struct debug_point_s *p = &d->points[d->num_points++];
+    p->start = start;
+    p->end   = end;
+    p->type  = type;
+    p->id    = ++d->next_id;
+    debug_update_traps(gb);
+    return p->id;
+}
+
+static void stop_at(struct gb_s *gb, enum debug_stop_e reason, uint8_t id) {
+    gb->debug->stop_reason = reason;
+    gb->debug->stop_id = id;
+    gb->debug->stops++;
+    gb->gb_break = true;
+}
+
+// -------------------------------
+// Setup and point list
+// -------------------------------
+
+int debug_init(struct gb_s *gb) {
+    struct debug_s *d = calloc(1, sizeof(*d));
+    if (!d) return -1;
+
+    debug_free(gb);
+    gb->debug = d;
+    return 0;
+}
+
+void debug_free(struct gb_s *gb) {
+    if (gb->debug) {
+        free(gb->debug);
+        gb->debug = NULL;
+        debug_update_traps(gb);
+    }
+    gb->gb_break = false;
+}
+
+int debug_add_breakpoint(struct gb_s *gb, uint16_t addr) {
+    return add_point(gb, addr, addr, MMU_TRAP_EXEC);
+}
+
+int debug_add_watchpoint(struct gb_s *gb, uint16_t start, uint16_t end, uint8_t type) {
+    if (end < start || type == 0 || (type & ~(MMU_TRAP_READ | MMU_TRAP_WRITE))) {
+        return -1;
+    }
+    return add_point(gb, start, end, type);
+}
+
+int debug_find(const struct gb_s *gb, uint16_t start, uint16_t end, uint8_t type) {
+    const struct debug_s *d = gb->debug;
+    for (uint8_t i = 0; d && i < d->num_points; i++) {
+        const struct debug_point_s *p = &d->points[i];
+        if (p->start == start && p->end == end && p->type == type) {
+            return p->id;
+        }
+    }
+    return -1;
+}
+
+int debug_delete(struct gb_s *gb, uint8_t id) {
+    struct debug_s *d = gb->debug;
+    if (!d) return -1;
+
+    if (id == 0) {
+        d->num_points = 0;
+        debug_update_traps(gb);
+        return 0;
+    }
+
+    for (uint8_t i = 0; i < d->num_points; i++) {
+        if (d->points[i].id == id) {
+            memmove(&d->points[i], &d->points[i + 1], (size_t)(d->num_points - i - 1) * sizeof(d->points[0]));
+            d->num_points--;
+            debug_update_traps(gb);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// -------------------------------
+// Trap handlers
+// -------------------------------
+
+bool debug_exec_hit(struct gb_s *gb) {
+    struct debug_s *d = gb->debug;
+    uint16_t pc = gb->cpu_reg.pc.reg;
+    if (!d) return false;
+
+    if (d->skip) {
+        d->skip = false;
+        if (pc == d->skip_pc) return false;
+    }
+
+    for (uint8_t i = 0; i < d->num_points; i++) {
+        if (d->points[i].type == MMU_TRAP_EXEC && d->points[i].start == pc) {
+            stop_at(gb, DEBUG_STOP_BREAKPOINT, d->points[i].id);
+            return true;
+        }
+    }
+    return false;
+}
+
+void debug_watch_hit(struct gb_s *gb, uint16_t addr, uint8_t value, bool write) {
+    struct debug_s *d = gb->debug;
+    uint8_t type = write ? MMU_TRAP_WRITE : MMU_TRAP_READ;
+    if (!d) return;
+
+    for (uint8_t i = 0; i < d->num_points; i++) {
+        const struct debug_point_s *p = &d->points[i];
+        if ((p->type & type) && addr >= p->start && addr <= p->end) {
+            stop_at(gb, write ? DEBUG_STOP_WATCH_WRITE : DEBUG_STOP_WATCH_READ, p->id);
+            d->stop_addr = addr;
+            d->stop_value = value;
+            return;
+        }
+    }
+}
+
+// -------------------------------
+// Execution control
+// -------------------------------
+
+void debug_continue(struct gb_s *gb) {
+    struct debug_s *d = gb->debug;
+    if (d) {
+        d->skip = true;
+        d->skip_pc = gb->cpu_reg.pc.reg;
+        d->stop_reason = DEBUG_STOP_NONE;
+    }
+    gb->gb_break = false;
+}
+
+void debug_stop(struct gb_s *gb, enum debug_stop_e reason) {
+    if (gb->debug) {
+        stop_at(gb, reason, 0);
+    }
+}
+
+void debug_step(struct gb_s *gb, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        if (i == 0) {
+            debug_continue(gb);     // Step off a breakpoint
+        }
+        cpu_step(gb);
+        if (gb->gb_break) {
+            return;
+        }
+    }
+    if (gb->debug) {
+        stop_at(gb, DEBUG_STOP_STEP, 0);
+    }
+}
+
+// -------------------------------
+// Output
+// -------------------------------
+
+static void print_insn(struct gb_s *gb, FILE *out, uint16_t addr) {
+    char text[24];
+    gb_disasm(gb, addr, text, sizeof(text));
+    fprintf(out, "$%04X: %s\n", addr, text);
+}
+
+static void print_regs(struct gb_s *gb, FILE *out) {
+    const struct cpu_registers_s *r = &gb->cpu_reg;
+    fprintf(out, "A=%02X F=%c%c%c%c BC=%04X DE=%04X HL=%04X SP=%04X PC=%04X IME=%d%s\n",
+            r->a,
+            r->f.f_bits.z ? 'Z' : '-', r->f.f_bits.n ? 'N' : '-',
+            r->f.f_bits.h ? 'H' : '-', r->f.f_bits.c ? 'C' : '-',
+            r->bc.reg, r->de.reg, r->hl.reg, r->sp.reg, r->pc.reg,
+            gb->gb_ime, gb->gb_halt ? " HALT" : "");
+}
+
+void debug_print_stop(struct gb_s *gb, FILE *out) {
+    const struct debug_s *d = gb->debug;
+    if (!d) return;
+
+    switch (d->stop_reason) {
+        case DEBUG_STOP_BREAKPOINT:
+            fprintf(out, "Breakpoint %u at ", d->stop_id);
+            break;
+        case DEBUG_STOP_WATCH_READ:
+        case DEBUG_STOP_WATCH_WRITE:
+            fprintf(out, "Watchpoint %u: %s $%04X = $%02X, stopped at ", d->stop_id,
+                    d->stop_reason == DEBUG_STOP_WATCH_WRITE ? "write" : "read",
+                    d->stop_addr, d->stop_value);
+            break;
+        case DEBUG_STOP_STEP:
+        case DEBUG_STOP_USER:
+            fprintf(out, "Stopped at ");
+            break;
+        case DEBUG_STOP_ERROR:
+            fprintf(out, "Emulator error at ");
+            break;
+        default:
+            return;
+    }
+    print_insn(gb, out, gb->cpu_reg.pc.reg);
+}
+
+static void print_points(const struct debug_s *d, FILE *out) {
+    if (d->num_points == 0) {
+        fprintf(out, "No breakpoints or watchpoints\n");
+        return;
+    }
+    for (uint8_t i = 0; i < d->num_points; i++) {
+        const struct debug_point_s *p = &d->points[i];
+        if (p->type == MMU_TRAP_EXEC) {
+            fprintf(out, "%3u  break  $%04X\n", p->id, p->start);
+        } else {
+            fprintf(out, "%3u  watch  $%04X-$%04X %s%s\n", p->id, p->start, p->end,
+                    (p->type & MMU_TRAP_READ) ? "r" : "", (p->type & MMU_TRAP_WRITE) ? "w" : "");
+        }
+    }
+}
+
+// -------------------------------
+// Commands
+// -------------------------------
+
+static const char HELP[] =
+    "break|b ADDR              stop before executing ADDR\n"
+    "watch|w ADDR[:LEN] [r|w|rw]  stop on access (default w)\n"
+    "delete|d [ID]             delete a point (all without ID)\n"
+    "list|l                    list points\n"
+    "continue|c                resume\n"
+    "pause|p                   stop now\n"
+    "step|s [N]                execute N instructions (default 1)\n"
+    "regs|r                    show registers\n"
+    "x ADDR [N]                hex dump N bytes (default 16)\n"
+    "dis [ADDR] [N]            disassemble N instructions (default PC, 8)\n"
+    "trace [N]                 last N executed instructions (default 16)\n"
+    "Addresses are hex ($C000, 0xC000 or C000), counts are decimal.\n";
+
+// Hex address with an optional "$" or "0x" prefix
+static bool parse_addr(const char *s, uint16_t *out) {
+    char *end;
+    if (!s) return false;
+    if (*s == '$') s++;
+    unsigned long v = strtoul(s, &end, 16);
+    if (end == s || *end != '\0' || v > 0xFFFF) return false;
+    *out = (uint16_t)v;
+    return true;
+}
+
+static bool parse_count(const char *s, uint32_t *out) {
+    char *end;
+    if (!s) return true;    // Keep the default
+    unsigned long v = strtoul(s, &end, 10);
+    if (end == s || *end != '\0' || v == 0) return false;
+    *out = (uint32_t)v;
+    return true;
+}
+
+static int cmd_watch(struct gb_s *gb, char *arg, const char *mode, FILE *out) {
+    uint16_t start;
+    uint32_t len = 1;
+    uint8_t type = MMU_TRAP_WRITE;
+
+    char *colon = arg ? strchr(arg, ':') : NULL;
+    if (colon) {
+        *colon = '\0';
+        if (!parse_count(colon + 1, &len)) return -1;
+    }
+    if (!parse_addr(arg, &start) || start + len - 1 > 0xFFFF) return -1;
+
+    if (mode) {
+        if (strcmp(mode, "r") == 0) type = MMU_TRAP_READ;
+        else if (strcmp(mode, "w") == 0) type = MMU_TRAP_WRITE;
+        else if (strcmp(mode, "rw") == 0) type = MMU_TRAP_READ | MMU_TRAP_WRITE;
+        else return -1;
+    }
+
+    int id = debug_add_watchpoint(gb, start, (uint16_t)(start + len - 1), type);
+    if (id < 0) {
+        fprintf(out, "Too many points\n");
+        return -1;
+    }
+    fprintf(out, "Watchpoint %d at $%04X", id, start);
+    if (len > 1) fprintf(out, "-$%04X", (unsigned)(start + len - 1));
+    fprintf(out, "\n");
+    return 0;
+}
+
+int debug_command(struct gb_s *gb, const char *line, FILE *out) {
+    char buf[128];
+    char *argv[4] = { NULL, NULL, NULL, NULL };
+    int argc = 0;
+
+    if (!gb->debug) return -1;
+
+    snprintf(buf, sizeof(buf), "%s", line);
+    for (char *tok = strtok(buf, " \t\r\n"); tok && argc < 4; tok = strtok(NULL, " \t\r\n")) {
+        argv[argc++] = tok;
+    }
+    if (argc == 0) return 0;
+
+    const char *cmd = argv[0];
+    uint16_t addr;
+    uint32_t n;
+
+    if (strcmp(cmd, "break") == 0 || strcmp(cmd, "b") == 0) {
+        if (!parse_addr(argv[1], &addr)) goto usage;
+        int id = debug_add_breakpoint(gb, addr);
+        if (id < 0) {
+            fprintf(out, "Too many points\n");
+            return -1;
+        }
+        fprintf(out, "Breakpoint %d at $%04X\n", id, addr);
+    } else if (strcmp(cmd, "watch") == 0 || strcmp(cmd, "w") == 0) {
+        if (cmd_watch(gb, argv[1], argv[2], out) != 0) goto usage;
+    } else if (strcmp(cmd, "delete") == 0 || strcmp(cmd, "d") == 0) {
+        n = 0;
+        if (argv[1] && (!parse_count(argv[1], &n) || n > 0xFF)) goto usage;
+        if (debug_delete(gb, (uint8_t)n) != 0) {
+            fprintf(out, "No point %u\n", n);
+            return -1;
+        }
+    } else if (strcmp(cmd, "list") == 0 || strcmp(cmd, "l") == 0) {
+        print_points(gb->debug, out);
+    } else if (strcmp(cmd, "continue") == 0 || strcmp(cmd, "c") == 0) {
+        debug_continue(gb);
+    } else if (strcmp(cmd, "pause") == 0 || strcmp(cmd, "p") == 0) {
+        if (!gb->gb_break) stop_at(gb, DEBUG_STOP_USER, 0);
+    } else if (strcmp(cmd, "step") == 0 || strcmp(cmd, "s") == 0) {
+        n = 1;
+        if (!parse_count(argv[1], &n)) goto usage;
+        debug_step(gb, n);
+    } else if (strcmp(cmd, "regs") == 0 || strcmp(cmd, "r") == 0) {
+        print_regs(gb, out);
+    } else if (strcmp(cmd, "x") == 0) {
+        n = 16;
+        if (!parse_addr(argv[1], &addr) || !parse_count(argv[2], &n)) goto usage;
+        for (uint32_t i = 0; i < n; i++) {
+            uint16_t a = (uint16_t)(addr + i);
+            if (i % 16 == 0) fprintf(out, "%s$%04X:", i ? "\n" : "", a);
+            fprintf(out, " %02X", mmu_peek(gb, a));
+        }
+        fprintf(out, "\n");
+    } else if (strcmp(cmd, "dis") == 0) {
+        addr = gb->cpu_reg.pc.reg;
+        n = 8;
+        if ((argv[1] && !parse_addr(argv[1], &addr)) || !parse_count(argv[2], &n)) goto usage;
+        for (uint32_t i = 0; i < n; i++) {
+            char text[24];
+            uint8_t len = gb_disasm(gb, addr, text, sizeof(text));
+            fprintf(out, "%c $%04X: %s\n", addr == gb->cpu_reg.pc.reg ? '>' : ' ', addr, text);
+            addr = (uint16_t)(addr + len);
+        }
+    } else if (strcmp(cmd, "trace") == 0) {
+        n = 16;
+        if (!parse_count(argv[1], &n)) goto usage;
+        if (!gb->itrace) {
+            fprintf(out, "Instruction trace is disabled\n");
+            return -1;
+        }
+        itrace_dump(gb, out, n);
+    } else if (strcmp(cmd, "help") == 0 || strcmp(cmd, "h") == 0 || strcmp(cmd, "?") == 0) {
+        fputs(HELP, out);
+    } else {
+        fprintf(out, "Unknown command '%s' (try help)\n", cmd);
+        return -1;
+    }
+    return 0;
+
+usage:
+    fprintf(out, "Bad arguments to '%s' (try help)\n", cmd);
+    return -1;
+}
@@ -0,0 +1,91 @@
+/**
+ * disasm.c - LR35902 Disassembler
+ *
+ * Also home to gb_opcodes[], the run-time form of OPCODE_TABLE.
+ */
+
+#include "disasm.h"
+#include "opcodes.h"
+#include "memory.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define OPCODE_INFO_ROW(op, mn, len, cyc, taken, fl, acc) \
+    [op] = { mn, len, cyc, taken, fl, acc },
+
+const struct opcode_info gb_opcodes[256] = { OPCODE_TABLE(OPCODE_INFO_ROW) };
+
+// -------------------------------
+// CB-prefixed names
+// -------------------------------
+
+// Operation in bits 7-3, operand in bits 2-0
+#define CB_ROW(op)  op " B", op " C", op " D", op " E", op " H", op " L", op " (HL)", op " A"
+#define CB_BITS(op) CB_ROW(op " 0,"), CB_ROW(op " 1,"), CB_ROW(op " 2,"), CB_ROW(op " 3,"), \
+                    CB_ROW(op " 4,"), CB_ROW(op " 5,"), CB_ROW(op " 6,"), CB_ROW(op " 7,")
+
+static const char *const CB_NAMES[256] = {
+    CB_ROW("RLC"), CB_ROW("RRC"), CB_ROW("RL"), CB_ROW("RR"),
+    CB_ROW("SLA"), CB_ROW("SRA"), CB_ROW("SWAP"), CB_ROW("SRL"),
+    CB_BITS("BIT"), CB_BITS("RES"), CB_BITS("SET")
+};
+
+const char *gb_opcode_name(uint8_t opcode, uint8_t cb, int prefixed) {
+    if (prefixed && opcode == 0xCB) {
+        return CB_NAMES[cb];
+    }
+    return gb_opcodes[opcode].mnemonic;
+}
+
+// -------------------------------
+// Disassembly
+// -------------------------------
+
+uint8_t gb_disasm_bytes(const uint8_t *bytes, uint16_t pc, char *buf, size_t len) {
+    const struct opcode_info *info = &gb_opcodes[bytes[0]];
+
+    if (bytes[0] == 0xCB) {
+        snprintf(buf, len, "%s", CB_NAMES[bytes[1]]);
+        return info->length;
+    }
+
+    // Find the operand placeholder, if any, and substitute the operand
+    const char *mn = info->mnemonic;
+    const char *ph = NULL;
+    char operand[8] = "";
+    uint16_t imm16 = (uint16_t)(bytes[1] | (bytes[2] << 8));
+
+    if ((ph = strstr(mn, "n16")) || (ph = strstr(mn, "a16"))) {
+        snprintf(operand, sizeof(operand), "$%04X", imm16);
+    } else if ((ph = strstr(mn, "n8")) || (ph = strstr(mn, "a8"))) {
+        snprintf(operand, sizeof(operand), "$%02X", bytes[1]);
+    } else if ((ph = strstr(mn, "e8"))) {
+        if (bytes[0] == 0x18 || (bytes[0] & 0xE7) == 0x20) {
+            // JR: show the absolute target
+            snprintf(operand, sizeof(operand), "$%04X", (uint16_t)(pc + 2 + (int8_t)bytes[1]));
+        } else {
+            snprintf(operand, sizeof(operand), "%+d", (int8_t)bytes[1]);
+        }
+    }
+
+    if (ph) {
+        size_t ph_len = (ph[1] == '1') ? 3 : 2;
+        int prefix = (int)(ph - mn);
+        if (prefix > 0 && mn[prefix - 1] == '+') prefix--;    // "SP+e8" -> "SP-3"
+        snprintf(buf, len, "%.*s%s%s", prefix, mn, operand, ph + ph_len);
+    } else {
+        snprintf(buf, len, "%s", mn);
+    }
+    return info->length;
+}
+
+uint8_t gb_disasm(struct gb_s *gb, uint16_t addr, char *buf, size_t len) {
+    uint8_t bytes[3] = { mmu_peek(gb, addr), 0, 0 };
+    uint8_t length = gb_opcodes[bytes[0]].length;
+
+    for (uint8_t i = 1; i < length; i++) {
+        bytes[i] = mmu_peek(gb, (uint16_t)(addr + i));
+    }
+    return gb_disasm_bytes(bytes, addr, buf, len);
+}
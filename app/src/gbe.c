@@ -0,0 +1,839 @@
+/**
+ * gbe.c - Embeddable Emulator API
+ *
+ * An instance lives in one cache-aligned slot: struct gbe_s (host side,
+ * framebuffer, then the core) followed by its cartridge RAM, so everything
+ * the machine state is made of - core, memory, cartridge RAM - is one
+ * contiguous tail of the slot and gbe_copy() is a single memcpy.
+ * gbe_create() allocates one slot, gbe_vec_create() an arena of n slots
+ * sharing one power-on snapshot. The ROM is never copied.
+ * A fork's slot has no cartridge RAM: it reads the snapshot's and keeps
+ * private copies of the 256-byte pages it writes (struct gbe_cow_s), while
+ * its work RAM is shared the same way through the core's page table.
+ * Optional parts (observation ring, hash cache) are allocated on first use.
+ * The callbacks find their instance from the gb pointer without using
+ * direct.priv. See gbe.h.
+ */
+
+#include "gbe.h"
+#include "cpu.h"
+#include "gpu.h"
+#include "memory.h"
+#include "rom.h"
+#include "trace.h"
+#include "ttable.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CACHE_LINE      64
+#define ALIGN_UP(x)     (((x) + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1))
+#define COW_PAGE        (1 << MMU_PAGE_SHIFT)
+
+// Cartridge RAM of a fork, copy-on-write
+struct gbe_cow_s {
+    const uint8_t *src;             // The snapshot's cart RAM
+    int npages;
+    int nspare;                     // Pages kept from before the last reset
+    uint8_t *page[];                // npages own copies (NULL = still shared),
+                                    // then up to npages spares
+};
+
+struct gbe_s {
+    const uint8_t *rom;             // Borrowed from the caller
+    size_t rom_size;
+    uint8_t *cart_ram;              // In the slot after this struct, NULL if none
+    size_t cart_ram_size;
+
+    struct gb_state_s *power_on;    // For gbe_reset(g, NULL); shared in an arena
+    bool own_slot;                  // Allocated by gbe_create(), not an arena
+    size_t slot_size;
+
+    uint8_t *out;                   // Where draw_line() writes: fb or an obs slot
+    uint8_t fb[GBE_FB_HEIGHT][GBE_FB_WIDTH];
+
+    // Observation sink (gbe_set_obs()), obs_ring == NULL when off
+    struct gbe_obs_config_s obs;
+    size_t obs_size;                // Bytes per observation
+    uint8_t *obs_ring;              // obs.stack observations
+    int obs_head;                   // Slot of the newest one
+    int obs_count;                  // Observations since reset, up to obs.stack
+    int16_t obs_row[GBE_FB_HEIGHT]; // Output row of each LCD line, -1 if skipped
+    uint8_t obs_col[GBE_FB_WIDTH + 1];  // Output column x averages [col[x], col[x+1])
+    uint32_t draw_mask[(GBE_FB_HEIGHT + 31) / 32];
+
+    struct gbe_cow_s *cow;          // gbe_fork() only, else NULL
+
+    struct state_hasher_s *hasher;  // gbe_hash()'s page hashes, NULL until used
+    uint64_t hash;                  // Last vector step's, with a table
+    bool seen;                      // Whether the table already had it
+
+    // Machine state: from here to the end of the slot (cart RAM included)
+    _Alignas(CACHE_LINE) struct gb_s gb;
+    const char *error;              // Set by on_error(), NULL when running
+};
+
+#define STATE_OFFSET    offsetof(struct gbe_s, gb)
+
+// Bytes per instance, keeping every slot (and its cart RAM) cache-aligned
+static size_t slot_size(const struct rom_info_s *info) {
+    return ALIGN_UP(sizeof(struct gbe_s)) + ALIGN_UP(info->cart_ram_size);
+}
+
+static inline struct gbe_s *to_gbe(struct gb_s *gb) {
+    return (struct gbe_s *)((uint8_t *)gb - STATE_OFFSET);
+}
+
+// -------------------------------
+// Core callbacks
+// -------------------------------
+
+static uint8_t rom_read(struct gb_s *gb, uint32_t addr) {
+    struct gbe_s *g = to_gbe(gb);
+    return addr < g->rom_size ? g->rom[addr] : 0xFF;
+}
+
+static uint8_t cart_ram_read(struct gb_s *gb, uint32_t addr) {
+    struct gbe_s *g = to_gbe(gb);
+    return addr < g->cart_ram_size ? g->cart_ram[addr] : 0xFF;
+}
+
+static void cart_ram_write(struct gb_s *gb, uint32_t addr, uint8_t val) {
+    struct gbe_s *g = to_gbe(gb);
+    if (addr < g->cart_ram_size) {
+        g->cart_ram[addr] = val;
+    }
+}
+
+// Stop the step loop instead of printing and exiting like the frontend
+static void on_error(struct gb_s *gb, enum gb_error_e error, uint16_t addr) {
+    (void)addr;
+    struct gbe_s *g = to_gbe(gb);
+    g->error = error == GB_ERROR_INVALID_OPCODE ? "invalid opcode" :
+               error == GB_INVALID_READ ? "invalid read" :
+               error == GB_INVALID_WRITE ? "invalid write" : "emulator error";
+    gb->gb_break = true;
+}
+
+static uint8_t fork_cart_ram_read(struct gb_s *gb, uint32_t addr) {
+    struct gbe_s *g = to_gbe(gb);
+    if (addr >= g->cart_ram_size) return 0xFF;
+    const uint8_t *page = g->cow->page[addr >> MMU_PAGE_SHIFT];
+    return page ? page[addr & (COW_PAGE - 1)] : g->cow->src[addr];
+}
+
+// First write to a page: copy it from the snapshot, reusing a spare if any
+static void fork_cart_ram_write(struct gb_s *gb, uint32_t addr, uint8_t val) {
+    struct gbe_s *g = to_gbe(gb);
+    if (addr >= g->cart_ram_size) return;
+
+    struct gbe_cow_s *c = g->cow;
+    uint32_t i = addr >> MMU_PAGE_SHIFT;
+    if (!c->page[i]) {
+        uint8_t *page = c->nspare > 0 ? c->page[c->npages + --c->nspare] : malloc(COW_PAGE);
+        if (!page) {
+            g->error = "out of memory";
+            gb->gb_break = true;
+            return;
+        }
+        size_t off = (size_t)i * COW_PAGE;
+        size_t len = g->cart_ram_size - off < COW_PAGE ? g->cart_ram_size - off : COW_PAGE;
+        memcpy(page, c->src + off, len);
+        c->page[i] = page;
+    }
+    c->page[i][addr & (COW_PAGE - 1)] = val;
+}
+
+// -------------------------------
+// Observation sink
+// -------------------------------
+
+// Two shades per output pixel, 8 input pixels per step: pair sums in
+// 16-bit lanes, then 255 - 85 * sum / 2 rounded, all lanes at once.
+// Little-endian lane order (x86, ARM).
+static void gray_half(const uint8_t *pixels, uint8_t *row) {
+    const uint64_t lo = 0x00FF00FF00FF00FFULL;
+    for (int x = 0; x < GBE_FB_WIDTH / 2; x += 4) {
+        uint64_t w;
+        memcpy(&w, pixels + 2 * x, sizeof(w));
+        w &= 0x0303030303030303ULL;
+        uint64_t sum = (w & lo) + ((w >> 8) & lo);
+        uint64_t gray = lo - (((sum * 85 + 0x0001000100010001ULL) >> 1) & lo);
+        row[x + 0] = (uint8_t)gray;
+        row[x + 1] = (uint8_t)(gray >> 16);
+        row[x + 2] = (uint8_t)(gray >> 32);
+        row[x + 3] = (uint8_t)(gray >> 48);
+    }
+}
+
+// Any width: average the shades each output pixel covers
+static void gray_box(const struct gbe_s *g, const uint8_t *pixels, uint8_t *row) {
+    for (int x = 0; x < g->obs.width; x++) {
+        int x0 = g->obs_col[x], n = g->obs_col[x + 1] - x0;
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += pixels[x0 + i] & 0x03;
+        }
+        row[x] = (uint8_t)(255 - (85 * sum + n / 2) / n);
+    }
+}
+
+// Shade of the pixel at the centre of each output pixel
+static void index_sample(const struct gbe_s *g, const uint8_t *pixels, uint8_t *row) {
+    for (int x = 0; x < g->obs.width; x++) {
+        row[x] = pixels[(g->obs_col[x] + g->obs_col[x + 1]) / 2] & 0x03;
+    }
+}
+
+static void obs_line(struct gbe_s *g, const uint8_t *pixels, uint8_t line) {
+    int r = g->obs_row[line];
+    if (r < 0) return;
+    uint8_t *row = g->obs_ring + (size_t)g->obs_head * g->obs_size + (size_t)r * g->obs.width;
+
+    if (g->obs.format == GBE_OBS_INDEX) {
+        index_sample(g, pixels, row);
+    } else if (g->obs.width == GBE_FB_WIDTH / 2) {
+        gray_half(pixels, row);
+    } else {
+        gray_box(g, pixels, row);
+    }
+}
+
+// Next observation slot, before the frame that fills it is drawn
+static void obs_advance(struct gbe_s *g) {
+    g->obs_head = (g->obs_head + 1) % g->obs.stack;
+    if (g->obs_count < g->obs.stack) g->obs_count++;
+}
+
+static void draw_line(struct gb_s *gb, const uint8_t *pixels, uint8_t line) {
+    struct gbe_s *g = to_gbe(gb);
+    if (g->obs_ring) {
+        obs_line(g, pixels, line);
+    } else if (line < GBE_FB_HEIGHT) {
+        uint8_t *row = g->out + (size_t)line * GBE_FB_WIDTH;
+        for (int x = 0; x < GBE_FB_WIDTH; x++) {
+            row[x] = pixels[x] & 0x03;
+        }
+    }
+}
+
+// -------------------------------
+// Lifetime
+// -------------------------------
+
+// Host side of an instance in a zeroed slot
+static void slot_attach(struct gbe_s *g, const uint8_t *rom, size_t size) {
+    g->rom = rom;
+    g->rom_size = size;
+    g->out = &g->fb[0][0];
+    g->slot_size = ALIGN_UP(sizeof(*g));
+
+    struct gb_s *gb = &g->gb;
+    gb->gb_rom_read = rom_read;
+    gb->gb_cart_ram_read = cart_ram_read;
+    gb->gb_cart_ram_write = cart_ram_write;
+    gb->gb_error = on_error;
+    gb->direct.joypad = 0xFF;
+}
+
+// Power on an instance in a zeroed slot
+static void slot_init(struct gbe_s *g, const uint8_t *rom, size_t size, const struct rom_info_s *info) {
+    slot_attach(g, rom, size);
+    if (info->cart_ram_size > 0) {
+        g->cart_ram = (uint8_t *)g + ALIGN_UP(sizeof(*g));
+        g->cart_ram_size = info->cart_ram_size;
+    }
+    g->slot_size = slot_size(info);
+    rom_setup(&g->gb, info);
+}
+
+// Zeroed, cache-aligned memory
+static void *alloc_aligned(size_t size) {
+    void *p = aligned_alloc(CACHE_LINE, ALIGN_UP(size));
+    if (p) memset(p, 0, ALIGN_UP(size));
+    return p;
+}
+
+// Power-on snapshot of an instance just set up
+static struct gb_state_s *power_on_state(const struct gbe_s *g) {
+    struct gb_state_s *st = gbe_state_new(g);
+    if (st) gbe_save(g, st);
+    return st;
+}
+
+struct gbe_s *gbe_create(const uint8_t *rom, size_t size, const char **error) {
+    struct rom_info_s info;
+    enum rom_error_e err = rom_parse_header(rom, size, &info);
+    if (err != ROM_OK) {
+        if (error) *error = rom_error_str(err);
+        return NULL;
+    }
+
+    struct gbe_s *g = alloc_aligned(slot_size(&info));
+    if (!g) {
+        if (error) *error = "out of memory";
+        return NULL;
+    }
+    slot_init(g, rom, size, &info);
+    g->own_slot = true;
+
+    g->power_on = power_on_state(g);
+    if (!g->power_on) {
+        if (error) *error = "out of memory";
+        free(g);
+        return NULL;
+    }
+    return g;
+}
+
+struct gbe_s *gbe_fork(const struct gbe_s *g, const struct gb_state_s *st, const char **error) {
+    if (st && st->cart_ram_size != g->cart_ram_size) {
+        if (error) *error = "snapshot is for another cartridge";
+        return NULL;
+    }
+
+    int npages = (int)((g->cart_ram_size + COW_PAGE - 1) / COW_PAGE);
+    struct gbe_s *f = alloc_aligned(sizeof(*f));
+    struct gbe_cow_s *c = calloc(1, sizeof(*c) + 2 * (size_t)npages * sizeof(c->page[0]));
+    if (!f || !c) {
+        if (error) *error = "out of memory";
+        free(f);
+        free(c);
+        return NULL;
+    }
+
+    /* No power-on: the reset below brings in the whole machine state */
+    slot_attach(f, g->rom, g->rom_size);
+    f->gb.gb_cart_ram_read = fork_cart_ram_read;
+    f->gb.gb_cart_ram_write = fork_cart_ram_write;
+    f->cart_ram_size = g->cart_ram_size;
+    f->own_slot = true;
+    f->power_on = g->power_on;
+    f->cow = c;
+    c->npages = npages;
+
+    gbe_reset(f, st);
+    return f;
+}
+
+void gbe_destroy(struct gbe_s *g) {
+    if (!g || !g->own_slot) return;
+    gbe_set_obs(g, NULL);
+    free(g->hasher);
+    if (g->cow) {
+        for (int i = 0; i < g->cow->npages + g->cow->nspare; i++) {
+            free(g->cow->page[i]);
+        }
+        free(g->cow);
+    } else {
+        gbe_state_free(g->power_on);
+    }
+    free(g);
+}
+
+// -------------------------------
+// Stepping
+// -------------------------------
+
+// Run frames, drawing the last one into @out
+static int step_into(struct gbe_s *g, uint8_t joypad, int frames, uint8_t *out) {
+    struct gb_s *gb = &g->gb;
+    int done = 0;
+
+    gb->direct.joypad = joypad;
+    g->out = out;
+
+    while (done < frames && !gb->gb_break) {
+        /* Frame-skip: only the last frame pays for rendering */
+        gb->display.lcd_draw_line = (done == frames - 1) ? draw_line : NULL;
+        if (gb->display.lcd_draw_line && g->obs_ring) {
+            obs_advance(g);
+        }
+
+        gb->gb_frame = 0;
+        while (!gb->gb_frame && !gb->gb_break) {
+            cpu_step(gb);
+        }
+        if (gb->gb_frame) done++;
+    }
+
+    gb->display.lcd_draw_line = NULL;
+    g->out = &g->fb[0][0];
+    return done;
+}
+
+int gbe_step(struct gbe_s *g, uint8_t joypad, int frames) {
+    return step_into(g, joypad, frames, &g->fb[0][0]);
+}
+
+// -------------------------------
+// Snapshots
+// -------------------------------
+
+struct gb_state_s *gbe_state_new(const struct gbe_s *g) {
+    struct gb_state_s *st = malloc(sizeof(*st));
+    if (st && state_init(st, g->cart_ram_size) != 0) {
+        free(st);
+        st = NULL;
+    }
+    return st;
+}
+
+void gbe_state_free(struct gb_state_s *st) {
+    if (!st) return;
+    state_free(st);
+    free(st);
+}
+
+void gbe_save(const struct gbe_s *g, struct gb_state_s *st) {
+    state_save(st, &g->gb, g->cart_ram);
+
+    const struct gbe_cow_s *c = g->cow;
+    if (c && st->cart_ram) {
+        for (int i = 0; i < c->npages; i++) {
+            size_t off = (size_t)i * COW_PAGE;
+            size_t len = g->cart_ram_size - off < COW_PAGE ? g->cart_ram_size - off : COW_PAGE;
+            const uint8_t *page = c->page[i] ? c->page[i] : c->src + off;
+            if (page != st->cart_ram + off) {
+                memcpy(st->cart_ram + off, page, len);
+            }
+        }
+    }
+}
+
+// Share @cart_ram again; the pages written since become spares
+static void cow_share(struct gbe_cow_s *c, const uint8_t *cart_ram) {
+    for (int i = 0; i < c->npages; i++) {
+        if (c->page[i]) {
+            c->page[c->npages + c->nspare++] = c->page[i];
+            c->page[i] = NULL;
+        }
+    }
+    c->src = cart_ram;
+}
+
+void gbe_reset(struct gbe_s *g, const struct gb_state_s *st) {
+    if (!st) st = g->power_on;
+    if (g->cow) {
+        state_load_shared(&g->gb, st);
+        cow_share(g->cow, st->cart_ram);
+    } else {
+        state_load(&g->gb, st, g->cart_ram);
+    }
+    g->gb.gb_break = false;
+    g->error = NULL;
+    g->obs_count = 0;
+}
+
+// -------------------------------
+// Zero-copy access
+// -------------------------------
+
+const uint8_t *gbe_framebuffer(const struct gbe_s *g) {
+    return &g->fb[0][0];
+}
+
+uint8_t *gbe_wram(struct gbe_s *g) {
+    mmu_unshare_wram(&g->gb);
+    return g->gb.wram;
+}
+
+// Page hashes for gbe_hash(), allocated the first time an instance is hashed
+static bool hasher_alloc(struct gbe_s *g) {
+    if (!g->hasher) {
+        g->hasher = malloc(sizeof(*g->hasher));
+        if (g->hasher) state_hasher_init(g->hasher);
+    }
+    return g->hasher != NULL;
+}
+
+uint64_t gbe_hash(struct gbe_s *g) {
+    const uint8_t *cram[MMU_CRAM_PAGES];
+    int n = (int)(g->cart_ram_size >> MMU_PAGE_SHIFT);
+
+    for (int i = 0; i < n; i++) {
+        size_t off = (size_t)i << MMU_PAGE_SHIFT;
+        cram[i] = !g->cow ? g->cart_ram + off : g->cow->page[i] ? g->cow->page[i] : g->cow->src + off;
+    }
+    if (!hasher_alloc(g)) {
+        return state_hash_full(&g->gb, cram, n);    /* Same value, just slower */
+    }
+    return state_hash_update(g->hasher, &g->gb, cram, n);
+}
+
+int gbe_copy(struct gbe_s *dst, const struct gbe_s *src) {
+    if (dst->rom != src->rom || dst->cart_ram_size != src->cart_ram_size || dst->cow || src->cow) {
+        return -1;
+    }
+    if (dst == src) return 0;
+
+    /* The core's host-side fields stay dst's */
+    struct gb_s *gb = &dst->gb;
+    struct state_host_s host;
+    state_host_save(&host, gb);
+
+    memcpy((uint8_t *)dst + STATE_OFFSET, (const uint8_t *)src + STATE_OFFSET, src->slot_size - STATE_OFFSET);
+
+    state_host_restore(gb, &host);
+    gpu_bg_invalidate(gb);
+    mmu_remap(gb);  /* The page table pointed into src */
+
+    /* The dirty bitmap came with the state, so src's page hashes still fit */
+    if (dst->hasher) {
+        if (src->hasher) {
+            *dst->hasher = *src->hasher;
+        } else {
+            state_hasher_init(dst->hasher);
+        }
+    }
+    dst->obs_count = 0;
+    return 0;
+}
+
+size_t gbe_size(const struct gbe_s *g) {
+    size_t size = g->slot_size + (g->hasher ? sizeof(*g->hasher) : 0);
+    if (g->obs_ring) {
+        size += (size_t)g->obs.stack * g->obs_size;
+    }
+    if (g->cow) {
+        int pages = g->cow->nspare;
+        for (int i = 0; i < g->cow->npages; i++) {
+            if (g->cow->page[i]) pages++;
+        }
+        size += sizeof(*g->cow) + 2 * (size_t)g->cow->npages * sizeof(g->cow->page[0]) + (size_t)pages * COW_PAGE;
+    }
+    return size;
+}
+
+int gbe_fork_pages(const struct gbe_s *g) {
+    int n = (WRAM_SIZE >> MMU_PAGE_SHIFT) - mmu_wram_shared(&g->gb);
+    if (g->cow) {
+        for (int i = 0; i < g->cow->npages; i++) {
+            if (g->cow->page[i]) n++;
+        }
+    }
+    return n;
+}
+
+struct gb_s *gbe_core(struct gbe_s *g) {
+    return &g->gb;
+}
+
+const char *gbe_error(const struct gbe_s *g) {
+    return g->error;
+}
+
+// -------------------------------
+// Observations
+// -------------------------------
+
+int gbe_set_obs(struct gbe_s *g, const struct gbe_obs_config_s *cfg) {
+    if (cfg && (cfg->width < 1 || cfg->width > GBE_FB_WIDTH || cfg->height < 1 || cfg->height > GBE_FB_HEIGHT ||
+                cfg->stack < 1 || cfg->stack > GBE_OBS_MAX_STACK ||
+                (cfg->format != GBE_OBS_GRAY && cfg->format != GBE_OBS_INDEX))) {
+        return -1;
+    }
+
+    free(g->obs_ring);
+    g->obs_ring = NULL;
+    g->obs_size = 0;
+    g->gb.display.draw_mask = NULL;
+    if (!cfg) {
+        return 0;
+    }
+
+    size_t size = (size_t)cfg->width * (size_t)cfg->height;
+    g->obs_ring = calloc((size_t)cfg->stack, size);
+    if (!g->obs_ring) {
+        return -1;
+    }
+    g->obs = *cfg;
+    g->obs_size = size;
+    g->obs_head = 0;
+    g->obs_count = 0;
+
+    /* Line decimation: output row r shows the LCD line at its centre */
+    memset(g->obs_row, 0xFF, sizeof(g->obs_row));
+    memset(g->draw_mask, 0, sizeof(g->draw_mask));
+    for (int r = 0; r < cfg->height; r++) {
+        int line = (2 * r + 1) * GBE_FB_HEIGHT / (2 * cfg->height);
+        g->obs_row[line] = (int16_t)r;
+        g->draw_mask[line >> 5] |= 1u << (line & 31);
+    }
+    for (int x = 0; x <= cfg->width; x++) {
+        g->obs_col[x] = (uint8_t)(x * GBE_FB_WIDTH / cfg->width);
+    }
+    g->gb.display.draw_mask = g->draw_mask;
+    return 0;
+}
+
+size_t gbe_obs_size(const struct gbe_s *g) {
+    return g->obs_size;
+}
+
+const uint8_t *gbe_obs(const struct gbe_s *g, int age) {
+    if (!g->obs_ring) return NULL;
+
+    /* Before the stack has filled, the oldest observation repeats */
+    if (age >= g->obs_count) age = g->obs_count - 1;
+    if (age < 0) age = 0;
+    int slot = (g->obs_head - age + g->obs.stack) % g->obs.stack;
+    return g->obs_ring + (size_t)slot * g->obs_size;
+}
+
+void gbe_obs_stack(const struct gbe_s *g, uint8_t *out) {
+    for (int age = g->obs.stack - 1; age >= 0; age--) {
+        memcpy(out, gbe_obs(g, age), g->obs_size);
+        out += g->obs_size;
+    }
+}
+
+// -------------------------------
+// Vectorized stepping
+// -------------------------------
+
+struct gbe_vec_s {
+    uint8_t *arena;                 // n slots of stride bytes
+    size_t stride;
+    int n;
+    struct gb_state_s *power_on;    // Shared by every slot
+    size_t obs_bytes;               // Per instance in the obs buffer
+
+    // Persistent workers (threads - 1 of them; the caller is the last)
+    int workers;
+    pthread_t *thread;
+    pthread_mutex_t lock;
+    pthread_cond_t go;              // New generation posted (or quit)
+    pthread_cond_t done;            // Last worker finished the generation
+    uint64_t generation;
+    bool quit;
+
+    // Current call, read-only while workers run
+    const uint8_t *actions;
+    int frames;
+    uint8_t *obs;
+    struct ttable_s *tt;            // Hash and look up each instance, NULL = no
+
+    _Alignas(CACHE_LINE) atomic_int next;   // Next instance to claim
+    _Alignas(CACHE_LINE) atomic_int active; // Workers still in this generation
+    atomic_int errors;                      // Instances that stopped early
+};
+
+static inline struct gbe_s *vec_slot(const struct gbe_vec_s *v, int i) {
+    return (struct gbe_s *)(v->arena + (size_t)i * v->stride);
+}
+
+// Claim instances one at a time until none are left
+static void vec_run(struct gbe_vec_s *v) {
+    int errors = 0;
+    for (int i = atomic_fetch_add_explicit(&v->next, 1, memory_order_relaxed); i < v->n;
+         i = atomic_fetch_add_explicit(&v->next, 1, memory_order_relaxed)) {
+        struct gbe_s *g = vec_slot(v, i);
+        uint8_t *dst = v->obs ? v->obs + (size_t)i * v->obs_bytes : NULL;
+
+        /* Full frames are drawn in place; a sink's stack is copied out */
+        if (step_into(g, v->actions[i], v->frames, dst && !g->obs_ring ? dst : &g->fb[0][0]) < v->frames) {
+            errors++;
+        }
+        if (dst && g->obs_ring) {
+            gbe_obs_stack(g, dst);
+        }
+        if (v->tt) {
+            g->hash = gbe_hash(g);
+            g->seen = ttable_insert(v->tt, g->hash);
+        }
+    }
+    if (errors) {
+        atomic_fetch_add_explicit(&v->errors, errors, memory_order_relaxed);
+    }
+}
+
+static void *vec_worker(void *arg) {
+    struct gbe_vec_s *v = arg;
+    uint64_t seen = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&v->lock);
+        while (v->generation == seen && !v->quit) {
+            pthread_cond_wait(&v->go, &v->lock);
+        }
+        if (v->quit) {
+            pthread_mutex_unlock(&v->lock);
+            return NULL;
+        }
+        seen = v->generation;
+        pthread_mutex_unlock(&v->lock);
+
+        vec_run(v);
+
+        if (atomic_fetch_sub_explicit(&v->active, 1, memory_order_acq_rel) == 1) {
+            pthread_mutex_lock(&v->lock);
+            pthread_cond_signal(&v->done);
+            pthread_mutex_unlock(&v->lock);
+        }
+    }
+}
+
+struct gbe_vec_s *gbe_vec_create(const uint8_t *rom, size_t size, int n, int threads, const char **error) {
+    struct rom_info_s info;
+    enum rom_error_e err = rom_parse_header(rom, size, &info);
+    if (err != ROM_OK || n <= 0) {
+        if (error) *error = err != ROM_OK ? rom_error_str(err) : "no instances requested";
+        return NULL;
+    }
+
+    if (threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (int)cpus : 1;
+    }
+    threads = threads > n ? n : threads;
+
+    struct gbe_vec_s *v = calloc(1, sizeof(*v));
+    if (!v) {
+        if (error) *error = "out of memory";
+        return NULL;
+    }
+    v->n = n;
+    v->stride = slot_size(&info);
+    v->obs_bytes = GBE_FB_SIZE;
+    v->arena = alloc_aligned(v->stride * (size_t)n);
+    v->thread = calloc((size_t)threads, sizeof(pthread_t));
+    if (!v->arena || !v->thread) {
+        goto fail;
+    }
+
+    for (int i = 0; i < n; i++) {
+        slot_init(vec_slot(v, i), rom, size, &info);
+    }
+    v->power_on = power_on_state(vec_slot(v, 0));
+    if (!v->power_on) {
+        goto fail;
+    }
+    for (int i = 0; i < n; i++) {
+        vec_slot(v, i)->power_on = v->power_on;
+    }
+
+    pthread_mutex_init(&v->lock, NULL);
+    pthread_cond_init(&v->go, NULL);
+    pthread_cond_init(&v->done, NULL);
+    atomic_init(&v->next, 0);
+    atomic_init(&v->active, 0);
+    atomic_init(&v->errors, 0);
+
+    for (int t = 0; t < threads - 1; t++) {
+        if (pthread_create(&v->thread[t], NULL, vec_worker, v) != 0) {
+            break;  // Run with the workers we have
+        }
+        v->workers++;
+    }
+    return v;
+
+fail:
+    if (error) *error = "out of memory";
+    free(v->arena);
+    free(v->thread);
+    free(v);
+    return NULL;
+}
+
+void gbe_vec_destroy(struct gbe_vec_s *v) {
+    if (!v) return;
+
+    pthread_mutex_lock(&v->lock);
+    v->quit = true;
+    pthread_cond_broadcast(&v->go);
+    pthread_mutex_unlock(&v->lock);
+    for (int t = 0; t < v->workers; t++) {
+        pthread_join(v->thread[t], NULL);
+    }
+    for (int i = 0; i < v->n; i++) {
+        gbe_set_obs(vec_slot(v, i), NULL);
+        free(vec_slot(v, i)->hasher);
+    }
+
+    pthread_cond_destroy(&v->done);
+    pthread_cond_destroy(&v->go);
+    pthread_mutex_destroy(&v->lock);
+    gbe_state_free(v->power_on);
+    free(v->thread);
+    free(v->arena);
+    free(v);
+}
+
+int gbe_vec_size(const struct gbe_vec_s *v) {
+    return v->n;
+}
+
+int gbe_vec_set_obs(struct gbe_vec_s *v, const struct gbe_obs_config_s *cfg) {
+    for (int i = 0; i < v->n; i++) {
+        if (gbe_set_obs(vec_slot(v, i), cfg) != 0) {
+            for (int j = 0; j < v->n; j++) gbe_set_obs(vec_slot(v, j), NULL);
+            v->obs_bytes = GBE_FB_SIZE;
+            return -1;
+        }
+    }
+    v->obs_bytes = cfg ? (size_t)cfg->stack * (size_t)cfg->width * (size_t)cfg->height : GBE_FB_SIZE;
+    return 0;
+}
+
+size_t gbe_vec_obs_bytes(const struct gbe_vec_s *v) {
+    return v->obs_bytes;
+}
+
+struct gbe_s *gbe_vec_env(struct gbe_vec_s *v, int i) {
+    return i >= 0 && i < v->n ? vec_slot(v, i) : NULL;
+}
+
+void gbe_vec_set_tt(struct gbe_vec_s *v, struct ttable_s *tt) {
+    v->tt = tt;
+    for (int i = 0; i < v->n; i++) {
+        struct gbe_s *g = vec_slot(v, i);
+        g->seen = false;
+        if (tt) hasher_alloc(g);    /* Now rather than in the workers */
+    }
+}
+
+int gbe_vec_seen(const struct gbe_vec_s *v, uint8_t *seen, uint64_t *hashes) {
+    int n = 0;
+    for (int i = 0; i < v->n; i++) {
+        const struct gbe_s *g = vec_slot(v, i);
+        if (seen) seen[i] = g->seen;
+        if (hashes) hashes[i] = g->hash;
+        n += g->seen;
+    }
+    return n;
+}
+
+int gbe_vec_step(struct gbe_vec_s *v, const uint8_t *actions, int frames, uint8_t *obs) {
+    TRACE_SCOPE("gbe_vec_step");
+
+    v->actions = actions;
+    v->frames = frames;
+    v->obs = obs;
+    atomic_store_explicit(&v->next, 0, memory_order_relaxed);
+    atomic_store_explicit(&v->errors, 0, memory_order_relaxed);
+    atomic_store_explicit(&v->active, v->workers, memory_order_relaxed);
+
+    if (v->workers > 0) {
+        pthread_mutex_lock(&v->lock);
+        v->generation++;
+        pthread_cond_broadcast(&v->go);
+        pthread_mutex_unlock(&v->lock);
+    }
+
+    vec_run(v);
+
+    if (v->workers > 0) {
+        pthread_mutex_lock(&v->lock);
+        while (atomic_load_explicit(&v->active, memory_order_acquire) > 0) {
+            pthread_cond_wait(&v->done, &v->lock);
+        }
+        pthread_mutex_unlock(&v->lock);
+    }
+    return atomic_load_explicit(&v->errors, memory_order_relaxed);
+}
@@ -0,0 +1,561 @@
+/**
+ * gdbstub.c - GDB Remote Serial Protocol Stub
+ *
+ * Packet framing ($data#checksum, +/- acks, 0x03 interrupts) and the small
+ * command set GDB needs to debug a bare-metal target: registers, memory,
+ * breakpoints, watchpoints, continue and single-step.
+ */
+
+#include "gdbstub.h"
+#include "debug.h"
+#include "memory.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define GDB_NUM_REGS    6
+
+static const char HEX[] = "0123456789abcdef";
+
+// -------------------------------
+// Socket helpers
+// -------------------------------
+
+static void send_all(int fd, const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, buf, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+                poll(&pfd, 1, 100);
+                continue;
+            }
+            return;     // Client gone; the next read notices
+        }
+        buf += n;
+        len -= (size_t)n;
+    }
+}
+
+static void send_packet(struct gdbstub_s *s, const char *data) {
+    char buf[GDB_PACKET_MAX + 8];
+    size_t len = strlen(data);
+    uint8_t sum = 0;
+
+    if (len > GDB_PACKET_MAX) len = GDB_PACKET_MAX;
+    buf[0] = '$';
+    for (size_t i = 0; i < len; i++) {
+        buf[1 + i] = data[i];
+        sum = (uint8_t)(sum + (uint8_t)data[i]);
+    }
+    buf[1 + len] = '#';
+    buf[2 + len] = HEX[sum >> 4];
+    buf[3 + len] = HEX[sum & 0xF];
+    send_all(s->client_fd, buf, len + 4);
+}
+
+static void drop_client(struct gdbstub_s *s, struct gb_s *gb) {
+    if (s->client_fd >= 0) {
+        close(s->client_fd);
+        s->client_fd = -1;
+    }
+    s->in_len = 0;
+    s->waiting = false;
+    s->fresh = false;
+
+    /* Let the game run on without the debugger */
+    if (s->own_debug) {
+        debug_free(gb);
+        s->own_debug = false;
+    } else {
+        debug_continue(gb);
+    }
+}
+
+// -------------------------------
+// Encoding
+// -------------------------------
+
+static int hex_val(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Parse hex digits; returns the position after them, or NULL if there are none
+static const char *parse_hex(const char *p, uint32_t *out) {
+    uint32_t v = 0;
+    int d;
+    const char *start = p;
+    while ((d = hex_val(*p)) >= 0) {
+        v = (v << 4) | (uint32_t)d;
+        p++;
+    }
+    *out = v;
+    return p == start ? NULL : p;
+}
+
+static uint16_t get_reg(const struct gb_s *gb, int n) {
+    const struct cpu_registers_s *r = &gb->cpu_reg;
+    switch (n) {
+        case 0: return (uint16_t)((r->a << 8) | r->f.reg);
+        case 1: return r->bc.reg;
+        case 2: return r->de.reg;
+        case 3: return r->hl.reg;
+        case 4: return r->sp.reg;
+        default: return r->pc.reg;
+    }
+}
+
+static void set_reg(struct gb_s *gb, int n, uint16_t v) {
+    struct cpu_registers_s *r = &gb->cpu_reg;
+    switch (n) {
+        case 0: r->a = (uint8_t)(v >> 8); r->f.reg = (uint8_t)(v & 0xF0); break;
+        case 1: r->bc.reg = v; break;
+        case 2: r->de.reg = v; break;
+        case 3: r->hl.reg = v; break;
+        case 4: r->sp.reg = v; break;
+        default: r->pc.reg = v; break;
+    }
+}
+
+// Four hex digits, little-endian byte order
+static void put_reg(char *out, uint16_t v) {
+    out[0] = HEX[(v >> 4) & 0xF];
+    out[1] = HEX[v & 0xF];
+    out[2] = HEX[(v >> 12) & 0xF];
+    out[3] = HEX[(v >> 8) & 0xF];
+}
+
+static bool read_reg(const char *p, uint16_t *v) {
+    int d[4];
+    for (int i = 0; i < 4; i++) {
+        if ((d[i] = hex_val(p[i])) < 0) return false;
+    }
+    *v = (uint16_t)((d[2] << 12) | (d[3] << 8) | (d[0] << 4) | d[1]);
+    return true;
+}
+
+// -------------------------------
+// Stop replies
+// -------------------------------
+
+static void send_stop(struct gdbstub_s *s, struct gb_s *gb) {
+    const struct debug_s *d = gb->debug;
+    char reply[32];
+
+    switch (d ? d->stop_reason : DEBUG_STOP_USER) {
+        case DEBUG_STOP_WATCH_WRITE:
+            snprintf(reply, sizeof(reply), "T05watch:%04x;", d->stop_addr);
+            break;
+        case DEBUG_STOP_WATCH_READ:
+            snprintf(reply, sizeof(reply), "T05rwatch:%04x;", d->stop_addr);
+            break;
+        case DEBUG_STOP_USER:
+            snprintf(reply, sizeof(reply), "S02");      // SIGINT
+            break;
+        case DEBUG_STOP_ERROR:
+            snprintf(reply, sizeof(reply), "S04");      // SIGILL
+            break;
+        default:
+            snprintf(reply, sizeof(reply), "S05");      // SIGTRAP
+            break;
+    }
+    send_packet(s, reply);
+}
+
+// -------------------------------
+// Commands
+// -------------------------------
+
+// Z/z packets: type,addr,kind
+static void cmd_point(struct gdbstub_s *s, struct gb_s *gb, const char *p, bool insert) {
+    uint32_t type, addr, len;
+    static const uint8_t TRAPS[] = {
+        MMU_TRAP_EXEC, MMU_TRAP_EXEC, MMU_TRAP_WRITE, MMU_TRAP_READ, MMU_TRAP_READ | MMU_TRAP_WRITE
+    };
+
+    if (!(p = parse_hex(p, &type)) || *p++ != ',' || !(p = parse_hex(p, &addr)) ||
+        *p++ != ',' || !parse_hex(p, &len)) {
+        send_packet(s, "E01");
+        return;
+    }
+    if (type > 4) {
+        send_packet(s, "");     // Unsupported type
+        return;
+    }
+
+    uint8_t trap = TRAPS[type];
+    uint16_t start = (uint16_t)addr;
+    uint16_t end = trap == MMU_TRAP_EXEC ? start : (uint16_t)(addr + (len ? len : 1) - 1);
+    int id = debug_find(gb, start, end, trap);
+    int ok;
+
+    if (insert) {
+        ok = id >= 0 || (trap == MMU_TRAP_EXEC ? debug_add_breakpoint(gb, start)
+                                               : debug_add_watchpoint(gb, start, end, trap)) >= 0;
+    } else {
+        ok = id < 0 || debug_delete(gb, (uint8_t)id) == 0;
+    }
+    send_packet(s, ok ? "OK" : "E02");
+}
+
+static void cmd_read_mem(struct gdbstub_s *s, struct gb_s *gb, const char *p) {
+    char reply[GDB_PACKET_MAX + 1];
+    uint32_t addr, len;
+
+    if (!(p = parse_hex(p, &addr)) || *p++ != ',' || !parse_hex(p, &len)) {
+        send_packet(s, "E01");
+        return;
+    }
+    if (len > GDB_PACKET_MAX / 2) len = GDB_PACKET_MAX / 2;
+
+    for (uint32_t i = 0; i < len; i++) {
+        uint8_t b = mmu_peek(gb, (uint16_t)(addr + i));
+        reply[2 * i] = HEX[b >> 4];
+        reply[2 * i + 1] = HEX[b & 0xF];
+    }
+    reply[2 * len] = '\0';
+    send_packet(s, reply);
+}
+
+static void cmd_write_mem(struct gdbstub_s *s, struct gb_s *gb, const char *p) {
+    uint32_t addr, len;
+
+    if (!(p = parse_hex(p, &addr)) || *p++ != ',' || !(p = parse_hex(p, &len)) || *p++ != ':' ||
+        strlen(p) < 2 * len) {
+        send_packet(s, "E01");
+        return;
+    }
+    for (uint32_t i = 0; i < len; i++) {
+        int hi = hex_val(p[2 * i]), lo = hex_val(p[2 * i + 1]);
+        if (hi < 0 || lo < 0) {
+            send_packet(s, "E01");
+            return;
+        }
+        mmu_poke(gb, (uint16_t)(addr + i), (uint8_t)((hi << 4) | lo));
+    }
+    send_packet(s, "OK");
+}
+
+static void handle_packet(struct gdbstub_s *s, struct gb_s *gb, const char *pkt) {
+    char reply[4 * GDB_NUM_REGS + 1];
+    uint32_t n, addr;
+    uint16_t v;
+    const char *p = pkt + 1;
+
+    switch (pkt[0]) {
+        case '?':
+            send_stop(s, gb);
+            return;
+
+        case 'g':
+            for (int i = 0; i < GDB_NUM_REGS; i++) {
+                put_reg(&reply[4 * i], get_reg(gb, i));
+            }
+            reply[4 * GDB_NUM_REGS] = '\0';
+            send_packet(s, reply);
+            return;
+
+        case 'G':
+            if (strlen(p) < 4 * GDB_NUM_REGS) break;
+            for (int i = 0; i < GDB_NUM_REGS; i++) {
+                if (!read_reg(p + 4 * i, &v)) goto error;
+                set_reg(gb, i, v);
+            }
+            send_packet(s, "OK");
+            return;
+
+        case 'p':
+            if (!parse_hex(p, &n) || n >= GDB_NUM_REGS) break;
+            put_reg(reply, get_reg(gb, (int)n));
+            reply[4] = '\0';
+            send_packet(s, reply);
+            return;
+
+        case 'P':
+            if (!(p = parse_hex(p, &n)) || *p++ != '=' || n >= GDB_NUM_REGS || !read_reg(p, &v)) break;
+            set_reg(gb, (int)n, v);
+            send_packet(s, "OK");
+            return;
+
+        case 'm':
+            cmd_read_mem(s, gb, p);
+            return;
+
+        case 'M':
+            cmd_write_mem(s, gb, p);
+            return;
+
+        case 'c':
+            if (parse_hex(p, &addr)) gb->cpu_reg.pc.reg = (uint16_t)addr;
+            debug_continue(gb);
+            s->waiting = true;      // Stop reply is sent when the core stops
+            return;
+
+        case 's':
+            if (parse_hex(p, &addr)) gb->cpu_reg.pc.reg = (uint16_t)addr;
+            debug_step(gb, 1);
+            send_stop(s, gb);
+            return;
+
+        case 'Z':
+        case 'z':
+            cmd_point(s, gb, p, pkt[0] == 'Z');
+            return;
+
+        case 'H':
+        case 'T':
+            send_packet(s, "OK");   // Single thread
+            return;
+
+        case 'D':
+            send_packet(s, "OK");
+            drop_client(s, gb);
+            return;
+
+        case 'k':
+            drop_client(s, gb);
+            return;
+
+        case 'q':
+            if (strncmp(pkt, "qSupported", 10) == 0) {
+                char features[64];
+                snprintf(features, sizeof(features), "PacketSize=%x;QStartNoAckMode+", GDB_PACKET_MAX);
+                send_packet(s, features);
+            } else if (strcmp(pkt, "qAttached") == 0) {
+                send_packet(s, "1");
+            } else if (strcmp(pkt, "qC") == 0) {
+                send_packet(s, "QC1");
+            } else if (strcmp(pkt, "qfThreadInfo") == 0) {
+                send_packet(s, "m1");
+            } else if (strcmp(pkt, "qsThreadInfo") == 0) {
+                send_packet(s, "l");
+            } else {
+                send_packet(s, "");
+            }
+            return;
+
+        case 'Q':
+            if (strcmp(pkt, "QStartNoAckMode") == 0) {
+                send_packet(s, "OK");
+                s->no_ack = true;
+            } else {
+                send_packet(s, "");
+            }
+            return;
+
+        default:
+            send_packet(s, "");     // Unsupported: GDB falls back (e.g. X -> M, vCont -> c/s)
+            return;
+    }
+
+error:
+    send_packet(s, "E01");
+}
+
+// Interrupt request (Ctrl-C in GDB)
+static void interrupt(struct gdbstub_s *s, struct gb_s *gb) {
+    if (!gb->gb_break) {
+        debug_stop(gb, DEBUG_STOP_USER);
+    }
+    if (s->waiting) {
+        s->waiting = false;
+        send_stop(s, gb);
+    }
+}
+
+// Parse every complete packet in the input buffer
+static void process_input(struct gdbstub_s *s, struct gb_s *gb) {
+    size_t pos = 0;
+
+    while (pos < s->in_len && s->client_fd >= 0) {
+        char c = s->in[pos];
+
+        if (c == 0x03) {
+            interrupt(s, gb);
+            pos++;
+            continue;
+        }
+        if (c != '$') {
+            pos++;      // Acks ('+' / '-') and noise
+            continue;
+        }
+
+        char *hash = memchr(&s->in[pos], '#', s->in_len - pos);
+        if (!hash || (size_t)(hash - s->in) + 2 >= s->in_len) {
+            break;      // Incomplete: wait for more
+        }
+
+        char *data = &s->in[pos + 1];
+        size_t len = (size_t)(hash - data);
+        uint8_t sum = 0;
+        for (size_t i = 0; i < len; i++) {
+            sum = (uint8_t)(sum + (uint8_t)data[i]);
+        }
+        int hi = hex_val(hash[1]), lo = hex_val(hash[2]);
+        pos = (size_t)(hash - s->in) + 3;
+
+        if (!s->no_ack && (hi < 0 || lo < 0 || ((hi << 4) | lo) != sum)) {
+            send_all(s->client_fd, "-", 1);
+            continue;
+        }
+        if (!s->no_ack) {
+            send_all(s->client_fd, "+", 1);
+        }
+
+        *hash = '\0';
+        handle_packet(s, gb, data);
+    }
+
+    if (s->client_fd < 0) {
+        return;     // Detached while processing
+    }
+    memmove(s->in, &s->in[pos], s->in_len - pos);
+    s->in_len -= pos;
+    if (s->in_len == sizeof(s->in)) {
+        s->in_len = 0;  // Oversized packet: drop it
+    }
+}
+
+// -------------------------------
+// Public API
+// -------------------------------
+
+void gdbstub_init(struct gdbstub_s *s) {
+    memset(s, 0, sizeof(*s));
+    s->listen_fd = -1;
+    s->client_fd = -1;
+}
+
+bool gdbstub_listen(struct gdbstub_s *s, const char *where) {
+    bool is_port = where[0] != '\0' && strspn(where, "0123456789") == strlen(where);
+    int fd;
+
+    if (is_port) {
+        struct sockaddr_in addr = { .sin_family = AF_INET };
+        addr.sin_port = htons((uint16_t)atoi(where));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);     // Never exposed beyond this host
+
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) {
+            perror("gdbstub: socket");
+            return false;
+        }
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+            perror("gdbstub: bind");
+            close(fd);
+            return false;
+        }
+    } else {
+        struct sockaddr_un addr = { .sun_family = AF_UNIX };
+        if (strlen(where) >= sizeof(addr.sun_path)) {
+            fprintf(stderr, "gdbstub: socket path too long: %s\n", where);
+            return false;
+        }
+        snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", where);
+
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            perror("gdbstub: socket");
+            return false;
+        }
+        unlink(where);
+        if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+            perror("gdbstub: bind");
+            close(fd);
+            return false;
+        }
+        snprintf(s->path, sizeof(s->path), "%s", where);
+    }
+
+    if (listen(fd, 1) != 0) {
+        perror("gdbstub: listen");
+        close(fd);
+        return false;
+    }
+    s->listen_fd = fd;
+    return true;
+}
+
+void gdbstub_attach_fd(struct gdbstub_s *s, int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    s->client_fd = fd;
+    s->in_len = 0;
+    s->no_ack = false;
+    s->waiting = false;
+    s->fresh = true;
+}
+
+void gdbstub_poll(struct gdbstub_s *s, struct gb_s *gb) {
+    /* No client: one zero-timeout poll of the listening socket */
+    if (s->client_fd < 0) {
+        struct pollfd pfd = { .fd = s->listen_fd, .events = POLLIN };
+        if (s->listen_fd < 0 || poll(&pfd, 1, 0) <= 0) {
+            return;
+        }
+        int fd = accept(s->listen_fd, NULL, NULL);
+        if (fd < 0) {
+            return;
+        }
+        gdbstub_attach_fd(s, fd);
+    }
+
+    /* New client: attach a debugger and stop, as GDB expects on connect */
+    if (s->fresh) {
+        s->fresh = false;
+        if (!gb->debug) {
+            if (debug_init(gb) != 0) {
+                drop_client(s, gb);
+                return;
+            }
+            s->own_debug = true;
+        }
+        debug_stop(gb, DEBUG_STOP_USER);
+    }
+
+    for (;;) {
+        ssize_t n = recv(s->client_fd, &s->in[s->in_len], sizeof(s->in) - s->in_len, 0);
+        if (n > 0) {
+            s->in_len += (size_t)n;
+            process_input(s, gb);
+            if (s->client_fd < 0) return;
+            continue;
+        }
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            drop_client(s, gb);     // Client went away
+            return;
+        }
+        if (errno != EINTR) break;
+    }
+
+    /* Report a breakpoint/watchpoint hit after 'c' */
+    if (s->waiting && gb->gb_break) {
+        s->waiting = false;
+        send_stop(s, gb);
+    }
+}
+
+void gdbstub_close(struct gdbstub_s *s, struct gb_s *gb) {
+    if (s->client_fd >= 0) {
+        drop_client(s, gb);
+    }
+    if (s->listen_fd >= 0) {
+        close(s->listen_fd);
+        s->listen_fd = -1;
+        if (s->path[0]) unlink(s->path);
+    }
+}
@@ -1,10 +1,111 @@
 #include "gpu.h"
 #include "gb_types.h"
+#include "trace.h"
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+/* The window covers part of the current line */
+static inline bool window_on_line(const struct gb_s *gb){
+	return (gb->hram_io[IO_LCDC] & LCDC_WINDOW_ENABLE) && gb->hram_io[IO_LY] >= gb->display.WY &&
+	       gb->hram_io[IO_WX] <= 166;
+}
+
+// -------------------------------
+// Background Cache
+// -------------------------------
+
+void gpu_bg_cache_attach(struct gb_s *gb, struct gpu_bg_cache_s *cache){
+	gb->display.bg_cache = cache;
+	if(cache) memset(cache->valid, 0, sizeof(cache->valid));
+	gpu_bg_invalidate(gb);
+	mmu_remap(gb);
+}
+
+/* Drop the tile rows that the VRAM pages in @dirty can change */
+static void bg_cache_sync(struct gpu_bg_cache_s *c, uint32_t dirty){
+	while(dirty){
+		int page = __builtin_ctz(dirty);
+		dirty &= dirty - 1;
+
+		/* Map entries: each page is 8 tile rows of one map */
+		if(page >= (VRAM_BMAP_1 >> 8)){
+			int map = (page - (VRAM_BMAP_1 >> 8)) >> 2;
+			uint32_t rows = 0xFFu << (((page - (VRAM_BMAP_1 >> 8)) & 3) * 8);
+			c->valid[map][0] &= ~rows;
+			c->valid[map][1] &= ~rows;
+			continue;
+		}
+
+		/*
+		 * Tile data: a page holds 16 tiles whose map indices share idx >> 4
+		 * in either mode. 0x8000-0x87FF is only reachable with LCDC bit 4
+		 * set, 0x9000-0x97FF only with it clear.
+		 */
+		uint16_t group = 1u << (page & 0x0F);
+		for(int sel = 0; sel < 2; sel++){
+			if(sel ? page >= 0x10 : page < 0x08) continue;
+			for(int map = 0; map < 2; map++){
+				for(uint32_t v = c->valid[map][sel]; v; v &= v - 1){
+					int row = __builtin_ctz(v);
+					if(c->groups[map][row] & group) c->valid[map][sel] &= ~(1u << row);
+				}
+			}
+		}
+	}
+}
+
+/* Redraw one tile row (8 lines) of a map from VRAM */
+static void bg_cache_row(struct gb_s *gb, struct gpu_bg_cache_s *c, int map, int sel, int row){
+	const uint8_t *entry = &gb->vram[(map ? VRAM_BMAP_2 : VRAM_BMAP_1) + row * 0x20];
+	uint16_t groups = 0;
+
+	for(int tx = 0; tx < 32; tx++){
+		uint8_t idx = entry[tx];
+		const uint8_t *tile = &gb->vram[sel ? VRAM_TILES_1 + idx * 0x10
+		                                    : VRAM_TILES_2 + ((idx + 0x80) % 0x100) * 0x10];
+		groups |= 1u << (idx >> 4);
+
+		for(int py = 0; py < 8; py++){
+			uint8_t t1 = tile[2 * py], t2 = tile[2 * py + 1];
+			uint8_t *dst = &c->px[map][sel][row * 8 + py][tx * 8];
+
+			for(int px = 0; px < 8; px++){
+				dst[px] = ((t1 >> (7 - px)) & 1) | (((t2 >> (7 - px)) & 1) << 1);
+			}
+		}
+	}
+	c->groups[map][row] = groups;
+	c->valid[map][sel] |= 1u << row;
+}
+
+/* Line @y of @map in the current addressing mode, brought up to date */
+static const uint8_t *bg_cache_line(struct gb_s *gb, int map, uint8_t y){
+	struct gpu_bg_cache_s *c = gb->display.bg_cache;
+	int sel = (gb->hram_io[IO_LCDC] & LCDC_TILE_SELECT) != 0;
+
+	if(gb->display.vram_dirty){
+		bg_cache_sync(c, gb->display.vram_dirty);
+		gb->display.vram_dirty = 0;
+	}
+	if(c->valid[map][sel] & (1u << (y >> 3))){
+		gb->stats.bg_cache_hits++;
+	}else{
+		gb->stats.bg_cache_misses++;
+		bg_cache_row(gb, c, map, sel, y >> 3);
+	}
+	return c->px[map][sel][y];
+}
+
+
+// -------------------------------
+// Scanline Rendering
+// -------------------------------
 
 void gpu_draw_line(struct gb_s *gb){
+	TRACE_SCOPE("gpu_draw_line");
+
 	// Per-line buffer (2‑bit color indices 0–3)
 	uint8_t pixels[160] = {0};
 
@@ -17,8 +118,25 @@ void gpu_draw_line(struct gb_s *gb){
 	/* If LCD not initialised by front-end, don't render anything. */
 	if(gb->display.lcd_draw_line == NULL) return;
 
-	/* If background is enabled, draw it. */
-	if(gb->hram_io[IO_LCDC] & LCDC_BG_ENABLE){
+	/* Line the front-end does not want: skip the work, keep the window line count */
+	if(gb->display.draw_mask &&
+	   !(gb->display.draw_mask[gb->hram_io[IO_LY] >> 5] & (1u << (gb->hram_io[IO_LY] & 31)))){
+		if(window_on_line(gb)) gb->display.window_clear++;
+		return;
+	}
+
+	/* If background is enabled, draw it: a wrapped copy from the cache... */
+	if((gb->hram_io[IO_LCDC] & LCDC_BG_ENABLE) && gb->display.bg_cache){
+		uint8_t bg_y = gb->hram_io[IO_LY] + gb->hram_io[IO_SCY];
+		uint8_t scx = gb->hram_io[IO_SCX];
+		const uint8_t *src = bg_cache_line(gb, (gb->hram_io[IO_LCDC] & LCDC_BG_MAP) != 0, bg_y);
+
+		for(uint8_t x = 0; x < LCD_WIDTH; x++){
+			pixels[x] = gb->display.bg_palette[src[(uint8_t)(scx + x)]];
+		}
+
+	/* ...or tile by tile from VRAM */
+	} else if(gb->hram_io[IO_LCDC] & LCDC_BG_ENABLE){
 		uint8_t bg_y, disp_x, bg_x, idx, py, px, t1, t2;
 		uint16_t bg_map, tile;
 
@@ -95,7 +213,17 @@ void gpu_draw_line(struct gb_s *gb){
 	}
 
 	/* draw window */
-	if(gb->hram_io[IO_LCDC] & LCDC_WINDOW_ENABLE && gb->hram_io[IO_LY] >= gb->display.WY && gb->hram_io[IO_WX] <= 166){
+	if(window_on_line(gb) && gb->display.bg_cache){
+		uint8_t wx = gb->hram_io[IO_WX];
+		const uint8_t *src = bg_cache_line(gb, (gb->hram_io[IO_LCDC] & LCDC_WINDOW_MAP) != 0,
+		                                  gb->display.window_clear);
+
+		for(uint8_t x = wx < 7 ? 0 : wx - 7; x < LCD_WIDTH; x++){
+			pixels[x] = gb->display.bg_palette[src[(uint8_t)(x - wx + 7)]];
+		}
+
+		gb->display.window_clear++; // advance window line
+	} else if(window_on_line(gb)){
 		uint16_t win_line, tile;
 		uint8_t disp_x, win_x, py, px, idx, t1, t2, end;
 
@@ -279,4 +407,78 @@ void gpu_draw_line(struct gb_s *gb){
 	}
 
 	gb->display.lcd_draw_line(gb, pixels, gb->hram_io[IO_LY]);
-}
\ No newline at end of file
+	gb->stats.lines_drawn++;
+}
+
+
+// -------------------------------
+// I/O Registers
+// -------------------------------
+
+/* LY reads 0 while the LCD is off; the stored line keeps counting */
+uint8_t gpu_read_ly(const struct gb_s *gb){
+	return (gb->hram_io[IO_LCDC] & LCDC_ENABLE) ? gb->hram_io[IO_LY] : 0;
+}
+
+/* Mode and the LYC flag are live, so a write to LYC shows up at once */
+uint8_t gpu_read_stat(const struct gb_s *gb){
+	uint8_t stat = (gb->hram_io[IO_STAT] & 0x78) | 0x80;
+
+	if(gb->hram_io[IO_LCDC] & LCDC_ENABLE) stat |= gb->hram_io[IO_STAT] & STAT_MODE;
+	if(gpu_read_ly(gb) == gb->hram_io[IO_LYC]) stat |= STAT_LYC_COINC;
+	return stat;
+}
+
+void gpu_write_lcdc(struct gb_s *gb, uint8_t val){
+	uint8_t lcd_was_on = gb->hram_io[IO_LCDC] & LCDC_ENABLE;
+	uint8_t lcd_is_now_on = val & LCDC_ENABLE;
+
+	gb->hram_io[IO_LCDC] = val;
+	if(lcd_was_on == lcd_is_now_on) return;
+
+	/* Switching on starts a blank frame in OAM Scan; off parks it in HBlank */
+	if(lcd_is_now_on) gb->lcd_blank = true;
+	gb->hram_io[IO_STAT] = (gb->hram_io[IO_STAT] & ~STAT_MODE) |
+	                       (lcd_is_now_on ? LCD_MODE_OAM_SCAN : LCD_MODE_HBLANK);
+	gb->hram_io[IO_LY] = 0;
+	gb->counter.line_start = gb->counter.cycles;
+	gpu_lcd_schedule(gb);
+}
+
+/* Only bits 3-6 are writable, bits 0-2 are read-only */
+void gpu_write_stat(struct gb_s *gb, uint8_t val){
+	gb->hram_io[IO_STAT] = (val & 0x78) | (gb->hram_io[IO_STAT] & 0x07) | 0x80;
+}
+
+/* LY is read-only */
+void gpu_write_ly(struct gb_s *gb, uint8_t val){
+	(void)gb; (void)val;
+}
+
+/* Takes effect now and is latched again at the start of each frame */
+void gpu_write_wy(struct gb_s *gb, uint8_t val){
+	gb->hram_io[IO_WY] = val;
+	gb->display.WY = val;
+}
+
+static inline void unpack_palette(uint8_t *pal, uint8_t val){
+	pal[0] = (val >> 0) & 0x03;
+	pal[1] = (val >> 2) & 0x03;
+	pal[2] = (val >> 4) & 0x03;
+	pal[3] = (val >> 6) & 0x03;
+}
+
+void gpu_write_bgp(struct gb_s *gb, uint8_t val){
+	gb->hram_io[IO_BGP] = val;
+	unpack_palette(&gb->display.bg_palette[0], val);
+}
+
+void gpu_write_obp0(struct gb_s *gb, uint8_t val){
+	gb->hram_io[IO_OBP0] = val;
+	unpack_palette(&gb->display.sp_palette[0], val);
+}
+
+void gpu_write_obp1(struct gb_s *gb, uint8_t val){
+	gb->hram_io[IO_OBP1] = val;
+	unpack_palette(&gb->display.sp_palette[4], val);
+}
@@ -0,0 +1,123 @@
+/**
+ * itrace.c - Instruction Trace Ring
+ *
+ * Recording is inline in itrace.h; this file allocates the ring and turns
+ * it back into readable text.
+ */
+
+#include "itrace.h"
+#include "disasm.h"
+#include "memory.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const char *const REG_NAMES[] = { "", "BC", "DE", "HL", "SP" };
+
+int itrace_init(struct gb_s *gb, uint32_t entries) {
+    if (entries == 0 || (entries & (entries - 1)) != 0) {
+        return -1;
+    }
+
+    struct itrace_s *t = calloc(1, sizeof(*t));
+    if (!t) return -1;
+
+    t->ring = calloc(entries, sizeof(uint64_t));
+    if (!t->ring) {
+        free(t);
+        return -1;
+    }
+    t->mask = entries - 1;
+    memcpy(&t->pairs, &gb->cpu_reg.bc, sizeof(t->pairs));
+
+    itrace_free(gb);
+    gb->itrace = t;
+    return 0;
+}
+
+void itrace_free(struct gb_s *gb) {
+    if (gb->itrace) {
+        free(gb->itrace->ring);
+        free(gb->itrace);
+        gb->itrace = NULL;
+    }
+}
+
+int itrace_get(const struct gb_s *gb, uint32_t age, struct itrace_entry_s *out) {
+    const struct itrace_s *t = gb->itrace;
+    if (!t || age >= t->count || age > t->mask) {
+        return -1;
+    }
+
+    uint64_t e = t->ring[(t->count - 1 - age) & t->mask];
+    out->pc     = (uint16_t)(e & 0xFFFF);
+    out->bank   = (uint8_t)((e >> 16) & 0x7F);
+    if (out->pc < 0x4000 || out->pc >= 0x8000) {
+        out->bank = 0;
+    } else if (gb->mbc == 1 && gb->cart_mode_select) {
+        out->bank &= 0x1F;      // As mmu_read() maps it (mode as of now)
+    }
+    out->opcode = (uint8_t)((e >> 23) & 0xFF);
+    out->a      = (uint8_t)((e >> 31) & 0xFF);
+    out->flags  = (uint8_t)((e >> 39) & 0x0F);
+    out->reg    = (uint8_t)((e >> 43) & 0x07);
+    out->value  = (uint16_t)((e >> 46) & 0xFFFF);
+    return 0;
+}
+
+// Instruction bytes as they were executed (banked ROM is read through the
+// recorded bank rather than the one mapped now)
+static void fetch_bytes(struct gb_s *gb, const struct itrace_entry_s *e, uint8_t bytes[3]) {
+    for (uint16_t i = 0; i < 3; i++) {
+        uint16_t addr = (uint16_t)(e->pc + i);
+        if (addr >= 0x4000 && addr < 0x8000 && e->bank > 0) {
+            bytes[i] = gb->gb_rom_read(gb, addr + (uint32_t)(e->bank - 1) * ROM_BANK_SIZE);
+        } else {
+            bytes[i] = mmu_peek(gb, addr);
+        }
+    }
+    bytes[0] = e->opcode;
+}
+
+static void print_entry(struct gb_s *gb, FILE *f, const struct itrace_entry_s *e) {
+    uint8_t bytes[3];
+    char text[24];
+
+    fetch_bytes(gb, e, bytes);
+    gb_disasm_bytes(bytes, e->pc, text, sizeof(text));
+
+    fprintf(f, "%02X:%04X  %-16s A=%02X F=%c%c%c%c",
+            e->bank, e->pc, text, e->a,
+            (e->flags & 8) ? 'Z' : '-', (e->flags & 4) ? 'N' : '-',
+            (e->flags & 2) ? 'H' : '-', (e->flags & 1) ? 'C' : '-');
+    if (e->reg != ITRACE_REG_NONE) {
+        fprintf(f, " %s=%04X", REG_NAMES[e->reg], e->value);
+    }
+    fprintf(f, "\n");
+}
+
+void itrace_dump(struct gb_s *gb, FILE *f, uint32_t max) {
+    const struct itrace_s *t = gb->itrace;
+    if (!t) return;
+
+    uint32_t n = max;
+    if (n > t->mask + 1) n = t->mask + 1;
+    if (n > t->count) n = (uint32_t)t->count;
+
+    fprintf(f, "Last %u of %llu instructions (oldest first):\n", n, (unsigned long long)t->count);
+    for (uint32_t age = n; age-- > 0;) {
+        struct itrace_entry_s e;
+        itrace_get(gb, age, &e);
+        print_entry(gb, f, &e);
+    }
+}
+
+int itrace_write(struct gb_s *gb, const char *path) {
+    if (!gb->itrace) return -1;
+
+    FILE *f = fopen(path, "w");
+    if (!f) return -1;
+
+    itrace_dump(gb, f, gb->itrace->mask + 1);
+    return fclose(f) == 0 ? 0 : -1;
+}
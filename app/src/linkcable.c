@@ -0,0 +1,231 @@
+/**
+ * linkcable.c - In-Process Link Cable
+ *
+ * SPSC message rings, horizon publishing and the two serial_link_s hooks.
+ */
+
+#include "linkcable.h"
+#include "cpu.h"
+
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -------------------------------
+// Rings
+// -------------------------------
+
+static bool ring_push(struct cable_ring_s *r, const struct cable_msg_s *m) {
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+
+    if (tail - head == CABLE_RING_LEN) {
+        return false;
+    }
+    r->msg[tail % CABLE_RING_LEN] = *m;
+    atomic_store_explicit(&r->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+static bool ring_pop(struct cable_ring_s *r, struct cable_msg_s *m) {
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+
+    if (head == tail) {
+        return false;
+    }
+    *m = r->msg[head % CABLE_RING_LEN];
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+    return true;
+}
+
+static bool peer_present(struct link_cable_s *c, int side) {
+    return atomic_load_explicit(&c->present[!side], memory_order_acquire);
+}
+
+static void send_msg(struct cable_end_s *e, uint64_t cycles, uint8_t byte, enum cable_msg_e kind) {
+    struct link_cable_s *c = e->cable;
+    struct cable_msg_s m = { .cycles = cycles, .byte = byte, .kind = (uint8_t)kind };
+
+    /* Only fills up if the peer stopped reading, i.e. hung up */
+    while (!ring_push(&c->ring[e->side], &m)) {
+        if (!peer_present(c, e->side)) return;
+        sched_yield();
+    }
+}
+
+// -------------------------------
+// Synchronization
+// -------------------------------
+
+/* Earliest cycle at which this side could complete a transfer as master */
+static void publish(struct cable_end_s *e, struct gb_s *gb) {
+    uint64_t h = gb->counter.cycles;
+    bool master = (gb->hram_io[IO_SC] & (SC_TRANSFER | SC_CLOCK_INTERNAL)) == (SC_TRANSFER | SC_CLOCK_INTERNAL);
+
+    h += master ? gb->counter.serial_count : SERIAL_CYCLES;
+    atomic_store_explicit(&e->cable->horizon[e->side], h, memory_order_release);
+}
+
+static uint64_t peer_horizon(struct cable_end_s *e) {
+    return atomic_load_explicit(&e->cable->horizon[!e->side], memory_order_acquire);
+}
+
+/* Move everything the peer sent into our end's state */
+static void drain(struct cable_end_s *e) {
+    struct cable_msg_s m;
+
+    while (ring_pop(&e->cable->ring[!e->side], &m)) {
+        if (m.kind == CABLE_CLOCK) {
+            e->clock_pending = true;
+            e->clock_at = m.cycles;
+            e->clock_byte = m.byte;
+        } else {
+            e->reply_ready = true;
+            e->reply = m.byte;
+        }
+    }
+}
+
+/* Answer the peer's byte once our clock has caught up with it */
+static void service(struct cable_end_s *e, struct gb_s *gb) {
+    if (!e->clock_pending || e->clock_at > gb->counter.cycles) {
+        return;
+    }
+    e->clock_pending = false;
+
+    /* Only a side that was already waiting on the external clock takes it */
+    uint8_t sc = gb->hram_io[IO_SC];
+    uint8_t out = 0xFF;
+    if ((sc & (SC_TRANSFER | SC_CLOCK_INTERNAL)) == SC_TRANSFER &&
+        gb->counter.serial_armed <= e->clock_at) {
+        out = gb->hram_io[IO_SB];
+        serial_complete(gb, e->clock_byte);
+    }
+    send_msg(e, gb->counter.cycles, out, CABLE_REPLY);
+}
+
+static void wait_peer(struct cable_end_s *e) {
+    e->stalls++;
+    sched_yield();
+}
+
+// -------------------------------
+// serial_link_s hooks
+// -------------------------------
+
+static uint8_t cable_transfer(struct serial_link_s *link, struct gb_s *gb, uint8_t out) {
+    struct cable_end_s *e = (struct cable_end_s *)link;
+    uint64_t now = gb->counter.cycles;
+
+    e->reply_ready = false;
+    send_msg(e, now, out, CABLE_CLOCK);
+    publish(e, gb);
+    e->transfers++;
+
+    for (;;) {
+        drain(e);
+        if (e->reply_ready) {
+            e->reply_ready = false;
+            return e->reply;
+        }
+        /* The peer clocking too gets 0xFF from us: we are a master */
+        service(e, gb);
+        if (!peer_present(e->cable, e->side)) {
+            return 0xFF;
+        }
+        wait_peer(e);
+    }
+}
+
+static void cable_poll(struct serial_link_s *link, struct gb_s *gb) {
+    struct cable_end_s *e = (struct cable_end_s *)link;
+
+    for (;;) {
+        drain(e);
+        service(e, gb);
+        if (!(gb->hram_io[IO_SC] & SC_TRANSFER)) {
+            return;     // Byte received
+        }
+        /* Safe to run on until the peer could next send */
+        if (e->clock_pending || gb->counter.cycles < peer_horizon(e) ||
+            !peer_present(e->cable, e->side)) {
+            return;
+        }
+        publish(e, gb);
+        wait_peer(e);
+    }
+}
+
+// -------------------------------
+// Public API
+// -------------------------------
+
+struct link_cable_s *cable_create(struct gb_s *a, struct gb_s *b) {
+    size_t size = (sizeof(struct link_cable_s) + 63) & ~(size_t)63;
+    struct link_cable_s *c = aligned_alloc(64, size);
+    if (!c) {
+        return NULL;
+    }
+    memset(c, 0, size);
+
+    c->gb[0] = a;
+    c->gb[1] = b;
+    for (int i = 0; i < 2; i++) {
+        struct cable_end_s *e = &c->end[i];
+        e->link.transfer = cable_transfer;
+        e->link.poll = cable_poll;
+        e->cable = c;
+        e->side = i;
+
+        atomic_init(&c->ring[i].head, 0);
+        atomic_init(&c->ring[i].tail, 0);
+        atomic_init(&c->horizon[i], 0);
+        atomic_init(&c->present[i], true);
+        publish(e, c->gb[i]);
+        c->gb[i]->link = &e->link;
+    }
+    return c;
+}
+
+uint64_t cable_run(struct link_cable_s *c, int side, uint64_t cycles) {
+    struct cable_end_s *e = &c->end[side];
+    struct gb_s *gb = c->gb[side];
+    uint64_t start = gb->counter.cycles;
+    uint64_t end = start + cycles;
+
+    while (gb->counter.cycles < end && !gb->gb_break) {
+        uint64_t quantum = gb->counter.cycles + CABLE_QUANTUM;
+        if (quantum > end) quantum = end;
+
+        while (gb->counter.cycles < quantum && !gb->gb_break) {
+            cpu_step(gb);
+        }
+
+        publish(e, gb);
+        drain(e);
+        service(e, gb);
+
+        /* Bounded lead over the peer */
+        while (gb->counter.cycles > peer_horizon(e) + CABLE_MAX_SKEW && peer_present(c, side)) {
+            wait_peer(e);
+            drain(e);
+            service(e, gb);
+        }
+    }
+    return gb->counter.cycles - start;
+}
+
+void cable_hangup(struct link_cable_s *c, int side) {
+    atomic_store_explicit(&c->present[side], false, memory_order_release);
+}
+
+void cable_destroy(struct link_cable_s *c) {
+    if (!c) return;
+    for (int i = 0; i < 2; i++) {
+        if (c->gb[i]->link == &c->end[i].link) {
+            c->gb[i]->link = NULL;
+        }
+    }
+    free(c);
+}
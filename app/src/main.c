@@ -7,6 +7,8 @@
  */
 
 #include <SDL3/SDL.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -15,25 +17,50 @@
 #include "gb_types.h"
 #include "cpu.h"
 #include "memory.h"
+#include "gpu.h"
 #include "rom.h"
+#include "pacing.h"
+#include "osd.h"
+#include "palette.h"
+#include "trace.h"
+#include "itrace.h"
+#include "debug.h"
+#include "console.h"
+#include "gdbstub.h"
+#include "netplay.h"
+#include "state.h"
+#include "buttons.h"
+#include "joystick.h"
+#include "rt.h"
 
 
 /* Display scaling factor */
 #define SCALE_FACTOR 5
 
+/* HAL input thread poll period (500 Hz) */
+#define INPUT_POLL_NS 2000000L
+
+/* Instruction trace written by the T key */
+#define ITRACE_FILE "itrace.txt"
+
+/* Stack pre-faulted for each real-time thread */
+#define RT_STACK_PREFAULT (256 * 1024)
+
 /* Palette definition (same as Peanut-GB DMG colors) */
 #define LCD_PALETTE_ALL 0x30
 
 /* Frame buffer for LCD output */
 static uint16_t fb[LCD_HEIGHT][LCD_WIDTH];
 
-/* Color palette - DMG grayscale */
-static const uint32_t palette[] = {
-    0xFFFFFF,  /* White */
-    0xA5A5A5,  /* Light gray */
-    0x525252,  /* Dark gray */
-    0x000000   /* Black */
-};
+/* Prerendered background maps */
+static struct gpu_bg_cache_s bg_cache;
+
+/* Cartridge RAM of the other player's machine during netplay */
+static uint8_t *peer_cart_ram = NULL;
+static size_t peer_cart_ram_size = 0;
+
+/* Shades 0-3 of the frame being drawn, turned into fb when presenting */
+static uint8_t fb_shade[LCD_HEIGHT][LCD_WIDTH];
 
 /* Emulator state */
 typedef struct {
@@ -43,9 +70,84 @@ typedef struct {
     SDL_Texture *texture;
     bool running;
     bool paused;
+    bool vsync;                 // Let the display's vsync pace frames instead of the pacer
     uint32_t frame_count;
+    struct pacing_s pacing;     // Frame pacing and jitter statistics
+    double rate_hz;             // Rate given with --rate, i.e. 100% speed
+    struct osd_s osd;           // On-screen FPS / speed / frame-time overlay
+    uint16_t lut[4];            // XRGB1555 colours for shades 0-3
+    int palette_preset;         // Index into palette_presets, -1 for a custom palette
+    struct console_s console;   // Debugger commands from stdin or a socket
+    struct gdbstub_s gdb;       // GDB remote protocol server
+    struct netplay_s *net;      // Rollback netplay session, NULL when playing alone
+    struct gb_s *peer_gb;       // The other player's machine during netplay
+
+    // Input: keyboard and HAL state are merged into the joypad once per frame
+    uint8_t keys;               // Keyboard joypad bits (0 = pressed)
+    _Atomic uint8_t hal_keys;   // Joypad bits published by the HAL input thread
+    atomic_bool input_stop;     // Tells the input thread to exit
+    bool hal_input;             // Poll BeagleBone buttons/joystick on a thread
+    bool input_thread_running;
+    pthread_t input_thread;
+
+    // Real-time mode
+    rt_thread_config_t rt_emu;   // Emulation (main) thread
+    rt_thread_config_t rt_input; // HAL input thread
 } emulator_state_t;
 
+/**
+ * Print frame pacing jitter statistics
+ */
+void print_pacing_stats(emulator_state_t *emu) {
+    struct pacing_stats_s st;
+    pacing_get_stats(&emu->pacing, &st);
+
+    printf("Pacing: %llu frames, target %.3f ms, mean %.3f ms, stddev %.3f ms\n",
+           (unsigned long long)st.frames, st.target_ns / 1e6, st.mean_ns / 1e6, st.stddev_ns / 1e6);
+    printf("        min %.3f ms, max %.3f ms, worst wake-up %.3f ms late\n",
+           st.min_ns / 1e6, st.max_ns / 1e6, st.max_wake_late_ns / 1e6);
+    printf("        %llu late, %llu off by >1 ms, %llu resyncs\n",
+           (unsigned long long)st.late_frames, (unsigned long long)st.off_target,
+           (unsigned long long)st.resyncs);
+}
+
+/**
+ * Print core statistics and the average host time per phase
+ */
+void print_core_stats(emulator_state_t *emu) {
+    const struct gb_stats_s *s = &emu->gb->stats;
+    double frames = s->frames ? (double)s->frames : 1.0;
+
+    printf("Core:   %llu frames, %llu instructions, %llu cycles (%llu halted), %llu lines drawn\n",
+           (unsigned long long)s->frames, (unsigned long long)s->instructions,
+           (unsigned long long)s->cycles, (unsigned long long)s->halt_cycles,
+           (unsigned long long)s->lines_drawn);
+    printf("        host ms/frame: cpu %.3f, ppu %.3f, present %.3f, input %.3f\n",
+           s->cpu_ns / frames / 1e6, s->ppu_ns / frames / 1e6,
+           s->present_ns / frames / 1e6, s->input_ns / frames / 1e6);
+    if (s->bg_cache_hits + s->bg_cache_misses) {
+        printf("        bg cache: %llu line hits, %llu tile rows redrawn (%.1f%% hit rate)\n",
+               (unsigned long long)s->bg_cache_hits, (unsigned long long)s->bg_cache_misses,
+               100.0 * s->bg_cache_hits / (s->bg_cache_hits + s->bg_cache_misses));
+    }
+    printf("        overlay: %.1f fps, %.0f%% speed\n", emu->osd.fps, emu->osd.speed_pct);
+}
+
+/**
+ * Print rollback netplay statistics
+ */
+void print_netplay_stats(emulator_state_t *emu) {
+    const struct netplay_stats_s *s = &emu->net->stats;
+
+    printf("Netplay: frame %u, %llu stalls, %llu rollbacks (%llu frames re-run, longest %u = %.3f ms)\n",
+           emu->net->frame, (unsigned long long)s->stalls, (unsigned long long)s->rollbacks,
+           (unsigned long long)s->resim_frames, s->max_rollback, s->max_rollback_ns / 1e6);
+    printf("         packets %llu sent, %llu received, %llu dropped, %llu rejected; %llu hash checks, %llu desyncs\n",
+           (unsigned long long)s->packets_sent, (unsigned long long)s->packets_received,
+           (unsigned long long)s->packets_dropped, (unsigned long long)s->packets_rejected,
+           (unsigned long long)s->hashes_checked, (unsigned long long)s->desyncs);
+}
+
 /**
  * LCD draw line callback - called by PPU for each scanline
  * This matches Peanut-GB's lcd_draw_line signature
@@ -53,28 +155,231 @@ typedef struct {
 void lcd_draw_line(struct gb_s *gb, const uint8_t pixels[160], uint8_t line) {
     (void)gb; // Unused parameter
 
-    for (unsigned int x = 0; x < LCD_WIDTH; x++) {
-        // 2-bit DMG colour index 0–3 from PPU
-        uint8_t idx = pixels[x] & 0x03;
+    // Keep the indexed line; update_display() converts the whole frame
+    memcpy(fb_shade[line], pixels, LCD_WIDTH);
+}
+
+/**
+ * HAL input thread - polls the BeagleBone buttons and joystick
+ * and publishes the result as joypad bits for the emulation thread.
+ */
+void *input_thread_main(void *arg) {
+    emulator_state_t *emu = (emulator_state_t *)arg;
+    struct timespec next;
+
+    if (emu->rt_input.enabled) {
+        rt_prefault_stack(RT_STACK_PREFAULT);
+    }
+
+    trace_thread_name("input");
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    while (!atomic_load(&emu->input_stop)) {
+        TRACE_SCOPE("hal_poll");
+        buttons_state_t btn;
+        joystick_state_t joy;
+        uint8_t keys = 0xFF;
+
+        buttons_poll(&btn);
+        joystick_poll(&joy);
+
+        if (btn.a)     keys &= ~JOYPAD_A;
+        if (btn.b)     keys &= ~JOYPAD_B;
+        if (btn.start) keys &= ~JOYPAD_START;
+        if (joy.up)    keys &= ~JOYPAD_UP;
+        if (joy.down)  keys &= ~JOYPAD_DOWN;
+        if (joy.left)  keys &= ~JOYPAD_LEFT;
+        if (joy.right) keys &= ~JOYPAD_RIGHT;
+
+        atomic_store(&emu->hal_keys, keys);
+
+        /* Fixed-rate polling on absolute deadlines */
+        next.tv_nsec += INPUT_POLL_NS;
+        if (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+
+    return NULL;
+}
+
+/**
+ * Start the HAL input thread if any HAL input device is present
+ */
+bool start_input_thread(emulator_state_t *emu) {
+    bool have_buttons = buttons_init();
+    bool have_joystick = joystick_init();
+
+    if (!have_buttons && !have_joystick) {
+        printf("No HAL input devices found, keyboard only\n");
+        return false;
+    }
+
+    atomic_store(&emu->input_stop, false);
+    if (pthread_create(&emu->input_thread, NULL, input_thread_main, emu) != 0) {
+        fprintf(stderr, "Failed to start input thread\n");
+        buttons_shutdown();
+        joystick_shutdown();
+        return false;
+    }
+
+    emu->input_thread_running = true;
+    printf("✓ HAL input thread started (buttons: %s, joystick: %s)\n",
+           have_buttons ? "yes" : "no", have_joystick ? "yes" : "no");
+    return true;
+}
+
+/**
+ * Stop the HAL input thread and release the devices
+ */
+void stop_input_thread(emulator_state_t *emu) {
+    if (!emu->input_thread_running) return;
+
+    atomic_store(&emu->input_stop, true);
+    pthread_join(emu->input_thread, NULL);
+    emu->input_thread_running = false;
+
+    buttons_shutdown();
+    joystick_shutdown();
+}
+
+/**
+ * Apply real-time settings to the emulation and input threads
+ * and report which ones took effect.
+ */
+void apply_rt_mode(emulator_state_t *emu) {
+    uint32_t mem = rt_lock_memory();
+
+    /* Pre-fault everything the emulation loop touches (mlockall already
+     * does this when it succeeds, but without privileges it is still
+     * worth avoiding first-touch faults). */
+    rt_prefault(emu->gb, sizeof(*emu->gb));
+    rt_prefault(fb, sizeof(fb));
+    rt_prefault(fb_shade, sizeof(fb_shade));
+    bootloader_prefault();
+    if (emu->gb->itrace) {
+        rt_prefault(emu->gb->itrace->ring, (emu->gb->itrace->mask + 1) * sizeof(uint64_t));
+    }
+    rt_prefault_stack(RT_STACK_PREFAULT);
+
+    uint32_t emu_applied = rt_apply_thread(pthread_self(), &emu->rt_emu);
+
+    printf("rt: mlockall: %s, instance memory pre-faulted\n",
+           (mem & RT_MLOCK) ? "yes" : "NO (missing privileges?)");
+    rt_report("emulation", &emu->rt_emu, emu_applied);
+
+    if (emu->input_thread_running) {
+        uint32_t in_applied = rt_apply_thread(emu->input_thread, &emu->rt_input);
+        rt_report("input", &emu->rt_input, in_applied);
+    } else {
+        printf("rt: %-10s not running (keyboard input is handled on the emulation thread)\n", "input");
+    }
+}
+
+/* Cart RAM callbacks of the other player's machine */
+static uint8_t peer_cart_ram_read(struct gb_s *gb, uint32_t addr) {
+    (void)gb;
+    return addr < peer_cart_ram_size ? peer_cart_ram[addr] : 0xFF;
+}
+
+static void peer_cart_ram_write(struct gb_s *gb, uint32_t addr, uint8_t val) {
+    (void)gb;
+    if (addr < peer_cart_ram_size) {
+        peer_cart_ram[addr] = val;
+    }
+}
+
+/**
+ * Start a netplay session: spec is "<local port>:<peer host>:<peer port>"
+ *
+ * The other player's machine starts as a copy of ours, so both peers must
+ * load the same ROM with the same options. Latency and loss are injected
+ * on our outgoing packets, for testing.
+ */
+bool start_netplay(emulator_state_t *emu, const char *spec, int player,
+                   int delay, int latency_ms, int loss_pct) {
+    char port[16];
+    const char *sep = strchr(spec, ':');
+    if (!sep || (size_t)(sep - spec) >= sizeof(port)) {
+        fprintf(stderr, "--netplay wants <local port>:<peer host>:<peer port>\n");
+        return false;
+    }
+    memcpy(port, spec, (size_t)(sep - spec));
+    port[sep - spec] = '\0';
 
-        // 24-bit RGB from our DMG palette (0xRRGGBB) /
-        uint32_t rgb = palette[idx];
+    struct netplay_s *np = malloc(sizeof(*np));
+    struct gb_s *peer = malloc(sizeof(*peer));
+    size_t ram_size;
+    uint8_t *ram = bootloader_cart_ram(&ram_size);
+    if (!np || !peer || (ram_size && !(peer_cart_ram = malloc(ram_size)))) {
+        fprintf(stderr, "Netplay: out of memory\n");
+        free(np);
+        free(peer);
+        return false;
+    }
+
+    netplay_init(np);
+    np->delay = delay;
+    np->latency_ms = latency_ms;
+    np->loss_pct = loss_pct;
+    if (!netplay_connect(np, port, sep + 1)) {
+        free(np);
+        free(peer);
+        free(peer_cart_ram);
+        peer_cart_ram = NULL;
+        return false;
+    }
 
-        // Extract 8-bit components /
-        uint8_t r8 = (rgb >> 16) & 0xFF;
-        uint8_t g8 = (rgb >> 8)  & 0xFF;
-        uint8_t b8 =  rgb        & 0xFF;
+    /* Copy of our machine with its own cart RAM and no attachments */
+    state_clone(peer, emu->gb);
+    peer->gb_rom_read = emu->gb->gb_rom_read;
+    peer->gb_error = emu->gb->gb_error;
+    peer->gb_cart_ram_read = peer_cart_ram_read;
+    peer->gb_cart_ram_write = peer_cart_ram_write;
+    if (ram_size) {
+        memcpy(peer_cart_ram, ram, ram_size);
+        peer_cart_ram_size = ram_size;
+    }
 
-        // Convert 8-bit → 5-bit for XRGB1555 /
-        uint16_t r5 = r8 >> 3;   // keep top 5 bits /
-        uint16_t g5 = g8 >> 3;
-        uint16_t b5 = b8 >> 3;
+    struct gb_s *gb[2];
+    uint8_t *cart_ram[2];
+    gb[player] = emu->gb;
+    gb[!player] = peer;
+    cart_ram[player] = ram;
+    cart_ram[!player] = peer_cart_ram;
+    if (netplay_start(np, gb, cart_ram, ram_size, player) != 0) {
+        fprintf(stderr, "Netplay: out of memory\n");
+        netplay_close(np);
+        free(np);
+        free(peer);
+        return false;
+    }
 
-        // Pack into XRGB1555: x rrrrr ggggg bbbbb */
-        uint16_t pixel1555 = (uint16_t)((r5 << 10) | (g5 << 5) | b5);
+    emu->net = np;
+    emu->peer_gb = peer;
+    printf("✓ Netplay as player %d on port %s with %s (input delay %d frames)\n",
+           player + 1, port, sep + 1, np->delay);
+    return true;
+}
 
-        fb[line][x] = pixel1555;
+/**
+ * Halve or double the pacing rate, between 25% and 400% of --rate.
+ * The jitter statistics are cleared since they were measured against the old target.
+ */
+void change_speed(emulator_state_t *emu, bool faster) {
+    if (emu->net) {
+        printf("Speed changes are disabled during netplay\n");
+        return;
     }
+
+    double hz = emu->pacing.target_hz * (faster ? 2.0 : 0.5);
+    if (hz > emu->rate_hz * 4.0 || hz < emu->rate_hz * 0.25) return;
+
+    pacing_set_rate(&emu->pacing, hz);
+    pacing_clear_stats(&emu->pacing);
+    printf("Speed: %.0f%% (%.2f Hz)\n", 100.0 * hz / emu->rate_hz, hz);
 }
 
 /**
@@ -90,35 +395,31 @@ void handle_input(emulator_state_t *emu, SDL_Event *event) {
             switch (event->key.key) {
                 /* Game Boy D-Pad */
                 case SDLK_UP:
-                    emu->gb->direct.joypad_bits.up = 0;
-                    printf("DEBUG: UP pressed, joypad = 0x%02X\n", emu->gb->direct.joypad);
+                    emu->keys &= ~JOYPAD_UP;
                     break;
                 case SDLK_DOWN:
-                    emu->gb->direct.joypad_bits.down = 0;
-                    printf("DEBUG: DOWN pressed, joypad = 0x%02X\n", emu->gb->direct.joypad);
+                    emu->keys &= ~JOYPAD_DOWN;
                     break;
                 case SDLK_LEFT:
-                    emu->gb->direct.joypad_bits.left = 0;
-                    printf("DEBUG: LEFT pressed, joypad = 0x%02X\n", emu->gb->direct.joypad);
+                    emu->keys &= ~JOYPAD_LEFT;
                     break;
                 case SDLK_RIGHT:
-                    emu->gb->direct.joypad_bits.right = 0;
-                    printf("DEBUG: RIGHT pressed, joypad = 0x%02X\n", emu->gb->direct.joypad);
+                    emu->keys &= ~JOYPAD_RIGHT;
                     break;
                 
                 /* Game Boy Buttons */
                 case SDLK_Z:  /* A button */
-                    emu->gb->direct.joypad_bits.a = 0;
+                    emu->keys &= ~JOYPAD_A;
                     break;
                 case SDLK_X:  /* B button */
-                    emu->gb->direct.joypad_bits.b = 0;
+                    emu->keys &= ~JOYPAD_B;
                     break;
                 case SDLK_RETURN:  /* Start */
-                    emu->gb->direct.joypad_bits.start = 0;
+                    emu->keys &= ~JOYPAD_START;
                     break;
                 case SDLK_RSHIFT:  /* Select */
                 case SDLK_LSHIFT:
-                    emu->gb->direct.joypad_bits.select = 0;
+                    emu->keys &= ~JOYPAD_SELECT;
                     break;
                 
                 /* Emulator Controls */
@@ -128,14 +429,45 @@ void handle_input(emulator_state_t *emu, SDL_Event *event) {
                 case SDLK_SPACE:
                     emu->paused = !emu->paused;
                     printf("%s\n", emu->paused ? "⏸  Paused" : "▶  Resumed");
+                    /* Don't try to catch up on the frames missed while paused */
+                    if (!emu->paused) pacing_reset(&emu->pacing);
                     break;
                 case SDLK_R:
+                    if (emu->net) {
+                        printf("Reset is disabled during netplay\n");
+                        break;
+                    }
                     printf("Reset\n");
                     cpu_reset(emu->gb);
                     mmu_reset(emu->gb);
+                    /* mmu_reset() clears the page traps; keep the debugger's */
+                    if (emu->gb->debug) debug_update_traps(emu->gb);
                     break;
                 case SDLK_F:
                     printf("Frames: %u\n", emu->frame_count);
+                    print_pacing_stats(emu);
+                    print_core_stats(emu);
+                    if (emu->net) print_netplay_stats(emu);
+                    break;
+                case SDLK_MINUS:
+                case SDLK_EQUALS:
+                    change_speed(emu, event->key.key == SDLK_EQUALS);
+                    break;
+                case SDLK_O:
+                    emu->osd.enabled = !emu->osd.enabled;
+                    break;
+                case SDLK_P:
+                    /* Only the four-entry table changes, the frame is converted as usual */
+                    emu->palette_preset = (emu->palette_preset + 1) % palette_num_presets;
+                    palette_lut_1555(palette_presets[emu->palette_preset].rgb, emu->lut);
+                    printf("Palette: %s\n", palette_presets[emu->palette_preset].name);
+                    break;
+                case SDLK_T:
+                    if (itrace_write(emu->gb, ITRACE_FILE) == 0) {
+                        printf("Instruction trace written to %s\n", ITRACE_FILE);
+                    } else {
+                        fprintf(stderr, "Instruction trace not written (disabled with --no-itrace?)\n");
+                    }
                     break;
             }
             break;
@@ -144,31 +476,31 @@ void handle_input(emulator_state_t *emu, SDL_Event *event) {
             switch (event->key.key) {
                 /* Release D-Pad */
                 case SDLK_UP:
-                    emu->gb->direct.joypad_bits.up = 1;
+                    emu->keys |= JOYPAD_UP;
                     break;
                 case SDLK_DOWN:
-                    emu->gb->direct.joypad_bits.down = 1;
+                    emu->keys |= JOYPAD_DOWN;
                     break;
                 case SDLK_LEFT:
-                    emu->gb->direct.joypad_bits.left = 1;
+                    emu->keys |= JOYPAD_LEFT;
                     break;
                 case SDLK_RIGHT:
-                    emu->gb->direct.joypad_bits.right = 1;
+                    emu->keys |= JOYPAD_RIGHT;
                     break;
                 
                 /* Release Buttons */
                 case SDLK_Z:
-                    emu->gb->direct.joypad_bits.a = 1;
+                    emu->keys |= JOYPAD_A;
                     break;
                 case SDLK_X:
-                    emu->gb->direct.joypad_bits.b = 1;
+                    emu->keys |= JOYPAD_B;
                     break;
                 case SDLK_RETURN:
-                    emu->gb->direct.joypad_bits.start = 1;
+                    emu->keys |= JOYPAD_START;
                     break;
                 case SDLK_RSHIFT:
                 case SDLK_LSHIFT:
-                    emu->gb->direct.joypad_bits.select = 1;
+                    emu->keys |= JOYPAD_SELECT;
                     break;
             }
             break;
@@ -208,8 +540,11 @@ bool init_sdl(emulator_state_t *emu) {
         return false;
     }
     
-    /* Enable VSync for smooth 60 FPS */
-    SDL_SetRenderVSync(emu->renderer, 1);
+    /*
+     * Frames are paced by the pacing engine at the native 59.73 Hz, so vsync
+     * is off by default. With --vsync the display drives timing instead.
+     */
+    SDL_SetRenderVSync(emu->renderer, emu->vsync ? 1 : 0);
     
     /* Create texture for frame buffer */
     emu->texture = SDL_CreateTexture(
@@ -254,21 +589,42 @@ void cleanup_sdl(emulator_state_t *emu) {
  * Run one frame of emulation
  */
 void run_frame(emulator_state_t *emu) {
+    TRACE_SCOPE("run_frame");
+
+    /* Netplay runs both machines; a stall repeats the last frame */
+    if (emu->net) {
+        if (netplay_frame(emu->net, emu->keys & atomic_load(&emu->hal_keys))) {
+            emu->frame_count++;
+        }
+        return;
+    }
+
+    /* Merge keyboard and HAL input */
+    emu->gb->direct.joypad = emu->keys & atomic_load(&emu->hal_keys);
+
     /* Reset frame flag */
     emu->gb->gb_frame = 0;
     
-    /* Execute CPU until frame is complete */
-    while (!emu->gb->gb_frame) {
+    /* Execute CPU until frame is complete or the debugger stops it */
+    while (!emu->gb->gb_frame && !emu->gb->gb_break) {
         cpu_step(emu->gb);
     }
     
-    emu->frame_count++;
+    if (emu->gb->gb_frame) emu->frame_count++;
 }
 
 /**
  * Update display with current frame buffer
  */
 void update_display(emulator_state_t *emu) {
+    TRACE_SCOPE("update_display");
+
+    /* Indexed frame to host colours in one pass */
+    palette_convert(&fb_shade[0][0], &fb[0][0], LCD_WIDTH * LCD_HEIGHT, emu->lut);
+
+    /* Performance overlay is drawn over the finished frame */
+    osd_draw(&emu->osd, fb);
+
     /* Clear renderer */
     SDL_RenderClear(emu->renderer);
     
@@ -298,28 +654,73 @@ void emulator_loop(emulator_state_t *emu) {
     printf("  Shift = Select\n");
     printf("  Space = Pause\n");
     printf("  R = Reset\n");
-    printf("  F = Show frame count\n");
+    printf("  F = Show frame count and stats\n");
+    printf("  - / = = Halve / double emulation speed\n");
+    printf("  O = Toggle performance overlay\n");
+    printf("  P = Next palette\n");
+    printf("  T = Write last %d instructions to %s\n", ITRACE_DEFAULT_ENTRIES, ITRACE_FILE);
     printf("  ESC = Quit\n\n");
     
+    pacing_reset(&emu->pacing);
+
     while (emu->running) {
+        struct gb_stats_s *stats = &emu->gb->stats;
+        int64_t t_start = pacing_now_ns();
+
         /* Handle all pending events */
-        while (SDL_PollEvent(&event)) {
-            handle_input(emu, &event);
+        {
+            TRACE_SCOPE("input");
+            while (SDL_PollEvent(&event)) {
+                handle_input(emu, &event);
+            }
         }
         
-        /* Run emulation if not paused */
-        if (!emu->paused) {
-            run_frame(emu);
-            update_display(emu);
+        /* Debugger commands run here, between frames */
+        if (emu->console.running) {
+            console_poll(&emu->console, emu->gb);
         }
-        
-        /* Small delay if paused to reduce CPU usage */
-        if (emu->paused) {
-            SDL_Delay(16);  /* ~60 FPS */
+        if (gdbstub_active(&emu->gdb)) {
+            gdbstub_poll(&emu->gdb, emu->gb);
+        }
+
+        /* Block until the next event while paused or stopped in the debugger
+           instead of polling (waking up regularly for debugger commands) */
+        if (emu->paused || emu->gb->gb_break) {
+            bool remote = emu->console.running || gdbstub_active(&emu->gdb);
+            bool got = remote ? SDL_WaitEventTimeout(&event, CONSOLE_POLL_MS)
+                              : SDL_WaitEvent(&event);
+            if (got) {
+                handle_input(emu, &event);
+            }
+            /* Don't try to catch up on the frames missed while stopped */
+            if (emu->gb->gb_break) pacing_reset(&emu->pacing);
+            continue;
         }
+
+        int64_t t_input = pacing_now_ns();
+        uint64_t ppu_before = stats->ppu_ns;
+
+        run_frame(emu);
+
+        int64_t t_cpu = pacing_now_ns();
+
+        update_display(emu);
+
+        int64_t t_present = pacing_now_ns();
+
+        /* Per-phase host time; PPU time is measured inside the core */
+        stats->input_ns += (uint64_t)(t_input - t_start);
+        stats->cpu_ns += (uint64_t)(t_cpu - t_input) - (stats->ppu_ns - ppu_before);
+        stats->present_ns += (uint64_t)(t_present - t_cpu);
+        osd_frame(&emu->osd, stats, t_present, t_present - t_start);
+
+        /* Sleep until this frame's deadline (only records stats with --vsync) */
+        pacing_wait(&emu->pacing);
     }
     
     printf("\nTotal frames rendered: %u\n", emu->frame_count);
+    print_pacing_stats(emu);
+    print_core_stats(emu);
 }
 
 /**
@@ -332,17 +733,119 @@ int main(int argc, char **argv) {
     
     /* Check command line arguments */
     if (argc < 2) {
-        fprintf(stderr, "Usage: %s <rom_file.gb>\n", argv[0]);
+        fprintf(stderr, "Usage: %s <rom_file.gb> [--rate <hz>] [--vsync] [--hal] [--osd] [--trace <file>]\n"
+                        "          [--palette <gray|green|pocket|RRGGBB,RRGGBB,RRGGBB,RRGGBB>]\n"
+                        "          [--no-itrace] [--rt] [--rt-prio <1-99>] [--emu-cpu <n>] [--input-cpu <n>]\n"
+                        "          [--console] [--console-socket <path>] [--gdb <port|path>]\n"
+                        "          [--netplay <port>:<host>:<port>] [--player <1|2>] [--input-delay <frames>]\n"
+                        "          [--net-latency <ms>] [--net-loss <pct>]\n", argv[0]);
         return 1;
     }
     
     char *rom_path = argv[1];
+    const char *trace_path = NULL;
+    bool use_itrace = true;
+    bool use_console = false;
+    const char *console_socket = NULL;
+    const char *gdb_where = NULL;
+    const char *netplay_spec = NULL;
+    int netplay_player = 0;
+    int netplay_delay = NETPLAY_DEFAULT_DELAY;
+    int net_latency_ms = 0;
+    int net_loss_pct = 0;
+    double rate_hz = PACING_DMG_HZ;
+    uint32_t palette_rgb[4];
     
     /* Initialize emulator state */
     emulator_state_t emu = {0};
     emu.running = true;
     emu.paused = false;
     emu.frame_count = 0;
+    emu.keys = 0xFF;
+    atomic_init(&emu.hal_keys, 0xFF);
+    atomic_init(&emu.input_stop, false);
+    emu.rt_emu = (rt_thread_config_t){ .enabled = false, .priority = RT_DEFAULT_PRIO, .cpu = -1 };
+    emu.rt_input = (rt_thread_config_t){ .enabled = false, .priority = RT_DEFAULT_PRIO + 1, .cpu = -1 };
+    osd_init(&emu.osd, false);
+    memcpy(palette_rgb, palette_presets[0].rgb, sizeof(palette_rgb));
+    gdbstub_init(&emu.gdb);
+
+    /* Optional arguments after the ROM path */
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            rate_hz = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--vsync") == 0) {
+            emu.vsync = true;
+        } else if (strcmp(argv[i], "--hal") == 0) {
+            emu.hal_input = true;
+        } else if (strcmp(argv[i], "--osd") == 0) {
+            emu.osd.enabled = true;
+        } else if (strcmp(argv[i], "--palette") == 0 && i + 1 < argc) {
+            if (palette_parse(argv[++i], palette_rgb) != 0) {
+                fprintf(stderr, "Unknown palette: %s\n", argv[i]);
+                return 1;
+            }
+            emu.palette_preset = -1;
+            for (int p = 0; p < palette_num_presets; p++) {
+                if (memcmp(palette_rgb, palette_presets[p].rgb, sizeof(palette_rgb)) == 0) emu.palette_preset = p;
+            }
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (strcmp(argv[i], "--no-itrace") == 0) {
+            use_itrace = false;
+        } else if (strcmp(argv[i], "--console") == 0) {
+            use_console = true;
+        } else if (strcmp(argv[i], "--console-socket") == 0 && i + 1 < argc) {
+            use_console = true;
+            console_socket = argv[++i];
+        } else if (strcmp(argv[i], "--gdb") == 0 && i + 1 < argc) {
+            gdb_where = argv[++i];
+        } else if (strcmp(argv[i], "--netplay") == 0 && i + 1 < argc) {
+            netplay_spec = argv[++i];
+        } else if (strcmp(argv[i], "--player") == 0 && i + 1 < argc) {
+            netplay_player = atoi(argv[++i]) == 2 ? 1 : 0;
+        } else if (strcmp(argv[i], "--input-delay") == 0 && i + 1 < argc) {
+            netplay_delay = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--net-latency") == 0 && i + 1 < argc) {
+            net_latency_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--net-loss") == 0 && i + 1 < argc) {
+            net_loss_pct = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--rt") == 0) {
+            emu.rt_emu.enabled = true;
+            emu.rt_input.enabled = true;
+        } else if (strcmp(argv[i], "--rt-prio") == 0 && i + 1 < argc) {
+            /* Input thread runs just above emulation so polling isn't starved */
+            emu.rt_emu.priority = atoi(argv[++i]);
+            emu.rt_input.priority = emu.rt_emu.priority + 1;
+        } else if (strcmp(argv[i], "--emu-cpu") == 0 && i + 1 < argc) {
+            emu.rt_emu.cpu = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--input-cpu") == 0 && i + 1 < argc) {
+            emu.rt_input.cpu = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (netplay_delay < 0 || netplay_delay > NETPLAY_MAX_ROLLBACK) {
+        fprintf(stderr, "--input-delay must be 0-%d frames\n", NETPLAY_MAX_ROLLBACK);
+        return 1;
+    }
+
+    pacing_init(&emu.pacing, rate_hz);
+    emu.rate_hz = emu.pacing.target_hz;
+    palette_lut_1555(palette_rgb, emu.lut);
+    emu.pacing.enabled = !emu.vsync;
+
+    /* Optional Chrome trace (only available in -DGBE_TRACE=ON builds) */
+    if (trace_path) {
+        if (trace_init(trace_path)) {
+            trace_thread_name("emulation");
+            printf("✓ Tracing to %s\n", trace_path);
+        } else {
+            fprintf(stderr, "Tracing not started (needs a -DGBE_TRACE=ON build and a writable file)\n");
+        }
+    }
     
     /* Initialize SDL */
     if (!init_sdl(&emu)) {
@@ -364,16 +867,51 @@ int main(int argc, char **argv) {
     // emu.gb->hram_io[IO_LCDC] = 0x91;  /* LCD on, BG on, window off, tiles 0x8000, BG map 0x9C00 */
     // emu.gb->hram_io[IO_STAT] = (emu.gb->hram_io[IO_STAT] & ~STAT_MODE) | LCD_MODE_OAM_SCAN;
     // emu.gb->hram_io[IO_LY] = 0;
-    // emu.gb->counter.lcd_count = 0;
+    // emu.gb->counter.line_start = emu.gb->counter.cycles;
     
     /* Set up LCD draw callback */
     emu.gb->display.lcd_draw_line = lcd_draw_line;
+    gpu_bg_cache_attach(emu.gb, &bg_cache);
     
     /* Initialize joypad to "all buttons released" state */
     emu.gb->direct.joypad = 0xFF;
+
+    /* Always-on instruction trace, dumped on emulator errors and by the T key */
+    if (use_itrace && itrace_init(emu.gb, ITRACE_DEFAULT_ENTRIES) != 0) {
+        fprintf(stderr, "Instruction trace disabled (out of memory)\n");
+    }
+
+    /* Optional debugger: breakpoints/watchpoints driven from a console */
+    if (use_console && (debug_init(emu.gb) != 0 || !console_start(&emu.console, console_socket))) {
+        fprintf(stderr, "Debugger console not started\n");
+        debug_free(emu.gb);
+    }
+
+    /* Optional GDB server; costs one poll() per frame until a client connects */
+    if (gdb_where) {
+        if (gdbstub_listen(&emu.gdb, gdb_where)) {
+            printf("✓ GDB server on %s (target remote %s%s)\n", gdb_where,
+                   strspn(gdb_where, "0123456789") == strlen(gdb_where) ? "localhost:" : "", gdb_where);
+        } else {
+            fprintf(stderr, "GDB server not started\n");
+        }
+    }
+
+    /* Optional BeagleBone button/joystick input on its own thread */
+    if (emu.hal_input) {
+        start_input_thread(&emu);
+    }
+
+    /* Optional real-time scheduling */
+    if (emu.rt_emu.enabled) {
+        apply_rt_mode(&emu);
+    }
     
     // Initialize frame debug counter
     emu.gb->frame_debug = 0;
+
+    /* Per-line PPU timing costs two clock reads per scanline */
+    emu.gb->stats.time_ppu = true;
     
     printf("✓ ROM loaded successfully\n");
 
@@ -382,12 +920,30 @@ int main(int argc, char **argv) {
         run_frame(&emu);
     }
     printf("Initial frames complete, starting display...\n");
+
+    /* Netplay starts from this state on both sides */
+    if (netplay_spec && !start_netplay(&emu, netplay_spec, netplay_player,
+                                       netplay_delay, net_latency_ms, net_loss_pct)) {
+        fprintf(stderr, "Netplay not started, playing alone\n");
+    }
     
     /* Run main emulation loop */
     emulator_loop(&emu);
     
     /* Cleanup */
     printf("\nCleaning up...\n");
+    stop_input_thread(&emu);
+    console_stop(&emu.console);
+    gdbstub_close(&emu.gdb, emu.gb);
+    if (emu.net) {
+        netplay_close(emu.net);
+        free(emu.net);
+        free(emu.peer_gb);
+        free(peer_cart_ram);
+    }
+    trace_shutdown();
+    debug_free(emu.gb);
+    itrace_free(emu.gb);
     free(emu.gb);
     bootloader_cleanup();
     cleanup_sdl(&emu);
@@ -7,19 +7,223 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "memory.h"
 #include "gb_types.h"
+#include "cpu.h"
+#include "debug.h"
+#include "serial.h"
+#include "timers.h"
+#include "gpu.h"
+#include "trace.h"
 
 /* External framebuffer from main.c */
 extern uint16_t fb[144][160];
 
 
+// ----------------------------------
+// Page Table
+// ----------------------------------
+
+void mmu_remap(struct gb_s *gb) {
+    struct mmu_map_s *map = &gb->mmu;
+
+    memset(map->rd, 0, sizeof(map->rd));
+    memset(map->wr, 0, sizeof(map->wr));
+
+    /* Plain memory: VRAM, WRAM and its echo (the echo's last page, 0xFDxx, is
+       still WRAM; 0xFExx mixes OAM and the unusable area) */
+    for (uint32_t page = 0x80; page < 0xA0; page++) {
+        uint8_t *vram = &gb->vram[(page - 0x80) << MMU_PAGE_SHIFT];
+        map->rd[page] = vram;
+        /* The background cache needs to see VRAM writes */
+        if (!gb->display.bg_cache) map->wr[page] = vram;
+    }
+    for (uint32_t page = 0xC0; page < 0xFE; page++) {
+        uint32_t wp = (page - 0xC0) % (WRAM_SIZE >> MMU_PAGE_SHIFT);
+        if (map->shared[wp]) {
+            map->rd[page] = map->shared[wp];    /* First write copies it in */
+        } else {
+            map->rd[page] = map->wr[page] = &gb->wram[wp << MMU_PAGE_SHIFT];
+        }
+    }
+
+    /* Trapped pages go through the slow path so the debugger sees them */
+    for (uint32_t page = 0; page < MMU_NUM_PAGES; page++) {
+        if (map->trap[page] & MMU_TRAP_READ) map->rd[page] = NULL;
+        if (map->trap[page] & MMU_TRAP_WRITE) map->wr[page] = NULL;
+    }
+}
+
+
+// ----------------------------------
+// Dirty Pages
+// ----------------------------------
+
+static inline void mark_dirty(struct gb_s *gb, uint16_t addr) {
+    gb->mmu.dirty[addr >> 14] |= 1ULL << ((addr >> MMU_PAGE_SHIFT) & 63);
+}
+
+void mmu_dirty(const struct gb_s *gb, struct mmu_dirty_s *out) {
+    const uint64_t *d = gb->mmu.dirty;
+    uint64_t top = d[3];    /* $C0-$FF */
+
+    out->page[0] = 0;                               /* ROM */
+    out->page[1] = 0;
+    out->page[2] = d[2] & 0xFFFFFFFFULL;            /* VRAM; cart RAM is in cram[] */
+    out->page[3] = (top & 0xFFFFFFFFULL) |          /* WRAM */
+                   ((top >> 32) & 0x3FFFFFFFULL) |  /* Echo $E0-$FD onto $C0-$DD */
+                   (top & (1ULL << 62)) |           /* OAM */
+                   (1ULL << 63);                    /* HRAM/I/O: timers and PPU too */
+    memcpy(out->cram, gb->mmu.dirty_cram, sizeof(out->cram));
+}
+
+void mmu_dirty_clear(struct gb_s *gb) {
+    memset(gb->mmu.dirty, 0, sizeof(gb->mmu.dirty));
+    memset(gb->mmu.dirty_cram, 0, sizeof(gb->mmu.dirty_cram));
+}
+
+void mmu_dirty_all(struct gb_s *gb) {
+    memset(gb->mmu.dirty, 0xFF, sizeof(gb->mmu.dirty));
+    memset(gb->mmu.dirty_cram, 0xFF, sizeof(gb->mmu.dirty_cram));
+    gpu_bg_invalidate(gb);
+}
+
+
+// ----------------------------------
+// Copy-on-Write Work RAM
+// ----------------------------------
+
+void mmu_share_wram(struct gb_s *gb, const uint8_t *wram) {
+    for (int wp = 0; wp < WRAM_SIZE >> MMU_PAGE_SHIFT; wp++) {
+        gb->mmu.shared[wp] = &wram[wp << MMU_PAGE_SHIFT];
+    }
+    mmu_remap(gb);
+}
+
+/* Take ownership of a shared page before its first write */
+static void unshare_page(struct gb_s *gb, int wp) {
+    memcpy(&gb->wram[wp << MMU_PAGE_SHIFT], gb->mmu.shared[wp], 1 << MMU_PAGE_SHIFT);
+    gb->mmu.shared[wp] = NULL;
+
+    /* The page and its echo, unless a watchpoint keeps them on the slow path */
+    for (uint32_t page = 0xC0 + wp; page < 0xFE; page += WRAM_SIZE >> MMU_PAGE_SHIFT) {
+        gb->mmu.rd[page] = (gb->mmu.trap[page] & MMU_TRAP_READ) ? NULL : &gb->wram[wp << MMU_PAGE_SHIFT];
+        gb->mmu.wr[page] = (gb->mmu.trap[page] & MMU_TRAP_WRITE) ? NULL : &gb->wram[wp << MMU_PAGE_SHIFT];
+    }
+}
+
+void mmu_unshare_wram(struct gb_s *gb) {
+    for (int wp = 0; wp < WRAM_SIZE >> MMU_PAGE_SHIFT; wp++) {
+        if (gb->mmu.shared[wp]) unshare_page(gb, wp);
+    }
+}
+
+int mmu_wram_shared(const struct gb_s *gb) {
+    int n = 0;
+    for (int wp = 0; wp < WRAM_SIZE >> MMU_PAGE_SHIFT; wp++) {
+        if (gb->mmu.shared[wp]) n++;
+    }
+    return n;
+}
+
+
+// ----------------------------------
+// I/O Registers
+// ----------------------------------
+
+// The JOYP register is a 2×4 matrix:
+//   Bits 4–5 select which half (d‑pad vs buttons) the game wants.
+//   Bits 0–3 return the state of that half (0 = pressed, 1 = released).
+//   If neither bit 4 nor bit 5 is cleared (i.e., both are 1), the game hasn’t selected anything;
+//     conceptually, “no keys are being scanned” and you typically return all 1s (no key pressed).
+static uint8_t read_joyp(const struct gb_s *gb) {
+    uint8_t joyp = gb->hram_io[IO_JOYP];
+    uint8_t result = joyp | 0x0F;  // Start with low nibble = 1111 (all released)
+
+    /* If direction keys selected (bit 4 = 0) */
+    if ((joyp & 0x10) == 0) {
+        // AND with direction bits (right, left, up, down)
+        result &= (gb->direct.joypad >> 4) | 0xF0;
+    }
+    /* If button keys selected (bit 5 = 0) */
+    else if ((joyp & 0x20) == 0) {
+        // AND with button bits (a, b, select, start)
+        result &= gb->direct.joypad | 0xF0;
+    }
+
+    return result;
+}
+
+/* Only bits 4 and 5 are writable */
+static void write_joyp(struct gb_s *gb, uint8_t val) {
+    gb->hram_io[IO_JOYP] = (val & 0x30) | 0xC0;
+}
+
+/* Upper 3 bits always read as 1 */
+static void write_if(struct gb_s *gb, uint8_t val) {
+    gb->hram_io[IO_IF] = val | 0xE0;
+    cpu_irq_update(gb);
+}
+
+static void write_dma(struct gb_s *gb, uint8_t val) {
+    gb->hram_io[IO_DMA] = val;
+    mmu_dma_transfer(gb, val);
+}
+
+/* Registers with side effects or derived values; the rest are plain storage */
+static const mmu_io_read_fn io_read_fn[MMU_IO_REGS] = {
+    [IO_JOYP]   = read_joyp,
+    /* Timers */
+    [IO_DIV]    = timers_read_div,
+    /* PPU */
+    [IO_STAT]   = gpu_read_stat,
+    [IO_LY]     = gpu_read_ly,
+};
+
+static const mmu_io_write_fn io_write_fn[MMU_IO_REGS] = {
+    [IO_JOYP]   = write_joyp,
+    [IO_IF]     = write_if,
+    [IO_DMA]    = write_dma,
+    /* Serial */
+    [IO_SC]     = serial_write_sc,
+    /* Timers */
+    [IO_DIV]    = timers_write_div,
+    /* PPU */
+    [IO_LCDC]   = gpu_write_lcdc,
+    [IO_STAT]   = gpu_write_stat,
+    [IO_LY]     = gpu_write_ly,
+    [IO_WY]     = gpu_write_wy,
+    [IO_BGP]    = gpu_write_bgp,
+    [IO_OBP0]   = gpu_write_obp0,
+    [IO_OBP1]   = gpu_write_obp1,
+};
+
+static inline uint8_t io_read(struct gb_s *gb, uint8_t reg) {
+    if (reg < MMU_IO_REGS && io_read_fn[reg]) {
+        return io_read_fn[reg](gb);
+    }
+    return gb->hram_io[reg];
+}
+
+static inline void io_write(struct gb_s *gb, uint8_t reg, uint8_t val) {
+    if (reg < MMU_IO_REGS && io_write_fn[reg]) {
+        io_write_fn[reg](gb, val);
+        return;
+    }
+    gb->hram_io[reg] = val;
+    if (reg == IO_IE) {
+        cpu_irq_update(gb);
+    }
+}
+
+
 // ----------------------------------
 // Memory Read Function
 // ----------------------------------
 
-uint8_t mmu_read(struct gb_s *gb, uint16_t addr) {
+static uint8_t mmu_read_slow(struct gb_s *gb, uint16_t addr) {
     /* ROM Bank 0 (0x0000 - 0x3FFF) - Always mapped */
     if (addr < 0x4000) {
         return gb->gb_rom_read(gb, addr);
@@ -65,14 +269,9 @@ uint8_t mmu_read(struct gb_s *gb, uint16_t addr) {
         return gb->gb_cart_ram_read(gb, ram_offset);
     }
     
-    /* Work RAM (0xC000 - 0xDFFF) */
-    else if (addr < 0xE000) {
-        return gb->wram[addr - 0xC000];
-    }
-    
-    /* Echo RAM (0xE000 - 0xFDFF) - Mirror of WRAM */
+    /* Work RAM (0xC000 - 0xDFFF) and its echo (0xE000 - 0xFDFF) */
     else if (addr < 0xFE00) {
-        return gb->wram[addr - 0xE000];
+        return mmu_wram_page(gb, (addr >> MMU_PAGE_SHIFT) & 0x1F)[addr & 0xFF];
     }
     
     /* Object Attribute Memory (0xFE00 - 0xFE9F) - Sprite data */
@@ -85,44 +284,36 @@ uint8_t mmu_read(struct gb_s *gb, uint16_t addr) {
         return 0xFF;
     }
     
-    // I/O Registers and High RAM (0xFF00 - 0xFFFF)
-    // Effectively the "no row selected" case for JOYP
-    // The JOYP register is a 2×4 matrix:
-    //   Bits 4–5 select which half (d‑pad vs buttons) the game wants.
-    //   Bits 0–3 return the state of that half (0 = pressed, 1 = released).
-    //   If neither bit 4 nor bit 5 is cleared (i.e., both are 1), the game hasn’t selected anything; 
-    //     conceptually, “no keys are being scanned” and you typically return all 1s (no key pressed).
+    /* I/O Registers and High RAM (0xFF00 - 0xFFFF) */
     else {
-        /* Special handling for joypad register */
-        if (addr == 0xFF00) {
-            uint8_t joyp = gb->hram_io[IO_JOYP];
-            uint8_t result = joyp | 0x0F;  // Start with low nibble = 1111 (all released)
-            
-            /* If direction keys selected (bit 4 = 0) */
-            if ((joyp & 0x10) == 0) {
-                // AND with direction bits (right, left, up, down)
-                result &= (gb->direct.joypad >> 4) | 0xF0;
-            }
-            /* If button keys selected (bit 5 = 0) */
-            else if ((joyp & 0x20) == 0) {
-                // AND with button bits (a, b, select, start)
-                result &= gb->direct.joypad | 0xF0;
-            }
-            
-            return result;
-        }
-        
-        /* All other I/O and HRAM */
-        return gb->hram_io[addr - 0xFF00];
+        return io_read(gb, addr - 0xFF00);
     }
 }
 
+uint8_t mmu_read(struct gb_s *gb, uint16_t addr) {
+    const uint8_t *page = gb->mmu.rd[addr >> MMU_PAGE_SHIFT];
+    if (page) {
+        return page[addr & 0xFF];
+    }
+
+    uint8_t val = mmu_read_slow(gb, addr);
+    if (gb->mmu.trap[addr >> MMU_PAGE_SHIFT] & MMU_TRAP_READ) {
+        debug_watch_hit(gb, addr, val, false);
+    }
+    return val;
+}
+
+uint8_t mmu_peek(struct gb_s *gb, uint16_t addr) {
+    const uint8_t *page = gb->mmu.rd[addr >> MMU_PAGE_SHIFT];
+    return page ? page[addr & 0xFF] : mmu_read_slow(gb, addr);
+}
+
 
 // ----------------------------------
 // Memory Write Function
 // ----------------------------------
 
-void mmu_write(struct gb_s *gb, uint16_t addr, uint8_t val) {
+static void mmu_write_slow(struct gb_s *gb, uint16_t addr, uint8_t val) {
     /* ROM area (0x0000 - 0x7FFF) - MBC banking control */
     if (addr < 0x8000) {
         /* Only handle MBC1 for MVP */
@@ -163,6 +354,7 @@ void mmu_write(struct gb_s *gb, uint16_t addr, uint8_t val) {
     /* Video RAM (0x8000 - 0x9FFF) */
     else if (addr < 0xA000) {
         gb->vram[addr - 0x8000] = val;
+        gb->display.vram_dirty |= 1u << ((addr >> MMU_PAGE_SHIFT) & 0x1F);
     }
     
     /* External RAM (0xA000 - 0xBFFF) */
@@ -183,17 +375,17 @@ void mmu_write(struct gb_s *gb, uint16_t addr, uint8_t val) {
             }
         }
         
+        gb->mmu.dirty_cram[ram_offset >> 14] |= 1ULL << ((ram_offset >> MMU_PAGE_SHIFT) & 63);
         gb->gb_cart_ram_write(gb, ram_offset, val);
     }
     
-    /* Work RAM (0xC000 - 0xDFFF) */
-    else if (addr < 0xE000) {
-        gb->wram[addr - 0xC000] = val;
-    }
-    
-    /* Echo RAM (0xE000 - 0xFDFF) - Mirror of WRAM */
+    /* Work RAM (0xC000 - 0xDFFF) and its echo (0xE000 - 0xFDFF) */
     else if (addr < 0xFE00) {
-        gb->wram[addr - 0xE000] = val;
+        int wp = (addr >> MMU_PAGE_SHIFT) & 0x1F;
+        if (gb->mmu.shared[wp]) {
+            unshare_page(gb, wp);
+        }
+        gb->wram[(wp << MMU_PAGE_SHIFT) | (addr & 0xFF)] = val;
     }
     
     /* Object Attribute Memory (0xFE00 - 0xFE9F) */
@@ -208,115 +400,40 @@ void mmu_write(struct gb_s *gb, uint16_t addr, uint8_t val) {
     
     /* I/O Registers and High RAM (0xFF00 - 0xFFFF) */
     else {
-        /* Handle special I/O registers */
-        uint8_t io_offset = addr - 0xFF00;
-        
-        switch (io_offset) {
-            case IO_JOYP: /* Joypad (0xFF00) */
-                /* Only bits 4 and 5 are writable */
-                gb->hram_io[IO_JOYP] = (val & 0x30) | 0xC0;
-                break;
-            
-            case IO_DIV: /* Divider Register (0xFF04) */
-                /* Writing any value resets DIV to 0 */
-                gb->hram_io[IO_DIV] = 0;
-                gb->counter.div_count = 0;
-                break;
-            
-            case IO_DMA: /* DMA Transfer (0xFF46) */
-                gb->hram_io[IO_DMA] = val;
-                mmu_dma_transfer(gb, val);
-                break;
-            
-            case IO_BGP: /* Background Palette (0xFF47) */
-                gb->hram_io[IO_BGP] = val;
-                /* Update palette data */
-                gb->display.bg_palette[0] = (val >> 0) & 0x03;
-                gb->display.bg_palette[1] = (val >> 2) & 0x03;
-                gb->display.bg_palette[2] = (val >> 4) & 0x03;
-                gb->display.bg_palette[3] = (val >> 6) & 0x03;
-                break;
-            
-            case IO_OBP0: /* Object Palette 0 (0xFF48) */
-                gb->hram_io[IO_OBP0] = val;
-                /* Update palette data */
-                gb->display.sp_palette[0] = (val >> 0) & 0x03;
-                gb->display.sp_palette[1] = (val >> 2) & 0x03;
-                gb->display.sp_palette[2] = (val >> 4) & 0x03;
-                gb->display.sp_palette[3] = (val >> 6) & 0x03;
-                break;
-            
-            case IO_OBP1: /* Object Palette 1 (0xFF49) */
-                gb->hram_io[IO_OBP1] = val;
-                /* Update palette data */
-                gb->display.sp_palette[4] = (val >> 0) & 0x03;
-                gb->display.sp_palette[5] = (val >> 2) & 0x03;
-                gb->display.sp_palette[6] = (val >> 4) & 0x03;
-                gb->display.sp_palette[7] = (val >> 6) & 0x03;
-                break;
-            
-            case IO_LCDC: /* LCD Control (0xFF40) */
-            {
-                uint8_t old = gb->hram_io[IO_LCDC];
-                uint8_t lcd_was_on = old & LCDC_ENABLE;
-                gb->hram_io[IO_LCDC] = val;
-                uint8_t lcd_is_now_on = val & LCDC_ENABLE;
-                
-                if (!lcd_was_on && lcd_is_now_on) {
-                    gb->lcd_blank = true;
-                    gb->hram_io[IO_STAT] = (gb->hram_io[IO_STAT] & ~STAT_MODE) | LCD_MODE_OAM_SCAN;
-                    gb->hram_io[IO_LY] = 0;
-                    gb->counter.lcd_count = 0;
-                }
-                else if (lcd_was_on && !lcd_is_now_on) {
-                    gb->hram_io[IO_STAT] = (gb->hram_io[IO_STAT] & ~STAT_MODE) | LCD_MODE_HBLANK;
-                    gb->hram_io[IO_LY] = 0;
-                    gb->counter.lcd_count = 0;
-                }
-                break;
-            }
-            
-            case IO_STAT: /* LCD Status (0xFF41) */
-                /* Only bits 3-6 are writable, bits 0-2 are read-only */
-                gb->hram_io[IO_STAT] = (val & 0x78) | (gb->hram_io[IO_STAT] & 0x07) | 0x80;
-                break;
-            
-            case IO_LY: /* LY is read-only, ignore writes */
-                break;
-            
-            case IO_IF: /* Interrupt Flags (0xFF0F) */
-                /* Upper 3 bits always read as 1 */
-                gb->hram_io[IO_IF] = val | 0xE0;
-                break;
-            
-            case IO_IE: /* Interrupt Enable (0xFF) */
-                gb->hram_io[IO_IE] = val;
-                break;
-
-            case IO_SCY: /* Scroll Y (0xFF42) */
-                gb->hram_io[IO_SCY] = val;
-                break;
-
-            case IO_SCX: /* Scroll X (0xFF43) */
-                gb->hram_io[IO_SCX] = val;
-                break;
+        io_write(gb, addr - 0xFF00, val);
+    }
+}
 
-            /* Also ensure you have these while you're here */
-            case IO_WX: /* Window X (0xFF4B) */
-                gb->hram_io[IO_WX] = val;
-                break;
+void mmu_write(struct gb_s *gb, uint16_t addr, uint8_t val) {
+    uint8_t *page = gb->mmu.wr[addr >> MMU_PAGE_SHIFT];
+    mark_dirty(gb, addr);
+    if (page) {
+        page[addr & 0xFF] = val;
+        return;
+    }
 
-            case IO_WY: /* Window Y (0xFF4A) */
-                gb->display.WY = val;  /* Store wherever your PPU reads WY from */
-                break;
+    if (gb->mmu.trap[addr >> MMU_PAGE_SHIFT] & MMU_TRAP_WRITE) {
+        debug_watch_hit(gb, addr, val, true);
+    }
+    mmu_write_slow(gb, addr, val);
+}
 
-            
-            default:
-                /* All other I/O registers and HRAM */
-                gb->hram_io[io_offset] = val;
-                break;
-        }
+void mmu_poke(struct gb_s *gb, uint16_t addr, uint8_t val) {
+    if (addr < 0x8000) {
+        return;     /* Would be an MBC command */
+    }
+    mark_dirty(gb, addr);
+    if (addr == 0xFF04) {
+        timers_set_div(gb, val);
+        return;
     }
+    if (addr >= 0xFF00) {
+        gb->hram_io[addr - 0xFF00] = val;
+        cpu_irq_update(gb);     /* In case it was IF or IE */
+        return;
+    }
+    /* RAM, VRAM and OAM writes have no side effects */
+    mmu_write_slow(gb, addr, val);
 }
 
 
@@ -325,12 +442,14 @@ void mmu_write(struct gb_s *gb, uint16_t addr, uint8_t val) {
 // ----------------------------------
 
 void mmu_dma_transfer(struct gb_s *gb, uint8_t source_high) {
+    TRACE_SCOPE("oam_dma");
     uint16_t source = source_high << 8;
     
     /* Copy 160 bytes from source to OAM */
     for (uint16_t i = 0; i < OAM_SIZE; i++) {
         gb->oam[i] = mmu_read(gb, source + i);
     }
+    mark_dirty(gb, 0xFE00);
 }
 
 // ----------------------------------
@@ -343,11 +462,18 @@ void mmu_init(struct gb_s *gb) {
     memset(gb->vram, 0, VRAM_SIZE);
     memset(gb->oam, 0, OAM_SIZE);
     memset(gb->hram_io, 0, HRAM_IO_SIZE);
+
+    /* Page table must be valid before the first mmu_write; no debug traps */
+    memset(gb->mmu.trap, 0, sizeof(gb->mmu.trap));
+    memset(gb->mmu.shared, 0, sizeof(gb->mmu.shared));
+    mmu_remap(gb);
+    mmu_dirty_all(gb);
     
     /* Initialize I/O registers to power-on state */
     gb->hram_io[IO_JOYP] = 0xCF;
-    gb->hram_io[IO_DIV] = 0xAB;
+    gb->hram_io[IO_SC] = 0x7E;
     gb->hram_io[IO_IF] = 0xE1;
+    cpu_irq_update(gb);
     gb->hram_io[IO_LCDC] = 0x91;
     gb->hram_io[IO_STAT] = 0x85;
     gb->hram_io[IO_BGP] = 0xFC;
@@ -358,6 +484,11 @@ void mmu_init(struct gb_s *gb) {
     mmu_write(gb, 0xFF47, 0xFC);  /* BGP */
     mmu_write(gb, 0xFF48, 0xFF);  /* OBP0 */
     mmu_write(gb, 0xFF49, 0xFF);  /* OBP1 */
+
+    /* DIV as the boot ROM leaves it; the LCD starts a line now */
+    timers_reset(gb);
+    gb->counter.line_start = gb->counter.cycles;
+    gpu_lcd_schedule(gb);
     
     /* Initialize banking */
     gb->selected_rom_bank = 1;
@@ -0,0 +1,453 @@
+/**
+ * netplay.c - Rollback Netplay over UDP
+ *
+ * Input exchange, prediction, rollback and desync checks. See netplay.h.
+ */
+
+#include "netplay.h"
+#include "gpu.h"
+#include "trace.h"
+
+#include <errno.h>
+#include <netdb.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+// Packet layout (little-endian):
+//   0 magic   4 version   5 player   6 delay   8 count   12 start
+//   16 ack   20 rom_id   24 hash_frame   28 hash   36 inputs[count]
+#define PKT_MAGIC       0x504E4247u     // "GBNP"
+#define PKT_VERSION     1
+#define PKT_HEADER      36
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint32_t get32(const uint8_t *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static void put64(uint8_t *p, uint64_t v) {
+    put32(p, (uint32_t)v);
+    put32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint64_t get64(const uint8_t *p) {
+    return (uint64_t)get32(p) | (uint64_t)get32(p + 4) << 32;
+}
+
+// -------------------------------
+// Sending (with injected loss and latency)
+// -------------------------------
+
+static uint32_t rng_next(struct netplay_s *np) {
+    uint32_t x = np->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return np->rng = x;
+}
+
+static void raw_send(struct netplay_s *np, const uint8_t *data, size_t len) {
+    if (send(np->fd, data, len, MSG_DONTWAIT | MSG_NOSIGNAL) == (ssize_t)len) {
+        np->stats.packets_sent++;
+    }
+}
+
+static void flush_queue(struct netplay_s *np) {
+    int64_t now = now_ns();
+
+    while (np->queue_head != np->queue_tail) {
+        struct netplay_delayed_s *d = &np->queue[np->queue_head % NETPLAY_QUEUE_LEN];
+        if (d->due_ns > now) break;
+        raw_send(np, d->data, d->len);
+        np->queue_head++;
+    }
+}
+
+static void send_datagram(struct netplay_s *np, const uint8_t *data, size_t len) {
+    if (np->loss_pct > 0 && (int)(rng_next(np) % 100) < np->loss_pct) {
+        np->stats.packets_dropped++;
+        return;
+    }
+    if (np->latency_ms <= 0) {
+        raw_send(np, data, len);
+        return;
+    }
+    if (np->queue_tail - np->queue_head == NETPLAY_QUEUE_LEN) {
+        np->stats.packets_dropped++;
+        return;
+    }
+    struct netplay_delayed_s *d = &np->queue[np->queue_tail % NETPLAY_QUEUE_LEN];
+    d->due_ns = now_ns() + (int64_t)np->latency_ms * 1000000LL;
+    d->len = (uint16_t)len;
+    memcpy(d->data, data, len);
+    np->queue_tail++;
+}
+
+/* Our unacknowledged inputs, our ack of theirs and our latest hash */
+static void send_update(struct netplay_s *np) {
+    uint8_t pkt[NETPLAY_PACKET_MAX];
+    uint32_t start = np->peer_ack;
+    uint32_t count = np->local_frames - start;
+
+    if (count > NETPLAY_SEND_WINDOW) count = NETPLAY_SEND_WINDOW;
+
+    uint32_t hash_frame = np->hash_next - NETPLAY_HASH_INTERVAL;
+    uint64_t hash = 0;
+    if (np->hash_next > NETPLAY_HASH_INTERVAL) {
+        hash = np->hash[(hash_frame / NETPLAY_HASH_INTERVAL) % NETPLAY_HASH_RING];
+    } else {
+        hash_frame = 0;
+    }
+
+    memset(pkt, 0, PKT_HEADER);
+    put32(pkt, PKT_MAGIC);
+    pkt[4] = PKT_VERSION;
+    pkt[5] = (uint8_t)np->local;
+    pkt[6] = (uint8_t)np->delay;
+    pkt[8] = (uint8_t)count;
+    put32(pkt + 12, start);
+    put32(pkt + 16, np->remote_frames);
+    put32(pkt + 20, np->rom_id);
+    put32(pkt + 24, hash_frame);
+    put64(pkt + 28, hash);
+    for (uint32_t i = 0; i < count; i++) {
+        pkt[PKT_HEADER + i] = np->input[np->local][(start + i) % NETPLAY_INPUT_RING];
+    }
+
+    send_datagram(np, pkt, PKT_HEADER + count);
+    np->last_send_ns = now_ns();
+}
+
+// -------------------------------
+// Simulation
+// -------------------------------
+
+/* Run frame f from the current state, snapshotting it first */
+static void run_frame(struct netplay_s *np, uint32_t f, bool visible) {
+    struct gb_state_s *st = np->state[f % NETPLAY_HISTORY];
+    int local = np->local, remote = !np->local;
+
+    for (int i = 0; i < 2; i++) {
+        state_save(&st[i], np->gb[i], np->cart_ram[i]);
+    }
+
+    /* Remote input not in yet: repeat the last one we have */
+    uint8_t in = 0xFF;
+    if (f < np->remote_frames) {
+        in = np->input[remote][f % NETPLAY_INPUT_RING];
+    } else if (np->remote_frames > 0) {
+        in = np->input[remote][(np->remote_frames - 1) % NETPLAY_INPUT_RING];
+    }
+    np->used[f % NETPLAY_HISTORY] = in;
+
+    np->gb[local]->direct.joypad = np->input[local][f % NETPLAY_INPUT_RING];
+    np->gb[remote]->direct.joypad = in;
+    np->gb[local]->display.lcd_draw_line = visible ? np->lcd_draw_line : NULL;
+
+    serial_wire_run(&np->wire, np->base_cycles + (uint64_t)(f + 1) * LCD_FRAME_CYCLES);
+}
+
+static void do_rollback(struct netplay_s *np) {
+    TRACE_SCOPE("rollback");
+    int64_t t0 = now_ns();
+    uint32_t from = np->rollback_to;
+    struct gb_state_s *st = np->state[from % NETPLAY_HISTORY];
+
+    np->rollback = false;
+    for (int i = 0; i < 2; i++) {
+        state_load(np->gb[i], &st[i], np->cart_ram[i]);
+    }
+    for (uint32_t f = from; f < np->frame; f++) {
+        run_frame(np, f, false);
+    }
+
+    uint32_t frames = np->frame - from;
+    uint64_t ns = (uint64_t)(now_ns() - t0);
+    np->stats.rollbacks++;
+    np->stats.resim_frames += frames;
+    if (frames > np->stats.max_rollback) np->stats.max_rollback = frames;
+    if (ns > np->stats.max_rollback_ns) np->stats.max_rollback_ns = ns;
+}
+
+// -------------------------------
+// Desync check
+// -------------------------------
+
+static void check_hash(struct netplay_s *np) {
+    if (np->peer_hash_checked || np->peer_hash_frame == 0) {
+        return;
+    }
+    uint32_t slot = (np->peer_hash_frame / NETPLAY_HASH_INTERVAL) % NETPLAY_HASH_RING;
+    if (np->hash_frame[slot] != np->peer_hash_frame) {
+        return;     // Not computed yet (or long gone)
+    }
+    np->peer_hash_checked = true;
+    np->stats.hashes_checked++;
+    if (np->hash[slot] != np->peer_hash) {
+        np->stats.desyncs++;
+        fprintf(stderr, "netplay: desync detected at frame %u\n", np->peer_hash_frame);
+    }
+}
+
+/* Hash the start of each confirmed NETPLAY_HASH_INTERVAL-th frame */
+static void update_hash(struct netplay_s *np) {
+    while (!np->rollback && np->hash_next < np->frame && np->hash_next <= np->remote_frames) {
+        uint32_t c = np->hash_next;
+        np->hash_next += NETPLAY_HASH_INTERVAL;
+        if (c + NETPLAY_HISTORY <= np->frame) {
+            continue;   // Snapshot already overwritten
+        }
+
+        const struct gb_state_s *st = np->state[c % NETPLAY_HISTORY];
+        uint64_t h0 = state_hash(&st[0].gb, st[0].cart_ram, st[0].cart_ram_size);
+        uint64_t h1 = state_hash(&st[1].gb, st[1].cart_ram, st[1].cart_ram_size);
+        uint32_t slot = (c / NETPLAY_HASH_INTERVAL) % NETPLAY_HASH_RING;
+        np->hash_frame[slot] = c;
+        np->hash[slot] = h0 ^ (h1 << 1 | h1 >> 63);
+    }
+    check_hash(np);
+}
+
+// -------------------------------
+// Receiving
+// -------------------------------
+
+static void handle_packet(struct netplay_s *np, const uint8_t *pkt, size_t len) {
+    int remote = !np->local;
+
+    if (len < PKT_HEADER || get32(pkt) != PKT_MAGIC || pkt[4] != PKT_VERSION ||
+        pkt[5] != remote || pkt[6] != np->delay || get32(pkt + 20) != np->rom_id ||
+        len < PKT_HEADER + (size_t)pkt[8]) {
+        np->stats.packets_rejected++;
+        return;
+    }
+    np->stats.packets_received++;
+
+    uint32_t count = pkt[8];
+    uint32_t start = get32(pkt + 12);
+    uint32_t ack = get32(pkt + 16);
+
+    if (ack > np->peer_ack && ack <= np->local_frames) {
+        np->peer_ack = ack;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t f = start + i;
+        if (f < np->remote_frames) continue;
+        if (f > np->remote_frames) break;
+
+        uint8_t in = pkt[PKT_HEADER + i];
+        np->input[remote][f % NETPLAY_INPUT_RING] = in;
+        np->remote_frames++;
+
+        /* Already run on a guess: was it right? */
+        if (f < np->frame && np->used[f % NETPLAY_HISTORY] != in) {
+            if (!np->rollback || f < np->rollback_to) {
+                np->rollback_to = f;
+            }
+            np->rollback = true;
+        }
+    }
+
+    uint32_t hash_frame = get32(pkt + 24);
+    if (hash_frame > np->peer_hash_frame) {
+        np->peer_hash_frame = hash_frame;
+        np->peer_hash = get64(pkt + 28);
+        np->peer_hash_checked = false;
+    }
+}
+
+void netplay_poll(struct netplay_s *np) {
+    uint8_t pkt[NETPLAY_PACKET_MAX + 64];
+    uint32_t had = np->remote_frames;
+
+    if (np->fd < 0) {
+        return;
+    }
+    flush_queue(np);
+
+    for (;;) {
+        ssize_t n = recv(np->fd, pkt, sizeof(pkt), MSG_DONTWAIT);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) break;
+        handle_packet(np, pkt, (size_t)n);
+    }
+
+    if (np->rollback) {
+        do_rollback(np);
+    }
+    update_hash(np);
+
+    /* Acknowledge new input now; keep resending ours until acknowledged */
+    if (np->remote_frames != had ||
+        (np->peer_ack < np->local_frames && now_ns() - np->last_send_ns > NETPLAY_RESEND_MS * 1000000LL)) {
+        send_update(np);
+    }
+}
+
+// -------------------------------
+// Public API
+// -------------------------------
+
+void netplay_init(struct netplay_s *np) {
+    memset(np, 0, sizeof(*np));
+    np->fd = -1;
+    np->delay = NETPLAY_DEFAULT_DELAY;
+}
+
+bool netplay_connect(struct netplay_s *np, const char *bind_port, const char *peer) {
+    char host[256];
+    const char *colon = strrchr(peer, ':');
+
+    if (!colon || colon == peer || (size_t)(colon - peer) >= sizeof(host)) {
+        fprintf(stderr, "netplay: peer must be host:port, got %s\n", peer);
+        return false;
+    }
+    memcpy(host, peer, (size_t)(colon - peer));
+    host[colon - peer] = '\0';
+
+    struct addrinfo hints = { .ai_family = AF_INET, .ai_socktype = SOCK_DGRAM };
+    struct addrinfo *res;
+    int err = getaddrinfo(host, colon + 1, &hints, &res);
+    if (err != 0) {
+        fprintf(stderr, "netplay: %s: %s\n", peer, gai_strerror(err));
+        return false;
+    }
+
+    hints.ai_flags = AI_PASSIVE;
+    struct addrinfo *local;
+    err = getaddrinfo(NULL, bind_port, &hints, &local);
+    if (err != 0) {
+        fprintf(stderr, "netplay: port %s: %s\n", bind_port, gai_strerror(err));
+        freeaddrinfo(res);
+        return false;
+    }
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    bool ok = fd >= 0 &&
+              bind(fd, local->ai_addr, local->ai_addrlen) == 0 &&
+              connect(fd, res->ai_addr, res->ai_addrlen) == 0;
+    if (!ok) {
+        perror("netplay: socket");
+        if (fd >= 0) close(fd);
+    }
+    freeaddrinfo(local);
+    freeaddrinfo(res);
+    if (!ok) {
+        return false;
+    }
+
+    np->fd = fd;
+    return true;
+}
+
+void netplay_attach_fd(struct netplay_s *np, int fd) {
+    np->fd = fd;
+}
+
+int netplay_start(struct netplay_s *np, struct gb_s *gb[2], uint8_t *cart_ram[2],
+                  size_t cart_ram_size, int local) {
+    np->state = calloc(NETPLAY_HISTORY, sizeof(*np->state));
+    if (!np->state) {
+        return -1;
+    }
+    for (int f = 0; f < NETPLAY_HISTORY; f++) {
+        for (int i = 0; i < 2; i++) {
+            if (state_init(&np->state[f][i], cart_ram[i] ? cart_ram_size : 0) != 0) {
+                netplay_close(np);
+                return -1;
+            }
+        }
+    }
+
+    np->local = local;
+    np->cart_ram_size = cart_ram_size;
+    for (int i = 0; i < 2; i++) {
+        np->gb[i] = gb[i];
+        np->cart_ram[i] = cart_ram[i];
+    }
+    np->rng = 0x9E3779B9u ^ (uint32_t)now_ns() ^ (uint32_t)local;
+    np->rom_id = (uint32_t)gb[0]->gb_rom_read(gb[0], 0x014D) << 16 |
+                 (uint32_t)gb[0]->gb_rom_read(gb[0], 0x014E) << 8 |
+                 gb[0]->gb_rom_read(gb[0], 0x014F);
+
+    /* Only our machine draws */
+    np->lcd_draw_line = gb[local]->display.lcd_draw_line;
+    gb[!local]->display.lcd_draw_line = NULL;
+    serial_wire_connect(&np->wire, gb[0], gb[1]);
+
+    /* Frames start at instance 0's VBlank so a whole frame is presented */
+    struct gb_s *g = gb[0];
+    uint32_t ly = g->hram_io[IO_LY];
+    uint32_t lines = ly < LCD_HEIGHT ? LCD_HEIGHT - ly : LCD_VERT_LINES - ly + LCD_HEIGHT;
+    np->base_cycles = g->counter.cycles + (uint64_t)lines * LCD_LINE_CYCLES - gpu_line_cycles(g);
+    gb[local]->display.lcd_draw_line = NULL;
+    serial_wire_run(&np->wire, np->base_cycles);
+    gb[local]->display.lcd_draw_line = np->lcd_draw_line;
+
+    /* Inputs before the delay has elapsed are "nothing pressed" on both sides */
+    memset(np->input, 0xFF, sizeof(np->input));
+    np->frame = 0;
+    np->local_frames = (uint32_t)np->delay;
+    np->remote_frames = (uint32_t)np->delay;
+    np->peer_ack = (uint32_t)np->delay;
+    np->hash_next = NETPLAY_HASH_INTERVAL;
+    return 0;
+}
+
+bool netplay_frame(struct netplay_s *np, uint8_t input) {
+    TRACE_SCOPE("netplay_frame");
+
+    netplay_poll(np);
+
+    /* Too far ahead of the peer's input, or of its acknowledgements */
+    if (np->frame >= np->remote_frames + NETPLAY_MAX_ROLLBACK ||
+        np->local_frames - np->peer_ack >= NETPLAY_INPUT_RING - NETPLAY_HISTORY) {
+        np->stats.stalls++;
+        if (now_ns() - np->last_send_ns > NETPLAY_RESEND_MS * 1000000LL) {
+            send_update(np);
+        }
+        return false;
+    }
+
+    uint32_t f = np->frame + (uint32_t)np->delay;
+    np->input[np->local][f % NETPLAY_INPUT_RING] = input;
+    np->local_frames = f + 1;
+
+    run_frame(np, np->frame, true);
+    np->frame++;
+    np->stats.frames++;
+
+    update_hash(np);
+    send_update(np);
+    return true;
+}
+
+void netplay_close(struct netplay_s *np) {
+    if (np->fd >= 0) {
+        close(np->fd);
+        np->fd = -1;
+    }
+    if (np->state) {
+        for (int f = 0; f < NETPLAY_HISTORY; f++) {
+            for (int i = 0; i < 2; i++) {
+                state_free(&np->state[f][i]);
+            }
+        }
+        free(np->state);
+        np->state = NULL;
+    }
+}
@@ -0,0 +1,178 @@
+/**
+ * osd.c - On-Screen Performance Overlay Implementation
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "osd.h"
+
+// Host time budget for one emulated frame (70224 cycles at 4.194304 MHz)
+#define OSD_BUDGET_NS   ((double)LCD_FRAME_CYCLES * 1e9 / GB_CPU_HZ)
+
+// XRGB1555 colours
+#define OSD_WHITE       0x7FFF
+#define OSD_GREEN       0x03E0
+#define OSD_RED         0x7C00
+#define OSD_YELLOW      0x7FE0
+
+// Glyph cell size, including one pixel of spacing
+#define GLYPH_W         4
+#define GLYPH_H         6
+
+
+// -------------------------------
+// Font
+// -------------------------------
+
+// 3x5 glyphs, one byte per row, bit 2 = leftmost pixel
+struct glyph_s {
+    char    c;
+    uint8_t rows[5];
+};
+
+static const struct glyph_s FONT[] = {
+    { '0', { 7, 5, 5, 5, 7 } },
+    { '1', { 2, 6, 2, 2, 7 } },
+    { '2', { 7, 1, 7, 4, 7 } },
+    { '3', { 7, 1, 7, 1, 7 } },
+    { '4', { 5, 5, 7, 1, 1 } },
+    { '5', { 7, 4, 7, 1, 7 } },
+    { '6', { 7, 4, 7, 5, 7 } },
+    { '7', { 7, 1, 1, 1, 1 } },
+    { '8', { 7, 5, 7, 5, 7 } },
+    { '9', { 7, 5, 7, 1, 7 } },
+    { '.', { 0, 0, 0, 0, 2 } },
+    { '%', { 5, 1, 2, 4, 5 } },
+    { 'B', { 6, 5, 6, 5, 6 } },
+    { 'F', { 7, 4, 6, 4, 4 } },
+    { 'G', { 7, 4, 5, 5, 7 } },
+    { 'P', { 6, 5, 6, 4, 4 } },
+    { 'S', { 3, 4, 2, 1, 6 } },
+};
+
+static const uint8_t *find_glyph(char c) {
+    for (size_t i = 0; i < sizeof(FONT) / sizeof(FONT[0]); i++) {
+        if (FONT[i].c == c) return FONT[i].rows;
+    }
+    return NULL;    // Unknown characters (and space) draw nothing
+}
+
+
+// -------------------------------
+// Drawing Helpers
+// -------------------------------
+
+// Halve the brightness of a rectangle so text stays readable on any background
+static void shade_rect(uint16_t fb[LCD_HEIGHT][LCD_WIDTH], int x, int y, int w, int h) {
+    for (int row = y; row < y + h && row < LCD_HEIGHT; row++) {
+        for (int col = x; col < x + w && col < LCD_WIDTH; col++) {
+            fb[row][col] = (fb[row][col] >> 1) & 0x3DEF;
+        }
+    }
+}
+
+static void draw_text(uint16_t fb[LCD_HEIGHT][LCD_WIDTH], int x, int y,
+                      const char *text, uint16_t colour) {
+    for (; *text; text++, x += GLYPH_W) {
+        const uint8_t *rows = find_glyph(*text);
+        if (!rows) continue;
+
+        for (int r = 0; r < 5; r++) {
+            for (int c = 0; c < 3; c++) {
+                int px = x + c, py = y + r;
+                if ((rows[r] & (4 >> c)) && px < LCD_WIDTH && py < LCD_HEIGHT) {
+                    fb[py][px] = colour;
+                }
+            }
+        }
+    }
+}
+
+
+// -------------------------------
+// Public Interface
+// -------------------------------
+
+void osd_init(struct osd_s *osd, bool enabled) {
+    memset(osd, 0, sizeof(*osd));
+    osd->enabled = enabled;
+    osd->bg_hit_pct = -1.0;
+}
+
+void osd_frame(struct osd_s *osd, const struct gb_stats_s *stats,
+               int64_t now_ns, int64_t busy_ns) {
+    if (busy_ns < 0) busy_ns = 0;
+    if (busy_ns > UINT32_MAX) busy_ns = UINT32_MAX;
+
+    osd->frame_ns[osd->head] = (uint32_t)busy_ns;
+    osd->head = (osd->head + 1) % OSD_GRAPH_LEN;
+
+    /* First frame only opens the measurement window */
+    if (osd->window_start_ns == 0) {
+        osd->window_start_ns = now_ns;
+        osd->window_frames = stats->frames;
+        osd->window_cycles = stats->cycles;
+        osd->window_bg_hits = stats->bg_cache_hits;
+        osd->window_bg_misses = stats->bg_cache_misses;
+        return;
+    }
+
+    int64_t elapsed = now_ns - osd->window_start_ns;
+    if (elapsed < OSD_UPDATE_NS) return;
+
+    double secs = (double)elapsed / 1e9;
+    osd->fps = (double)(stats->frames - osd->window_frames) / secs;
+    osd->speed_pct = 100.0 * (double)(stats->cycles - osd->window_cycles) / (secs * GB_CPU_HZ);
+
+    uint64_t hits = stats->bg_cache_hits - osd->window_bg_hits;
+    uint64_t lookups = hits + stats->bg_cache_misses - osd->window_bg_misses;
+    osd->bg_hit_pct = lookups ? 100.0 * (double)hits / (double)lookups : -1.0;
+
+    osd->window_start_ns = now_ns;
+    osd->window_frames = stats->frames;
+    osd->window_cycles = stats->cycles;
+    osd->window_bg_hits = stats->bg_cache_hits;
+    osd->window_bg_misses = stats->bg_cache_misses;
+}
+
+void osd_draw(const struct osd_s *osd, uint16_t fb[LCD_HEIGHT][LCD_WIDTH]) {
+    if (!osd->enabled) return;
+
+    char line[16];
+
+    /* Readouts, top-left */
+    int lines = osd->bg_hit_pct >= 0.0 ? 3 : 2;
+    shade_rect(fb, 0, 0, 9 * GLYPH_W + 1, lines * GLYPH_H + 1);
+
+    snprintf(line, sizeof(line), "%.1f FPS", osd->fps);
+    draw_text(fb, 1, 1, line, OSD_WHITE);
+
+    snprintf(line, sizeof(line), "%.0f%%", osd->speed_pct);
+    draw_text(fb, 1, 1 + GLYPH_H, line, osd->speed_pct >= 99.0 ? OSD_WHITE : OSD_RED);
+
+    if (osd->bg_hit_pct >= 0.0) {
+        snprintf(line, sizeof(line), "BG %.1f%%", osd->bg_hit_pct);
+        draw_text(fb, 1, 1 + 2 * GLYPH_H, line, OSD_WHITE);
+    }
+
+    /* Frame-time graph, bottom-left: oldest sample on the left */
+    int base = LCD_HEIGHT - 1;
+    int budget_row = base - OSD_GRAPH_HEIGHT / 2;
+
+    shade_rect(fb, 0, LCD_HEIGHT - OSD_GRAPH_HEIGHT, OSD_GRAPH_LEN, OSD_GRAPH_HEIGHT);
+
+    for (int i = 0; i < OSD_GRAPH_LEN; i++) {
+        uint32_t ns = osd->frame_ns[(osd->head + i) % OSD_GRAPH_LEN];
+        int h = (int)(ns * (OSD_GRAPH_HEIGHT / 2) / OSD_BUDGET_NS + 0.5);
+        if (h > OSD_GRAPH_HEIGHT) h = OSD_GRAPH_HEIGHT;
+
+        uint16_t colour = ns > OSD_BUDGET_NS ? OSD_RED : OSD_GREEN;
+        for (int y = 0; y < h; y++) {
+            fb[base - y][i] = colour;
+        }
+
+        /* Dotted budget marker */
+        if ((i & 1) == 0) fb[budget_row][i] = OSD_YELLOW;
+    }
+}
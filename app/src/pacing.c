@@ -0,0 +1,157 @@
+/**
+ * pacing.c - Frame Pacing Engine Implementation
+ *
+ * Deadlines are absolute CLOCK_MONOTONIC times slept on with
+ * clock_nanosleep(TIMER_ABSTIME), so oversleeping one frame does not push
+ * every following frame back. The fractional part of the period is carried
+ * between frames, so the long-run rate matches target_hz exactly.
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+#include "pacing.h"
+
+#define NS_PER_SEC 1000000000LL
+
+
+// -------------------------------
+// Helper Functions
+// -------------------------------
+
+int64_t pacing_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+}
+
+// Sleep until an absolute CLOCK_MONOTONIC time, retrying if interrupted by a signal
+static void sleep_until_ns(int64_t deadline_ns) {
+    struct timespec ts = {
+        .tv_sec  = deadline_ns / NS_PER_SEC,
+        .tv_nsec = deadline_ns % NS_PER_SEC
+    };
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+        /* Absolute deadline, so simply sleep again */
+    }
+}
+
+static void update_period(struct pacing_s *p) {
+    p->period_ns = (double)NS_PER_SEC / p->target_hz;
+}
+
+// Advance the deadline chain by one period, carrying the sub-ns remainder
+static void advance_deadline(struct pacing_s *p) {
+    p->deadline_frac += p->period_ns;
+    int64_t whole = (int64_t)p->deadline_frac;
+    p->deadline_frac -= (double)whole;
+    p->deadline_ns += whole;
+}
+
+// Record the measured period between two consecutive wake-ups
+static void record_period(struct pacing_s *p, int64_t period) {
+    p->frames++;
+
+    double delta = (double)period - p->mean_ns;
+    p->mean_ns += delta / (double)p->frames;
+    p->m2_ns += delta * ((double)period - p->mean_ns);
+
+    if (p->frames == 1 || period < p->min_ns) p->min_ns = period;
+    if (p->frames == 1 || period > p->max_ns) p->max_ns = period;
+
+    if (fabs((double)period - p->period_ns) > PACING_JITTER_LIMIT_NS) {
+        p->off_target++;
+    }
+}
+
+
+// -------------------------------
+// Public Interface
+// -------------------------------
+
+void pacing_init(struct pacing_s *p, double target_hz) {
+    memset(p, 0, sizeof(*p));
+    p->target_hz = target_hz > 0.0 ? target_hz : PACING_DMG_HZ;
+    p->enabled = true;
+    update_period(p);
+    pacing_reset(p);
+}
+
+void pacing_set_rate(struct pacing_s *p, double target_hz) {
+    if (target_hz <= 0.0) return;
+
+    p->target_hz = target_hz;
+    update_period(p);
+}
+
+void pacing_reset(struct pacing_s *p) {
+    p->deadline_ns = pacing_now_ns();
+    p->deadline_frac = 0.0;
+    p->last_wake_ns = 0;
+    advance_deadline(p);
+}
+
+void pacing_wait(struct pacing_s *p) {
+    int64_t now = pacing_now_ns();
+
+    if (p->enabled) {
+        if (now < p->deadline_ns) {
+            sleep_until_ns(p->deadline_ns);
+            now = pacing_now_ns();
+
+            int64_t wake_late = now - p->deadline_ns;
+            if (wake_late > p->max_wake_late_ns) p->max_wake_late_ns = wake_late;
+        } else {
+            p->late_frames++;
+        }
+
+        /*
+         * Drift correction: a short stall is absorbed by the chain (the next
+         * frames just sleep less), but after a long stall (window drag,
+         * debugger, swapping) re-anchor rather than fast-forwarding.
+         */
+        if (now - p->deadline_ns > (int64_t)(p->period_ns * PACING_MAX_LAG_FRAMES)) {
+            p->deadline_ns = now;
+            p->deadline_frac = 0.0;
+            p->resyncs++;
+        }
+
+        advance_deadline(p);
+    }
+
+    if (p->last_wake_ns != 0) {
+        record_period(p, now - p->last_wake_ns);
+    }
+    p->last_wake_ns = now;
+}
+
+void pacing_get_stats(const struct pacing_s *p, struct pacing_stats_s *out) {
+    memset(out, 0, sizeof(*out));
+
+    out->frames = p->frames;
+    out->late_frames = p->late_frames;
+    out->off_target = p->off_target;
+    out->resyncs = p->resyncs;
+    out->target_ns = p->period_ns;
+    out->mean_ns = p->mean_ns;
+    out->stddev_ns = p->frames > 1 ? sqrt(p->m2_ns / (double)(p->frames - 1)) : 0.0;
+    out->min_ns = p->min_ns;
+    out->max_ns = p->max_ns;
+    out->max_wake_late_ns = p->max_wake_late_ns;
+}
+
+void pacing_clear_stats(struct pacing_s *p) {
+    p->frames = 0;
+    p->late_frames = 0;
+    p->off_target = 0;
+    p->resyncs = 0;
+    p->mean_ns = 0.0;
+    p->m2_ns = 0.0;
+    p->min_ns = 0;
+    p->max_ns = 0;
+    p->max_wake_late_ns = 0;
+    p->last_wake_ns = 0;
+}
@@ -0,0 +1,83 @@
+/**
+ * palette.c - Host Colours for the LCD
+ */
+
+#include <string.h>
+
+#include "palette.h"
+
+const struct palette_s palette_presets[] = {
+    { "gray",   { 0xFFFFFF, 0xA5A5A5, 0x525252, 0x000000 } },
+    { "green",  { 0x9BBC0F, 0x8BAC0F, 0x306230, 0x0F380F } },
+    { "pocket", { 0xC4CFA1, 0x8B956D, 0x4D533C, 0x1F1F1F } },
+};
+
+const int palette_num_presets = sizeof(palette_presets) / sizeof(palette_presets[0]);
+
+// Exactly six hex digits (no sign, prefix or spaces, which sscanf would take)
+static int parse_colour(const char *s, uint32_t *out) {
+    uint32_t v = 0;
+    for (int i = 0; i < 6; i++) {
+        char c = s[i];
+        int d = (c >= '0' && c <= '9') ? c - '0' :
+                (c >= 'a' && c <= 'f') ? c - 'a' + 10 :
+                (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+        if (d < 0) return -1;   // Also stops at the terminating NUL
+        v = (v << 4) | (uint32_t)d;
+    }
+    *out = v;
+    return 0;
+}
+
+int palette_parse(const char *spec, uint32_t rgb[4]) {
+    for (int p = 0; p < palette_num_presets; p++) {
+        if (strcmp(spec, palette_presets[p].name) == 0) {
+            memcpy(rgb, palette_presets[p].rgb, sizeof(palette_presets[p].rgb));
+            return 0;
+        }
+    }
+
+    uint32_t c[4];
+    for (int i = 0; i < 4; i++) {
+        const char *field = spec + i * 7;
+        if (parse_colour(field, &c[i]) != 0 || field[6] != (i < 3 ? ',' : '\0')) return -1;
+    }
+    memcpy(rgb, c, sizeof(c));
+    return 0;
+}
+
+void palette_lut_1555(const uint32_t rgb[4], uint16_t lut[4]) {
+    for (int i = 0; i < 4; i++) {
+        // Keep the top 5 bits of each 8-bit component: x rrrrr ggggg bbbbb
+        uint16_t r5 = (rgb[i] >> 19) & 0x1F;
+        uint16_t g5 = (rgb[i] >> 11) & 0x1F;
+        uint16_t b5 = (rgb[i] >> 3) & 0x1F;
+        lut[i] = (uint16_t)((r5 << 10) | (g5 << 5) | b5);
+    }
+}
+
+#if defined(__GNUC__)
+// Eight pixels per step in 16-bit lanes (SSE2 on x86-64, NEON on ARM):
+// each lane picks its colour by comparing the shade with 0-3.
+typedef uint8_t  u8x8  __attribute__((vector_size(8)));
+typedef uint16_t u16x8 __attribute__((vector_size(16)));
+#endif
+
+void palette_convert(const uint8_t *shades, uint16_t *out, size_t n, const uint16_t lut[4]) {
+    size_t i = 0;
+
+#if defined(__GNUC__)
+    for (; i + 8 <= n; i += 8) {
+        u8x8 b;
+        memcpy(&b, shades + i, sizeof(b));
+        u16x8 s = __builtin_convertvector(b, u16x8) & 0x03;
+        u16x8 px = ((u16x8)(s == 0) & lut[0]) | ((u16x8)(s == 1) & lut[1]) |
+                   ((u16x8)(s == 2) & lut[2]) | ((u16x8)(s == 3) & lut[3]);
+        memcpy(out + i, &px, sizeof(px));
+    }
+#endif
+
+    for (; i < n; i++) {
+        out[i] = lut[shades[i] & 0x03];
+    }
+}
@@ -20,6 +20,10 @@
 #include "gb_types.h"
 #include "memory.h"
 #include "cpu.h"
+#include "disasm.h"
+#include "itrace.h"
+#include "debug.h"
+#include "rt.h"
 
 
 
@@ -177,8 +181,21 @@ void bootloader_error_handler(struct gb_s *gb, enum gb_error_e error, uint16_t a
     fprintf(stderr, "EMULATOR ERROR: %s at address 0x%04X\n",
             error < GB_INVALID_MAX ? error_str[error] : "Unknown error",
             addr);
-    fprintf(stderr, "PC: 0x%04X, A: 0x%02X, OpCode: 0x%02X\n",
-            gb->cpu_reg.pc.reg, gb->cpu_reg.a, mmu_read(gb, addr));
+    char text[24];
+    gb_disasm(gb, addr, text, sizeof(text));
+    fprintf(stderr, "PC: 0x%04X, A: 0x%02X, OpCode: 0x%02X (%s)\n",
+            gb->cpu_reg.pc.reg, gb->cpu_reg.a, mmu_peek(gb, addr), text);
+
+    if (gb->itrace) {
+        itrace_dump(gb, stderr, ITRACE_DUMP_ON_ERROR);
+    }
+
+    /* Under a debugger, stop at the faulting instruction so it can be inspected */
+    if (gb->debug) {
+        gb->cpu_reg.pc.reg = addr;
+        debug_stop(gb, DEBUG_STOP_ERROR);
+        return;
+    }
     
     /* Halt execution */
     exit(1);
@@ -190,7 +207,7 @@ void bootloader_error_handler(struct gb_s *gb, enum gb_error_e error, uint16_t a
 // -------------------------------
 
 // Verify the scrolling Nintendo graphic as a sanity check
-static bool verify_nintendo_logo(void) {
+static bool verify_nintendo_logo(const uint8_t *rom) {
     
     static const uint8_t correct_nintendo_graphic[] = {
         0xCE, 0xED, 0x66, 0x66, 0xCC, 0x0D, 0x00, 0x0B,
@@ -203,14 +220,11 @@ static bool verify_nintendo_logo(void) {
     
     // Loop through each of the the Nintendo graphic bytes and compare to the correct
     for(size_t i = 0; i < sizeof(correct_nintendo_graphic); i++) {
-        if(g_rom_data[NINTENDO_LOGO_START + i] != correct_nintendo_graphic[i]) {
-            printf("bootloader: Nintendo graphic mismatch at address 0x%04X, expected 0x%02X, got 0x%02X\n",
-                NINTENDO_LOGO_START + (int)i, correct_nintendo_graphic[i], g_rom_data[NINTENDO_LOGO_START + i]);
+        if(rom[NINTENDO_LOGO_START + i] != correct_nintendo_graphic[i]) {
             return false;
         }
     }
 
-    printf("bootloader: Successfully verified Nintendo graphic in ROM\n");
     return true;
 }
 
@@ -244,11 +258,9 @@ static uint8_t get_num_rom_banks(uint8_t size_code) {
         case 0x53: num_rom_banks = 80; break;
         case 0x54: num_rom_banks = 96; break;
         default:
-            printf("bootloader: Unsupported ROM size code: 0x%02X\n", size_code);
             return 0;
     }
 
-    printf("bootloader: Detected ROM size code: %02X, num banks: %d\n", size_code, num_rom_banks);
     return num_rom_banks;
 }
 
@@ -286,8 +298,7 @@ static uint8_t get_num_ram_banks(uint8_t size_code) {
             num_cart_ram_banks = 8;
             break;  
         default:
-            printf("bootloader: Unsupported cartridge RAM size: 0x%02X\n", size_code);
-            return 0;
+            return 0;   // Unsupported size: treated as no RAM
     }
 
     return num_cart_ram_banks;
@@ -317,7 +328,6 @@ static int8_t get_mbc_type(uint8_t cart_type) {
         case 0x09: // No MBC + RAM + Battery (same as 0x08 for our purposes)
             return 0;
         default:
-            printf("bootloader: Unsupported cartridge type: 0x%2X\n", cart_type);
             return -1;
     }
 }
@@ -335,6 +345,67 @@ static bool has_cart_ram(uint8_t cart_type) {
     }
 }
 
+// -------------------------------
+// Header Parsing (no output, shared with gbe.h)
+// -------------------------------
+
+enum rom_error_e rom_parse_header(const uint8_t *rom, size_t size, struct rom_info_s *info) {
+
+    memset(info, 0, sizeof(*info));
+
+    if (size < 2 * ROM_BANK_SIZE) {
+        return ROM_ERR_TOO_SMALL;
+    }
+    if (!verify_nintendo_logo(rom)) {
+        return ROM_ERR_LOGO;
+    }
+    if (rom[ROM_HEADER_SGB_FLAG] == 0x03) {
+        return ROM_ERR_SGB;
+    }
+
+    info->cart_type = rom[ROM_HEADER_CART_TYPE];
+    info->cgb = (rom[ROM_HEADER_CGB_FLAG] & 0x80) != 0;
+    info->num_rom_banks = get_num_rom_banks(rom[ROM_HEADER_ROM_SIZE]);
+    if (info->num_rom_banks == 0) {
+        return ROM_ERR_ROM_SIZE;
+    }
+
+    int8_t mbc_type = get_mbc_type(info->cart_type);
+    if (mbc_type < 0) {
+        return ROM_ERR_CART_TYPE;
+    }
+    info->mbc = (uint8_t)mbc_type;
+
+    info->cart_ram = has_cart_ram(info->cart_type);
+    info->num_ram_banks = get_num_ram_banks(rom[ROM_HEADER_RAM_SIZE]);
+    if (info->cart_ram) {
+        info->cart_ram_size = (size_t)info->num_ram_banks * CRAM_BANK_SIZE;
+    }
+    return ROM_OK;
+}
+
+const char *rom_error_str(enum rom_error_e err) {
+    switch (err) {
+        case ROM_OK:            return "OK";
+        case ROM_ERR_TOO_SMALL: return "ROM image smaller than 32 KB";
+        case ROM_ERR_LOGO:      return "Nintendo logo verification failed";
+        case ROM_ERR_SGB:       return "Super GameBoy cartridges are unsupported";
+        case ROM_ERR_ROM_SIZE:  return "Invalid ROM size";
+        case ROM_ERR_CART_TYPE: return "Unsupported cartridge type (only MBC1 is supported)";
+    }
+    return "Unknown error";
+}
+
+void rom_setup(struct gb_s *gb, const struct rom_info_s *info) {
+    gb->mbc = info->mbc;
+    gb->cart_ram = info->cart_ram ? 1 : 0;
+    gb->num_rom_banks_mask = info->num_rom_banks - 1;
+    gb->num_ram_banks = info->num_ram_banks;
+
+    mmu_init(gb);
+    cpu_init(gb);
+}
+
 // Print ROM title from header
 static void print_rom_title(void) {
     printf("Welcome to ");
@@ -397,66 +468,33 @@ struct gb_s* bootloader(char* rom_path) {
     
     fclose(rom_file);
     
-    // Verify Nintendo logo
-    if (!verify_nintendo_logo()) {
-        fprintf(stderr, "bootloader: Nintendo logo verification failed\n");
+    // Verify the logo and parse the header
+    struct rom_info_s info;
+    enum rom_error_e err = rom_parse_header(g_rom_data, g_rom_size, &info);
+    if (err != ROM_OK) {
+        fprintf(stderr, "bootloader: %s\n", rom_error_str(err));
+        if (err == ROM_ERR_CART_TYPE) {
+            fprintf(stderr, "bootloader: Cartridge type: 0x%02X\n", g_rom_data[ROM_HEADER_CART_TYPE]);
+        }
         free(g_rom_data);
         g_rom_data = NULL;
         return NULL;
     }
     printf("bootloader: Nintendo logo verified\n");
-    
-    // Check for super GameBoy cartridge, unsupported
-    if (g_rom_data[ROM_HEADER_SGB_FLAG] == 0x03) {
-        printf("bootloader: Super GameBoy cartridges are unsupported\n");
-        free(g_rom_data);
-        g_rom_data = NULL;
-        return NULL;
-    }
 
-    // Check for GameBoy Color cartridge but don't reject, just warn
+    // GameBoy Color cartridges are not rejected, just warned about
     // Rejecting is too strict since many games are dual-compatible
-    if (g_rom_data[ROM_HEADER_CGB_FLAG] & 0x80) {
+    if (info.cgb) {
         printf("bootloader: CGB-compatible ROM detected (running in DMG mode)\n");
     }
 
-    // Parse ROM header
-    uint8_t rom_size_code = g_rom_data[ROM_HEADER_ROM_SIZE];
-    uint8_t ram_size_code = g_rom_data[ROM_HEADER_RAM_SIZE];
-    uint8_t cart_type = g_rom_data[ROM_HEADER_CART_TYPE];
-    
-    uint8_t num_rom_banks = get_num_rom_banks(rom_size_code);
-    uint8_t num_ram_banks = get_num_ram_banks(ram_size_code);
-    int8_t mbc_type = get_mbc_type(cart_type);
-    
-    if (num_rom_banks == 0) {
-        fprintf(stderr, "bootloader: Invalid ROM size\n");
-        free(g_rom_data);
-        g_rom_data = NULL;
-        return NULL;
-    }
-    
-    if (mbc_type < 0) {
-        fprintf(stderr, "bootloader: Unsupported cartridge type: 0x%02X\n", cart_type);
-        free(g_rom_data);
-        g_rom_data = NULL;
-        return NULL;
-    }
-    
-    if (mbc_type != 0 && mbc_type != 1) {
-        fprintf(stderr, "bootloader: Only MBC1 is supported (got MBC%d)\n", mbc_type);
-        free(g_rom_data);
-        g_rom_data = NULL;
-        return NULL;
-    }
-    
-    printf("bootloader: Cartridge type: 0x%02X (MBC%d)\n", cart_type, mbc_type);
-    printf("bootloader: ROM banks: %d (%d KB)\n", num_rom_banks, (num_rom_banks * ROM_BANK_SIZE) / 1024);
-    printf("bootloader: RAM banks: %d (%d KB)\n", num_ram_banks, (num_ram_banks * CRAM_BANK_SIZE) / 1024);
+    printf("bootloader: Cartridge type: 0x%02X (MBC%d)\n", info.cart_type, info.mbc);
+    printf("bootloader: ROM banks: %d (%d KB)\n", info.num_rom_banks, (info.num_rom_banks * ROM_BANK_SIZE) / 1024);
+    printf("bootloader: RAM banks: %d (%d KB)\n", info.num_ram_banks, (info.num_ram_banks * CRAM_BANK_SIZE) / 1024);
     
     // Allocate cart RAM if needed
-    if (has_cart_ram(cart_type) && num_ram_banks > 0) {
-        g_cart_ram_size = num_ram_banks * CRAM_BANK_SIZE;
+    if (info.cart_ram_size > 0) {
+        g_cart_ram_size = info.cart_ram_size;
         g_cart_ram = (uint8_t*)calloc(1, g_cart_ram_size);
         if (!g_cart_ram) {
             fprintf(stderr, "bootloader: Failed to allocate cart RAM\n");
@@ -484,15 +522,8 @@ struct gb_s* bootloader(char* rom_path) {
     gb->gb_cart_ram_write = bootloader_cart_ram_write;
     gb->gb_error = bootloader_error_handler;
     
-    // Set cartridge info
-    gb->mbc = mbc_type;
-    gb->cart_ram = has_cart_ram(cart_type) ? 1 : 0;
-    gb->num_rom_banks_mask = num_rom_banks - 1;
-    gb->num_ram_banks = num_ram_banks;
-    
-    // Initialize MMU and CPU
-    mmu_init(gb);
-    cpu_init(gb);
+    // Set cartridge info, initialize MMU and CPU
+    rom_setup(gb, &info);
     
     // Print a welcome message with the name of the game that was loaded form the ROM
     print_rom_title();
@@ -518,3 +549,17 @@ void bootloader_cleanup(void) {
         g_cart_ram = NULL;
     }
 }
+
+
+// Pre-fault ROM and RAM pages (real-time mode)
+void bootloader_prefault(void) {
+    rt_prefault(g_rom_data, g_rom_size);
+    rt_prefault(g_cart_ram, g_cart_ram_size);
+}
+
+
+// Cart RAM buffer (save states)
+uint8_t *bootloader_cart_ram(size_t *size) {
+    *size = g_cart_ram ? g_cart_ram_size : 0;
+    return g_cart_ram;
+}
@@ -0,0 +1,89 @@
+/**
+ * serial.c - Serial Port (Link Cable)
+ *
+ * Transfer timing and completion; the cable itself is a serial_link_s.
+ */
+
+#include "serial.h"
+#include "cpu.h"
+
+#include <stddef.h>
+
+void serial_write_sc(struct gb_s *gb, uint8_t val) {
+    /* Bits 1-6 are unused and read back as 1 */
+    gb->hram_io[IO_SC] = val | 0x7E;
+
+    if (!(val & SC_TRANSFER)) {
+        return;
+    }
+    if (val & SC_CLOCK_INTERNAL) {
+        gb->counter.serial_count = SERIAL_CYCLES;
+    } else {
+        gb->counter.serial_armed = gb->counter.cycles;
+    }
+}
+
+void serial_step(struct gb_s *gb, uint16_t cycles) {
+    struct serial_link_s *link = gb->link;
+
+    /* External clock: only the other end can finish the transfer */
+    if (!(gb->hram_io[IO_SC] & SC_CLOCK_INTERNAL)) {
+        if (link && link->poll) {
+            link->poll(link, gb);
+        }
+        return;
+    }
+
+    if (gb->counter.serial_count > cycles) {
+        gb->counter.serial_count -= cycles;
+        return;
+    }
+    gb->counter.serial_count = 0;
+
+    /* Nothing plugged in: the data line floats high */
+    uint8_t in = link ? link->transfer(link, gb, gb->hram_io[IO_SB]) : 0xFF;
+    serial_complete(gb, in);
+}
+
+void serial_complete(struct gb_s *gb, uint8_t in) {
+    gb->hram_io[IO_SB] = in;
+    gb->hram_io[IO_SC] &= (uint8_t)~SC_TRANSFER;
+    cpu_irq_raise(gb, SERIAL_INTR);
+}
+
+// -------------------------------
+// Same-thread wire
+// -------------------------------
+
+static uint8_t wire_transfer(struct serial_link_s *link, struct gb_s *gb, uint8_t out) {
+    struct gb_s *peer = ((struct serial_wire_end_s *)link)->peer;
+    (void)gb;
+
+    /* Only a peer waiting on the external clock shifts a byte back */
+    if ((peer->hram_io[IO_SC] & (SC_TRANSFER | SC_CLOCK_INTERNAL)) != SC_TRANSFER) {
+        return 0xFF;
+    }
+    uint8_t in = peer->hram_io[IO_SB];
+    serial_complete(peer, out);
+    return in;
+}
+
+void serial_wire_connect(struct serial_wire_s *w, struct gb_s *a, struct gb_s *b) {
+    struct gb_s *gb[2] = { a, b };
+
+    for (int i = 0; i < 2; i++) {
+        w->end[i].link.transfer = wire_transfer;
+        w->end[i].link.poll = NULL;
+        w->end[i].peer = gb[!i];
+        gb[i]->link = &w->end[i].link;
+    }
+}
+
+void serial_wire_run(struct serial_wire_s *w, uint64_t until) {
+    struct gb_s *a = w->end[1].peer;
+    struct gb_s *b = w->end[0].peer;
+
+    while ((a->counter.cycles < until || b->counter.cycles < until) && !a->gb_break && !b->gb_break) {
+        cpu_step(a->counter.cycles <= b->counter.cycles ? a : b);
+    }
+}
@@ -0,0 +1,323 @@
+/**
+ * state.c - Save States
+ *
+ * Snapshot = memcpy of struct gb_s; loading puts the host-owned fields back
+ * and rebuilds the page table. A shared load skips work RAM and maps the
+ * snapshot's pages copy-on-write instead.
+ */
+
+#include "state.h"
+#include "memory.h"
+#include "gpu.h"
+#include "timers.h"
+#include "trace.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FNV_OFFSET  0xCBF29CE484222325ULL
+#define FNV_PRIME   0x100000001B3ULL
+
+#define PRIME1      0x9E3779B185EBCA87ULL
+#define PRIME2      0xC2B2AE3D27D4EB4FULL
+#define PRIME3      0x165667B19E3779F9ULL
+
+// Page numbering for the incremental hash
+#define PAGES       (VRAM_SIZE >> MMU_PAGE_SHIFT)
+#define ID_VRAM     0
+#define ID_WRAM     (ID_VRAM + PAGES)
+#define ID_OAM      (ID_WRAM + PAGES)
+#define ID_IO       (ID_OAM + 1)
+#define ID_CRAM     (ID_IO + 1)
+#define ID_FIELDS   STATE_HASH_PAGES
+
+int state_init(struct gb_state_s *st, size_t cart_ram_size) {
+    memset(st, 0, sizeof(*st));
+    if (cart_ram_size > 0) {
+        st->cart_ram = calloc(1, cart_ram_size);
+        if (!st->cart_ram) {
+            return -1;
+        }
+        st->cart_ram_size = cart_ram_size;
+    }
+    return 0;
+}
+
+void state_free(struct gb_state_s *st) {
+    free(st->cart_ram);
+    st->cart_ram = NULL;
+    st->cart_ram_size = 0;
+}
+
+void state_save(struct gb_state_s *st, const struct gb_s *gb, const uint8_t *cart_ram) {
+    TRACE_SCOPE("state_save");
+
+    memcpy(&st->gb, gb, offsetof(struct gb_s, wram));
+    memcpy(st->gb.vram, gb->vram, sizeof(*gb) - offsetof(struct gb_s, vram));
+
+    /* A snapshot owns all of its work RAM (pages shared with @st itself are
+       already in place) */
+    for (int wp = 0; wp < WRAM_SIZE >> MMU_PAGE_SHIFT; wp++) {
+        const uint8_t *page = mmu_wram_page(gb, wp);
+        if (page != &st->gb.wram[wp << MMU_PAGE_SHIFT]) {
+            memcpy(&st->gb.wram[wp << MMU_PAGE_SHIFT], page, 1 << MMU_PAGE_SHIFT);
+        }
+    }
+    memset(st->gb.mmu.shared, 0, sizeof(st->gb.mmu.shared));
+
+    if (st->cart_ram && cart_ram) {
+        memcpy(st->cart_ram, cart_ram, st->cart_ram_size);
+    }
+}
+
+void state_host_save(struct state_host_s *h, const struct gb_s *gb) {
+    h->rom_read = gb->gb_rom_read;
+    h->cart_ram_read = gb->gb_cart_ram_read;
+    h->cart_ram_write = gb->gb_cart_ram_write;
+    h->error = gb->gb_error;
+    h->lcd_draw_line = gb->display.lcd_draw_line;
+    h->draw_mask = gb->display.draw_mask;
+    h->bg_cache = gb->display.bg_cache;
+    h->itrace = gb->itrace;
+    h->debug = gb->debug;
+    h->link = gb->link;
+    h->priv = gb->direct.priv;
+    h->ppu_ns = gb->stats.ppu_ns;
+    h->cpu_ns = gb->stats.cpu_ns;
+    h->present_ns = gb->stats.present_ns;
+    h->input_ns = gb->stats.input_ns;
+    h->time_ppu = gb->stats.time_ppu;
+    h->brk = gb->gb_break;
+    memcpy(h->trap, gb->mmu.trap, sizeof(h->trap));
+}
+
+void state_host_restore(struct gb_s *gb, const struct state_host_s *h) {
+    gb->gb_rom_read = h->rom_read;
+    gb->gb_cart_ram_read = h->cart_ram_read;
+    gb->gb_cart_ram_write = h->cart_ram_write;
+    gb->gb_error = h->error;
+    gb->display.lcd_draw_line = h->lcd_draw_line;
+    gb->display.draw_mask = h->draw_mask;
+    gb->display.bg_cache = h->bg_cache;
+    gb->itrace = h->itrace;
+    gb->debug = h->debug;
+    gb->link = h->link;
+    gb->direct.priv = h->priv;
+    gb->stats.ppu_ns = h->ppu_ns;
+    gb->stats.cpu_ns = h->cpu_ns;
+    gb->stats.present_ns = h->present_ns;
+    gb->stats.input_ns = h->input_ns;
+    gb->stats.time_ppu = h->time_ppu;
+    gb->gb_break = h->brk;
+    memcpy(gb->mmu.trap, h->trap, sizeof(gb->mmu.trap));
+}
+
+void state_clone(struct gb_s *dst, const struct gb_s *src) {
+    struct state_host_s h;
+    memset(&h, 0, sizeof(h));
+
+    memcpy(dst, src, offsetof(struct gb_s, wram));
+    memcpy(dst->vram, src->vram, sizeof(*dst) - offsetof(struct gb_s, vram));
+    for (int wp = 0; wp < WRAM_SIZE >> MMU_PAGE_SHIFT; wp++) {
+        memcpy(&dst->wram[wp << MMU_PAGE_SHIFT], mmu_wram_page(src, wp), 1 << MMU_PAGE_SHIFT);
+    }
+    memset(dst->mmu.shared, 0, sizeof(dst->mmu.shared));
+
+    state_host_restore(dst, &h);
+    mmu_remap(dst);
+    mmu_dirty_all(dst);
+}
+
+static void load(struct gb_s *gb, const struct gb_state_s *st, bool share_wram) {
+    struct state_host_s h;
+    state_host_save(&h, gb);
+
+    if (share_wram) {
+        /* Everything but work RAM; VRAM is copied, the PPU reads it directly */
+        memcpy(gb, &st->gb, offsetof(struct gb_s, wram));
+        memcpy(gb->vram, st->gb.vram, sizeof(*gb) - offsetof(struct gb_s, vram));
+    } else {
+        memcpy(gb, &st->gb, sizeof(*gb));
+    }
+
+    state_host_restore(gb, &h);
+
+    if (share_wram) {
+        mmu_share_wram(gb, st->gb.wram);
+    } else {
+        memset(gb->mmu.shared, 0, sizeof(gb->mmu.shared));
+        mmu_remap(gb);
+    }
+    mmu_dirty_all(gb);
+}
+
+void state_load(struct gb_s *gb, const struct gb_state_s *st, uint8_t *cart_ram) {
+    TRACE_SCOPE("state_load");
+
+    load(gb, st, false);
+    if (st->cart_ram && cart_ram) {
+        memcpy(cart_ram, st->cart_ram, st->cart_ram_size);
+    }
+}
+
+void state_load_shared(struct gb_s *gb, const struct gb_state_s *st) {
+    TRACE_SCOPE("state_load_shared");
+
+    load(gb, st, true);
+}
+
+// -------------------------------
+// Hash
+// -------------------------------
+
+static uint64_t fnv(uint64_t h, const void *data, size_t len) {
+    const uint8_t *p = data;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ p[i]) * FNV_PRIME;
+    }
+    return h;
+}
+
+uint64_t state_hash(const struct gb_s *gb, const uint8_t *cart_ram, size_t cart_ram_size) {
+    uint64_t h = FNV_OFFSET;
+
+    /* Field by field: struct padding is not state. The same fields as
+     * hash_fields(); cycle counts and statistics are left out */
+    h = fnv(h, &gb->cpu_reg, sizeof(gb->cpu_reg));
+    uint8_t flags = (uint8_t)(gb->gb_halt | gb->gb_ime << 1 | gb->lcd_blank << 2 |
+                              gb->ime_delay << 3 | gb->halt_bug << 4);
+    h = fnv(h, &flags, 1);
+    h = fnv(h, &gb->selected_rom_bank, sizeof(gb->selected_rom_bank));
+    h = fnv(h, &gb->cart_ram_bank, 1);
+    h = fnv(h, &gb->enable_cart_ram, 1);
+    h = fnv(h, &gb->cart_mode_select, 1);
+    uint16_t line = (uint16_t)gpu_line_cycles(gb), divider = timers_divider(gb);
+    h = fnv(h, &line, sizeof(line));
+    h = fnv(h, &divider, sizeof(divider));
+    h = fnv(h, &gb->counter.serial_count, sizeof(gb->counter.serial_count));
+    h = fnv(h, &gb->display.window_clear, 1);
+    h = fnv(h, &gb->display.WY, 1);
+    for (int wp = 0; wp < WRAM_SIZE >> MMU_PAGE_SHIFT; wp++) {
+        h = fnv(h, mmu_wram_page(gb, wp), 1 << MMU_PAGE_SHIFT);
+    }
+    h = fnv(h, gb->vram, sizeof(gb->vram));
+    h = fnv(h, gb->oam, sizeof(gb->oam));
+    h = fnv(h, gb->hram_io, sizeof(gb->hram_io));
+    if (cart_ram) {
+        h = fnv(h, cart_ram, cart_ram_size);
+    }
+    return h;
+}
+
+// -------------------------------
+// Incremental Hash
+// -------------------------------
+
+static inline uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t lane(uint64_t acc, uint64_t w) {
+    return rotl(acc + w * PRIME2, 31) * PRIME1;
+}
+
+// @len a multiple of 32: four independent multiply chains, then avalanche
+static uint64_t hash_block(const uint8_t *p, size_t len, uint64_t id) {
+    uint64_t a = id + PRIME1 + PRIME2, b = id + PRIME2, c = id, d = id - PRIME1;
+    for (size_t i = 0; i < len; i += 32) {
+        uint64_t w[4];
+        memcpy(w, p + i, sizeof(w));
+        a = lane(a, w[0]);
+        b = lane(b, w[1]);
+        c = lane(c, w[2]);
+        d = lane(d, w[3]);
+    }
+    uint64_t h = rotl(a, 1) + rotl(b, 7) + rotl(c, 12) + rotl(d, 18);
+    h ^= h >> 33;
+    h *= PRIME2;
+    h ^= h >> 29;
+    h *= PRIME3;
+    return h ^ (h >> 32);
+}
+
+// Everything outside the pages that makes up the machine state
+static uint64_t hash_fields(const struct gb_s *gb) {
+    uint8_t f[32] = { 0 };
+    size_t n = sizeof(gb->cpu_reg);
+
+    memcpy(f, &gb->cpu_reg, n);
+    f[n++] = (uint8_t)(gb->gb_halt | gb->gb_ime << 1 | gb->lcd_blank << 2 |
+                       gb->ime_delay << 3 | gb->halt_bug << 4);
+    f[n++] = (uint8_t)gb->selected_rom_bank;
+    f[n++] = (uint8_t)(gb->selected_rom_bank >> 8);
+    f[n++] = gb->cart_ram_bank;
+    f[n++] = gb->enable_cart_ram;
+    f[n++] = gb->cart_mode_select;
+    uint16_t line = (uint16_t)gpu_line_cycles(gb), divider = timers_divider(gb);
+    memcpy(&f[n], &line, 2);       /* Positions, not the cycle count itself */
+    memcpy(&f[n + 2], &divider, 2);
+    memcpy(&f[n + 4], &gb->counter.serial_count, 2);
+    n += 6;
+    f[n++] = gb->display.window_clear;
+    f[n++] = gb->display.WY;
+    return hash_block(f, sizeof(f), ID_FIELDS);
+}
+
+static inline void rehash(struct state_hasher_s *h, int id, const uint8_t *p, size_t len) {
+    uint64_t v = hash_block(p, len, (uint64_t)id);
+    h->pages ^= h->page[id] ^ v;
+    h->page[id] = v;
+}
+
+void state_hasher_init(struct state_hasher_s *h) {
+    memset(h, 0, sizeof(*h));
+    h->cram_pages = -1;
+}
+
+uint64_t state_hash_update(struct state_hasher_s *h, struct gb_s *gb, const uint8_t *const cram[], int cram_pages) {
+    struct mmu_dirty_s d;
+    bool all = h->cram_pages != cram_pages;
+
+    mmu_dirty(gb, &d);
+    mmu_dirty_clear(gb);
+    if (all) {
+        state_hasher_init(h);
+        h->cram_pages = cram_pages;
+    }
+
+    for (int i = 0; i < PAGES; i++) {
+        if (all || mmu_dirty_test(d.page, 0x80 + i)) {
+            rehash(h, ID_VRAM + i, &gb->vram[i << MMU_PAGE_SHIFT], 1 << MMU_PAGE_SHIFT);
+        }
+        if (all || mmu_dirty_test(d.page, 0xC0 + i)) {
+            rehash(h, ID_WRAM + i, mmu_wram_page(gb, i), 1 << MMU_PAGE_SHIFT);
+        }
+    }
+    if (all || mmu_dirty_test(d.page, 0xFE)) {
+        rehash(h, ID_OAM, gb->oam, OAM_SIZE);
+    }
+    rehash(h, ID_IO, gb->hram_io, HRAM_IO_SIZE);
+    for (int i = 0; i < cram_pages; i++) {
+        if (all || mmu_dirty_test(d.cram, (unsigned)i)) {
+            rehash(h, ID_CRAM + i, cram[i], 1 << MMU_PAGE_SHIFT);
+        }
+    }
+
+    return h->pages ^ hash_fields(gb);
+}
+
+uint64_t state_hash_full(const struct gb_s *gb, const uint8_t *const cram[], int cram_pages) {
+    uint64_t h = hash_fields(gb);
+
+    for (int i = 0; i < PAGES; i++) {
+        h ^= hash_block(&gb->vram[i << MMU_PAGE_SHIFT], 1 << MMU_PAGE_SHIFT, ID_VRAM + i);
+        h ^= hash_block(mmu_wram_page(gb, i), 1 << MMU_PAGE_SHIFT, ID_WRAM + i);
+    }
+    h ^= hash_block(gb->oam, OAM_SIZE, ID_OAM);
+    h ^= hash_block(gb->hram_io, HRAM_IO_SIZE, ID_IO);
+    for (int i = 0; i < cram_pages; i++) {
+        h ^= hash_block(cram[i], 1 << MMU_PAGE_SHIFT, ID_CRAM + (uint64_t)i);
+    }
+    return h;
+}
@@ -1,34 +1,28 @@
 /**
  * timers.c - Minimal Timer Implementation
- * 
- * Implements just the DIV register for MVP.
- * Full timer support (TIMA/TMA/TAC) can be added later.
+ *
+ * Implements just the DIV register, derived from the cycle counter (see
+ * timers.h). TIMA/TMA/TAC can be added later the same way: TIMA counts
+ * falling edges of one divider bit, so it too can be computed on read.
  */
 
 #include "timers.h"
-#include "gpu.h"
 
-/**
- * Update timers based on CPU cycles
- * 
- * For MVP, only DIV register is implemented.
- */
-void timers_step(struct gb_s *gb, uint16_t cycles) {
-    /* Update DIV register */
-    gb->counter.div_count += cycles;
-    
-    while (gb->counter.div_count >= DIV_CYCLES) {
-        gb->counter.div_count -= DIV_CYCLES;
-        gb->hram_io[IO_DIV]++;
-    }
-    
-    /* TODO: Implement TIMA/TMA/TAC for games that need it */
+#define DIV_POWER_ON    0xAB    // DIV after the boot ROM
+
+uint8_t timers_read_div(const struct gb_s *gb) {
+    return (uint8_t)(timers_divider(gb) / DIV_CYCLES);
+}
+
+void timers_write_div(struct gb_s *gb, uint8_t val) {
+    (void)val;
+    gb->counter.div_base = gb->counter.cycles;
+}
+
+void timers_set_div(struct gb_s *gb, uint8_t val) {
+    gb->counter.div_base = gb->counter.cycles - (uint64_t)val * DIV_CYCLES;
 }
 
-/**
- * Reset timers to initial state
- */
 void timers_reset(struct gb_s *gb) {
-    gb->counter.div_count = 0;
-    gb->hram_io[IO_DIV] = 0;
-}
\ No newline at end of file
+    timers_set_div(gb, DIV_POWER_ON);
+}
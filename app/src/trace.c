@@ -0,0 +1,213 @@
+/**
+ * trace.c - Chrome/Perfetto Trace Recorder (built with -DGBE_TRACE=ON)
+ *
+ * Producers (any thread calling trace_span()) only touch their own ring:
+ * write the event, then publish it with a release store of 'head'. The
+ * flusher thread reads up to 'head' with an acquire load and hands the slots
+ * back by advancing 'tail'. The registration mutex is taken once per thread
+ * (first event) and by the flusher, never on the per-event path.
+ */
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "trace.h"
+
+struct trace_event_s {
+    const char *name;
+    uint64_t    start_ns;
+    uint64_t    dur_ns;
+};
+
+struct trace_ring_s {
+    struct trace_event_s   events[TRACE_RING_SIZE];
+    _Atomic uint32_t       head;           // Next slot the producer writes
+    _Atomic uint32_t       tail;           // Next slot the flusher reads
+    _Atomic uint64_t       dropped;        // Events lost to a full ring
+    _Atomic(const char *)  name;           // Thread name, NULL until set
+    bool                   name_written;   // Flusher-only
+    uint32_t               tid;
+    struct trace_ring_s   *next;
+};
+
+static FILE *trace_file;
+static pthread_t flusher;
+static atomic_bool active;                  // Spans are recorded while set
+static atomic_bool flusher_stop;
+static uint64_t base_ns;                    // trace_init() time, subtracted from timestamps
+static bool first_record;                   // No comma before the first JSON record
+
+static pthread_mutex_t rings_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct trace_ring_s *rings;          // Rings are kept for the life of the process
+static uint32_t next_tid = 1;
+
+static _Thread_local struct trace_ring_s *thread_ring;
+
+
+// -------------------------------
+// Helper Functions
+// -------------------------------
+
+uint64_t trace_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static struct trace_ring_s *get_ring(void) {
+    if (thread_ring) return thread_ring;
+
+    struct trace_ring_s *ring = calloc(1, sizeof(*ring));
+    if (!ring) return NULL;
+
+    pthread_mutex_lock(&rings_lock);
+    ring->tid = next_tid++;
+    ring->next = rings;
+    rings = ring;
+    pthread_mutex_unlock(&rings_lock);
+
+    thread_ring = ring;
+    return ring;
+}
+
+// Separator before each JSON record in the traceEvents array
+static void begin_record(void) {
+    fputs(first_record ? "\n" : ",\n", trace_file);
+    first_record = false;
+}
+
+// Drain every ring into the file (flusher thread, or shutdown after it stopped)
+static void flush_rings(void) {
+    pid_t pid = getpid();
+
+    pthread_mutex_lock(&rings_lock);
+    for (struct trace_ring_s *ring = rings; ring; ring = ring->next) {
+        const char *name = atomic_load_explicit(&ring->name, memory_order_acquire);
+        if (name && !ring->name_written) {
+            begin_record();
+            fprintf(trace_file,
+                    "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%" PRIu32
+                    ",\"args\":{\"name\":\"%s\"}}", (int)pid, ring->tid, name);
+            ring->name_written = true;
+        }
+
+        uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+        for (; tail != head; tail++) {
+            const struct trace_event_s *ev = &ring->events[tail % TRACE_RING_SIZE];
+            uint64_t ts = ev->start_ns > base_ns ? ev->start_ns - base_ns : 0;
+
+            begin_record();
+            fprintf(trace_file,
+                    "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%" PRIu32
+                    ",\"ts\":%" PRIu64 ".%03u,\"dur\":%" PRIu64 ".%03u}",
+                    ev->name, (int)pid, ring->tid,
+                    ts / 1000, (unsigned)(ts % 1000),
+                    ev->dur_ns / 1000, (unsigned)(ev->dur_ns % 1000));
+        }
+
+        atomic_store_explicit(&ring->tail, tail, memory_order_release);
+    }
+    pthread_mutex_unlock(&rings_lock);
+}
+
+static void *flusher_main(void *arg) {
+    (void)arg;
+    struct timespec period = { .tv_sec = 0, .tv_nsec = TRACE_FLUSH_NS };
+
+    while (!atomic_load(&flusher_stop)) {
+        nanosleep(&period, NULL);
+        flush_rings();
+    }
+
+    return NULL;
+}
+
+
+// -------------------------------
+// Public Interface
+// -------------------------------
+
+bool trace_init(const char *path) {
+    if (atomic_load(&active)) return false;
+
+    trace_file = fopen(path, "w");
+    if (!trace_file) {
+        perror("trace: fopen");
+        return false;
+    }
+
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", trace_file);
+    first_record = true;
+    base_ns = trace_now_ns();
+
+    atomic_store(&flusher_stop, false);
+    if (pthread_create(&flusher, NULL, flusher_main, NULL) != 0) {
+        fprintf(stderr, "trace: failed to start flusher thread\n");
+        fclose(trace_file);
+        trace_file = NULL;
+        return false;
+    }
+
+    atomic_store(&active, true);
+    return true;
+}
+
+void trace_shutdown(void) {
+    if (!atomic_load(&active)) return;
+
+    atomic_store(&active, false);
+    atomic_store(&flusher_stop, true);
+    pthread_join(flusher, NULL);
+
+    /* Pick up whatever was recorded since the last periodic flush */
+    flush_rings();
+    fputs("\n]}\n", trace_file);
+    fclose(trace_file);
+    trace_file = NULL;
+
+    uint64_t dropped = 0;
+    pthread_mutex_lock(&rings_lock);
+    for (struct trace_ring_s *ring = rings; ring; ring = ring->next) {
+        dropped += atomic_load(&ring->dropped);
+    }
+    pthread_mutex_unlock(&rings_lock);
+
+    if (dropped) {
+        fprintf(stderr, "trace: %" PRIu64 " events dropped (ring full)\n", dropped);
+    }
+}
+
+void trace_thread_name(const char *name) {
+    struct trace_ring_s *ring = get_ring();
+    if (ring) atomic_store_explicit(&ring->name, name, memory_order_release);
+}
+
+void trace_span(const char *name, uint64_t start_ns) {
+    if (!atomic_load_explicit(&active, memory_order_relaxed)) return;
+
+    uint64_t end_ns = trace_now_ns();
+    struct trace_ring_s *ring = get_ring();
+    if (!ring) return;
+
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (head - tail >= TRACE_RING_SIZE) {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    struct trace_event_s *ev = &ring->events[head % TRACE_RING_SIZE];
+    ev->name = name;
+    ev->start_ns = start_ns;
+    ev->dur_ns = end_ns - start_ns;
+
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
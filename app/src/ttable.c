@@ -0,0 +1,93 @@
+/**
+ * ttable.c - Transposition Table
+ *
+ * Slot value 0 means empty, so key 0 is stored as 1. Keys come from a
+ * well-mixed hash, so their low bits pick the first slot directly.
+ */
+
+#include "ttable.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#define CACHE_LINE  64
+#define MIN_SLOTS   64
+
+struct ttable_s {
+    _Atomic uint64_t *slot;
+    size_t mask;
+    _Alignas(CACHE_LINE) atomic_size_t count;
+    atomic_size_t dropped;
+};
+
+struct ttable_s *ttable_create(size_t entries) {
+    size_t n = MIN_SLOTS;
+    while (n < entries) n <<= 1;
+
+    struct ttable_s *t = aligned_alloc(CACHE_LINE, sizeof(*t));
+    if (!t) return NULL;
+    t->slot = aligned_alloc(CACHE_LINE, n * sizeof(t->slot[0]));
+    if (!t->slot) {
+        free(t);
+        return NULL;
+    }
+    t->mask = n - 1;
+    ttable_clear(t);
+    return t;
+}
+
+void ttable_destroy(struct ttable_s *t) {
+    if (!t) return;
+    free((void *)t->slot);
+    free(t);
+}
+
+bool ttable_insert(struct ttable_s *t, uint64_t key) {
+    key = key ? key : 1;
+    size_t i = (size_t)key & t->mask;
+
+    for (int p = 0; p < TTABLE_PROBES; p++, i = (i + 1) & t->mask) {
+        uint64_t cur = atomic_load_explicit(&t->slot[i], memory_order_relaxed);
+        if (cur == 0) {
+            /* Claim it; on failure cur is whatever another thread put there */
+            if (atomic_compare_exchange_strong_explicit(&t->slot[i], &cur, key,
+                                                        memory_order_relaxed, memory_order_relaxed)) {
+                atomic_fetch_add_explicit(&t->count, 1, memory_order_relaxed);
+                return false;
+            }
+        }
+        if (cur == key) {
+            return true;
+        }
+    }
+    atomic_fetch_add_explicit(&t->dropped, 1, memory_order_relaxed);
+    return false;
+}
+
+bool ttable_contains(const struct ttable_s *t, uint64_t key) {
+    key = key ? key : 1;
+    size_t i = (size_t)key & t->mask;
+
+    for (int p = 0; p < TTABLE_PROBES; p++, i = (i + 1) & t->mask) {
+        uint64_t cur = atomic_load_explicit(&t->slot[i], memory_order_relaxed);
+        if (cur == key) return true;
+        if (cur == 0) return false;
+    }
+    return false;
+}
+
+size_t ttable_count(const struct ttable_s *t) {
+    return atomic_load_explicit(&t->count, memory_order_relaxed);
+}
+
+size_t ttable_dropped(const struct ttable_s *t) {
+    return atomic_load_explicit(&t->dropped, memory_order_relaxed);
+}
+
+void ttable_clear(struct ttable_s *t) {
+    for (size_t i = 0; i <= t->mask; i++) {
+        atomic_init(&t->slot[i], 0);
+    }
+    atomic_init(&t->count, 0);
+    atomic_init(&t->dropped, 0);
+}
@@ -0,0 +1,439 @@
+/**
+ * bench.c - Headless Frame-Time Benchmark
+ *
+ * Runs a ROM without SDL as fast as possible and reports the distribution
+ * of host time per emulated frame. The worst-case numbers are what matter
+ * for stutter, so compare a normal run against --rt on a loaded system:
+ *
+ *   ./gbe_bench rom/tetris.gb --frames 3600
+ *   sudo ./gbe_bench rom/tetris.gb --frames 3600 --rt --cpu 3
+ *
+ * --perf adds host hardware counters (cycles, instructions, branch and L1D
+ * misses) normalised per frame and per million guest instructions.
+ *
+ * --itrace runs with the instruction trace ring enabled, as the emulator
+ * does by default, to measure its cost on a real ROM.
+ *
+ * --rollback <n> measures the netplay worst case instead: two linked copies
+ * of the machine, a snapshot of both every frame, and after every frame a
+ * rollback that restores the snapshot from n frames back and runs those n
+ * frames again without drawing. Reported times are per rollback; to keep
+ * up, one frame plus one rollback must fit the frame budget.
+ *
+ * --vec <n> [--threads <t>] measures training throughput through gbe.h:
+ * n instances stepped one frame each per gbe_vec_step() call, observations
+ * into one [n x 144 x 160] buffer. Reports time per call and instance-frames
+ * per second; compare --threads 1 to see what the pool buys. --obs <w>x<h>
+ * adds a grayscale observation sink (e.g. 84x84) instead of full frames.
+ * Also reports the memory per instance and the cost of cloning one
+ * (gbe_copy()).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "gb_types.h"
+#include "cpu.h"
+#include "rom.h"
+#include "rt.h"
+#include "perf_counters.h"
+#include "itrace.h"
+#include "memory.h"
+#include "gpu.h"
+#include "netplay.h"
+#include "gbe.h"
+
+#define DEFAULT_FRAMES  3600                // One minute of emulated time
+#define DMG_FRAME_NS    16742706.0          // 70224 cycles at 4.194304 MHz
+
+/* Frame buffer the PPU renders into, so drawing cost is included */
+static uint8_t fb[LCD_HEIGHT][LCD_WIDTH];
+static struct gpu_bg_cache_s bg_cache;
+
+static void lcd_draw_line(struct gb_s *gb, const uint8_t *pixels, uint8_t line) {
+    (void)gb;
+    memcpy(fb[line], pixels, LCD_WIDTH);
+}
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int cmp_i64(const void *a, const void *b) {
+    int64_t x = *(const int64_t *)a;
+    int64_t y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(const int64_t *sorted, uint32_t n, double pct) {
+    uint32_t idx = (uint32_t)(pct / 100.0 * (n - 1) + 0.5);
+    return sorted[idx] / 1e6;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s <rom_file.gb> [--frames <n>] [--rt] [--rt-prio <1-99>] [--cpu <n>] [--perf] [--itrace]\n"
+                    "          [--no-bg-cache] [--rollback <1-%d>] [--vec <n> [--threads <n>] [--obs <w>x<h>]]\n", prog, NETPLAY_MAX_ROLLBACK);
+}
+
+/*
+ * Netplay worst case: every frame is followed by an n-frame rollback.
+ * frame_ns receives the rollback times.
+ */
+static int run_rollback(struct gb_s *gb, uint32_t frames, uint32_t n, int64_t *frame_ns, int64_t *frame_total) {
+    struct gb_s *peer = malloc(sizeof(*peer));
+    struct gb_state_s (*st)[2] = calloc(NETPLAY_HISTORY, sizeof(*st));
+    size_t ram_size;
+    uint8_t *ram = bootloader_cart_ram(&ram_size);
+    struct serial_wire_s wire;
+    int ret = -1;
+
+    if (!peer || !st) goto out;
+    for (int f = 0; f < NETPLAY_HISTORY; f++) {
+        /* The copy shares the bootloader's cart RAM; it is saved once */
+        if (state_init(&st[f][0], ram_size) != 0 || state_init(&st[f][1], 0) != 0) goto out;
+    }
+
+    memcpy(peer, gb, sizeof(*peer));
+    peer->itrace = NULL;
+    peer->display.lcd_draw_line = NULL;
+    peer->display.bg_cache = NULL;
+    mmu_remap(peer);
+    serial_wire_connect(&wire, gb, peer);
+
+    struct gb_s *pair[2] = { gb, peer };
+    uint64_t base = gb->counter.cycles;
+    *frame_total = 0;
+
+    for (uint32_t f = 0; f < frames + n; f++) {
+        int64_t t0 = now_ns();
+        for (int i = 0; i < 2; i++) {
+            state_save(&st[f % NETPLAY_HISTORY][i], pair[i], i == 0 ? ram : NULL);
+        }
+        serial_wire_run(&wire, base + (uint64_t)(f + 1) * LCD_FRAME_CYCLES);
+        int64_t t1 = now_ns();
+        if (f < n) continue;
+
+        /* Back to the start of frame f + 1 - n and through frame f again */
+        uint32_t from = f + 1 - n;
+        gb->display.lcd_draw_line = NULL;
+        for (int i = 0; i < 2; i++) {
+            state_load(pair[i], &st[from % NETPLAY_HISTORY][i], i == 0 ? ram : NULL);
+        }
+        for (uint32_t r = from; r <= f; r++) {
+            for (int i = 0; i < 2; i++) {
+                state_save(&st[r % NETPLAY_HISTORY][i], pair[i], i == 0 ? ram : NULL);
+            }
+            serial_wire_run(&wire, base + (uint64_t)(r + 1) * LCD_FRAME_CYCLES);
+        }
+        gb->display.lcd_draw_line = lcd_draw_line;
+
+        frame_ns[f - n] = now_ns() - t1;
+        *frame_total += t1 - t0;
+    }
+    ret = 0;
+
+out:
+    if (st) {
+        for (int f = 0; f < NETPLAY_HISTORY; f++) {
+            state_free(&st[f][0]);
+            state_free(&st[f][1]);
+        }
+    }
+    free(st);
+    free(peer);
+    gb->link = NULL;
+    return ret;
+}
+
+/*
+ * Training throughput: every call steps all n instances one frame.
+ * frame_ns receives the time per call, bytes the memory per instance and
+ * copy_ns the time to copy one instance over another.
+ */
+static int run_vec(const char *rom_path, uint32_t calls, int n, int threads, const struct gbe_obs_config_s *sink,
+                   int64_t *frame_ns, size_t *bytes, double *copy_ns) {
+    FILE *f = fopen(rom_path, "rb");
+    if (!f) {
+        perror(rom_path);
+        return -1;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *rom = size > 0 ? malloc((size_t)size) : NULL;
+    size_t got = rom ? fread(rom, 1, (size_t)size, f) : 0;
+    fclose(f);
+
+    const char *why = "read failed";
+    struct gbe_vec_s *v = got == (size_t)size ? gbe_vec_create(rom, got, n, threads, &why) : NULL;
+    if (v && sink && gbe_vec_set_obs(v, sink) != 0) {
+        why = "bad --obs size";
+        gbe_vec_destroy(v);
+        v = NULL;
+    }
+    uint8_t *obs = v ? malloc((size_t)n * gbe_vec_obs_bytes(v)) : NULL;
+    uint8_t *actions = malloc((size_t)n);
+    if (!v || !obs || !actions) {
+        fprintf(stderr, "gbe_vec: %s\n", v ? "out of memory" : why);
+        gbe_vec_destroy(v);
+        free(actions);
+        free(obs);
+        free(rom);
+        return -1;
+    }
+
+    /* Varied inputs so the instances diverge */
+    for (uint32_t c = 0; c < calls; c++) {
+        for (int i = 0; i < n; i++) {
+            actions[i] = (uint8_t)~(1u << ((c / 8 + (uint32_t)i) % 8));
+        }
+        int64_t t0 = now_ns();
+        gbe_vec_step(v, actions, 1, obs);
+        frame_ns[c] = now_ns() - t0;
+    }
+
+    /* Clone every instance over its neighbour, a few rounds */
+    const int rounds = 16;
+    *bytes = gbe_size(gbe_vec_env(v, 0));
+    int64_t t0 = now_ns();
+    for (int r = 0; r < rounds; r++) {
+        for (int i = 1; i < n; i++) {
+            gbe_copy(gbe_vec_env(v, i - 1), gbe_vec_env(v, i));
+        }
+    }
+    *copy_ns = n > 1 ? (double)(now_ns() - t0) / (rounds * (n - 1)) : 0.0;
+
+    gbe_vec_destroy(v);
+    free(actions);
+    free(obs);
+    free(rom);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const char *rom_path = argv[1];
+    uint32_t frames = DEFAULT_FRAMES;
+    rt_thread_config_t rt = { .enabled = false, .priority = RT_DEFAULT_PRIO, .cpu = -1 };
+    bool use_perf = false;
+    bool use_itrace = false;
+    bool use_bg_cache = true;
+    uint32_t rollback = 0;
+    int vec = 0;
+    int threads = 0;
+    struct gbe_obs_config_s sink = { .format = GBE_OBS_GRAY, .stack = 1 };
+    struct perf_counters_s perf;
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--rt") == 0) {
+            rt.enabled = true;
+        } else if (strcmp(argv[i], "--rt-prio") == 0 && i + 1 < argc) {
+            rt.priority = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--cpu") == 0 && i + 1 < argc) {
+            rt.cpu = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--perf") == 0) {
+            use_perf = true;
+        } else if (strcmp(argv[i], "--itrace") == 0) {
+            use_itrace = true;
+        } else if (strcmp(argv[i], "--no-bg-cache") == 0) {
+            use_bg_cache = false;
+        } else if (strcmp(argv[i], "--rollback") == 0 && i + 1 < argc) {
+            rollback = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--vec") == 0 && i + 1 < argc) {
+            vec = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--obs") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &sink.width, &sink.height) != 2) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (frames == 0 || rollback > NETPLAY_MAX_ROLLBACK || vec < 0 || threads < 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (vec > 0) {
+        int64_t *call_ns = malloc(frames * sizeof(int64_t));
+        if (!call_ns) {
+            fprintf(stderr, "Out of memory\n");
+            return 1;
+        }
+        printf("Stepping %d instances of %s for %u frames...\n", vec, rom_path, frames);
+
+        size_t bytes = 0;
+        double copy_ns = 0.0;
+        int64_t start = now_ns();
+        int ret = run_vec(rom_path, frames, vec, threads, sink.width ? &sink : NULL, call_ns, &bytes, &copy_ns);
+        int64_t total = now_ns() - start;
+
+        if (ret == 0) {
+            qsort(call_ns, frames, sizeof(int64_t), cmp_i64);
+            char nthreads[16] = "one per CPU";
+            if (threads > 0) snprintf(nthreads, sizeof(nthreads), "%d", threads);
+
+            char output[32] = "160x144 frames";
+            if (sink.width) snprintf(output, sizeof(output), "%dx%d gray", sink.width, sink.height);
+
+            printf("\n=== gbe_vec_step, %d instances, threads: %s, %s (host ms per call) ===\n",
+                   vec, nthreads, output);
+            printf("  calls     : %u\n", frames);
+            printf("  p50       : %.4f\n", percentile(call_ns, frames, 50.0));
+            printf("  p99       : %.4f\n", percentile(call_ns, frames, 99.0));
+            printf("  worst     : %.4f\n", call_ns[frames - 1] / 1e6);
+            printf("  throughput: %.0f instance-frames/s (%.1fx real time per instance)\n",
+                   (double)frames * vec / (total / 1e9), (double)frames * DMG_FRAME_NS / total);
+            printf("  memory    : %.1f KB per instance\n", bytes / 1024.0);
+            if (vec > 1) printf("  gbe_copy  : %.2f us per instance\n", copy_ns / 1e3);
+        }
+        free(call_ns);
+        return ret == 0 ? 0 : 1;
+    }
+
+    struct gb_s *gb = bootloader((char *)rom_path);
+    if (!gb) {
+        fprintf(stderr, "Failed to load ROM: %s\n", rom_path);
+        return 1;
+    }
+    gb->display.lcd_draw_line = lcd_draw_line;
+    gb->direct.joypad = 0xFF;
+    if (use_bg_cache) gpu_bg_cache_attach(gb, &bg_cache);
+
+    if (use_itrace && itrace_init(gb, ITRACE_DEFAULT_ENTRIES) != 0) {
+        fprintf(stderr, "Failed to enable the instruction trace\n");
+        use_itrace = false;
+    }
+
+    int64_t *frame_ns = malloc(frames * sizeof(int64_t));
+    if (!frame_ns) {
+        fprintf(stderr, "Out of memory\n");
+        itrace_free(gb);
+        free(gb);
+        bootloader_cleanup();
+        return 1;
+    }
+
+    /* Real-time mode: lock and pre-fault everything before measuring */
+    if (rt.enabled) {
+        uint32_t mem = rt_lock_memory();
+        rt_prefault(gb, sizeof(*gb));
+        if (gb->itrace) rt_prefault(gb->itrace->ring, (gb->itrace->mask + 1) * sizeof(uint64_t));
+        rt_prefault(frame_ns, frames * sizeof(int64_t));
+        rt_prefault(fb, sizeof(fb));
+        rt_prefault(&bg_cache, sizeof(bg_cache));
+        bootloader_prefault();
+        rt_prefault_stack(256 * 1024);
+
+        uint32_t applied = rt_apply_thread(pthread_self(), &rt);
+        printf("rt: mlockall: %s\n", (mem & RT_MLOCK) ? "yes" : "NO (missing privileges?)");
+        rt_report("bench", &rt, applied);
+    }
+
+    /* Counters are opened after rt_apply_thread() so they follow this thread */
+    if (use_perf && perf_counters_open(&perf) == 0) {
+        use_perf = false;
+    }
+
+    printf("Running %u frames of %s%s...\n", frames, rom_path, use_itrace ? " (instruction trace on)" : "");
+
+    if (rollback > 0) {
+        int64_t frames_total = 0;
+        int ret = run_rollback(gb, frames, rollback, frame_ns, &frames_total);
+
+        if (ret == 0) {
+            double frame_mean = (double)frames_total / frames / 1e6;
+            qsort(frame_ns, frames, sizeof(int64_t), cmp_i64);
+
+            printf("\n=== %u-frame rollback, two linked machines (host ms) ===\n", rollback);
+            printf("  rollbacks : %u\n", frames);
+            printf("  frame     : %.4f mean (both machines, drawing)\n", frame_mean);
+            printf("  p50       : %.4f\n", percentile(frame_ns, frames, 50.0));
+            printf("  p99       : %.4f\n", percentile(frame_ns, frames, 99.0));
+            printf("  worst     : %.4f\n", frame_ns[frames - 1] / 1e6);
+            printf("  headroom  : frame + worst rollback uses %.1f%% of the 16.74 ms budget\n",
+                   100.0 * (frame_mean * 1e6 + frame_ns[frames - 1]) / DMG_FRAME_NS);
+        } else {
+            fprintf(stderr, "Out of memory\n");
+        }
+
+        free(frame_ns);
+        itrace_free(gb);
+        free(gb);
+        bootloader_cleanup();
+        return ret == 0 ? 0 : 1;
+    }
+
+    uint64_t instrs_before = gb->stats.instructions;
+    if (use_perf) perf_counters_start(&perf);
+
+    int64_t start = now_ns();
+    for (uint32_t f = 0; f < frames; f++) {
+        int64_t t0 = now_ns();
+
+        gb->gb_frame = 0;
+        while (!gb->gb_frame) {
+            cpu_step(gb);
+        }
+
+        frame_ns[f] = now_ns() - t0;
+    }
+    int64_t total = now_ns() - start;
+
+    if (use_perf) perf_counters_stop(&perf);
+    uint64_t guest_instrs = gb->stats.instructions - instrs_before;
+
+    /* Report */
+    double mean = (double)total / frames / 1e6;
+    qsort(frame_ns, frames, sizeof(int64_t), cmp_i64);
+
+    printf("\n=== Frame time (host ms per emulated frame) ===\n");
+    printf("  frames    : %u\n", frames);
+    printf("  mean      : %.4f\n", mean);
+    printf("  min       : %.4f\n", frame_ns[0] / 1e6);
+    printf("  p50       : %.4f\n", percentile(frame_ns, frames, 50.0));
+    printf("  p99       : %.4f\n", percentile(frame_ns, frames, 99.0));
+    printf("  p99.9     : %.4f\n", percentile(frame_ns, frames, 99.9));
+    printf("  worst     : %.4f\n", frame_ns[frames - 1] / 1e6);
+    printf("  speed     : %.1f fps (%.0f%% of DMG)\n",
+           frames / (total / 1e9), 100.0 * DMG_FRAME_NS * frames / total);
+    printf("  headroom  : worst frame uses %.1f%% of the 16.74 ms budget\n",
+           100.0 * frame_ns[frames - 1] / DMG_FRAME_NS);
+    printf("  guest ins : %llu (%.2f M/s)\n", (unsigned long long)guest_instrs,
+           guest_instrs / (total / 1e9) / 1e6);
+    if (use_bg_cache) {
+        uint64_t hits = gb->stats.bg_cache_hits, misses = gb->stats.bg_cache_misses;
+        printf("  bg cache  : %.2f%% hit rate (%llu line hits, %llu tile rows redrawn)\n",
+               hits + misses ? 100.0 * hits / (hits + misses) : 0.0,
+               (unsigned long long)hits, (unsigned long long)misses);
+    }
+
+    if (use_perf) {
+        perf_counters_report(&perf, frames, guest_instrs);
+        perf_counters_close(&perf);
+    }
+
+    free(frame_ns);
+    itrace_free(gb);
+    free(gb);
+    bootloader_cleanup();
+
+    return 0;
+}
@@ -0,0 +1,696 @@
+/**
+ * microbench.c - Subsystem Micro-Benchmarks
+ *
+ * Times the core's building blocks in isolation so a regression in a
+ * whole-ROM benchmark can be pinned on one subsystem:
+ *
+ *   mmu.*   mmu_read() / mmu_write() per memory region
+ *   op.*    every valid opcode, one cpu_step() each
+ *   cb.*    every CB-prefixed opcode
+ *   ppu.*   gpu_draw_line() for BG-only, BG + window and 10 sprites per line
+ *   dma.*   OAM DMA from ROM and from WRAM
+ *   dirty.* mmu_dirty() / mmu_dirty_clear(), and WRAM writes interleaved
+ *           with the same write path minus the dirty bitmap's OR; the
+ *           summary prints the OR's cost per write
+ *   hash.*  state hash: incremental after writes to 3 pages (plus OAM DMA
+ *           and the I/O page), and from scratch
+ *   rom.*   whole frames of each synthetic stress ROM (bench/stress_rom.c)
+ *   itrace.* the same frames with the instruction trace ring enabled; the
+ *           summary prints its overhead against interleaved untraced runs
+ *
+ * Like tests/cpu_test.c, everything runs against a synthetic in-memory
+ * ROM, so no ROM file is needed. Each case is repeated (--reps) and
+ * reported as the median ns/op with min and standard deviation across
+ * repetitions. --csv / --json write the full table for comparing runs:
+ *
+ *   ./gbe_microbench --filter ppu --reps 31
+ *   ./gbe_microbench --csv before.csv
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "gb_types.h"
+#include "cpu.h"
+#include "memory.h"
+#include "gpu.h"
+#include "opcodes.h"
+#include "disasm.h"
+#include "itrace.h"
+#include "state.h"
+#include "stress_rom.h"
+
+#define DEFAULT_REPS    15
+#define MAX_REPS        255
+#define MAX_CASES       600
+
+// Operations per repetition, per group (sized for ~1 ms per repetition)
+#define MMU_OPS         65536
+#define CPU_OPS         16384
+#define PPU_OPS         1440        // 10 frames worth of lines
+#define DMA_OPS         2048
+#define HASH_OPS        4096
+#define ROM_OPS         4           // Frames
+#define ROM_WARMUP      10          // Frames run before timing (stress ROM init code)
+
+// Where the synthetic program's pointers aim (WRAM, so (HL)/(BC)/(DE) ops stay cheap and harmless)
+#define SCRATCH_ADDR    0xC000
+#define STACK_ADDR      0xDFF0
+
+/* Synthetic cartridge */
+static uint8_t bench_rom[0x8000];
+static uint8_t bench_ram[0x2000];
+
+/* Sink so the compiler can't drop reads */
+static volatile uint32_t sink;
+
+struct case_s;
+typedef void (*case_fn)(struct gb_s *gb, const struct case_s *c, uint32_t ops);
+
+struct case_s {
+    char      name[32];
+    const char *group;
+    case_fn   fn;
+    uint32_t  ops;          // Operations per repetition
+    uint16_t  addr;         // MMU address / DMA source page
+    uint8_t   opcode;       // CPU opcode (CB opcode for cb.*)
+    uint8_t   lcdc;         // LCDC for ppu.* cases
+    uint8_t   sprites;      // Sprites per line for ppu.* cases
+    uint8_t   kind;         // enum stress_rom_kind for rom.* / itrace.* cases
+    uint8_t   itrace;       // Run with the instruction trace ring enabled
+
+    // Results, ns per operation
+    double    median, mean, stddev, min;
+    double    base_min;     // itrace.*: fastest untraced repetition, interleaved with the traced ones
+                            // dirty.write: fastest write without the bitmap, likewise
+};
+
+static struct case_s cases[MAX_CASES];
+static uint32_t num_cases;
+
+
+// -------------------------------
+// Synthetic Machine
+// -------------------------------
+
+static uint8_t rom_read(struct gb_s *gb, uint32_t addr) {
+    (void)gb;
+    return addr < sizeof(bench_rom) ? bench_rom[addr] : 0xFF;
+}
+
+static uint8_t cart_ram_read(struct gb_s *gb, uint32_t addr) {
+    (void)gb;
+    return addr < sizeof(bench_ram) ? bench_ram[addr] : 0xFF;
+}
+
+static void cart_ram_write(struct gb_s *gb, uint32_t addr, uint8_t val) {
+    (void)gb;
+    if (addr < sizeof(bench_ram)) bench_ram[addr] = val;
+}
+
+static void error_handler(struct gb_s *gb, enum gb_error_e error, uint16_t addr) {
+    (void)gb; (void)error; (void)addr;
+}
+
+static void lcd_draw_line(struct gb_s *gb, const uint8_t *pixels, uint8_t line) {
+    (void)gb;
+    sink += pixels[line % LCD_WIDTH];
+}
+
+static void machine_init(struct gb_s *gb) {
+    memset(gb, 0, sizeof(*gb));
+    gb->gb_rom_read = rom_read;
+    gb->gb_cart_ram_read = cart_ram_read;
+    gb->gb_cart_ram_write = cart_ram_write;
+    gb->gb_error = error_handler;
+
+    mmu_init(gb);
+    cpu_init(gb);
+
+    /* MBC1 with RAM enabled, so the cart RAM path is exercised */
+    gb->mbc = 1;
+    gb->cart_ram = 1;
+    gb->enable_cart_ram = 1;
+    gb->num_rom_banks_mask = 1;
+    gb->num_ram_banks = 1;
+    gb->selected_rom_bank = 1;
+
+    /* No interrupts: EI/RETI must not divert the benchmarked instruction */
+    gb->gb_ime = false;
+    gb->hram_io[IO_IE] = 0x00;
+    gb->hram_io[IO_IF] = 0x00;
+    cpu_irq_update(gb);
+    gb->display.lcd_draw_line = NULL;
+}
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+// -------------------------------
+// Benchmark Bodies
+// -------------------------------
+
+static void run_mmu_read(struct gb_s *gb, const struct case_s *c, uint32_t ops) {
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < ops; i++) {
+        acc += mmu_read(gb, (uint16_t)(c->addr + (i & 0x3F)));
+    }
+    sink += acc;
+}
+
+static void run_mmu_write(struct gb_s *gb, const struct case_s *c, uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        mmu_write(gb, (uint16_t)(c->addr + (i & 0x3F)), (uint8_t)i);
+    }
+}
+
+// One instruction per cpu_step(), re-executed from 0x0100 with fixed register state
+static void run_opcode(struct gb_s *gb, const struct case_s *c, uint32_t ops) {
+    (void)c;
+    for (uint32_t i = 0; i < ops; i++) {
+        gb->cpu_reg.pc.reg = 0x0100;
+        gb->cpu_reg.sp.reg = STACK_ADDR;
+        gb->cpu_reg.hl.reg = SCRATCH_ADDR;
+        gb->cpu_reg.bc.reg = SCRATCH_ADDR;
+        gb->cpu_reg.de.reg = SCRATCH_ADDR;
+        gb->gb_ime = false;
+        gb->gb_halt = false;
+        sink += cpu_step(gb);
+    }
+}
+
+static void run_ppu(struct gb_s *gb, const struct case_s *c, uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        uint8_t ly = (uint8_t)(i % LCD_HEIGHT);
+        gb->hram_io[IO_LY] = ly;
+        if (ly == 0) gb->display.window_clear = 0;
+
+        /* Keep the first 'sprites' objects on the current line (the rest stay hidden) */
+        for (uint32_t s = 0; s < c->sprites; s++) {
+            gb->oam[4 * s + 0] = (uint8_t)(ly + 16);
+        }
+
+        gpu_draw_line(gb);
+    }
+}
+
+static void run_rom_frames(struct gb_s *gb, const struct case_s *c, uint32_t ops) {
+    (void)c;
+    for (uint32_t i = 0; i < ops; i++) {
+        gb->gb_frame = 0;
+        while (!gb->gb_frame) {
+            cpu_step(gb);
+        }
+    }
+}
+
+static void run_dma(struct gb_s *gb, const struct case_s *c, uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        mmu_dma_transfer(gb, (uint8_t)c->addr);
+    }
+    sink += gb->oam[0];
+}
+
+// mmu_write() without the dirty bitmap, out of line like the real one
+__attribute__((noinline)) static void bare_write(struct gb_s *gb, uint16_t addr, uint8_t val) {
+    uint8_t *page = gb->mmu.wr[addr >> MMU_PAGE_SHIFT];
+    if (page) {
+        page[addr & 0xFF] = val;
+        return;
+    }
+    mmu_write(gb, addr, val);
+}
+
+static void run_bare_write(struct gb_s *gb, const struct case_s *c, uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        bare_write(gb, (uint16_t)(c->addr + (i & 0x3F)), (uint8_t)i);
+    }
+}
+
+static void run_dirty_write(struct gb_s *gb, const struct case_s *c, uint32_t ops) {
+    run_mmu_write(gb, c, ops);
+}
+
+static void run_dirty_query(struct gb_s *gb, const struct case_s *c, uint32_t ops) {
+    (void)c;
+    struct mmu_dirty_s d;
+    for (uint32_t i = 0; i < ops; i++) {
+        mmu_write(gb, (uint16_t)(0xC000 + (i & 0x1FFF)), (uint8_t)i);
+        mmu_dirty(gb, &d);
+        sink += (uint32_t)d.page[3];
+    }
+}
+
+// Like a frame of a typical game: a few WRAM variables, the OAM shadow, DMA
+static void run_hash_incremental(struct gb_s *gb, const struct case_s *c, uint32_t ops) {
+    (void)c;
+    static struct state_hasher_s h;
+    const uint8_t *cram[1] = { bench_ram };
+    state_hasher_init(&h);
+    for (uint32_t i = 0; i < ops; i++) {
+        mmu_write(gb, 0xC010, (uint8_t)i);
+        mmu_write(gb, 0xC123, (uint8_t)(i >> 3));
+        mmu_write(gb, 0xC200 + (i & 0xFF), (uint8_t)i);
+        mmu_dma_transfer(gb, 0xC2);
+        sink += (uint32_t)state_hash_update(&h, gb, cram, 1);
+    }
+}
+
+static void run_hash_full(struct gb_s *gb, const struct case_s *c, uint32_t ops) {
+    (void)c;
+    const uint8_t *cram[1] = { bench_ram };
+    for (uint32_t i = 0; i < ops; i++) {
+        sink += (uint32_t)state_hash_full(gb, cram, 1);
+    }
+}
+
+static void run_dirty_clear(struct gb_s *gb, const struct case_s *c, uint32_t ops) {
+    (void)c;
+    for (uint32_t i = 0; i < ops; i++) {
+        mmu_write(gb, (uint16_t)(0xC000 + (i & 0x1FFF)), (uint8_t)i);
+        mmu_dirty_clear(gb);
+    }
+    sink += (uint32_t)gb->mmu.dirty[3];
+}
+
+
+// -------------------------------
+// Case Setup
+// -------------------------------
+
+static void prepare_opcode(struct gb_s *gb, const struct case_s *c) {
+    (void)gb;
+    uint8_t *p = &bench_rom[0x0100];
+
+    /* Immediate operands point at WRAM (a16 = 0xC000, a8 = 0x00, e8 = 0) */
+    if (strncmp(c->name, "cb.", 3) == 0) {
+        p[0] = 0xCB;
+        p[1] = c->opcode;
+    } else {
+        p[0] = c->opcode;
+        p[1] = (uint8_t)(SCRATCH_ADDR & 0xFF);
+        p[2] = (uint8_t)(SCRATCH_ADDR >> 8);
+    }
+}
+
+static void prepare_ppu(struct gb_s *gb, const struct case_s *c) {
+    /* Every tile gets a distinct, non-trivial pattern */
+    for (uint32_t i = 0; i < 0x1800; i++) {
+        gb->vram[i] = (uint8_t)(i * 37 + (i >> 4));
+    }
+    for (uint32_t i = 0x1800; i < VRAM_SIZE; i++) {
+        gb->vram[i] = (uint8_t)i;
+    }
+
+    mmu_write(gb, 0xFF00 + IO_BGP, 0xE4);
+    mmu_write(gb, 0xFF00 + IO_OBP0, 0xE4);
+    mmu_write(gb, 0xFF00 + IO_OBP1, 0x1B);
+    gb->hram_io[IO_LCDC] = c->lcdc;
+    gb->hram_io[IO_SCX] = 3;
+    gb->hram_io[IO_SCY] = 5;
+    gb->hram_io[IO_WX] = 7 + 40;
+    gb->hram_io[IO_WY] = 0;
+    gb->display.WY = 0;
+
+    /* Spread the visible sprites across the line; run_ppu() sets their Y */
+    memset(gb->oam, 0, OAM_SIZE);
+    for (uint32_t s = 0; s < c->sprites; s++) {
+        gb->oam[4 * s + 1] = (uint8_t)(8 + s * 16);         // X
+        gb->oam[4 * s + 2] = (uint8_t)s;                    // Tile
+        gb->oam[4 * s + 3] = (s & 1) ? (OBJ_FLIP_X | OBJ_PALETTE) : 0;
+    }
+
+    gb->display.lcd_draw_line = lcd_draw_line;
+}
+
+static void add_case(const char *name, const char *group, case_fn fn, uint32_t ops) {
+    if (num_cases >= MAX_CASES) return;
+
+    struct case_s *c = &cases[num_cases++];
+    memset(c, 0, sizeof(*c));
+    snprintf(c->name, sizeof(c->name), "%s", name);
+    c->group = group;
+    c->fn = fn;
+    c->ops = ops;
+}
+
+// Opcodes with no instruction on the SM83 (they lock up real hardware)
+static void build_cases(void) {
+    static const struct { const char *name; uint16_t addr; } regions[] = {
+        { "rom0",  0x0150 },
+        { "romx",  0x4150 },
+        { "vram",  0x8100 },
+        { "cram",  0xA100 },
+        { "wram",  0xC100 },
+        { "echo",  0xE100 },
+        { "oam",   0xFE10 },
+        { "io",    0xFF40 },
+        { "hram",  0xFF90 },
+    };
+    char name[32];
+
+    for (size_t i = 0; i < sizeof(regions) / sizeof(regions[0]); i++) {
+        snprintf(name, sizeof(name), "mmu.read.%s", regions[i].name);
+        add_case(name, "mmu", run_mmu_read, MMU_OPS);
+        cases[num_cases - 1].addr = regions[i].addr;
+
+        /* Writes to ROM are MBC register writes; keep them, they are a real path */
+        snprintf(name, sizeof(name), "mmu.write.%s", regions[i].name);
+        add_case(name, "mmu", run_mmu_write, MMU_OPS);
+        cases[num_cases - 1].addr = regions[i].addr == 0x0150 ? 0x2000 : regions[i].addr;
+    }
+
+    for (uint32_t op = 0; op < 0x100; op++) {
+        if (op == 0xCB || (gb_opcodes[op].access & OPF_INVALID)) continue;
+        snprintf(name, sizeof(name), "op.%02X", op);
+        add_case(name, "cpu", run_opcode, CPU_OPS);
+        cases[num_cases - 1].opcode = (uint8_t)op;
+    }
+
+    for (uint32_t op = 0; op < 0x100; op++) {
+        snprintf(name, sizeof(name), "cb.%02X", op);
+        add_case(name, "cb", run_opcode, CPU_OPS);
+        cases[num_cases - 1].opcode = (uint8_t)op;
+    }
+
+    add_case("ppu.bg", "ppu", run_ppu, PPU_OPS);
+    cases[num_cases - 1].lcdc = LCDC_ENABLE | LCDC_TILE_SELECT | LCDC_BG_ENABLE;
+
+    add_case("ppu.bg_window", "ppu", run_ppu, PPU_OPS);
+    cases[num_cases - 1].lcdc = LCDC_ENABLE | LCDC_WINDOW_ENABLE | LCDC_WINDOW_MAP |
+                                LCDC_TILE_SELECT | LCDC_BG_ENABLE;
+
+    add_case("ppu.bg_sprites10", "ppu", run_ppu, PPU_OPS);
+    cases[num_cases - 1].lcdc = LCDC_ENABLE | LCDC_TILE_SELECT | LCDC_OBJ_ENABLE | LCDC_BG_ENABLE;
+    cases[num_cases - 1].sprites = MAX_SPRITES_LINE;
+
+    add_case("dma.from_rom", "dma", run_dma, DMA_OPS);
+    cases[num_cases - 1].addr = 0x01;
+
+    add_case("dma.from_wram", "dma", run_dma, DMA_OPS);
+    cases[num_cases - 1].addr = 0xC0;
+
+    add_case("dirty.write", "dirty", run_dirty_write, MMU_OPS);
+    cases[num_cases - 1].addr = 0xC100;
+    add_case("dirty.query", "dirty", run_dirty_query, MMU_OPS);
+    add_case("dirty.clear", "dirty", run_dirty_clear, MMU_OPS);
+
+    add_case("hash.incremental", "hash", run_hash_incremental, HASH_OPS);
+    add_case("hash.full", "hash", run_hash_full, HASH_OPS / 16);
+
+    for (int k = 0; k < STRESS_NUM_KINDS; k++) {
+        snprintf(name, sizeof(name), "rom.%s", stress_rom_name((enum stress_rom_kind)k));
+        add_case(name, "rom", run_rom_frames, ROM_OPS);
+        cases[num_cases - 1].kind = (uint8_t)k;
+
+        snprintf(name, sizeof(name), "itrace.%s", stress_rom_name((enum stress_rom_kind)k));
+        add_case(name, "itrace", run_rom_frames, ROM_OPS);
+        cases[num_cases - 1].kind = (uint8_t)k;
+        cases[num_cases - 1].itrace = 1;
+    }
+}
+
+
+// -------------------------------
+// Measurement and Reporting
+// -------------------------------
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void attach_rom(struct gb_s *gb, const struct case_s *c, const uint8_t *rom, size_t size, int itrace) {
+    stress_rom_attach(gb, rom, size);
+    gb->display.lcd_draw_line = lcd_draw_line;
+    gb->direct.joypad = 0xFF;
+    if (itrace && itrace_init(gb, ITRACE_DEFAULT_ENTRIES) != 0) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    run_rom_frames(gb, c, ROM_WARMUP);
+}
+
+static void measure(struct case_s *c, uint32_t reps) {
+    struct gb_s *gb = malloc(sizeof(struct gb_s));
+    struct gb_s *base = NULL;
+    uint8_t *rom = NULL;
+    double samples[MAX_REPS];
+
+    if (!gb) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+
+    if (c->fn == run_rom_frames) {
+        size_t size = stress_rom_build((enum stress_rom_kind)c->kind, &rom);
+        attach_rom(gb, c, rom, size, c->itrace);
+
+        /* Trace overhead is a few percent: time an untraced twin in between */
+        if (c->itrace) {
+            base = malloc(sizeof(struct gb_s));
+            if (!base) {
+                fprintf(stderr, "Out of memory\n");
+                exit(1);
+            }
+            attach_rom(base, c, rom, size, 0);
+            c->base_min = INFINITY;
+        }
+    } else {
+        machine_init(gb);
+    }
+    if (c->fn == run_dirty_write) c->base_min = INFINITY;
+    if (c->fn == run_opcode) prepare_opcode(gb, c);
+    if (c->fn == run_ppu) prepare_ppu(gb, c);
+
+    /* Warm-up: caches, branch predictors, page faults */
+    c->fn(gb, c, c->ops);
+
+    for (uint32_t r = 0; r < reps; r++) {
+        if (base) {
+            int64_t t0 = now_ns();
+            c->fn(base, c, c->ops);
+            c->base_min = fmin(c->base_min, (double)(now_ns() - t0) / c->ops);
+        }
+        if (c->fn == run_dirty_write) {
+            int64_t t0 = now_ns();
+            run_bare_write(gb, c, c->ops);
+            c->base_min = fmin(c->base_min, (double)(now_ns() - t0) / c->ops);
+        }
+
+        int64_t t0 = now_ns();
+        c->fn(gb, c, c->ops);
+        samples[r] = (double)(now_ns() - t0) / c->ops;
+    }
+
+    double sum = 0.0, sq = 0.0;
+    for (uint32_t r = 0; r < reps; r++) sum += samples[r];
+    c->mean = sum / reps;
+    for (uint32_t r = 0; r < reps; r++) sq += (samples[r] - c->mean) * (samples[r] - c->mean);
+    c->stddev = reps > 1 ? sqrt(sq / (reps - 1)) : 0.0;
+
+    qsort(samples, reps, sizeof(double), cmp_double);
+    c->min = samples[0];
+    c->median = samples[reps / 2];
+
+    itrace_free(gb);
+    free(gb);
+    free(base);
+    free(rom);
+}
+
+static void print_group_summary(const char *group) {
+    uint32_t n = 0;
+    double sum = 0.0;
+    const struct case_s *slowest[5] = { 0 };
+
+    for (uint32_t i = 0; i < num_cases; i++) {
+        const struct case_s *c = &cases[i];
+        if (strcmp(c->group, group) != 0 || c->median == 0.0) continue;
+
+        n++;
+        sum += c->median;
+        for (int k = 0; k < 5; k++) {
+            if (!slowest[k] || c->median > slowest[k]->median) {
+                memmove(&slowest[k + 1], &slowest[k], (4 - k) * sizeof(slowest[0]));
+                slowest[k] = c;
+                break;
+            }
+        }
+    }
+    if (n == 0) return;
+
+    printf("  %-20s %4u opcodes, mean of medians %7.2f ns; slowest:", group, n, sum / n);
+    for (int k = 0; k < 5 && slowest[k]; k++) {
+        printf(" %s %.1f", slowest[k]->name, slowest[k]->median);
+    }
+    printf("\n");
+}
+
+/*
+ * Instruction trace cost. Each itrace.* repetition is interleaved with an
+ * untraced run of the same ROM and the fastest of each is compared, since
+ * medians of separately measured cases drift more than the overhead itself.
+ */
+static void print_itrace_overhead(void) {
+    int header = 0;
+
+    for (uint32_t i = 0; i < num_cases; i++) {
+        const struct case_s *c = &cases[i];
+        if (!c->itrace || c->median == 0.0) continue;
+
+        if (!header) {
+            printf("\nInstruction trace overhead (traced vs untraced, fastest repetition):\n");
+            header = 1;
+        }
+        printf("  %-20s %+6.1f%%\n", stress_rom_name((enum stress_rom_kind)c->kind),
+               100.0 * (c->min - c->base_min) / c->base_min);
+    }
+}
+
+/* Dirty bitmap cost on the write path, measured the same way */
+static void print_dirty_overhead(void) {
+    for (uint32_t i = 0; i < num_cases; i++) {
+        const struct case_s *c = &cases[i];
+        if (c->fn != run_dirty_write || c->median == 0.0) continue;
+
+        printf("\nDirty tracking: WRAM write %.2f ns, %.2f ns without the bitmap (%+.2f ns, fastest repetition)\n",
+               c->min, c->base_min, c->min - c->base_min);
+    }
+}
+
+static void print_report(int verbose) {
+    printf("\n%-22s %10s %10s %10s\n", "case", "median ns", "min ns", "stddev");
+    for (uint32_t i = 0; i < num_cases; i++) {
+        const struct case_s *c = &cases[i];
+        if (c->median == 0.0) continue;
+
+        /* Opcode rows are summarised unless asked for */
+        int is_op = strcmp(c->group, "cpu") == 0 || strcmp(c->group, "cb") == 0;
+        if (is_op && !verbose) continue;
+
+        printf("%-22s %10.2f %10.2f %10.2f", c->name, c->median, c->min, c->stddev);
+        if (strcmp(c->group, "cpu") == 0) {
+            printf("  %s", gb_opcode_name(c->opcode, 0, 0));
+        } else if (strcmp(c->group, "cb") == 0) {
+            printf("  %s", gb_opcode_name(0xCB, c->opcode, 1));
+        }
+        printf("\n");
+    }
+
+    if (!verbose) {
+        printf("\nOpcodes (--verbose for every opcode):\n");
+        print_group_summary("cpu");
+        print_group_summary("cb");
+    }
+
+    print_itrace_overhead();
+    print_dirty_overhead();
+}
+
+static int write_csv(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+
+    fprintf(f, "case,group,ops,median_ns,mean_ns,min_ns,stddev_ns\n");
+    for (uint32_t i = 0; i < num_cases; i++) {
+        const struct case_s *c = &cases[i];
+        if (c->median == 0.0) continue;
+        fprintf(f, "%s,%s,%u,%.3f,%.3f,%.3f,%.3f\n",
+                c->name, c->group, c->ops, c->median, c->mean, c->min, c->stddev);
+    }
+
+    fclose(f);
+    return 0;
+}
+
+static int write_json(const char *path, uint32_t reps) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+
+    fprintf(f, "{\n  \"reps\": %u,\n  \"cases\": [", reps);
+    const char *sep = "\n";
+    for (uint32_t i = 0; i < num_cases; i++) {
+        const struct case_s *c = &cases[i];
+        if (c->median == 0.0) continue;
+        fprintf(f, "%s    {\"case\": \"%s\", \"group\": \"%s\", \"ops\": %u, \"median_ns\": %.3f, "
+                   "\"mean_ns\": %.3f, \"min_ns\": %.3f, \"stddev_ns\": %.3f}",
+                sep, c->name, c->group, c->ops, c->median, c->mean, c->min, c->stddev);
+        sep = ",\n";
+    }
+    fprintf(f, "\n  ]\n}\n");
+
+    fclose(f);
+    return 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [--filter <prefix>] [--reps <n>] [--csv <file>] [--json <file>] [--verbose]\n", prog);
+}
+
+int main(int argc, char **argv) {
+    const char *filter = NULL;
+    const char *csv_path = NULL;
+    const char *json_path = NULL;
+    uint32_t reps = DEFAULT_REPS;
+    int verbose = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) {
+            reps = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            csv_path = argv[++i];
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "--verbose") == 0) {
+            verbose = 1;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (reps == 0 || reps > MAX_REPS) {
+        fprintf(stderr, "--reps must be 1..%d\n", MAX_REPS);
+        return 1;
+    }
+
+    build_cases();
+
+    uint32_t run = 0;
+    for (uint32_t i = 0; i < num_cases; i++) {
+        if (filter && strncmp(cases[i].name, filter, strlen(filter)) != 0) continue;
+        measure(&cases[i], reps);
+        run++;
+    }
+
+    if (run == 0) {
+        fprintf(stderr, "No cases match '%s'\n", filter);
+        return 1;
+    }
+
+    printf("%u cases, %u repetitions each\n", run, reps);
+    print_report(verbose);
+
+    if (csv_path && write_csv(csv_path) == 0) printf("\nWrote %s\n", csv_path);
+    if (json_path && write_json(json_path, reps) == 0) printf("Wrote %s\n", json_path);
+
+    return 0;
+}
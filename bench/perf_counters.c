@@ -0,0 +1,143 @@
+/**
+ * perf_counters.c - Linux Hardware Performance Counters for Benchmarks
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "perf_counters.h"
+
+struct counter_desc_s {
+    const char *name;
+    uint32_t    type;
+    uint64_t    config;
+};
+
+static const struct counter_desc_s COUNTERS[PERF_NUM_COUNTERS] = {
+    [PERF_CYCLES]        = { "cycles",        PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    [PERF_INSTRUCTIONS]  = { "instructions",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    [PERF_BRANCH_MISSES] = { "branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    [PERF_L1D_MISSES]    = { "L1d-misses",    PERF_TYPE_HW_CACHE,
+                             PERF_COUNT_HW_CACHE_L1D |
+                             (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+};
+
+// Layout of read() with PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING
+struct read_format_s {
+    uint64_t value;
+    uint64_t time_enabled;
+    uint64_t time_running;
+};
+
+static int open_counter(const struct counter_desc_s *desc) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = desc->type;
+    attr.config = desc->config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;        // Allowed at perf_event_paranoid <= 2
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    /* This thread, any CPU, no group */
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+int perf_counters_open(struct perf_counters_s *pc) {
+    int opened = 0;
+    int first_errno = 0;
+
+    memset(pc, 0, sizeof(*pc));
+
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+        pc->fd[i] = open_counter(&COUNTERS[i]);
+        if (pc->fd[i] >= 0) {
+            opened++;
+        } else if (!first_errno) {
+            first_errno = errno;
+        }
+    }
+
+    if (opened == 0) {
+        fprintf(stderr, "perf: no hardware counters available (%s)%s\n", strerror(first_errno),
+                (first_errno == EACCES || first_errno == EPERM)
+                    ? "; try: sudo sysctl kernel.perf_event_paranoid=2" : "");
+    }
+
+    return opened;
+}
+
+void perf_counters_start(struct perf_counters_s *pc) {
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+        if (pc->fd[i] < 0) continue;
+        ioctl(pc->fd[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(pc->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+void perf_counters_stop(struct perf_counters_s *pc) {
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+        if (pc->fd[i] >= 0) ioctl(pc->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+    }
+
+    pc->multiplexed = false;
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+        struct read_format_s rf;
+        pc->value[i] = 0;
+
+        if (pc->fd[i] < 0) continue;
+        if (read(pc->fd[i], &rf, sizeof(rf)) != (ssize_t)sizeof(rf)) continue;
+
+        /* Scale up if the PMU had to time-share counters */
+        if (rf.time_running && rf.time_running < rf.time_enabled) {
+            pc->value[i] = (uint64_t)((double)rf.value * rf.time_enabled / rf.time_running);
+            pc->multiplexed = true;
+        } else {
+            pc->value[i] = rf.value;
+        }
+    }
+}
+
+void perf_counters_report(const struct perf_counters_s *pc, uint64_t frames, uint64_t guest_instrs) {
+    double per_minstr = guest_instrs ? 1e6 / (double)guest_instrs : 0.0;
+
+    printf("\n=== Host hardware counters ===\n");
+    printf("  %-14s %16s %14s %16s\n", "counter", "total", "per frame", "per M guest ins");
+
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+        if (pc->fd[i] < 0) {
+            printf("  %-14s %16s\n", COUNTERS[i].name, "n/a");
+            continue;
+        }
+        printf("  %-14s %16llu %14.1f %16.1f\n", COUNTERS[i].name,
+               (unsigned long long)pc->value[i],
+               frames ? (double)pc->value[i] / frames : 0.0,
+               pc->value[i] * per_minstr);
+    }
+
+    if (pc->fd[PERF_CYCLES] >= 0 && pc->fd[PERF_INSTRUCTIONS] >= 0 && pc->value[PERF_CYCLES]) {
+        printf("  host IPC       : %.2f\n",
+               (double)pc->value[PERF_INSTRUCTIONS] / pc->value[PERF_CYCLES]);
+    }
+    if (pc->fd[PERF_INSTRUCTIONS] >= 0 && guest_instrs) {
+        printf("  host ins/guest : %.1f\n", (double)pc->value[PERF_INSTRUCTIONS] / guest_instrs);
+    }
+    if (pc->multiplexed) {
+        printf("  (some counters were multiplexed and scaled)\n");
+    }
+}
+
+void perf_counters_close(struct perf_counters_s *pc) {
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+        if (pc->fd[i] >= 0) close(pc->fd[i]);
+        pc->fd[i] = -1;
+    }
+}
@@ -0,0 +1,63 @@
+/**
+ * perf_counters.h - Linux Hardware Performance Counters for Benchmarks
+ *
+ * Thin wrapper over perf_event_open(2) counting host cycles, instructions,
+ * branch misses and L1D read misses for the calling thread. Each counter is
+ * opened on its own, so a PMU that lacks one event (or a kernel that refuses
+ * all of them: perf_event_paranoid, containers, no PMU in the VM) simply
+ * leaves that counter unavailable instead of failing the benchmark.
+ */
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+enum perf_counter_id {
+    PERF_CYCLES = 0,
+    PERF_INSTRUCTIONS,
+    PERF_BRANCH_MISSES,
+    PERF_L1D_MISSES,
+    PERF_NUM_COUNTERS
+};
+
+struct perf_counters_s {
+    int      fd[PERF_NUM_COUNTERS];         // -1 when the counter is unavailable
+    uint64_t value[PERF_NUM_COUNTERS];      // Scaled counts after perf_counters_stop()
+    bool     multiplexed;                   // At least one counter was scaled
+};
+
+/**
+ * Open all counters (disabled) for the calling thread
+ *
+ * @param pc    Counter set
+ * @return      Number of counters that could be opened (0 = none available)
+ */
+int perf_counters_open(struct perf_counters_s *pc);
+
+/**
+ * Reset and enable every available counter
+ */
+void perf_counters_start(struct perf_counters_s *pc);
+
+/**
+ * Disable the counters and read them into pc->value
+ */
+void perf_counters_stop(struct perf_counters_s *pc);
+
+/**
+ * Print the counts per emulated frame and per million guest instructions
+ *
+ * @param pc            Counter set, after perf_counters_stop()
+ * @param frames        Emulated frames in the measured region
+ * @param guest_instrs  Game Boy instructions executed in the measured region
+ */
+void perf_counters_report(const struct perf_counters_s *pc, uint64_t frames, uint64_t guest_instrs);
+
+/**
+ * Close all counters
+ */
+void perf_counters_close(struct perf_counters_s *pc);
+
+#endif // PERF_COUNTERS_H
@@ -0,0 +1,481 @@
+/**
+ * stress_rom.c - Synthetic Stress-ROM Generator
+ *
+ * Each ROM is: header, a common init block (palettes, tile data, BG map,
+ * OAM cleared, LCD on) and one workload loop. The code is emitted byte by
+ * byte through a tiny assembler; every line carries the mnemonic.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "stress_rom.h"
+#include "memory.h"
+#include "cpu.h"
+
+#define STRESS_ROM_BANKS    8           // mbc1 ROM: 8 x 16 KB = 128 KB
+#define STRESS_RAM_BANKS    4           // mbc1 RAM: 4 x 8 KB = 32 KB
+
+#define CODE_START          0x0150      // Right after the header
+#define DATA_START          0x3000      // Tables copied to WRAM / HRAM by the init code
+#define HRAM_DMA            0xFF80      // OAM DMA routine copied into HRAM
+
+// LCDC values used by the workloads
+#define LCDC_BG_ONLY        (LCDC_ENABLE | LCDC_TILE_SELECT | LCDC_BG_ENABLE)
+#define LCDC_BG_WINDOW      (LCDC_BG_ONLY | LCDC_WINDOW_ENABLE | LCDC_WINDOW_MAP)
+#define LCDC_BG_OBJ16       (LCDC_BG_ONLY | LCDC_OBJ_SIZE | LCDC_OBJ_ENABLE)
+
+static const char *const KIND_NAMES[STRESS_NUM_KINDS] = {
+    [STRESS_SPRITES]  = "sprites",
+    [STRESS_MIDLINE]  = "midline",
+    [STRESS_WINDOW]   = "window",
+    [STRESS_MBC1]     = "mbc1",
+    [STRESS_HALT]     = "halt",
+    [STRESS_BUSYWAIT] = "busywait",
+};
+
+static const uint8_t NINTENDO_LOGO[48] = {
+    0xCE, 0xED, 0x66, 0x66, 0xCC, 0x0D, 0x00, 0x0B,
+    0x03, 0x73, 0x00, 0x83, 0x00, 0x0C, 0x00, 0x0D,
+    0x00, 0x08, 0x11, 0x1F, 0x88, 0x89, 0x00, 0x0E,
+    0xDC, 0xCC, 0x6E, 0xE6, 0xDD, 0xDD, 0xD9, 0x99,
+    0xBB, 0xBB, 0x67, 0x63, 0x6E, 0x0E, 0xEC, 0xCC,
+    0xDD, 0xDC, 0x99, 0x9F, 0xBB, 0xB9, 0x33, 0x3E
+};
+
+// OAM DMA routine (runs from HRAM on real hardware): LDH (DMA),A then wait 160 us
+static const uint8_t DMA_ROUTINE[] = {
+    0xE0, 0x46,         // LDH (DMA),A
+    0x3E, 0x28,         // LD A,40
+    0x3D,               // wait: DEC A
+    0x20, 0xFD,         // JR NZ,wait
+    0xC9,               // RET
+};
+
+/* Cartridge attached by stress_rom_attach() */
+static const uint8_t *attached_rom;
+static size_t attached_size;
+static uint8_t attached_ram[STRESS_RAM_BANKS * CRAM_BANK_SIZE];
+static uint32_t error_count;
+
+
+// -------------------------------
+// Assembler
+// -------------------------------
+
+struct sasm_s {
+    uint8_t *rom;
+    size_t   size;
+    uint32_t pc;        // Offset into bank 0 (== CPU address)
+};
+
+static void emit(struct sasm_s *a, const uint8_t *bytes, size_t n) {
+    if (a->pc + n > ROM_BANK_SIZE) {
+        fprintf(stderr, "stress_rom: bank 0 overflow\n");
+        return;
+    }
+    memcpy(&a->rom[a->pc], bytes, n);
+    a->pc += (uint32_t)n;
+}
+
+#define EMIT(a, ...) \
+    emit((a), (const uint8_t[]){ __VA_ARGS__ }, sizeof((const uint8_t[]){ __VA_ARGS__ }))
+
+#define LO(x)   ((uint8_t)((x) & 0xFF))
+#define HI(x)   ((uint8_t)((x) >> 8))
+
+static uint16_t here(const struct sasm_s *a) {
+    return (uint16_t)a->pc;
+}
+
+// JR / JR cc to an earlier label
+static void jr(struct sasm_s *a, uint8_t opcode, uint16_t target) {
+    int off = (int)target - (int)(a->pc + 2);
+    if (off < -128 || off > 127) {
+        fprintf(stderr, "stress_rom: JR out of range at 0x%04X\n", a->pc);
+    }
+    EMIT(a, opcode, (uint8_t)(int8_t)off);
+}
+
+// Wait until LY == line
+static void wait_ly(struct sasm_s *a, uint8_t line) {
+    uint16_t loop = here(a);
+    EMIT(a, 0xF0, IO_LY);               // LDH A,(LY)
+    EMIT(a, 0xFE, line);                // CP line
+    jr(a, 0x20, loop);                  // JR NZ,loop
+}
+
+// Copy 'len' bytes (1..256 per page, any length) from ROM to RAM
+static void copy_block(struct sasm_s *a, uint16_t src, uint16_t dst, uint16_t len) {
+    uint16_t end = (uint16_t)(dst + len);
+
+    EMIT(a, 0x21, LO(src), HI(src));    // LD HL,src
+    EMIT(a, 0x11, LO(dst), HI(dst));    // LD DE,dst
+    uint16_t loop = here(a);
+    EMIT(a, 0x2A);                      // LD A,(HL+)
+    EMIT(a, 0x12);                      // LD (DE),A
+    EMIT(a, 0x13);                      // INC DE
+    EMIT(a, 0x7B);                      // LD A,E
+    EMIT(a, 0xFE, LO(end));             // CP LO(end)
+    jr(a, 0x20, loop);                  // JR NZ,loop
+    EMIT(a, 0x7A);                      // LD A,D
+    EMIT(a, 0xFE, HI(end));             // CP HI(end)
+    jr(a, 0x20, loop);                  // JR NZ,loop
+}
+
+
+// -------------------------------
+// Common Blocks
+// -------------------------------
+
+static void emit_header(struct sasm_s *a, const char *title,
+                        uint8_t cart_type, uint8_t rom_code, uint8_t ram_code) {
+    /* Entry point: NOP; JP CODE_START */
+    a->pc = 0x0100;
+    EMIT(a, 0x00, 0xC3, LO(CODE_START), HI(CODE_START));
+
+    memcpy(&a->rom[0x0104], NINTENDO_LOGO, sizeof(NINTENDO_LOGO));
+    memcpy(&a->rom[0x0134], title, strnlen(title, 15));   // not NUL-terminated
+    a->rom[0x0147] = cart_type;
+    a->rom[0x0148] = rom_code;
+    a->rom[0x0149] = ram_code;
+    a->rom[0x014A] = 0x01;              // Non-Japanese
+    a->rom[0x014B] = 0x00;              // No licensee
+
+    a->pc = CODE_START;
+}
+
+static void finish_checksums(struct sasm_s *a) {
+    uint8_t hdr = 0;
+    for (uint32_t i = 0x0134; i <= 0x014C; i++) {
+        hdr = (uint8_t)(hdr - a->rom[i] - 1);
+    }
+    a->rom[0x014D] = hdr;
+
+    uint16_t global = 0;
+    for (size_t i = 0; i < a->size; i++) {
+        if (i != 0x014E && i != 0x014F) global = (uint16_t)(global + a->rom[i]);
+    }
+    a->rom[0x014E] = HI(global);
+    a->rom[0x014F] = LO(global);
+}
+
+// Palettes, tile data, BG map, cleared OAM, then LCD on with 'lcdc'
+static void emit_init(struct sasm_s *a, uint8_t lcdc) {
+    EMIT(a, 0xF3);                      // DI
+    EMIT(a, 0x31, 0xFE, 0xFF);          // LD SP,FFFE
+    EMIT(a, 0x3E, 0xE4, 0xE0, IO_BGP);  // LD A,E4 / LDH (BGP),A
+    EMIT(a, 0x3E, 0xE4, 0xE0, IO_OBP0); // LD A,E4 / LDH (OBP0),A
+    EMIT(a, 0x3E, 0x1B, 0xE0, IO_OBP1); // LD A,1B / LDH (OBP1),A
+
+    /* Tile data 8000-97FF: a = a + 0x25 per byte, so every tile differs */
+    EMIT(a, 0x21, 0x00, 0x80);          // LD HL,8000
+    EMIT(a, 0xAF);                      // XOR A
+    uint16_t tiles = here(a);
+    EMIT(a, 0x22);                      // LD (HL+),A
+    EMIT(a, 0xC6, 0x25);                // ADD A,25
+    EMIT(a, 0x5F);                      // LD E,A
+    EMIT(a, 0x7C);                      // LD A,H
+    EMIT(a, 0xFE, 0x98);                // CP 98
+    EMIT(a, 0x7B);                      // LD A,E
+    jr(a, 0x20, tiles);                 // JR NZ,tiles
+
+    /* Both BG maps 9800-9FFF: tile = L ^ H */
+    EMIT(a, 0x21, 0x00, 0x98);          // LD HL,9800
+    uint16_t map = here(a);
+    EMIT(a, 0x7D);                      // LD A,L
+    EMIT(a, 0xAC);                      // XOR H
+    EMIT(a, 0x22);                      // LD (HL+),A
+    EMIT(a, 0x7C);                      // LD A,H
+    EMIT(a, 0xFE, 0xA0);                // CP A0
+    jr(a, 0x20, map);                   // JR NZ,map
+
+    /* OAM FE00-FE9F cleared (all sprites hidden) */
+    EMIT(a, 0x21, 0x00, 0xFE);          // LD HL,FE00
+    uint16_t oam = here(a);
+    EMIT(a, 0xAF);                      // XOR A
+    EMIT(a, 0x22);                      // LD (HL+),A
+    EMIT(a, 0x7D);                      // LD A,L
+    EMIT(a, 0xFE, 0xA0);                // CP A0
+    jr(a, 0x20, oam);                   // JR NZ,oam
+
+    EMIT(a, 0xAF);                      // XOR A
+    EMIT(a, 0xE0, IO_SCX);              // LDH (SCX),A
+    EMIT(a, 0xE0, IO_SCY);              // LDH (SCY),A
+    EMIT(a, 0xE0, IO_WY);               // LDH (WY),A
+    EMIT(a, 0xEA, LO(STRESS_WRAM_BANK), HI(STRESS_WRAM_BANK));          // LD (C000),A
+    EMIT(a, 0xEA, LO(STRESS_WRAM_CRAM), HI(STRESS_WRAM_CRAM));          // LD (C001),A
+    EMIT(a, 0xEA, LO(STRESS_WRAM_VBLANKS), HI(STRESS_WRAM_VBLANKS));    // LD (C002),A
+    EMIT(a, 0xEA, LO(STRESS_WRAM_LYCS), HI(STRESS_WRAM_LYCS));          // LD (C003),A
+    EMIT(a, 0xEA, LO(STRESS_WRAM_FRAMES), HI(STRESS_WRAM_FRAMES));      // LD (C004),A
+    EMIT(a, 0x3E, 0x07 + 40, 0xE0, IO_WX);                              // LD A,47 / LDH (WX),A
+    EMIT(a, 0x3E, lcdc, 0xE0, IO_LCDC); // LD A,lcdc / LDH (LCDC),A
+}
+
+
+// -------------------------------
+// Workloads
+// -------------------------------
+
+/*
+ * 40 8x16 sprites in four rows of ten cover 64 lines. Three OAM images in
+ * WRAM shift those rows down by 64 lines each; DMA swaps them in at LY 0,
+ * 64 and 128 so every visible line has 10 sprites.
+ */
+static void build_sprites(struct sasm_s *a) {
+    for (int img = 0; img < 3; img++) {
+        uint8_t *oam = &a->rom[DATA_START + 0x100 * img];
+        for (int s = 0; s < NUM_SPRITES; s++) {
+            oam[4 * s + 0] = (uint8_t)(16 + img * 64 + (s / 10) * 16);   // >= 160 is off-screen
+            oam[4 * s + 1] = (uint8_t)(8 + (s % 10) * 16);
+            oam[4 * s + 2] = (uint8_t)(s * 2);
+            oam[4 * s + 3] = (uint8_t)((s & 1) ? (OBJ_FLIP_X | OBJ_PALETTE) : 0);
+        }
+    }
+    memcpy(&a->rom[DATA_START + 0x300], DMA_ROUTINE, sizeof(DMA_ROUTINE));
+
+    emit_init(a, LCDC_BG_OBJ16);
+    copy_block(a, DATA_START, 0xC100, 0x300);                       // OAM images -> C100-C3FF
+    copy_block(a, DATA_START + 0x300, HRAM_DMA, sizeof(DMA_ROUTINE));
+
+    uint16_t frame = here(a);
+    for (int img = 0; img < 3; img++) {
+        wait_ly(a, (uint8_t)(img * 64));
+        EMIT(a, 0x3E, (uint8_t)(0xC1 + img));           // LD A,C1+img
+        EMIT(a, 0xCD, LO(HRAM_DMA), HI(HRAM_DMA));      // CALL FF80
+    }
+    jr(a, 0x18, frame);                                 // JR frame
+}
+
+// Scroll and palette registers rewritten as fast as the CPU can go
+static void build_midline(struct sasm_s *a) {
+    emit_init(a, LCDC_BG_ONLY | LCDC_OBJ_ENABLE);
+
+    uint16_t loop = here(a);
+    EMIT(a, 0x3C);                      // INC A
+    EMIT(a, 0xE0, IO_SCX);              // LDH (SCX),A
+    EMIT(a, 0xE0, IO_BGP);              // LDH (BGP),A
+    EMIT(a, 0xE0, IO_OBP0);             // LDH (OBP0),A
+    EMIT(a, 0x47);                      // LD B,A
+    EMIT(a, 0xF0, IO_LY);               // LDH A,(LY)
+    EMIT(a, 0xE0, IO_SCY);              // LDH (SCY),A
+    EMIT(a, 0x78);                      // LD A,B
+    jr(a, 0x18, loop);                  // JR loop
+}
+
+// Window on for 8 lines, off for 8, with WX following LY
+static void build_window(struct sasm_s *a) {
+    emit_init(a, LCDC_BG_WINDOW);
+
+    uint16_t loop = here(a);
+    EMIT(a, 0xF0, IO_LY);               // LDH A,(LY)
+    EMIT(a, 0xC6, 0x07);                // ADD A,7
+    EMIT(a, 0xE0, IO_WX);               // LDH (WX),A
+    EMIT(a, 0xF0, IO_LY);               // LDH A,(LY)
+    EMIT(a, 0xE6, 0x08);                // AND 08
+    EMIT(a, 0x3E, LCDC_BG_ONLY);        // LD A,BG only (flags kept)
+    EMIT(a, 0x28, 0x02);                // JR Z,+2
+    EMIT(a, 0x3E, LCDC_BG_WINDOW);      // LD A,BG + window
+    EMIT(a, 0xE0, IO_LCDC);             // LDH (LCDC),A
+    jr(a, 0x18, loop);                  // JR loop
+}
+
+/*
+ * Every bank N (1..7) starts with the marker byte N. The loop selects the
+ * next ROM bank, reads its marker into C000, selects a RAM bank (mode 1),
+ * writes B to A000 and reads it back into C001.
+ */
+static void build_mbc1(struct sasm_s *a) {
+    for (uint32_t bank = 1; bank < STRESS_ROM_BANKS; bank++) {
+        uint8_t *b = &a->rom[bank * ROM_BANK_SIZE];
+        for (uint32_t i = 0; i < ROM_BANK_SIZE; i++) {
+            b[i] = (uint8_t)(bank ^ i ^ (i >> 8));
+        }
+        b[0] = (uint8_t)bank;
+    }
+
+    emit_init(a, LCDC_BG_ONLY);
+    EMIT(a, 0x3E, 0x0A, 0xEA, 0x00, 0x00);  // LD A,0A / LD (0000),A   RAM enable
+    EMIT(a, 0x3E, 0x01, 0xEA, 0x00, 0x60);  // LD A,01 / LD (6000),A   mode 1
+    EMIT(a, 0x06, 0x00);                    // LD B,0
+
+    uint16_t loop = here(a);
+    EMIT(a, 0x04);                      // INC B
+    EMIT(a, 0x78);                      // LD A,B
+    EMIT(a, 0xE6, STRESS_ROM_BANKS - 1);// AND 07
+    EMIT(a, 0x20, 0x01);                // JR NZ,+1
+    EMIT(a, 0x3C);                      // INC A        (bank 0 -> 1)
+    EMIT(a, 0xEA, 0x00, 0x20);          // LD (2000),A  ROM bank
+    EMIT(a, 0xFA, 0x00, 0x40);          // LD A,(4000)  marker
+    EMIT(a, 0xEA, LO(STRESS_WRAM_BANK), HI(STRESS_WRAM_BANK));  // LD (C000),A
+    EMIT(a, 0x78);                      // LD A,B
+    EMIT(a, 0xE6, STRESS_RAM_BANKS - 1);// AND 03
+    EMIT(a, 0xEA, 0x00, 0x40);          // LD (4000),A  RAM bank
+    EMIT(a, 0x78);                      // LD A,B
+    EMIT(a, 0xEA, 0x00, 0xA0);          // LD (A000),A
+    EMIT(a, 0xFA, 0x00, 0xA0);          // LD A,(A000)
+    EMIT(a, 0xEA, LO(STRESS_WRAM_CRAM), HI(STRESS_WRAM_CRAM));  // LD (C001),A
+    jr(a, 0x18, loop);                  // JR loop
+}
+
+// Interrupt service routine: increment a WRAM counter and return
+static uint16_t emit_counter_isr(struct sasm_s *a, uint16_t counter) {
+    uint16_t isr = here(a);
+    EMIT(a, 0xF5);                                  // PUSH AF
+    EMIT(a, 0xFA, LO(counter), HI(counter));        // LD A,(counter)
+    EMIT(a, 0x3C);                                  // INC A
+    EMIT(a, 0xEA, LO(counter), HI(counter));        // LD (counter),A
+    EMIT(a, 0xF1);                                  // POP AF
+    EMIT(a, 0xD9);                                  // RETI
+    return isr;
+}
+
+static void build_halt(struct sasm_s *a) {
+    /* ISRs live at the start of the code area; the entry point jumps over them */
+    EMIT(a, 0xC3, 0x00, 0x00);                      // JP main (patched below)
+    uint16_t vblank_isr = emit_counter_isr(a, STRESS_WRAM_VBLANKS);
+    uint16_t lyc_isr = emit_counter_isr(a, STRESS_WRAM_LYCS);
+    uint16_t main_start = here(a);
+    a->rom[CODE_START + 1] = LO(main_start);
+    a->rom[CODE_START + 2] = HI(main_start);
+
+    uint32_t pc = a->pc;
+    a->pc = 0x0040;                                 // VBlank vector
+    EMIT(a, 0xC3, LO(vblank_isr), HI(vblank_isr));
+    a->pc = 0x0048;                                 // STAT vector
+    EMIT(a, 0xC3, LO(lyc_isr), HI(lyc_isr));
+    a->pc = pc;
+
+    emit_init(a, LCDC_BG_ONLY);
+    /* The core has no TIMA, so the second wake-up comes from LY=LYC mid-frame */
+    EMIT(a, 0x3E, LCD_HEIGHT / 2, 0xE0, IO_LYC);            // LD A,72 / LDH (LYC),A
+    EMIT(a, 0x3E, STAT_LYC_INTR, 0xE0, IO_STAT);            // LD A,40 / LDH (STAT),A
+    EMIT(a, 0x3E, VBLANK_INTR | LCDC_INTR, 0xE0, IO_IE);    // LDH (IE),A
+    EMIT(a, 0xAF, 0xE0, IO_IF);         // XOR A / LDH (IF),A
+    EMIT(a, 0xFB);                      // EI
+
+    uint16_t loop = here(a);
+    EMIT(a, 0x76);                      // HALT
+    EMIT(a, 0x00);                      // NOP
+    jr(a, 0x18, loop);                  // JR loop
+}
+
+static void build_busywait(struct sasm_s *a) {
+    emit_init(a, LCDC_BG_ONLY);
+
+    uint16_t loop = here(a);
+    wait_ly(a, LCD_HEIGHT);                                     // Wait for VBlank
+    EMIT(a, 0xFA, LO(STRESS_WRAM_FRAMES), HI(STRESS_WRAM_FRAMES)); // LD A,(C004)
+    EMIT(a, 0x3C);                                              // INC A
+    EMIT(a, 0xEA, LO(STRESS_WRAM_FRAMES), HI(STRESS_WRAM_FRAMES)); // LD (C004),A
+    uint16_t leave = here(a);
+    EMIT(a, 0xF0, IO_LY);               // LDH A,(LY)
+    EMIT(a, 0xFE, LCD_HEIGHT);          // CP 144
+    jr(a, 0x28, leave);                 // JR Z,leave
+    jr(a, 0x18, loop);                  // JR loop
+}
+
+
+// -------------------------------
+// Public Interface
+// -------------------------------
+
+const char *stress_rom_name(enum stress_rom_kind kind) {
+    return (kind >= 0 && kind < STRESS_NUM_KINDS) ? KIND_NAMES[kind] : "unknown";
+}
+
+int stress_rom_from_name(const char *name) {
+    for (int k = 0; k < STRESS_NUM_KINDS; k++) {
+        if (strcmp(name, KIND_NAMES[k]) == 0) return k;
+    }
+    return -1;
+}
+
+size_t stress_rom_build(enum stress_rom_kind kind, uint8_t **out) {
+    struct sasm_s a = { 0 };
+    char title[16];
+
+    if (kind < 0 || kind >= STRESS_NUM_KINDS) return 0;
+
+    a.size = (kind == STRESS_MBC1) ? STRESS_ROM_BANKS * ROM_BANK_SIZE : 2 * ROM_BANK_SIZE;
+    a.rom = calloc(1, a.size);
+    if (!a.rom) return 0;
+
+    snprintf(title, sizeof(title), "STRESS %s", KIND_NAMES[kind]);
+    for (char *c = title; *c; c++) {
+        if (*c >= 'a' && *c <= 'z') *c = (char)(*c - 'a' + 'A');
+    }
+
+    if (kind == STRESS_MBC1) {
+        emit_header(&a, title, 0x03, 0x02, 0x03);   // MBC1+RAM+BATTERY, 128 KB, 32 KB
+    } else {
+        emit_header(&a, title, 0x00, 0x00, 0x00);   // ROM only, 32 KB
+    }
+
+    switch (kind) {
+        case STRESS_SPRITES:  build_sprites(&a);  break;
+        case STRESS_MIDLINE:  build_midline(&a);  break;
+        case STRESS_WINDOW:   build_window(&a);   break;
+        case STRESS_MBC1:     build_mbc1(&a);     break;
+        case STRESS_HALT:     build_halt(&a);     break;
+        case STRESS_BUSYWAIT: build_busywait(&a); break;
+        default: break;
+    }
+
+    finish_checksums(&a);
+    *out = a.rom;
+    return a.size;
+}
+
+
+// -------------------------------
+// In-Memory Cartridge
+// -------------------------------
+
+static uint8_t stress_rom_read(struct gb_s *gb, uint32_t addr) {
+    (void)gb;
+    return addr < attached_size ? attached_rom[addr] : 0xFF;
+}
+
+static uint8_t stress_cart_ram_read(struct gb_s *gb, uint32_t addr) {
+    (void)gb;
+    return addr < sizeof(attached_ram) ? attached_ram[addr] : 0xFF;
+}
+
+static void stress_cart_ram_write(struct gb_s *gb, uint32_t addr, uint8_t val) {
+    (void)gb;
+    if (addr < sizeof(attached_ram)) attached_ram[addr] = val;
+}
+
+static void stress_error(struct gb_s *gb, enum gb_error_e error, uint16_t addr) {
+    (void)gb; (void)error; (void)addr;
+    error_count++;
+}
+
+void stress_rom_attach(struct gb_s *gb, const uint8_t *rom, size_t size) {
+    attached_rom = rom;
+    attached_size = size;
+    memset(attached_ram, 0, sizeof(attached_ram));
+    error_count = 0;
+
+    memset(gb, 0, sizeof(*gb));
+    gb->gb_rom_read = stress_rom_read;
+    gb->gb_cart_ram_read = stress_cart_ram_read;
+    gb->gb_cart_ram_write = stress_cart_ram_write;
+    gb->gb_error = stress_error;
+
+    /* Only the cartridge types stress_rom_build() emits */
+    uint8_t cart_type = size > 0x0147 ? rom[0x0147] : 0;
+    gb->mbc = (cart_type >= 0x01 && cart_type <= 0x03) ? 1 : 0;
+    gb->cart_ram = (cart_type == 0x02 || cart_type == 0x03) ? 1 : 0;
+    gb->num_rom_banks_mask = (uint16_t)(size / ROM_BANK_SIZE - 1);
+    gb->num_ram_banks = gb->cart_ram ? STRESS_RAM_BANKS : 0;
+
+    mmu_init(gb);
+    cpu_init(gb);
+}
+
+uint32_t stress_rom_errors(void) {
+    return error_count;
+}
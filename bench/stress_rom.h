@@ -0,0 +1,82 @@
+/**
+ * stress_rom.h - Synthetic Stress-ROM Generator
+ *
+ * Assembles small, license-free Game Boy ROMs in memory that hit the
+ * emulator's worst cases, which the bundled games rarely do:
+ *
+ *   sprites   10 sprites (8x16) on every line, OAM DMA three times a frame
+ *   midline   SCX / BGP / OBP0 rewritten continuously during each line
+ *   window    window toggled every 8 lines, WX moved every line
+ *   mbc1      MBC1 ROM and RAM bank switch every few instructions
+ *   halt      HALT loop woken by VBlank and STAT (LY=LYC) interrupts
+ *   busywait  LY polling loop, the classic "wait for VBlank" pattern
+ *
+ * The ROMs carry a valid Nintendo logo and header checksums, so they load
+ * through bootloader() as well as through stress_rom_attach().
+ */
+
+#ifndef STRESS_ROM_H
+#define STRESS_ROM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "gb_types.h"
+
+enum stress_rom_kind {
+    STRESS_SPRITES = 0,
+    STRESS_MIDLINE,
+    STRESS_WINDOW,
+    STRESS_MBC1,
+    STRESS_HALT,
+    STRESS_BUSYWAIT,
+    STRESS_NUM_KINDS
+};
+
+// WRAM locations the ROMs update, so tests can check they ran correctly
+#define STRESS_WRAM_BANK        0xC000  // mbc1: marker byte read from the switched ROM bank
+#define STRESS_WRAM_CRAM        0xC001  // mbc1: byte read back from cart RAM
+#define STRESS_WRAM_VBLANKS     0xC002  // halt: VBlank interrupts serviced
+#define STRESS_WRAM_LYCS        0xC003  // halt: STAT LY=LYC interrupts serviced
+#define STRESS_WRAM_FRAMES      0xC004  // busywait: frames seen by the LY poll loop
+
+/**
+ * Short name of a ROM kind ("sprites", "mbc1", ...)
+ */
+const char *stress_rom_name(enum stress_rom_kind kind);
+
+/**
+ * Look up a ROM kind by name
+ *
+ * @return  The kind, or -1 if the name is unknown
+ */
+int stress_rom_from_name(const char *name);
+
+/**
+ * Assemble a stress ROM
+ *
+ * @param kind  Which workload to generate
+ * @param out   Receives a malloc'd ROM image (caller frees)
+ * @return      ROM size in bytes, or 0 on failure
+ */
+size_t stress_rom_build(enum stress_rom_kind kind, uint8_t **out);
+
+/**
+ * Set up an emulator context to run a ROM image straight from memory
+ *
+ * Mirrors bootloader(): cartridge type and bank counts come from the
+ * header, then the MMU and CPU are initialised. The image must stay valid
+ * while 'gb' runs. Only one ROM can be attached at a time (like the
+ * bootloader, the cartridge lives in file-scope storage).
+ *
+ * @param gb    Context to initialise (fully overwritten)
+ * @param rom   ROM image
+ * @param size  ROM size in bytes
+ */
+void stress_rom_attach(struct gb_s *gb, const uint8_t *rom, size_t size);
+
+/**
+ * Number of emulator errors (invalid opcodes etc.) raised since the last attach
+ */
+uint32_t stress_rom_errors(void);
+
+#endif // STRESS_ROM_H
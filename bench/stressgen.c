@@ -0,0 +1,79 @@
+/**
+ * stressgen.c - Write Synthetic Stress ROMs to Disk
+ *
+ * Writes the ROMs from stress_rom.c as .gb files so they can be run in the
+ * full emulator (or any other one) and in gbe_bench:
+ *
+ *   ./gbe_stressgen all rom/
+ *   ./gbe_bench rom/stress_sprites.gb
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "stress_rom.h"
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s <all|", prog);
+    for (int k = 0; k < STRESS_NUM_KINDS; k++) {
+        fprintf(stderr, "%s%s", stress_rom_name((enum stress_rom_kind)k),
+                k + 1 < STRESS_NUM_KINDS ? "|" : "");
+    }
+    fprintf(stderr, "> [output_dir]\n");
+}
+
+static int write_rom(enum stress_rom_kind kind, const char *dir) {
+    uint8_t *rom = NULL;
+    size_t size = stress_rom_build(kind, &rom);
+    if (size == 0) {
+        fprintf(stderr, "Failed to build %s\n", stress_rom_name(kind));
+        return -1;
+    }
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/stress_%s.gb", dir, stress_rom_name(kind));
+
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        perror(path);
+        free(rom);
+        return -1;
+    }
+
+    size_t written = fwrite(rom, 1, size, f);
+    fclose(f);
+    free(rom);
+
+    if (written != size) {
+        fprintf(stderr, "Short write to %s\n", path);
+        return -1;
+    }
+
+    printf("Wrote %s (%zu KB)\n", path, size / 1024);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2 || argc > 3) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const char *dir = argc == 3 ? argv[2] : ".";
+
+    if (strcmp(argv[1], "all") == 0) {
+        for (int k = 0; k < STRESS_NUM_KINDS; k++) {
+            if (write_rom((enum stress_rom_kind)k, dir) != 0) return 1;
+        }
+        return 0;
+    }
+
+    int kind = stress_rom_from_name(argv[1]);
+    if (kind < 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    return write_rom((enum stress_rom_kind)kind, dir) == 0 ? 0 : 1;
+}
@@ -0,0 +1,51 @@
+// rt.h
+#ifndef RT_H
+#define RT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+/* Bits returned by rt_apply_thread() / rt_lock_memory() describing what
+ * actually took effect. Missing bits mean the setting was not requested
+ * or was refused (usually for lack of CAP_SYS_NICE / CAP_IPC_LOCK).
+ */
+#define RT_FIFO         0x01    /* SCHED_FIFO priority applied */
+#define RT_AFFINITY     0x02    /* CPU affinity applied */
+#define RT_MLOCK        0x04    /* mlockall(MCL_CURRENT | MCL_FUTURE) succeeded */
+
+/* Below the PREEMPT_RT IRQ threads (50) so SPI/GPIO interrupts still get
+ * serviced, but above every SCHED_OTHER daemon.
+ */
+#define RT_DEFAULT_PRIO 40
+
+typedef struct {
+    bool enabled;       /* Master switch, nothing is touched when false */
+    int  priority;      /* SCHED_FIFO priority (1..99) */
+    int  cpu;           /* Core to pin to, -1 to leave affinity alone */
+} rt_thread_config_t;
+
+/* Put 'thread' on SCHED_FIFO at cfg->priority and pin it to cfg->cpu.
+ * Each setting is tried independently; failures fall back to the normal
+ * scheduler silently. Returns the RT_* bits that took effect.
+ */
+uint32_t rt_apply_thread(pthread_t thread, const rt_thread_config_t *cfg);
+
+/* Lock all current and future pages into RAM.
+ * Returns RT_MLOCK on success, 0 if refused.
+ */
+uint32_t rt_lock_memory(void);
+
+/* Touch every page in [ptr, ptr + len) so later accesses don't page-fault.
+ * The contents are preserved. Call before other threads use the memory.
+ */
+void rt_prefault(void *ptr, size_t len);
+
+/* Pre-fault 'len' bytes of the calling thread's stack. */
+void rt_prefault_stack(size_t len);
+
+/* Print a one-line summary of which settings took effect for 'name'. */
+void rt_report(const char *name, const rt_thread_config_t *cfg, uint32_t applied);
+
+#endif // RT_H
@@ -9,6 +9,7 @@
 #include "gb_types.h"
 #include "cpu.h"
 #include "memory.h"
+#include "timers.h"
 
 /* Simple test ROM in memory */
 static uint8_t test_rom[0x8000];
@@ -283,6 +284,178 @@ void test_jumps(void) {
     }
 }
 
+/* Test 6: DIV and LY from the cycle count */
+void test_timing(void) {
+    printf("\n=== Test 6: DIV and LCD Timing ===\n");
+
+    struct gb_s gb = {0};
+    gb.gb_rom_read = rom_read;
+    gb.gb_cart_ram_read = cart_ram_read;
+    gb.gb_cart_ram_write = cart_ram_write;
+    gb.gb_error = error_handler;
+
+    mmu_init(&gb);
+    cpu_init(&gb);
+
+    test_rom[0x0100] = 0x18;  /* JR -2 */
+    test_rom[0x0101] = 0xFE;
+
+    int ok = mmu_read(&gb, 0xFF04) == 0xAB;
+    while (gb.counter.cycles < 1000) cpu_step(&gb);
+    ok = ok && mmu_read(&gb, 0xFF04) == (uint8_t)(0xAB + gb.counter.cycles / DIV_CYCLES);
+    mmu_write(&gb, 0xFF04, 0x55);
+    uint64_t reset_at = gb.counter.cycles;
+    ok = ok && mmu_read(&gb, 0xFF04) == 0;
+    while (gb.counter.cycles < reset_at + 3 * DIV_CYCLES) cpu_step(&gb);
+    ok = ok && mmu_read(&gb, 0xFF04) == 3;
+
+    if (ok) {
+        printf("✓ Test PASSED: DIV counts every %d cycles and resets on write\n", DIV_CYCLES);
+    } else {
+        printf("✗ Test FAILED: DIV = 0x%02X\n", mmu_read(&gb, 0xFF04));
+    }
+
+    /* Frame starts (entries into VBlank) are one frame apart, LY tops out at 153 */
+    uint64_t vblank[3];
+    int frames = 0, max_ly = 0;
+    while (frames < 3) {
+        gb.gb_frame = false;
+        cpu_step(&gb);
+        if (gb.hram_io[IO_LY] > max_ly) max_ly = gb.hram_io[IO_LY];
+        if (gb.gb_frame) vblank[frames++] = gb.counter.cycles;
+    }
+    int64_t d1 = (int64_t)(vblank[1] - vblank[0]), d2 = (int64_t)(vblank[2] - vblank[1]);
+
+    if (max_ly == LCD_VERT_LINES - 1 && llabs(d1 - LCD_FRAME_CYCLES) < 24 && llabs(d2 - LCD_FRAME_CYCLES) < 24) {
+        printf("✓ Test PASSED: %d-line frames of %d cycles\n", LCD_VERT_LINES, LCD_FRAME_CYCLES);
+    } else {
+        printf("✗ Test FAILED: LY up to %d, frames %lld and %lld cycles apart\n", max_ly, (long long)d1, (long long)d2);
+    }
+}
+
+/* Power on with IME off, only VBlank enabled and IF as given */
+static void irq_setup(struct gb_s *gb, uint8_t if_flag) {
+    memset(gb, 0, sizeof(*gb));
+    gb->gb_rom_read = rom_read;
+    gb->gb_cart_ram_read = cart_ram_read;
+    gb->gb_cart_ram_write = cart_ram_write;
+    gb->gb_error = error_handler;
+
+    mmu_init(gb);
+    cpu_init(gb);
+    gb->gb_ime = false;
+    mmu_write(gb, 0xFFFF, VBLANK_INTR);
+    mmu_write(gb, 0xFF0F, if_flag);
+}
+
+/* Test 7: EI delay, HALT and the HALT bug */
+void test_interrupts(void) {
+    printf("\n=== Test 7: Interrupts and HALT ===\n");
+
+    struct gb_s gb;
+
+    /* The instruction after EI runs before a pending interrupt is taken */
+    irq_setup(&gb, VBLANK_INTR);
+    test_rom[0x0100] = 0xFB;  /* EI */
+    test_rom[0x0101] = 0x00;  /* NOP */
+    test_rom[0x0102] = 0x00;  /* NOP */
+
+    cpu_step(&gb);
+    cpu_step(&gb);
+    int ok = gb.cpu_reg.pc.reg == 0x0102 && gb.gb_ime;
+    uint16_t cycles = cpu_step(&gb);
+    ok = ok && cycles == 20 && gb.cpu_reg.pc.reg == 0x0040 && !gb.gb_ime &&
+         !(gb.hram_io[IO_IF] & VBLANK_INTR) && gb.irq_pending == 0 &&
+         mmu_read(&gb, gb.cpu_reg.sp.reg) == 0x02;
+
+    if (ok) {
+        printf("✓ Test PASSED: interrupt taken one instruction after EI\n");
+    } else {
+        printf("✗ Test FAILED: PC = 0x%04X, dispatch took %d cycles\n", gb.cpu_reg.pc.reg, cycles);
+    }
+
+    /* HALT with IME off sleeps until VBlank, then carries on without a dispatch */
+    irq_setup(&gb, 0x00);
+    test_rom[0x0100] = 0x76;  /* HALT */
+    test_rom[0x0101] = 0x00;  /* NOP */
+
+    cpu_step(&gb);
+    int steps = 0;
+    while (gb.gb_halt && steps < 100000) {
+        cpu_step(&gb);
+        steps++;
+    }
+    /* The waking step runs the NOP; PC is still in the main program */
+    ok = !gb.gb_halt && gb.cpu_reg.pc.reg == 0x0102 && gb.hram_io[IO_LY] == LCD_HEIGHT &&
+         gb.stats.halt_cycles > 10000 && steps < 1000;
+
+    if (ok) {
+        printf("✓ Test PASSED: HALT slept %llu cycles in %d steps\n",
+               (unsigned long long)gb.stats.halt_cycles, steps);
+    } else {
+        printf("✗ Test FAILED: PC = 0x%04X after %d halted steps\n", gb.cpu_reg.pc.reg, steps);
+    }
+
+    /* HALT bug: IME off with a request pending, the next opcode is read twice */
+    irq_setup(&gb, VBLANK_INTR);
+    test_rom[0x0100] = 0x76;  /* HALT */
+    test_rom[0x0101] = 0x3C;  /* INC A */
+    test_rom[0x0102] = 0x00;  /* NOP */
+    gb.cpu_reg.a = 0;
+
+    for (int i = 0; i < 3; i++) cpu_step(&gb);
+
+    if (gb.cpu_reg.a == 2 && gb.cpu_reg.pc.reg == 0x0102 && !gb.gb_halt) {
+        printf("✓ Test PASSED: HALT bug repeats the next opcode\n");
+    } else {
+        printf("✗ Test FAILED: A = %d, PC = 0x%04X\n", gb.cpu_reg.a, gb.cpu_reg.pc.reg);
+    }
+}
+
+/* Test 8: I/O register handlers */
+void test_io_registers(void) {
+    printf("\n=== Test 8: I/O Registers ===\n");
+
+    struct gb_s gb = {0};
+    gb.gb_rom_read = rom_read;
+    gb.gb_cart_ram_read = cart_ram_read;
+    gb.gb_cart_ram_write = cart_ram_write;
+    gb.gb_error = error_handler;
+
+    mmu_init(&gb);
+    cpu_init(&gb);
+
+    /* Plain registers and HRAM store what is written */
+    mmu_write(&gb, 0xFF43, 0x5A);   /* SCX */
+    mmu_write(&gb, 0xFF90, 0xA5);   /* HRAM */
+    int ok = mmu_read(&gb, 0xFF43) == 0x5A && mmu_read(&gb, 0xFF90) == 0xA5;
+
+    /* The LYC flag follows a write to LYC without waiting for the next line */
+    mmu_write(&gb, 0xFF45, gb.hram_io[IO_LY]);
+    ok = ok && (mmu_read(&gb, 0xFF41) & STAT_LYC_COINC);
+    mmu_write(&gb, 0xFF45, (uint8_t)(gb.hram_io[IO_LY] + 1));
+    ok = ok && !(mmu_read(&gb, 0xFF41) & STAT_LYC_COINC);
+
+    /* STAT mode bits are read-only */
+    mmu_write(&gb, 0xFF41, 0x03);
+    ok = ok && (mmu_read(&gb, 0xFF41) & STAT_MODE) == (gb.hram_io[IO_STAT] & STAT_MODE);
+
+    /* With the LCD off, LY and the mode read 0 */
+    gb.hram_io[IO_LY] = 0x20;
+    mmu_write(&gb, 0xFF40, 0x11);
+    ok = ok && mmu_read(&gb, 0xFF44) == 0 && (mmu_read(&gb, 0xFF41) & STAT_MODE) == 0;
+
+    /* WY keeps its value for the next frame */
+    mmu_write(&gb, 0xFF4A, 0x30);
+    ok = ok && mmu_read(&gb, 0xFF4A) == 0x30 && gb.display.WY == 0x30;
+
+    if (ok) {
+        printf("✓ Test PASSED: I/O reads and writes go through their handlers\n");
+    } else {
+        printf("✗ Test FAILED: STAT = 0x%02X, LY = %d\n", mmu_read(&gb, 0xFF41), mmu_read(&gb, 0xFF44));
+    }
+}
+
 int main(void) {
     printf("====================================\n");
     printf("  Game Boy CPU + MMU Test Suite\n");
@@ -298,6 +471,9 @@ int main(void) {
     test_memory_access();
     test_stack_operations();
     test_jumps();
+    test_timing();
+    test_interrupts();
+    test_io_registers();
     
     printf("\n====================================\n");
     printf("  All tests completed!\n");
@@ -0,0 +1,192 @@
+/**
+ * debug_test.c - Tests for breakpoints, watchpoints and debugger commands
+ *
+ * Checks that unwatched pages keep their direct page-table pointers, that
+ * breakpoints stop before the instruction and resume past it, that read and
+ * write watchpoints fire on the exact address only, that the console
+ * commands parse and report correctly.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gb_types.h"
+#include "cpu.h"
+#include "memory.h"
+#include "debug.h"
+#include "test_machine.h"
+
+static const uint8_t prog[] = {
+    0x21, 0x00, 0xC0,   // 0100  LD HL, $C000
+    0x3E, 0x07,         // 0103  LD A, $07
+    0x77,               // 0105  LD (HL), A      write $C000
+    0x23,               // 0106  INC HL
+    0x7E,               // 0107  LD A, (HL)      read $C001
+    0x00,               // 0108  NOP
+    0x18, 0xF5,         // 0109  JR $0100
+};
+
+static void machine_setup(struct gb_s *gb) {
+    machine_init(gb);
+    memcpy(&test_rom[0x0100], prog, sizeof(prog));
+}
+
+/* Run until the debugger stops the CPU (or give up) */
+static int run_until_break(struct gb_s *gb, int max_steps) {
+    int steps = 0;
+    while (!gb->gb_break && steps < max_steps) {
+        cpu_step(gb);
+        steps++;
+    }
+    return gb->gb_break;
+}
+
+/* Test 1: page table without any traps */
+void test_page_table(void) {
+    printf("\n=== Test 1: Page Table ===\n");
+
+    struct gb_s *gb = machine_new();
+    machine_setup(gb);
+
+    check(gb->mmu.rd[0xC0] == &gb->wram[0] && gb->mmu.wr[0xDF] == &gb->wram[0x1F00],
+          "WRAM pages map straight to wram[]");
+    check(gb->mmu.rd[0xE0] == &gb->wram[0] && gb->mmu.rd[0xFD] == &gb->wram[0x1D00],
+          "echo pages alias WRAM");
+    check(gb->mmu.rd[0x80] == &gb->vram[0], "VRAM pages map straight to vram[]");
+    check(!gb->mmu.rd[0x00] && !gb->mmu.wr[0x40] && !gb->mmu.rd[0xA0] && !gb->mmu.wr[0xFF],
+          "ROM, cart RAM and I/O take the slow path");
+
+    mmu_write(gb, 0xE123, 0x5A);
+    check(mmu_read(gb, 0xC123) == 0x5A, "echo write lands in WRAM");
+
+    free(gb);
+}
+
+/* Test 2: breakpoints */
+void test_breakpoints(void) {
+    printf("\n=== Test 2: Breakpoints ===\n");
+
+    struct gb_s *gb = machine_new();
+    machine_setup(gb);
+    check(debug_init(gb) == 0, "debugger attached");
+
+    int id = debug_add_breakpoint(gb, 0x0107);
+    check(id > 0 && (gb->mmu.trap[0x01] & MMU_TRAP_EXEC), "breakpoint sets the page's exec trap");
+
+    check(run_until_break(gb, 100) && gb->cpu_reg.pc.reg == 0x0107 &&
+          gb->debug->stop_reason == DEBUG_STOP_BREAKPOINT && gb->debug->stop_id == id,
+          "stops before the instruction at $0107");
+
+    uint64_t before = gb->stats.instructions;
+    check(cpu_step(gb) == 0 && gb->stats.instructions == before, "stopped CPU executes nothing");
+
+    debug_continue(gb);
+    cpu_step(gb);
+    check(!gb->gb_break && gb->cpu_reg.pc.reg == 0x0108, "continue runs the breakpoint instruction");
+
+    check(run_until_break(gb, 100) && gb->cpu_reg.pc.reg == 0x0107, "next pass stops again");
+
+    debug_step(gb, 3);
+    check(gb->gb_break && gb->debug->stop_reason == DEBUG_STOP_STEP && gb->cpu_reg.pc.reg == 0x0100,
+          "step 3 lands on $0100");
+
+    check(debug_delete(gb, (uint8_t)id) == 0 && gb->mmu.trap[0x01] == 0, "delete clears the trap");
+    debug_continue(gb);
+    check(!run_until_break(gb, 100), "no stop after delete");
+
+    debug_free(gb);
+    free(gb);
+}
+
+/* Test 3: watchpoints */
+void test_watchpoints(void) {
+    printf("\n=== Test 3: Watchpoints ===\n");
+
+    struct gb_s *gb = machine_new();
+    machine_setup(gb);
+    debug_init(gb);
+
+    int w = debug_add_watchpoint(gb, 0xC000, 0xC000, MMU_TRAP_WRITE);
+    check(w > 0 && !gb->mmu.wr[0xC0] && gb->mmu.rd[0xC0] && gb->mmu.wr[0xC1],
+          "write watch only slows writes to its own page");
+
+    check(run_until_break(gb, 100) && gb->debug->stop_reason == DEBUG_STOP_WATCH_WRITE &&
+          gb->debug->stop_addr == 0xC000 && gb->debug->stop_value == 0x07,
+          "write to $C000 reported with its value");
+    check(gb->cpu_reg.pc.reg == 0x0106 && gb->wram[0] == 0x07, "write completed before stopping");
+
+    mmu_write(gb, 0xE000, 0x11);
+    check(gb->debug->stop_addr == 0xC000 && gb->wram[0] == 0x11, "echo alias is not watched");
+    debug_delete(gb, 0);
+
+    int r = debug_add_watchpoint(gb, 0xC001, 0xC001, MMU_TRAP_READ);
+    check(r > 0 && !gb->mmu.rd[0xC0] && gb->mmu.wr[0xC0], "read watch only slows reads");
+
+    debug_continue(gb);
+    mmu_peek(gb, 0xC001);
+    check(!gb->gb_break, "mmu_peek does not fire a read watch");
+
+    check(run_until_break(gb, 100) && gb->debug->stop_reason == DEBUG_STOP_WATCH_READ &&
+          gb->debug->stop_addr == 0xC001 && gb->cpu_reg.pc.reg == 0x0108,
+          "read of $C001 stops after LD A, (HL)");
+
+    check(debug_add_watchpoint(gb, 0xC010, 0xC000, MMU_TRAP_WRITE) < 0 &&
+          debug_add_watchpoint(gb, 0xC000, 0xC000, MMU_TRAP_EXEC) < 0, "bad range and type rejected");
+
+    debug_free(gb);
+    check(gb->mmu.rd[0xC0] == &gb->wram[0] && gb->mmu.trap[0xC0] == 0, "debug_free restores direct pages");
+
+    free(gb);
+}
+
+/* Test 4: console commands */
+void test_commands(void) {
+    printf("\n=== Test 4: Commands ===\n");
+
+    struct gb_s *gb = machine_new();
+    machine_setup(gb);
+    debug_init(gb);
+
+    FILE *out = tmpfile();
+    char text[1024] = {0};
+
+    check(debug_command(gb, "b $0107", out) == 0 &&
+          debug_command(gb, "watch C000:4 rw", out) == 0 &&
+          debug_command(gb, "list", out) == 0, "break, watch and list accepted");
+    check(debug_command(gb, "bogus", out) != 0 && debug_command(gb, "b", out) != 0 &&
+          debug_command(gb, "w C000 x", out) != 0, "bad commands rejected");
+
+    debug_command(gb, "d 2", out);
+    debug_command(gb, "c", out);
+    run_until_break(gb, 100);
+    debug_print_stop(gb, out);
+    mmu_write(gb, 0xC010, 0xAB);
+    debug_command(gb, "x C010 2", out);
+    debug_command(gb, "dis 0105 1", out);
+
+    rewind(out);
+    size_t n = fread(text, 1, sizeof(text) - 1, out);
+    text[n] = '\0';
+    fclose(out);
+
+    check(strstr(text, "1  break  $0107") != NULL, "list shows the breakpoint");
+    check(strstr(text, "2  watch  $C000-$C003 rw") != NULL, "list shows the watch range");
+    check(strstr(text, "Breakpoint 1 at $0107: LD A, (HL)") != NULL, "stop report disassembles PC");
+    check(strstr(text, "$C010: AB 00") != NULL, "x dumps memory");
+    check(strstr(text, "$0105: LD (HL), A") != NULL, "dis disassembles");
+
+    debug_free(gb);
+    free(gb);
+}
+
+int main(void) {
+    printf("Debugger Test Suite\n");
+    printf("===================\n");
+
+    test_page_table();
+    test_breakpoints();
+    test_watchpoints();
+    test_commands();
+
+    return test_summary("debugger");
+}
@@ -0,0 +1,531 @@
+/**
+ * gbe_test.c - Tests for the embeddable emulator API
+ *
+ * Runs the synthetic stress ROMs through gbe.h: ROM rejection, frame-skip
+ * stepping, zero-copy framebuffer and WRAM, snapshot reset determinism,
+ * independent instances sharing one ROM image, invalid-opcode reporting,
+ * that none of it writes to stdout, that the vectorized step on a thread
+ * pool gives the same observations as stepping one at a time, that the
+ * downsampled observation sink matches the full frame it replaces, and that
+ * copy-on-write forks run like full instances while copying only the pages
+ * they write, that the incremental state hash matches a full one and
+ * finds repeated states through a shared transposition table, and that an
+ * instance copied with gbe_copy() runs on like the original.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "gb_types.h"
+#include "gbe.h"
+#include "memory.h"
+#include "ttable.h"
+#include "stress_rom.h"
+#include "test_check.h"
+
+static uint8_t wram_at(struct gbe_s *g, uint16_t addr) {
+    return gbe_wram(g)[addr - 0xC000];
+}
+
+/* Test 1: ROM checks */
+void test_create(void) {
+    printf("\n=== Test 1: Create ===\n");
+
+    uint8_t *rom = NULL;
+    size_t size = stress_rom_build(STRESS_BUSYWAIT, &rom);
+    const char *why = NULL;
+
+    check(gbe_create(rom, 0x100, &why) == NULL && why && strstr(why, "32 KB"), "short image rejected");
+
+    rom[0x0104] ^= 0xFF;
+    why = NULL;
+    check(gbe_create(rom, size, &why) == NULL && why && strstr(why, "logo"), "bad logo rejected");
+    rom[0x0104] ^= 0xFF;
+
+    struct gbe_s *g = gbe_create(rom, size, &why);
+    check(g != NULL, "valid ROM accepted");
+    check(gbe_core(g)->cpu_reg.pc.reg == 0x0100 && gbe_error(g) == NULL, "powered on at $0100");
+
+    gbe_destroy(g);
+    free(rom);
+}
+
+/* Test 2: stepping with frame-skip */
+void test_step(void) {
+    printf("\n=== Test 2: Step ===\n");
+
+    uint8_t *rom = NULL;
+    size_t size = stress_rom_build(STRESS_SPRITES, &rom);
+    struct gbe_s *g = gbe_create(rom, size, NULL);
+    struct gb_s *gb = gbe_core(g);
+
+    check(gbe_step(g, 0xFF, 10) == 10, "step runs the requested frames");
+
+    uint64_t frames = gb->stats.frames;
+    uint64_t lines = gb->stats.lines_drawn;
+    check(gbe_step(g, 0xFF, 4) == 4 && gb->stats.frames == frames + 4, "four frames per step");
+    check(gb->stats.lines_drawn - lines == LCD_HEIGHT, "only the last frame is drawn");
+
+    const uint8_t *fb = gbe_framebuffer(g);
+    int lit = 0, in_range = 1;
+    for (int i = 0; i < GBE_FB_WIDTH * GBE_FB_HEIGHT; i++) {
+        if (fb[i] != 0) lit++;
+        if (fb[i] > 3) in_range = 0;
+    }
+    check(lit > 0 && in_range, "framebuffer holds shades 0-3");
+    check(gbe_framebuffer(g) == fb && gbe_wram(g) == gb->wram, "pointers are stable and zero-copy");
+
+    gbe_destroy(g);
+    free(rom);
+}
+
+/* Test 3: reset to a snapshot replays exactly */
+void test_reset(void) {
+    printf("\n=== Test 3: Reset ===\n");
+
+    uint8_t *rom = NULL;
+    size_t size = stress_rom_build(STRESS_MBC1, &rom);
+    struct gbe_s *g = gbe_create(rom, size, NULL);
+    struct gb_state_s *st = gbe_state_new(g);
+    static uint8_t wram[WRAM_SIZE], fb[GBE_FB_WIDTH * GBE_FB_HEIGHT];
+
+    check(st != NULL && st->cart_ram_size > 0, "snapshot sized for cart RAM");
+
+    gbe_step(g, 0xFF, 10);
+    gbe_save(g, st);
+    gbe_step(g, 0x7F, 20);
+    memcpy(wram, gbe_wram(g), sizeof(wram));
+    memcpy(fb, gbe_framebuffer(g), sizeof(fb));
+    uint8_t cram = wram_at(g, STRESS_WRAM_CRAM);
+
+    gbe_reset(g, st);
+    gbe_step(g, 0x7F, 20);
+    check(memcmp(wram, gbe_wram(g), sizeof(wram)) == 0 && memcmp(fb, gbe_framebuffer(g), sizeof(fb)) == 0,
+          "same input from the same snapshot gives the same frame and WRAM");
+    check(cram != 0 && wram_at(g, STRESS_WRAM_CRAM) == cram, "cart RAM restored with the snapshot");
+
+    gbe_reset(g, NULL);
+    check(gbe_core(g)->cpu_reg.pc.reg == 0x0100 && gbe_core(g)->stats.frames == 0, "NULL resets to power-on");
+
+    gbe_state_free(st);
+    gbe_destroy(g);
+    free(rom);
+}
+
+/* Test 4: instances sharing a ROM image are independent */
+void test_instances(void) {
+    printf("\n=== Test 4: Instances ===\n");
+
+    uint8_t *rom = NULL;
+    size_t size = stress_rom_build(STRESS_BUSYWAIT, &rom);
+    struct gbe_s *a = gbe_create(rom, size, NULL);
+    struct gbe_s *b = gbe_create(rom, size, NULL);
+
+    gbe_step(a, 0xFF, 30);
+    gbe_step(b, 0xFF, 5);
+    check(wram_at(a, STRESS_WRAM_FRAMES) != wram_at(b, STRESS_WRAM_FRAMES) && gbe_wram(a) != gbe_wram(b),
+          "each instance has its own state");
+    check(gbe_core(a)->stats.frames == 30 && gbe_core(b)->stats.frames == 5, "frame counts kept apart");
+
+    gbe_destroy(a);
+    gbe_destroy(b);
+    free(rom);
+}
+
+/* Test 5: errors are reported, not printed */
+void test_errors(void) {
+    printf("\n=== Test 5: Errors and Output ===\n");
+
+    uint8_t *rom = NULL;
+    size_t size = stress_rom_build(STRESS_HALT, &rom);
+    rom[0x0100] = 0xD3;     // Invalid opcode at the entry point
+
+    /* Everything from create to destroy with stdout sent to a file */
+    fflush(stdout);
+    FILE *capture = tmpfile();
+    int saved = dup(STDOUT_FILENO);
+    dup2(fileno(capture), STDOUT_FILENO);
+
+    struct gbe_s *g = gbe_create(rom, size, NULL);
+    int done = gbe_step(g, 0xFF, 3);
+    const char *why = gbe_error(g);
+    gbe_reset(g, NULL);
+    const char *after = gbe_error(g);
+    gbe_destroy(g);
+    gbe_create(rom, 0x10, NULL);
+
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    long written = ftell(capture) < 0 ? -1 : (fseek(capture, 0, SEEK_END), ftell(capture));
+    fclose(capture);
+
+    check(done == 0 && why && strstr(why, "invalid opcode"), "invalid opcode stops the step");
+    check(after == NULL, "reset clears the error");
+    check(written == 0, "nothing written to stdout");
+
+    free(rom);
+}
+
+/* Test 6: vectorized step matches single instances */
+void test_vec(void) {
+    printf("\n=== Test 6: Vectorized Step ===\n");
+
+    enum { N = 12, STEPS = 6 };
+    uint8_t *rom = NULL;
+    size_t size = stress_rom_build(STRESS_MBC1, &rom);
+    struct gbe_vec_s *v = gbe_vec_create(rom, size, N, 4, NULL);
+    struct gbe_s *ref[N];
+    uint8_t *obs = malloc((size_t)N * GBE_FB_SIZE);
+    uint8_t actions[N];
+
+    check(v != NULL && gbe_vec_size(v) == N && gbe_vec_env(v, N) == NULL, "vector of 12 instances");
+
+    int aligned = 1;
+    for (int i = 0; i < N; i++) {
+        ref[i] = gbe_create(rom, size, NULL);
+        if ((uintptr_t)gbe_vec_env(v, i) % 64) aligned = 0;
+    }
+    check(aligned, "instances are cache-line aligned");
+
+    int errors = 0, same = 1;
+    for (int s = 0; s < STEPS; s++) {
+        for (int i = 0; i < N; i++) {
+            actions[i] = (uint8_t)~(1u << ((i + s) % 8));
+            gbe_step(ref[i], actions[i], 3);
+        }
+        errors += gbe_vec_step(v, actions, 3, obs);
+        for (int i = 0; i < N; i++) {
+            if (memcmp(obs + (size_t)i * GBE_FB_SIZE, gbe_framebuffer(ref[i]), GBE_FB_SIZE) != 0 ||
+                memcmp(gbe_wram(gbe_vec_env(v, i)), gbe_wram(ref[i]), WRAM_SIZE) != 0) {
+                same = 0;
+            }
+        }
+    }
+    check(errors == 0, "no instance stopped early");
+    check(same, "observations and WRAM match stepping one at a time");
+    check(gbe_core(gbe_vec_env(v, 5))->stats.frames == 3 * STEPS, "every instance advanced");
+
+    gbe_reset(gbe_vec_env(v, 0), NULL);
+    gbe_vec_step(v, actions, 1, NULL);
+    check(gbe_core(gbe_vec_env(v, 0))->stats.frames == 1 && gbe_core(gbe_vec_env(v, 1))->stats.frames == 3 * STEPS + 1,
+          "reset one instance through the shared power-on snapshot");
+
+    for (int i = 0; i < N; i++) gbe_destroy(ref[i]);
+    gbe_vec_destroy(v);
+    free(obs);
+    free(rom);
+}
+
+/* Observation expected from a full frame, per the gbe_set_obs() contract */
+static void expected_obs(const uint8_t *fb, const struct gbe_obs_config_s *cfg, uint8_t *out) {
+    for (int r = 0; r < cfg->height; r++) {
+        const uint8_t *line = fb + (size_t)((2 * r + 1) * GBE_FB_HEIGHT / (2 * cfg->height)) * GBE_FB_WIDTH;
+        for (int x = 0; x < cfg->width; x++) {
+            int x0 = x * GBE_FB_WIDTH / cfg->width, x1 = (x + 1) * GBE_FB_WIDTH / cfg->width;
+            int sum = 0;
+            for (int i = x0; i < x1; i++) sum += line[i];
+            out[r * cfg->width + x] = cfg->format == GBE_OBS_INDEX ? line[(x0 + x1) / 2]
+                                    : (uint8_t)(255 - (85 * sum + (x1 - x0) / 2) / (x1 - x0));
+        }
+    }
+}
+
+/* Test 7: observation sink and frame stack */
+void test_obs(void) {
+    printf("\n=== Test 7: Observations ===\n");
+
+    static const struct { enum stress_rom_kind rom; struct gbe_obs_config_s cfg; const char *what; } cases[] = {
+        { STRESS_SPRITES, { 80, 72, GBE_OBS_GRAY, 1 },   "80x72 gray (2:1 path) matches the full frame" },
+        { STRESS_WINDOW,  { 84, 84, GBE_OBS_GRAY, 1 },   "84x84 gray with the window matches the full frame" },
+        { STRESS_MIDLINE, { 80, 72, GBE_OBS_INDEX, 1 },  "80x72 shade index matches the full frame" },
+    };
+    static uint8_t want[GBE_FB_SIZE];
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        uint8_t *rom = NULL;
+        size_t size = stress_rom_build(cases[c].rom, &rom);
+        struct gbe_s *g = gbe_create(rom, size, NULL);
+        struct gbe_s *ref = gbe_create(rom, size, NULL);
+        int same = gbe_set_obs(g, &cases[c].cfg) == 0;
+
+        for (int s = 0; s < 8 && same; s++) {
+            uint64_t lines = gbe_core(g)->stats.lines_drawn;
+            gbe_step(g, 0xFF, 2);
+            gbe_step(ref, 0xFF, 2);
+            expected_obs(gbe_framebuffer(ref), &cases[c].cfg, want);
+            same = memcmp(gbe_obs(g, 0), want, gbe_obs_size(g)) == 0 &&
+                   gbe_core(g)->stats.lines_drawn - lines == (uint64_t)cases[c].cfg.height;
+        }
+        check(same, cases[c].what);
+
+        gbe_destroy(g);
+        gbe_destroy(ref);
+        free(rom);
+    }
+
+    /* Frame stack */
+    uint8_t *rom = NULL;
+    size_t size = stress_rom_build(STRESS_SPRITES, &rom);
+    struct gbe_s *g = gbe_create(rom, size, NULL);
+    struct gbe_obs_config_s cfg = { 84, 84, GBE_OBS_GRAY, 4 };
+    static uint8_t history[6][84 * 84], stack[4 * 84 * 84];
+
+    check(gbe_set_obs(g, &(struct gbe_obs_config_s){ 200, 84, GBE_OBS_GRAY, 4 }) != 0 && gbe_obs(g, 0) == NULL,
+          "bad config rejected");
+    gbe_set_obs(g, &cfg);
+
+    gbe_step(g, 0xFF, 1);
+    check(gbe_obs(g, 3) == gbe_obs(g, 0), "short history repeats the oldest observation");
+
+    for (int s = 0; s < 6; s++) {
+        gbe_step(g, (uint8_t)~(1u << s), 1);
+        memcpy(history[s], gbe_obs(g, 0), sizeof(history[s]));
+    }
+    gbe_obs_stack(g, stack);
+    int ordered = 1;
+    for (int k = 0; k < 4; k++) {
+        if (memcmp(stack + k * sizeof(history[0]), history[2 + k], sizeof(history[0])) != 0) ordered = 0;
+    }
+    check(ordered && memcmp(gbe_obs(g, 1), history[4], sizeof(history[4])) == 0, "stack holds the last four, oldest first");
+
+    /* Vector with a sink: the stacks land in the obs buffer */
+    struct gbe_vec_s *v = gbe_vec_create(rom, size, 3, 2, NULL);
+    uint8_t actions[3] = { 0xFF, 0xFE, 0xFD };
+    uint8_t *obs = malloc(3 * sizeof(stack));
+    check(gbe_vec_set_obs(v, &cfg) == 0 && gbe_vec_obs_bytes(v) == sizeof(stack), "vector obs size is the stack");
+    for (int s = 0; s < 5; s++) gbe_vec_step(v, actions, 2, obs);
+    gbe_obs_stack(gbe_vec_env(v, 2), stack);
+    check(memcmp(obs + 2 * sizeof(stack), stack, sizeof(stack)) == 0, "vector step copies each stack out");
+
+    free(obs);
+    gbe_vec_destroy(v);
+    gbe_destroy(g);
+    free(rom);
+}
+
+static uint64_t saved_hash(const struct gbe_s *g, struct gb_state_s *tmp) {
+    gbe_save(g, tmp);
+    return state_hash(&tmp->gb, tmp->cart_ram, tmp->cart_ram_size);
+}
+
+/* Test 8: copy-on-write forks */
+void test_fork(void) {
+    printf("\n=== Test 8: Forks ===\n");
+
+    uint8_t *rom = NULL;
+    size_t size = stress_rom_build(STRESS_MBC1, &rom);
+    struct gbe_s *g = gbe_create(rom, size, NULL);
+    struct gb_state_s *st = gbe_state_new(g);
+    struct gb_state_s *tmp = gbe_state_new(g);
+    const int total = (WRAM_SIZE + (int)st->cart_ram_size) >> MMU_PAGE_SHIFT;
+    const char *why = NULL;
+
+    gbe_step(g, 0xFF, 10);
+    gbe_save(g, st);
+    uint64_t node = state_hash(&st->gb, st->cart_ram, st->cart_ram_size);
+
+    struct gbe_s *f = gbe_fork(g, st, &why);
+    check(f != NULL && gbe_fork_pages(f) == 0, "a fork starts out sharing every page");
+    check(saved_hash(f, tmp) == node, "and is in the snapshot's state");
+
+    gbe_reset(g, st);
+    gbe_step(g, 0x7F, 20);
+    gbe_step(f, 0x7F, 20);
+    int pages = gbe_fork_pages(f);
+    check(pages > 0 && pages < total, "only the pages written are copied");
+    uint64_t ran = saved_hash(g, tmp);
+    check(saved_hash(f, tmp) == ran &&
+          memcmp(gbe_framebuffer(f), gbe_framebuffer(g), GBE_FB_SIZE) == 0,
+          "a fork runs exactly like a full instance");
+    check(state_hash(&st->gb, st->cart_ram, st->cart_ram_size) == node, "the snapshot is left untouched");
+
+    struct gbe_s *f2 = gbe_fork(g, st, NULL);
+    gbe_step(f2, 0xFE, 20);
+    check(saved_hash(f, tmp) == ran, "sibling forks do not see each other's writes");
+
+    gbe_reset(f, st);
+    check(gbe_fork_pages(f) == 0 && saved_hash(f, tmp) == node, "reset shares the snapshot again");
+    gbe_step(f, 0x7F, 20);
+    check(gbe_fork_pages(f) == pages && saved_hash(f, tmp) == ran, "and replays the same rollout");
+
+    uint8_t cram = wram_at(f, STRESS_WRAM_CRAM);
+    check(mmu_wram_shared(gbe_core(f)) == 0 && cram != 0 && cram == wram_at(g, STRESS_WRAM_CRAM), "gbe_wram() copies the rest of work RAM in");
+
+    gbe_reset(f, st);
+    gbe_save(f, st);
+    check(state_hash(&st->gb, st->cart_ram, st->cart_ram_size) == node, "saving into the shared snapshot keeps it");
+
+    gbe_reset(f, NULL);
+    check(gbe_core(f)->cpu_reg.pc.reg == 0x0100 && gbe_core(f)->stats.frames == 0, "NULL forks from power-on");
+
+    tmp->cart_ram_size = 0;
+    why = NULL;
+    check(gbe_fork(g, tmp, &why) == NULL && why != NULL, "snapshot for another cartridge rejected");
+    tmp->cart_ram_size = st->cart_ram_size;
+
+    gbe_destroy(f2);
+    gbe_destroy(f);
+    gbe_state_free(tmp);
+    gbe_state_free(st);
+    gbe_destroy(g);
+    free(rom);
+}
+
+/* Hash of a snapshot from scratch */
+static uint64_t full_hash(const struct gb_state_s *st) {
+    const uint8_t *cram[MMU_CRAM_PAGES];
+    int n = (int)(st->cart_ram_size >> MMU_PAGE_SHIFT);
+    for (int i = 0; i < n; i++) cram[i] = st->cart_ram + ((size_t)i << MMU_PAGE_SHIFT);
+    return state_hash_full(&st->gb, cram, n);
+}
+
+/* Test 9: incremental hash and duplicate states */
+void test_hash(void) {
+    printf("\n=== Test 9: State Hash ===\n");
+
+    uint8_t *rom = NULL;
+    size_t size = stress_rom_build(STRESS_MBC1, &rom);
+    struct gbe_s *g = gbe_create(rom, size, NULL);
+    struct gb_state_s *st = gbe_state_new(g);
+
+    uint64_t h0 = gbe_hash(g);
+    gbe_save(g, st);
+    check(h0 == full_hash(st), "first hash matches a full one");
+
+    int same = 1;
+    uint64_t prev = h0;
+    for (int s = 0; s < 30; s++) {
+        gbe_step(g, (uint8_t)(0xFF ^ (1 << (s & 7))), 1);
+        uint64_t h = gbe_hash(g);
+        gbe_save(g, st);
+        if (h != full_hash(st) || h == prev) same = 0;
+        prev = h;
+    }
+    check(same, "incremental hash tracks every step and matches a full one");
+    check(gbe_hash(g) == prev, "no writes, same hash");
+
+    struct gbe_s *f = gbe_fork(g, st, NULL);
+    check(gbe_hash(f) == prev, "a fork hashes like the state it came from");
+    gbe_core(f)->stats.cycles += 12345;
+    gbe_core(f)->stats.frames += 7;
+    check(gbe_hash(f) == prev, "cycle counts and statistics are not part of the state");
+    gbe_step(f, 0xFF, 2);
+    gbe_step(g, 0xFF, 2);
+    check(gbe_hash(f) == gbe_hash(g), "same input, same hash");
+
+    /* Four copies of one state: the table sees the first and flags the rest */
+    struct gbe_vec_s *v = gbe_vec_create(rom, size, 4, 2, NULL);
+    struct ttable_s *tt = ttable_create(1024);
+    uint8_t actions[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+    uint8_t seen[4];
+    uint64_t hashes[4];
+
+    gbe_vec_set_tt(v, tt);
+    gbe_vec_step(v, actions, 3, NULL);
+    check(gbe_vec_seen(v, seen, hashes) == 3 && hashes[0] == hashes[3] && ttable_count(tt) == 1,
+          "identical instances after a vector step: three pruned");
+    gbe_vec_step(v, actions, 1, NULL);
+    check(gbe_vec_seen(v, NULL, NULL) == 3 && ttable_count(tt) == 2, "next state is new to the table");
+
+    gbe_reset(gbe_vec_env(v, 1), NULL);
+    gbe_vec_step(v, actions, 3, NULL);
+    /* 0, 2 and 3 reach one new state; whichever thread gets there first
+       inserts it */
+    int n_seen = gbe_vec_seen(v, seen, NULL);
+    check(seen[1] && n_seen == 3 && seen[0] + seen[2] + seen[3] == 2,
+          "an instance that repeats an old state is flagged");
+
+    gbe_vec_set_tt(v, NULL);
+    gbe_vec_step(v, actions, 1, NULL);
+    check(gbe_vec_seen(v, NULL, NULL) == 0, "no table, nothing flagged");
+
+    ttable_destroy(tt);
+    gbe_vec_destroy(v);
+    gbe_destroy(f);
+    gbe_state_free(st);
+    gbe_destroy(g);
+    free(rom);
+}
+
+/* Test 10: copying an instance */
+void test_copy(void) {
+    printf("\n=== Test 10: Copy ===\n");
+
+    uint8_t *rom = NULL;
+    size_t size = stress_rom_build(STRESS_MBC1, &rom);
+    struct gbe_s *a = gbe_create(rom, size, NULL);
+    struct gbe_s *b = gbe_create(rom, size, NULL);
+    struct gbe_vec_s *v = gbe_vec_create(rom, size, 2, 1, NULL);
+    struct gbe_s *e = gbe_vec_env(v, 1);
+
+    /* Core, framebuffer and cartridge RAM, plus under 4 KB of the rest */
+    size_t base = gbe_size(b);
+    size_t parts = sizeof(struct gb_s) + GBE_FB_SIZE + (size_t)gbe_core(b)->num_ram_banks * 0x2000;
+    check(base >= parts && base < parts + 4096, "an instance is little more than its memory");
+
+    gbe_step(a, 0xFF, 25);
+    gbe_hash(a);
+    gbe_step(a, 0x7F, 2);
+    gbe_core(b)->stats.time_ppu = true;
+    gbe_core(b)->direct.priv = &base;
+    check(gbe_copy(b, a) == 0 && gbe_copy(e, a) == 0, "copied into an instance and a vector slot");
+    check(gbe_size(b) == base, "copying allocates nothing");
+
+    struct gb_s *gb = gbe_core(b);
+    check(gb->stats.time_ppu && gb->direct.priv == &base && !gbe_core(a)->stats.time_ppu,
+          "host-owned fields stay the destination's");
+    check(gb->mmu.rd[0xC0] == &gb->wram[0] && gb->mmu.wr[0x80] == &gb->vram[0] && gbe_wram(b) != gbe_wram(a),
+          "the copy's page table points into its own memory");
+    check(gbe_hash(b) == gbe_hash(a), "copy hashes like the original");
+
+    int same = 1;
+    for (int s = 0; s < 20; s++) {
+        uint8_t joypad = (uint8_t)(0xFF ^ (1 << (s & 7)));
+        gbe_step(a, joypad, 1);
+        gbe_step(b, joypad, 1);
+        gbe_step(e, joypad, 1);
+        if (memcmp(gbe_wram(a), gbe_wram(b), WRAM_SIZE) != 0 || memcmp(gbe_wram(a), gbe_wram(e), WRAM_SIZE) != 0 ||
+            memcmp(gbe_framebuffer(a), gbe_framebuffer(b), GBE_FB_SIZE) != 0 || gbe_hash(a) != gbe_hash(b)) {
+            same = 0;
+        }
+    }
+    check(same, "copies run on exactly like the original");
+    check(gbe_core(a)->stats.frames == gbe_core(b)->stats.frames && gbe_core(gbe_vec_env(v, 0))->stats.frames == 0,
+          "neighbouring slot untouched");
+
+    struct gbe_s *f = gbe_fork(a, NULL, NULL);
+    check(gbe_copy(f, a) == -1 && gbe_copy(a, f) == -1, "forks cannot be copied");
+    uint8_t *other = NULL;
+    size_t other_size = stress_rom_build(STRESS_MBC1, &other);
+    struct gbe_s *c = gbe_create(other, other_size, NULL);
+    check(gbe_copy(c, a) == -1, "instances of another ROM image cannot be copied");
+
+    gbe_destroy(c);
+    free(other);
+    gbe_destroy(f);
+    gbe_vec_destroy(v);
+    gbe_destroy(b);
+    gbe_destroy(a);
+    free(rom);
+}
+
+int main(void) {
+    printf("Embeddable API Test Suite\n");
+    printf("=========================\n");
+
+    test_create();
+    test_step();
+    test_reset();
+    test_instances();
+    test_errors();
+    test_vec();
+    test_obs();
+    test_fork();
+    test_hash();
+    test_copy();
+
+    return test_summary("embeddable API");
+}
@@ -0,0 +1,179 @@
+/**
+ * gdbstub_test.c - Tests for the GDB remote protocol stub
+ *
+ * Plays the GDB side over a socketpair: checks packet framing and acks,
+ * register and memory access (without side effects), breakpoints,
+ * watchpoints, single-step, continue / interrupt and detach.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "gb_types.h"
+#include "cpu.h"
+#include "memory.h"
+#include "debug.h"
+#include "gdbstub.h"
+#include "timers.h"
+#include "test_machine.h"
+
+static int gdb_fd;
+
+static const uint8_t prog[] = {
+    0x21, 0x00, 0xC0,   // 0100  LD HL, $C000
+    0x3E, 0x07,         // 0103  LD A, $07
+    0x77,               // 0105  LD (HL), A
+    0x23,               // 0106  INC HL
+    0x00,               // 0107  NOP
+    0x18, 0xF6,         // 0108  JR $0100
+};
+
+static void machine_setup(struct gb_s *gb) {
+    machine_init(gb);
+    memcpy(&test_rom[0x0100], prog, sizeof(prog));
+}
+
+/* Send a packet as GDB would and return the stub's reply payload */
+static const char *transact(struct gdbstub_s *s, struct gb_s *gb, const char *data) {
+    static char reply[2048];
+    char pkt[512];
+    uint8_t sum = 0;
+
+    for (const char *p = data; *p; p++) sum = (uint8_t)(sum + (uint8_t)*p);
+    snprintf(pkt, sizeof(pkt), "$%s#%02x", data, sum);
+    if (write(gdb_fd, pkt, strlen(pkt)) < 0) return "";
+    gdbstub_poll(s, gb);
+
+    ssize_t n = recv(gdb_fd, reply, sizeof(reply) - 1, MSG_DONTWAIT);
+    if (n <= 0) return "";
+    reply[n] = '\0';
+
+    /* Strip the ack and the framing */
+    char *start = strchr(reply, '$');
+    char *hash = start ? strchr(start, '#') : NULL;
+    if (!start || !hash) return "";    /* Just the ack */
+    *hash = '\0';
+    return start + 1;
+}
+
+/* Test 1: connect, framing and registers */
+void test_registers(struct gdbstub_s *s, struct gb_s *gb) {
+    printf("\n=== Test 1: Connect and Registers ===\n");
+
+    gdbstub_poll(s, gb);
+    check(gb->debug && gb->gb_break, "connecting attaches a debugger and stops the CPU");
+
+    check(strcmp(transact(s, gb, "?"), "S02") == 0, "? reports the interrupt stop");
+    check(strstr(transact(s, gb, "qSupported:multiprocess+"), "PacketSize=400") != NULL, "qSupported");
+
+    /* AF=01B0 BC=0013 DE=00D8 HL=014D SP=FFFE PC=0100, little-endian */
+    check(strcmp(transact(s, gb, "g"), "b0011300d8004d01feff0001") == 0, "g returns AF BC DE HL SP PC");
+
+    check(strcmp(transact(s, gb, "P3=3412"), "OK") == 0 && gb->cpu_reg.hl.reg == 0x1234, "P sets HL");
+    check(strcmp(transact(s, gb, "p3"), "3412") == 0, "p reads HL");
+    check(strcmp(transact(s, gb, "p9"), "E01") == 0, "bad register rejected");
+
+    /* Corrupt checksum gets a NAK */
+    char buf[16];
+    if (write(gdb_fd, "$g#00", 5) < 0) return;
+    gdbstub_poll(s, gb);
+    ssize_t n = recv(gdb_fd, buf, sizeof(buf), MSG_DONTWAIT);
+    check(n == 1 && buf[0] == '-', "bad checksum NAKed");
+}
+
+/* Test 2: memory access has no side effects */
+void test_memory(struct gdbstub_s *s, struct gb_s *gb) {
+    printf("\n=== Test 2: Memory ===\n");
+
+    check(strcmp(transact(s, gb, "m100,3"), "2100c0") == 0, "m reads ROM");
+
+    check(strcmp(transact(s, gb, "Mc010,2:abcd"), "OK") == 0 && gb->wram[0x10] == 0xAB && gb->wram[0x11] == 0xCD,
+          "M writes WRAM");
+
+    uint16_t bank = gb->selected_rom_bank;
+    transact(s, gb, "M2000,1:03");
+    check(gb->selected_rom_bank == bank, "M to the ROM area does not switch banks");
+
+    timers_set_div(gb, 0x42);
+    transact(s, gb, "Mff46,1:c0");
+    check(gb->oam[0] == 0 && gb->hram_io[IO_DMA] == 0xC0, "M to DMA stores the byte without a transfer");
+    check(strcmp(transact(s, gb, "mff04,1"), "42") == 0, "m reads DIV");
+}
+
+/* Test 3: breakpoints, watchpoints, step and continue */
+void test_execution(struct gdbstub_s *s, struct gb_s *gb) {
+    printf("\n=== Test 3: Execution ===\n");
+
+    check(strcmp(transact(s, gb, "s"), "S05") == 0 && gb->cpu_reg.pc.reg == 0x0103, "s steps one instruction");
+
+    check(strcmp(transact(s, gb, "Z0,106,1"), "OK") == 0 && (gb->mmu.trap[0x01] & MMU_TRAP_EXEC),
+          "Z0 sets a breakpoint");
+    check(strcmp(transact(s, gb, "c"), "") == 0 && !gb->gb_break, "c resumes with no immediate reply");
+
+    while (!gb->gb_break) cpu_step(gb);
+    gdbstub_poll(s, gb);
+    char buf[64];
+    ssize_t n = recv(gdb_fd, buf, sizeof(buf) - 1, MSG_DONTWAIT);
+    buf[n > 0 ? n : 0] = '\0';
+    check(strstr(buf, "$S05#") != NULL && gb->cpu_reg.pc.reg == 0x0106, "breakpoint hit reported as S05");
+
+    check(strcmp(transact(s, gb, "z0,106,1"), "OK") == 0 && gb->mmu.trap[0x01] == 0, "z0 removes it");
+
+    check(strcmp(transact(s, gb, "Z2,c000,1"), "OK") == 0 && !gb->mmu.wr[0xC0], "Z2 sets a write watch");
+    transact(s, gb, "c");
+    while (!gb->gb_break) cpu_step(gb);
+    gdbstub_poll(s, gb);
+    n = recv(gdb_fd, buf, sizeof(buf) - 1, MSG_DONTWAIT);
+    buf[n > 0 ? n : 0] = '\0';
+    check(strstr(buf, "T05watch:c000;") != NULL, "watch hit reported with the address");
+    transact(s, gb, "z2,c000,1");
+
+    /* Ctrl-C while running */
+    transact(s, gb, "c");
+    if (write(gdb_fd, "\x03", 1) < 0) return;
+    gdbstub_poll(s, gb);
+    n = recv(gdb_fd, buf, sizeof(buf) - 1, MSG_DONTWAIT);
+    buf[n > 0 ? n : 0] = '\0';
+    check(gb->gb_break && strstr(buf, "$S02#") != NULL, "interrupt stops the CPU");
+}
+
+/* Test 4: detach leaves the core as it was */
+void test_detach(struct gdbstub_s *s, struct gb_s *gb) {
+    printf("\n=== Test 4: Detach ===\n");
+
+    transact(s, gb, "Z0,150,1");
+    check(strcmp(transact(s, gb, "D"), "OK") == 0, "D acknowledged");
+    check(s->client_fd < 0 && !gb->debug && !gb->gb_break, "debugger removed and CPU running");
+    check(gb->mmu.trap[0x01] == 0 && gb->mmu.rd[0xC0] == &gb->wram[0], "no traps left behind");
+}
+
+int main(void) {
+    printf("GDB Stub Test Suite\n");
+    printf("===================\n");
+
+    struct gb_s *gb = machine_new();
+    struct gdbstub_s stub;
+    int sv[2];
+
+    machine_setup(gb);
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+        perror("socketpair");
+        return 1;
+    }
+    gdb_fd = sv[0];
+    gdbstub_init(&stub);
+    gdbstub_attach_fd(&stub, sv[1]);
+
+    test_registers(&stub, gb);
+    test_memory(&stub, gb);
+    test_execution(&stub, gb);
+    test_detach(&stub, gb);
+
+    gdbstub_close(&stub, gb);
+    close(gdb_fd);
+    free(gb);
+
+    return test_summary("GDB stub");
+}
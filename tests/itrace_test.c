@@ -0,0 +1,124 @@
+/**
+ * itrace_test.c - Tests for the instruction trace ring
+ *
+ * Runs a short program and checks the packed entries decode back to the
+ * PCs, opcodes and register changes that were executed, that the ring
+ * wraps, and that the dump disassembles the instructions.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gb_types.h"
+#include "cpu.h"
+#include "memory.h"
+#include "itrace.h"
+#include "test_machine.h"
+
+/* Test 1: entries decode to what was executed */
+void test_decode(void) {
+    printf("\n=== Test 1: Decode ===\n");
+
+    struct gb_s *gb = machine_new();
+
+    static const uint8_t prog[] = {
+        0x21, 0x34, 0x12,   // 0100  LD HL, $1234
+        0x3E, 0x42,         // 0103  LD A, $42
+        0x23,               // 0105  INC HL
+        0xAF,               // 0106  XOR A
+        0x00,               // 0107  NOP
+    };
+    memcpy(&test_rom[0x0100], prog, sizeof(prog));
+
+    check(itrace_init(gb, 100) != 0, "non power-of-two size rejected");
+    check(itrace_init(gb, 16) == 0, "16-entry ring allocated");
+    for (int i = 0; i < 5; i++) cpu_step(gb);
+
+    /* Entries hold the state each instruction started with */
+    struct itrace_entry_s e[5];
+    for (uint32_t age = 0; age < 5; age++) itrace_get(gb, 4 - age, &e[age]);
+
+    check(e[0].pc == 0x0100 && e[0].opcode == 0x21, "LD HL, n16 recorded at 0100");
+    check(e[1].pc == 0x0103 && e[1].reg == ITRACE_REG_HL && e[1].value == 0x1234,
+          "HL change shows up on the next entry");
+    check(e[2].pc == 0x0105 && e[2].a == 0x42, "A = 42 before INC HL");
+    check(e[3].reg == ITRACE_REG_HL && e[3].value == 0x1235, "INC HL delta");
+    check(e[4].a == 0x00 && (e[4].flags & 0x8), "XOR A result: A = 0, Z set");
+
+    struct itrace_entry_s none;
+    check(itrace_get(gb, 5, &none) != 0, "no entry beyond what was recorded");
+
+    itrace_free(gb);
+    check(gb->itrace == NULL, "itrace_free() disables tracing");
+    free(gb);
+}
+
+/* Test 2: the ring keeps only the newest entries */
+void test_wrap(void) {
+    printf("\n=== Test 2: Wrap-around ===\n");
+
+    struct gb_s *gb = machine_new();
+
+    /* NOPs up to a JR -2 loop at 0x0200 */
+    memset(&test_rom[0x0100], 0x00, 0x100);
+    test_rom[0x0200] = 0x18;
+    test_rom[0x0201] = 0xFE;
+
+    itrace_init(gb, 8);
+    for (int i = 0; i < 300; i++) cpu_step(gb);
+
+    struct itrace_entry_s e;
+    int ok = 1;
+    for (uint32_t age = 0; age < 8; age++) {
+        ok &= itrace_get(gb, age, &e) == 0 && e.pc == 0x0200 && e.opcode == 0x18;
+    }
+    check(ok, "8 newest entries are the JR loop");
+    check(itrace_get(gb, 8, &e) != 0, "older entries overwritten");
+    check(gb->itrace->count == 300, "count keeps the total");
+
+    itrace_free(gb);
+    free(gb);
+}
+
+/* Test 3: dump output */
+void test_dump(void) {
+    printf("\n=== Test 3: Dump ===\n");
+
+    struct gb_s *gb = machine_new();
+
+    test_rom[0x0100] = 0x3E; test_rom[0x0101] = 0x99;  // LD A, $99
+    test_rom[0x0102] = 0xCB; test_rom[0x0103] = 0x37;  // SWAP A
+
+    itrace_init(gb, 16);
+    cpu_step(gb);
+    cpu_step(gb);
+
+    char buf[512] = "";
+    FILE *f = tmpfile();
+    if (f) {
+        itrace_dump(gb, f, 16);
+        rewind(f);
+        size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+        buf[n] = '\0';
+        fclose(f);
+    }
+    printf("%s", buf);
+
+    check(strstr(buf, "0100  LD A, $99") != NULL, "dump disassembles operands");
+    check(strstr(buf, "0102  SWAP A") != NULL && strstr(buf, "A=99") != NULL,
+          "dump shows CB opcodes and A");
+
+    itrace_free(gb);
+    free(gb);
+}
+
+int main(void) {
+    printf("Instruction Trace Test Suite\n");
+    printf("============================\n");
+
+    test_decode();
+    test_wrap();
+    test_dump();
+
+    return test_summary("instruction trace");
+}
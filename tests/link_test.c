@@ -0,0 +1,245 @@
+/**
+ * link_test.c - Tests for the serial port and the in-process link cable
+ *
+ * Checks SB/SC behaviour with nothing plugged in, then runs a master and a
+ * slave program on two threads joined by a cable: every byte must arrive
+ * on both sides, the exchange must come out the same on every run, and
+ * neither side may deadlock when the other hangs up. A same-thread wire
+ * must keep both sides in step even when one side's statistics are cleared
+ * mid-exchange.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gb_types.h"
+#include "cpu.h"
+#include "memory.h"
+#include "serial.h"
+#include "linkcable.h"
+#include "test_machine.h"
+
+#define TRANSFERS   16
+
+static uint8_t rom_master[0x8000];
+static uint8_t rom_slave[0x8000];
+static struct gb_s *gb_slave;
+
+/* Sends 0, 1, ... 15 and stores what comes back at $C000 */
+static const uint8_t master_prog[] = {
+    0x21, 0x00, 0xC0,   // 0100  LD HL, $C000
+    0x06, 0x00,         // 0103  LD B, $00
+    0x78,               // 0105  LD A, B
+    0xE0, 0x01,         // 0106  LDH ($01), A      SB
+    0x3E, 0x81,         // 0108  LD A, $81
+    0xE0, 0x02,         // 010A  LDH ($02), A      SC: start, internal clock
+    0xF0, 0x02,         // 010C  LDH A, ($02)
+    0xCB, 0x7F,         // 010E  BIT 7, A
+    0x20, 0xFA,         // 0110  JR NZ, $010C
+    0xF0, 0x01,         // 0112  LDH A, ($01)
+    0x22,               // 0114  LD (HL+), A
+    0x04,               // 0115  INC B
+    0x78,               // 0116  LD A, B
+    0xFE, TRANSFERS,    // 0117  CP TRANSFERS
+    0x20, 0xEA,         // 0119  JR NZ, $0105
+    0x18, 0xFE,         // 011B  JR $011B
+};
+
+/* Stores each byte received at $C000 and answers it + $40 on the next one */
+static const uint8_t slave_prog[] = {
+    0x21, 0x00, 0xC0,   // 0100  LD HL, $C000
+    0x3E, 0x40,         // 0103  LD A, $40
+    0xE0, 0x01,         // 0105  LDH ($01), A      SB
+    0x3E, 0x80,         // 0107  LD A, $80
+    0xE0, 0x02,         // 0109  LDH ($02), A      SC: start, external clock
+    0xF0, 0x02,         // 010B  LDH A, ($02)
+    0xCB, 0x7F,         // 010D  BIT 7, A
+    0x20, 0xFA,         // 010F  JR NZ, $010B
+    0xF0, 0x01,         // 0111  LDH A, ($01)
+    0x22,               // 0113  LD (HL+), A
+    0xC6, 0x40,         // 0114  ADD A, $40
+    0x18, 0xED,         // 0116  JR $0105
+};
+
+/* Each side runs its own program */
+static uint8_t link_rom_read(struct gb_s *gb, uint32_t addr) {
+    const uint8_t *rom = gb == gb_slave ? rom_slave : rom_master;
+    return addr < sizeof(rom_master) ? rom[addr] : 0xFF;
+}
+
+static void machine_setup(struct gb_s *gb) {
+    machine_init(gb);
+    gb->gb_rom_read = link_rom_read;
+}
+
+/* Test 1: serial port with no cable */
+void test_unplugged(void) {
+    printf("\n=== Test 1: No Cable ===\n");
+
+    struct gb_s *gb = machine_new();
+    machine_setup(gb);
+
+    check(mmu_read(gb, 0xFF02) == 0x7E, "SC reads back unused bits as 1");
+
+    /* Run the master program up to its first completed transfer */
+    uint64_t start = 0;
+    while (gb->cpu_reg.pc.reg != 0x0112) {
+        cpu_step(gb);
+        if (gb->cpu_reg.pc.reg == 0x010C && !start) start = gb->counter.cycles;
+    }
+    check(gb->counter.cycles - start >= SERIAL_CYCLES && gb->counter.cycles - start < SERIAL_CYCLES + 32,
+          "transfer takes 4096 cycles");
+    check(gb->hram_io[IO_SB] == 0xFF && (gb->hram_io[IO_IF] & SERIAL_INTR) && !(gb->hram_io[IO_SC] & SC_TRANSFER),
+          "master reads 0xFF, SC bit 7 clears, interrupt requested");
+
+    /* External clock with nothing on the other end never completes */
+    gb->cpu_reg.pc.reg = 0x011B;
+    mmu_write(gb, 0xFF02, 0x80);
+    for (int i = 0; i < 10000; i++) cpu_step(gb);
+    check((gb->hram_io[IO_SC] & SC_TRANSFER) != 0, "slave without a cable keeps waiting");
+
+    free(gb);
+}
+
+struct side_s {
+    struct link_cable_s *cable;
+    int side;
+    uint64_t cycles;
+};
+
+static void *side_main(void *arg) {
+    struct side_s *s = arg;
+    cable_run(s->cable, s->side, s->cycles);
+    cable_hangup(s->cable, s->side);
+    return NULL;
+}
+
+/* Run master and slave for @frames on two threads; results left in WRAM */
+static void run_linked(struct gb_s *a, struct gb_s *b, uint64_t cycles_a, uint64_t cycles_b,
+                       struct link_cable_s **out) {
+    machine_setup(a);
+    machine_setup(b);
+
+    struct link_cable_s *cable = cable_create(a, b);
+    struct side_s sa = { cable, 0, cycles_a };
+    struct side_s sb = { cable, 1, cycles_b };
+    pthread_t ta, tb;
+
+    pthread_create(&ta, NULL, side_main, &sa);
+    pthread_create(&tb, NULL, side_main, &sb);
+    pthread_join(ta, NULL);
+    pthread_join(tb, NULL);
+
+    *out = cable;
+}
+
+/* Test 2: master and slave on two threads */
+void test_linked(void) {
+    printf("\n=== Test 2: Two Instances ===\n");
+
+    struct gb_s *a = machine_new();
+    struct gb_s *b = machine_new();
+    struct link_cable_s *cable;
+    gb_slave = b;
+
+    run_linked(a, b, 20 * LCD_FRAME_CYCLES, 20 * LCD_FRAME_CYCLES, &cable);
+
+    int slave_ok = 1, master_ok = a->wram[0] == 0x40;
+    for (int i = 0; i < TRANSFERS; i++) {
+        if (b->wram[i] != i) slave_ok = 0;
+        if (i > 0 && a->wram[i] != (uint8_t)(i - 1 + 0x40)) master_ok = 0;
+    }
+    check(slave_ok, "slave received 0..15");
+    check(master_ok, "master received each answer");
+    check(cable->end[0].transfers == TRANSFERS && a->cpu_reg.pc.reg == 0x011B, "master finished all transfers");
+    check(b->wram[TRANSFERS] == 0 && (b->hram_io[IO_SC] & SC_TRANSFER), "slave waiting for the next byte");
+
+    uint8_t first[2][TRANSFERS];
+    memcpy(first[0], a->wram, TRANSFERS);
+    memcpy(first[1], b->wram, TRANSFERS);
+    uint64_t stalls = cable->end[0].stalls + cable->end[1].stalls;
+    cable_destroy(cable);
+    check(!a->link && !b->link, "destroy unplugs both sides");
+
+    int same = 1;
+    for (int run = 0; run < 20 && same; run++) {
+        run_linked(a, b, 20 * LCD_FRAME_CYCLES, 20 * LCD_FRAME_CYCLES, &cable);
+        same = memcmp(first[0], a->wram, TRANSFERS) == 0 && memcmp(first[1], b->wram, TRANSFERS) == 0;
+        stalls += cable->end[0].stalls + cable->end[1].stalls;
+        cable_destroy(cable);
+    }
+    check(same, "same exchange on 20 more runs");
+    printf("  (%llu waits for the peer over 21 runs)\n", (unsigned long long)stalls);
+
+    free(a);
+    free(b);
+}
+
+/* Test 3: one side hangs up early */
+void test_hangup(void) {
+    printf("\n=== Test 3: Hang Up ===\n");
+
+    struct gb_s *a = machine_new();
+    struct gb_s *b = machine_new();
+    struct link_cable_s *cable;
+    gb_slave = b;
+
+    /* Slave leaves after a handful of transfers; master must not block */
+    run_linked(a, b, 20 * LCD_FRAME_CYCLES, 5 * SERIAL_CYCLES, &cable);
+    check(a->cpu_reg.pc.reg == 0x011B, "master runs on after the slave hangs up");
+    check(a->wram[TRANSFERS - 1] == 0xFF, "and reads 0xFF from then on");
+    cable_destroy(cable);
+
+    /* Master leaves at once; slave waiting on the external clock runs on */
+    run_linked(a, b, 64, 10 * LCD_FRAME_CYCLES, &cable);
+    check(b->counter.cycles >= 10 * LCD_FRAME_CYCLES, "slave runs on after the master hangs up");
+    cable_destroy(cable);
+
+    free(a);
+    free(b);
+}
+
+/* Test 4: transfer timing runs off counter.cycles, not the statistics */
+void test_stats_reset(void) {
+    printf("\n=== Test 4: Statistics Reset ===\n");
+
+    struct gb_s *a = machine_new();
+    struct gb_s *b = machine_new();
+    struct serial_wire_s wire;
+    gb_slave = b;
+
+    machine_setup(a);
+    machine_setup(b);
+    serial_wire_connect(&wire, a, b);
+
+    serial_wire_run(&wire, 4 * SERIAL_CYCLES);
+    memset(&b->stats, 0, sizeof(b->stats));
+    serial_wire_run(&wire, 2 * LCD_FRAME_CYCLES);
+
+    int slave_ok = 1;
+    for (int i = 0; i < TRANSFERS; i++) {
+        if (b->wram[i] != i) slave_ok = 0;
+    }
+    check(slave_ok && a->cpu_reg.pc.reg == 0x011B, "exchange completes across a stats reset");
+    check(a->counter.cycles - 2 * LCD_FRAME_CYCLES < 32 && b->counter.cycles - 2 * LCD_FRAME_CYCLES < 32,
+          "both sides stop at the same cycle");
+
+    free(a);
+    free(b);
+}
+
+int main(void) {
+    printf("Link Cable Test Suite\n");
+    printf("=====================\n");
+
+    memcpy(&rom_master[0x0100], master_prog, sizeof(master_prog));
+    memcpy(&rom_slave[0x0100], slave_prog, sizeof(slave_prog));
+
+    test_unplugged();
+    test_linked();
+    test_hangup();
+    test_stats_reset();
+
+    return test_summary("link cable");
+}
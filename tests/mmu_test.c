@@ -0,0 +1,70 @@
+/**
+ * mmu_test.c - Tests for MMU dirty-page tracking
+ *
+ * Checks that CPU writes, echo RAM, OAM DMA, banked cart RAM and debugger
+ * pokes mark the right pages in the dirty bitmap, and that tracking
+ * leaves direct pages on the fast path.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "gb_types.h"
+#include "memory.h"
+#include "test_machine.h"
+
+/* Test 1: dirty page bitmap */
+void test_dirty(void) {
+    printf("\n=== Test 1: Dirty Pages ===\n");
+
+    struct gb_s *gb = machine_new();
+    struct mmu_dirty_s d;
+
+    mmu_dirty_clear(gb);
+    mmu_dirty(gb, &d);
+    check(!d.page[0] && !d.page[1] && !d.page[2] && d.page[3] == 1ULL << 63 && !d.cram[0] && !d.cram[1],
+          "after a clear only the I/O page is dirty");
+
+    mmu_write(gb, 0xC123, 0x01);
+    mmu_write(gb, 0xE234, 0x02);
+    mmu_write(gb, 0x8010, 0x03);
+    mmu_write(gb, 0x2000, 0x01);
+    mmu_dirty(gb, &d);
+    check(mmu_dirty_test(d.page, 0xC1) && mmu_dirty_test(d.page, 0xC2) && mmu_dirty_test(d.page, 0x80),
+          "WRAM, echo and VRAM writes mark their pages");
+    check(!mmu_dirty_test(d.page, 0xE2) && !mmu_dirty_test(d.page, 0x20) && !mmu_dirty_test(d.page, 0xFE) &&
+          __builtin_popcountll(d.page[2]) + __builtin_popcountll(d.page[3]) == 4,
+          "echo folded into WRAM, ROM writes not reported");
+    check(gb->mmu.wr[0xC1] == &gb->wram[0x100], "direct pages stay direct");
+
+    mmu_dirty_clear(gb);
+    mmu_dma_transfer(gb, 0xC0);
+    mmu_dirty(gb, &d);
+    check(mmu_dirty_test(d.page, 0xFE) && !mmu_dirty_test(d.page, 0xC0), "OAM DMA marks OAM only");
+
+    gb->mbc = 1;
+    gb->cart_ram = 1;
+    gb->num_ram_banks = 4;
+    mmu_write(gb, 0x0000, 0x0A);    /* RAM enable */
+    mmu_write(gb, 0x4000, 0x02);    /* Bank 2 */
+    mmu_write(gb, 0x6000, 0x01);    /* RAM banking mode */
+    mmu_write(gb, 0xA310, 0x55);
+    mmu_dirty(gb, &d);
+    check(mmu_dirty_test(d.cram, 0x43) && __builtin_popcountll(d.cram[0]) + __builtin_popcountll(d.cram[1]) == 1 &&
+          !mmu_dirty_test(d.page, 0xA3), "cart RAM writes mark the page of the bank written");
+
+    mmu_dirty_clear(gb);
+    mmu_poke(gb, 0x9F00, 0x01);
+    mmu_dirty(gb, &d);
+    check(mmu_dirty_test(d.page, 0x9F), "debugger pokes are tracked");
+
+    free(gb);
+}
+
+int main(void) {
+    printf("MMU Test Suite\n");
+    printf("==============\n");
+
+    test_dirty();
+
+    return test_summary("MMU");
+}
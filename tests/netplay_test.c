@@ -0,0 +1,261 @@
+/**
+ * netplay_test.c - Tests for save states and rollback netplay
+ *
+ * Checks that a snapshot restores a machine exactly and that a clone carries
+ * none of the host's fields, then plays a session
+ * between two processes over loopback UDP with injected latency and loss:
+ * both sides must roll back, agree on every exchanged state hash and end in
+ * the same state as a session without loss or latency.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include "gb_types.h"
+#include "cpu.h"
+#include "memory.h"
+#include "serial.h"
+#include "state.h"
+#include "netplay.h"
+#include "test_machine.h"
+
+#define SESSION_FRAMES  240
+
+static int lines_drawn = 0;
+
+static void draw_line(struct gb_s *gb, const uint8_t *pixels, uint8_t line) {
+    (void)gb; (void)pixels; (void)line;
+    lines_drawn++;
+}
+
+/*
+ * Adds the joypad to a running sum over $C000-$C0FF. Whenever no transfer
+ * is in progress it folds the last byte received into the sum and sends
+ * it, as master while START is held and as slave otherwise.
+ */
+static const uint8_t prog[] = {
+    0x21, 0x00, 0xC0,   // 0100  LD HL, $C000
+    0x3E, 0x10,         // 0103  LD A, $10
+    0xE0, 0x00,         // 0105  LDH ($00), A      select buttons
+    0xF0, 0x00,         // 0107  LDH A, ($00)
+    0x47,               // 0109  LD B, A
+    0x86,               // 010A  ADD A, (HL)
+    0x77,               // 010B  LD (HL), A
+    0x2C,               // 010C  INC L
+    0xF0, 0x02,         // 010D  LDH A, ($02)
+    0xCB, 0x7F,         // 010F  BIT 7, A
+    0x20, 0xF0,         // 0111  JR NZ, $0103      transfer in progress
+    0xF0, 0x01,         // 0113  LDH A, ($01)
+    0x86,               // 0115  ADD A, (HL)
+    0x77,               // 0116  LD (HL), A
+    0xE0, 0x01,         // 0117  LDH ($01), A
+    0x78,               // 0119  LD A, B
+    0xE6, 0x08,         // 011A  AND $08           START (0 = held)
+    0x0F, 0x0F, 0x0F,   // 011C  RRCA x3           -> 0 or 1
+    0xEE, 0x81,         // 011F  XOR $81           -> $81 master, $80 slave
+    0xE0, 0x02,         // 0121  LDH ($02), A
+    0x18, 0xDE,         // 0123  JR $0103
+};
+
+static void machine_setup(struct gb_s *gb) {
+    machine_init(gb);
+    gb->direct.joypad = 0xFF;
+}
+
+/* Scripted input: changes every few frames, player 1 holds START at times */
+static uint8_t script(int player, uint32_t frame) {
+    uint32_t x = (frame / (5 + 3 * (uint32_t)player) + 1) * 2654435761u ^ (uint32_t)player * 40503u;
+    uint8_t pressed = (uint8_t)((x >> 13) & 0x07);
+    if (player == 0 && (x >> 20) % 3 == 0) pressed |= JOYPAD_START;
+    return (uint8_t)~pressed;
+}
+
+static uint64_t pair_hash(struct gb_s *gb[2]) {
+    return state_hash(gb[0], NULL, 0) * 31 + state_hash(gb[1], NULL, 0);
+}
+
+static void sleep_ms(int ms) {
+    struct timespec ts = { .tv_sec = 0, .tv_nsec = (long)ms * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+/* Test 1: snapshots */
+void test_state(void) {
+    printf("\n=== Test 1: Save States ===\n");
+
+    struct gb_s *gb = machine_new();
+    struct gb_state_s st;
+    machine_setup(gb);
+
+    while (gb->counter.cycles < LCD_FRAME_CYCLES) cpu_step(gb);
+    check(state_init(&st, 0) == 0, "snapshot allocated");
+    state_save(&st, gb, NULL);
+    uint64_t at_save = state_hash(gb, NULL, 0);
+
+    gb->direct.joypad = 0xF6;
+    while (gb->counter.cycles < 2 * LCD_FRAME_CYCLES) cpu_step(gb);
+    uint64_t after = state_hash(gb, NULL, 0);
+    check(after != at_save, "state changes while running");
+
+    gb->display.lcd_draw_line = draw_line;
+    gb->mmu.trap[0x40] = MMU_TRAP_EXEC;
+    state_load(gb, &st, NULL);
+    check(state_hash(gb, NULL, 0) == at_save, "load restores the saved state");
+    check(gb->display.lcd_draw_line == draw_line && gb->mmu.trap[0x40] == MMU_TRAP_EXEC,
+          "host callbacks and traps survive a load");
+    check(gb->mmu.rd[0xC0] == &gb->wram[0], "page table rebuilt");
+
+    gb->mmu.trap[0x40] = 0;
+    gb->direct.joypad = 0xF6;
+    while (gb->counter.cycles < 2 * LCD_FRAME_CYCLES) cpu_step(gb);
+    check(state_hash(gb, NULL, 0) == after, "same input from the snapshot gives the same state");
+
+    memset(&gb->stats, 0, sizeof(gb->stats));
+    check(state_hash(gb, NULL, 0) == after, "clearing the statistics leaves the hash alone");
+
+    /* A clone has the same state and none of the host's attachments */
+    struct gb_s *peer = machine_new();
+    gb->direct.priv = gb;
+    gb->gb_break = true;
+    gb->mmu.trap[0x40] = MMU_TRAP_EXEC;
+    state_clone(peer, gb);
+    check(state_hash(peer, NULL, 0) == after, "clone hashes the same");
+    check(!peer->gb_rom_read && !peer->gb_error && !peer->display.lcd_draw_line && !peer->direct.priv &&
+          !peer->gb_break && !peer->mmu.trap[0x40] && peer->mmu.rd[0xC0] == &peer->wram[0],
+          "clone has no host fields and its own page table");
+
+    state_free(&st);
+    free(peer);
+    free(gb);
+}
+
+struct result_s {
+    uint64_t hash;
+    struct netplay_stats_s stats;
+};
+
+/* One player's side of a session; returns its final confirmed state */
+static struct result_s play(int local, int fd, int latency_ms, int loss_pct) {
+    struct gb_s *gb[2] = { machine_new(), machine_new() };
+    uint8_t *ram[2] = { NULL, NULL };
+    struct netplay_s *np = malloc(sizeof(*np));
+    struct result_s r = {0};
+
+    machine_setup(gb[0]);
+    machine_setup(gb[1]);
+    gb[local]->display.lcd_draw_line = draw_line;
+
+    netplay_init(np);
+    np->latency_ms = latency_ms;
+    np->loss_pct = loss_pct;
+    netplay_attach_fd(np, fd);
+    if (netplay_start(np, gb, ram, 0, local) != 0) return r;
+
+    /* About 250 frames per second, so latency spans several frames */
+    while (np->frame < SESSION_FRAMES) {
+        netplay_frame(np, script(local, np->frame));
+        sleep_ms(4);
+    }
+
+    /* Wait for the last inputs, then linger so the peer gets our acks */
+    for (int i = 0; i < 2000 && !(netplay_confirmed(np) && np->peer_ack >= np->local_frames); i++) {
+        netplay_poll(np);
+        sleep_ms(1);
+    }
+    for (int i = 0; i < 100; i++) {
+        netplay_poll(np);
+        sleep_ms(1);
+    }
+
+    r.hash = netplay_confirmed(np) ? pair_hash(gb) : 0;
+    r.stats = np->stats;
+    netplay_close(np);
+    free(np);
+    free(gb[0]);
+    free(gb[1]);
+    return r;
+}
+
+/* Both sides as two processes over loopback UDP; player 1 is this process */
+static int session(int latency_ms, int loss_pct, struct result_s out[2]) {
+    int fd[2];
+    struct sockaddr_in addr[2];
+    socklen_t len = sizeof(addr[0]);
+    int pipefd[2];
+
+    for (int i = 0; i < 2; i++) {
+        fd[i] = socket(AF_INET, SOCK_DGRAM, 0);
+        addr[i] = (struct sockaddr_in){ .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+        if (fd[i] < 0 || bind(fd[i], (struct sockaddr *)&addr[i], sizeof(addr[i])) != 0 ||
+            getsockname(fd[i], (struct sockaddr *)&addr[i], &len) != 0) {
+            perror("socket");
+            return -1;
+        }
+    }
+    for (int i = 0; i < 2; i++) {
+        connect(fd[i], (struct sockaddr *)&addr[!i], sizeof(addr[!i]));
+    }
+    if (pipe(pipefd) != 0) return -1;
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fd[0]);
+        struct result_s r = play(1, fd[1], latency_ms, loss_pct);
+        if (write(pipefd[1], &r, sizeof(r)) != sizeof(r)) _exit(1);
+        _exit(0);
+    }
+    close(fd[1]);
+    out[0] = play(0, fd[0], latency_ms, loss_pct);
+
+    int status = 0;
+    ssize_t n = read(pipefd[0], &out[1], sizeof(out[1]));
+    waitpid(pid, &status, 0);
+    close(pipefd[0]);
+    close(pipefd[1]);
+    return n == sizeof(out[1]) && WIFEXITED(status) && WEXITSTATUS(status) == 0 ? 0 : -1;
+}
+
+/* Test 2: two processes, ideal network and a bad one */
+void test_session(void) {
+    printf("\n=== Test 2: Netplay Session ===\n");
+
+    struct result_s clean[2], lossy[2];
+
+    check(session(0, 0, clean) == 0, "clean session completed");
+    check(clean[0].hash && clean[0].hash == clean[1].hash, "both players end in the same state");
+
+    check(session(30, 20, lossy) == 0, "session with 30 ms latency and 20% loss completed");
+    check(lossy[0].hash && lossy[0].hash == lossy[1].hash, "both players end in the same state");
+    check(lossy[0].hash == clean[0].hash, "and it matches the clean session");
+    check(lossy[0].stats.rollbacks > 0 && lossy[1].stats.rollbacks > 0, "mispredictions were rolled back");
+    check(lossy[0].stats.packets_dropped > 0 && lossy[1].stats.packets_dropped > 0, "packets were dropped");
+    check(lossy[0].stats.hashes_checked > 0 && lossy[0].stats.desyncs == 0 && lossy[1].stats.desyncs == 0,
+          "hash exchange found no desync");
+    check(lossy[0].stats.max_rollback <= NETPLAY_MAX_ROLLBACK, "rollbacks stay within the limit");
+
+    for (int i = 0; i < 2; i++) {
+        printf("  player %d: %llu rollbacks (%llu frames, longest %u = %.2f ms), %llu stalls\n", i + 1,
+               (unsigned long long)lossy[i].stats.rollbacks, (unsigned long long)lossy[i].stats.resim_frames,
+               lossy[i].stats.max_rollback, lossy[i].stats.max_rollback_ns / 1e6,
+               (unsigned long long)lossy[i].stats.stalls);
+    }
+}
+
+int main(void) {
+    printf("Netplay Test Suite\n");
+    printf("==================\n");
+
+    memcpy(&test_rom[0x0100], prog, sizeof(prog));
+
+    test_state();
+    test_session();
+
+    return test_summary("netplay");
+}
@@ -0,0 +1,182 @@
+/**
+ * opcode_test.c - Checks the interpreter against the opcode table
+ *
+ * Every opcode is executed once on a synthetic machine; the PC advance and
+ * the cycles cpu_step() returns must match opcodes.h. Conditional branches
+ * are run with the condition both true and false. Also spot-checks the
+ * disassembler generated from the same table.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gb_types.h"
+#include "cpu.h"
+#include "memory.h"
+#include "opcodes.h"
+#include "disasm.h"
+#include "test_machine.h"
+
+#define START_PC    0x0100
+#define STACK_TOP   0xDFF0
+#define RET_ADDR    0xC020
+
+/*
+ * Fresh machine with 'bytes' at START_PC. Operands point into WRAM
+ * (a16 = 0xC010, a8 = 0x10, e8 = +16) so no branch lands on PC + length.
+ */
+static void machine_setup(struct gb_s *gb, uint8_t op, uint8_t cb, uint8_t flags) {
+    machine_init(gb);
+    gb->hram_io[IO_IE] = 0;
+
+    test_rom[START_PC] = op;
+    test_rom[START_PC + 1] = op == 0xCB ? cb : 0x10;
+    test_rom[START_PC + 2] = 0xC0;
+
+    gb->cpu_reg.pc.reg = START_PC;
+    gb->cpu_reg.sp.reg = STACK_TOP;
+    gb->cpu_reg.hl.reg = 0xC100;
+    gb->cpu_reg.f.f_bits.z = (flags >> 7) & 1;
+    gb->cpu_reg.f.f_bits.n = (flags >> 6) & 1;
+    gb->cpu_reg.f.f_bits.h = (flags >> 5) & 1;
+    gb->cpu_reg.f.f_bits.c = (flags >> 4) & 1;
+
+    /* Return address for RET / RETI */
+    mmu_write(gb, STACK_TOP, RET_ADDR & 0xFF);
+    mmu_write(gb, STACK_TOP + 1, RET_ADDR >> 8);
+}
+
+/* Whether a conditional opcode's condition (bits 4-3: NZ, Z, NC, C) holds */
+static int condition_met(uint8_t op, uint8_t flags) {
+    switch ((op >> 3) & 3) {
+        case 0: return !(flags & 0x80);
+        case 1: return (flags & 0x80) != 0;
+        case 2: return !(flags & 0x10);
+        default: return (flags & 0x10) != 0;
+    }
+}
+
+/* Test 1: base opcodes */
+void test_base_opcodes(void) {
+    printf("\n=== Test 1: Base Opcodes vs Table ===\n");
+
+    struct gb_s *gb = machine_new();
+    static const uint8_t flag_sets[] = { 0x00, 0x90 };
+    int checked = 0, bad = 0;
+
+    for (uint32_t op = 0; op < 0x100; op++) {
+        const struct opcode_info *info = &gb_opcodes[op];
+        if ((info->access & OPF_INVALID) || op == 0xCB) continue;
+
+        for (size_t f = 0; f < sizeof(flag_sets); f++) {
+            machine_setup(gb, (uint8_t)op, 0, flag_sets[f]);
+            uint8_t cycles = cpu_step(gb);
+            uint16_t pc = gb->cpu_reg.pc.reg;
+
+            int taken = (info->access & OPF_BRANCH) &&
+                        (!(info->access & OPF_COND) || condition_met((uint8_t)op, flag_sets[f]));
+            uint8_t want_cycles = taken ? info->cycles_taken : info->cycles;
+            int pc_ok = taken ? pc != START_PC + info->length : pc == START_PC + info->length;
+
+            if (cycles != want_cycles || !pc_ok) {
+                printf("  0x%02X %-16s F=%02X: %u cycles (table %u), PC +%d (length %u)\n",
+                       op, info->mnemonic, flag_sets[f], cycles, want_cycles,
+                       pc - START_PC, info->length);
+                bad++;
+            }
+            checked++;
+        }
+    }
+
+    char what[64];
+    snprintf(what, sizeof(what), "%d executions match length and cycles", checked - bad);
+    check(bad == 0 && errors == 0, what);
+    free(gb);
+}
+
+/* Test 2: CB-prefixed opcodes */
+void test_cb_opcodes(void) {
+    printf("\n=== Test 2: CB Opcodes vs Table ===\n");
+
+    struct gb_s *gb = machine_new();
+    int bad = 0;
+
+    for (uint32_t cb = 0; cb < 0x100; cb++) {
+        machine_setup(gb, 0xCB, (uint8_t)cb, 0x00);
+        uint8_t cycles = cpu_step(gb);
+        if (cycles != OPCODE_CB_CYCLES(cb) || gb->cpu_reg.pc.reg != START_PC + 2) {
+            printf("  CB %02X %-12s: %u cycles (table %u), PC +%d\n", cb,
+                   gb_opcode_name(0xCB, (uint8_t)cb, 1), cycles, OPCODE_CB_CYCLES(cb),
+                   gb->cpu_reg.pc.reg - START_PC);
+            bad++;
+        }
+    }
+
+    check(bad == 0, "256 CB opcodes match length and cycles");
+    free(gb);
+}
+
+/* Test 3: operand placeholders agree with instruction lengths */
+void test_table_lengths(void) {
+    printf("\n=== Test 3: Table Self-Consistency ===\n");
+
+    int bad = 0;
+    for (uint32_t op = 0; op < 0x100; op++) {
+        const struct opcode_info *info = &gb_opcodes[op];
+        if (info->access & OPF_INVALID) continue;
+
+        const char *mn = info->mnemonic;
+        uint8_t want = 1;
+        if (strstr(mn, "n16") || strstr(mn, "a16")) want = 3;
+        else if (strstr(mn, "n8") || strstr(mn, "a8") || strstr(mn, "e8")) want = 2;
+        else if (op == 0xCB || op == 0x10) want = 2;    // CB opcode / STOP padding byte
+
+        if (want != info->length || strlen(info->flags) != 4 || info->cycles_taken < info->cycles) {
+            printf("  0x%02X %s: length %u, expected %u\n", op, mn, info->length, want);
+            bad++;
+        }
+    }
+    check(bad == 0, "lengths match operands, flag strings well formed");
+}
+
+/* Test 4: disassembler output */
+void test_disasm(void) {
+    printf("\n=== Test 4: Disassembler ===\n");
+
+    static const struct {
+        uint8_t bytes[3];
+        uint16_t pc;
+        uint8_t length;
+        const char *text;
+    } cases[] = {
+        { { 0x00, 0x00, 0x00 }, 0x0100, 1, "NOP" },
+        { { 0xFA, 0x34, 0x12 }, 0x0100, 3, "LD A, ($1234)" },
+        { { 0x20, 0xFE, 0x00 }, 0x0150, 2, "JR NZ, $0150" },
+        { { 0xE0, 0x44, 0x00 }, 0x0100, 2, "LDH ($44), A" },
+        { { 0xF8, 0xFD, 0x00 }, 0x0100, 2, "LD HL, SP-3" },
+        { { 0xE8, 0x05, 0x00 }, 0x0100, 2, "ADD SP, +5" },
+        { { 0xCB, 0x7E, 0x00 }, 0x0100, 2, "BIT 7, (HL)" },
+        { { 0xCB, 0x37, 0x00 }, 0x0100, 2, "SWAP A" },
+        { { 0xCD, 0x00, 0x40 }, 0x0100, 3, "CALL $4000" },
+        { { 0xFF, 0x00, 0x00 }, 0x0100, 1, "RST $38" },
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        char text[32], what[80];
+        uint8_t length = gb_disasm_bytes(cases[i].bytes, cases[i].pc, text, sizeof(text));
+        snprintf(what, sizeof(what), "%02X -> \"%s\"", cases[i].bytes[0], text);
+        check(length == cases[i].length && strcmp(text, cases[i].text) == 0, what);
+    }
+}
+
+int main(void) {
+    printf("Opcode Table Test Suite\n");
+    printf("=======================\n");
+
+    test_base_opcodes();
+    test_cb_opcodes();
+    test_table_lengths();
+    test_disasm();
+
+    return test_summary("opcode");
+}
@@ -0,0 +1,112 @@
+/**
+ * pacing_test.c - Tests for the frame pacing engine
+ *
+ * Moves the deadline into the past instead of sleeping wherever possible,
+ * so the checks do not depend on how busy the host is: the fractional
+ * period is carried between frames, late frames are counted, a long stall
+ * re-anchors the chain, and rate changes and stats resets leave it alone.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include "pacing.h"
+#include "test_check.h"
+
+#define FRAMES  100
+
+/* Test 1: deadline advance and late frames */
+void test_advance(void) {
+    printf("\n=== Test 1: Deadline Advance ===\n");
+
+    /* 3 Hz: a 333333333.33 ns period, so the remainder has to be carried */
+    struct pacing_s p;
+    pacing_init(&p, 3.0);
+    int64_t whole = (int64_t)p.period_ns;
+
+    int64_t advanced = 0;
+    int steps_ok = 1;
+    for (int i = 0; i < FRAMES; i++) {
+        /* One period late: no sleep, and well short of a re-anchor */
+        p.deadline_ns = pacing_now_ns() - whole;
+        int64_t before = p.deadline_ns;
+        pacing_wait(&p);
+        int64_t step = p.deadline_ns - before;
+        if (step != whole && step != whole + 1) steps_ok = 0;
+        advanced += step;
+    }
+
+    check(steps_ok, "each frame advances the deadline by one whole period");
+    check(fabs((double)advanced - FRAMES * p.period_ns) < 1.0, "sub-ns remainder carried, no drift");
+    check(p.late_frames == FRAMES && p.resyncs == 0, "late frames counted without re-anchoring");
+}
+
+/* Test 2: a long stall re-anchors instead of bursting frames */
+void test_stall(void) {
+    printf("\n=== Test 2: Stall ===\n");
+
+    struct pacing_s p;
+    pacing_init(&p, 60.0);
+
+    p.deadline_ns = pacing_now_ns() - 10 * (int64_t)p.period_ns;
+    pacing_wait(&p);
+    int64_t ahead = p.deadline_ns - pacing_now_ns();
+
+    check(p.resyncs == 1 && p.late_frames == 1, "stall of 10 frames re-anchors once");
+    check(ahead > 0 && ahead <= (int64_t)p.period_ns + 1, "next deadline is one period from now");
+}
+
+/* Test 3: an on-time frame sleeps until its deadline */
+void test_sleep(void) {
+    printf("\n=== Test 3: Sleep ===\n");
+
+    struct pacing_s p;
+    pacing_init(&p, 200.0);
+
+    int64_t deadline = p.deadline_ns;
+    pacing_wait(&p);
+
+    check(pacing_now_ns() >= deadline, "woke at or after the deadline");
+    check(p.late_frames == 0 && p.max_wake_late_ns >= 0, "not counted late");
+}
+
+/* Test 4: rate changes, stats reset and a disabled pacer */
+void test_controls(void) {
+    printf("\n=== Test 4: Rate and Stats ===\n");
+
+    struct pacing_s p;
+    pacing_init(&p, PACING_DMG_HZ);
+    p.deadline_ns = pacing_now_ns() - (int64_t)p.period_ns;
+    pacing_wait(&p);
+    pacing_wait(&p);
+
+    int64_t deadline = p.deadline_ns;
+    pacing_set_rate(&p, 100.0);
+    check(p.period_ns == 1e7 && p.deadline_ns == deadline, "pacing_set_rate changes the period, not the deadline");
+    pacing_set_rate(&p, 0.0);
+    check(p.target_hz == 100.0, "non-positive rate ignored");
+
+    check(p.frames == 1, "one period measured between two waits");
+    pacing_clear_stats(&p);
+    struct pacing_stats_s st;
+    pacing_get_stats(&p, &st);
+    check(st.frames == 0 && st.late_frames == 0 && st.max_ns == 0 && p.deadline_ns == deadline,
+          "pacing_clear_stats keeps the deadline chain");
+
+    p.enabled = false;
+    pacing_wait(&p);
+    pacing_wait(&p);
+    check(p.deadline_ns == deadline && p.frames == 1 && p.late_frames == 0,
+          "disabled pacer only records the period");
+}
+
+int main(void) {
+    printf("Frame Pacing Test Suite\n");
+    printf("=======================\n");
+
+    test_advance();
+    test_stall();
+    test_sleep();
+    test_controls();
+
+    return test_summary("pacing");
+}
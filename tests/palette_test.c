@@ -0,0 +1,129 @@
+/**
+ * palette_test.c - Tests for the host palette
+ *
+ * Compares the vectorised shade-to-XRGB1555 conversion with a plain
+ * per-pixel lookup for every preset and a custom palette, over lengths
+ * that are and are not a multiple of the vector width and from unaligned
+ * buffers. Also checks the colour packing and palette parsing, including
+ * malformed strings.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gb_types.h"
+#include "palette.h"
+#include "test_check.h"
+
+#define PIXELS  (LCD_WIDTH * LCD_HEIGHT)
+
+/* Test 1: colour packing */
+void test_lut(void) {
+    printf("\n=== Test 1: XRGB1555 Table ===\n");
+
+    uint16_t lut[4];
+    palette_lut_1555(palette_presets[0].rgb, lut);
+    check(lut[0] == 0x7FFF && lut[1] == 0x5294 && lut[2] == 0x294A && lut[3] == 0x0000,
+          "gray packs to 7FFF 5294 294A 0000");
+
+    static const uint32_t rgb[4] = { 0xFF0000, 0x00FF00, 0x0000FF, 0x080808 };
+    palette_lut_1555(rgb, lut);
+    check(lut[0] == 0x7C00 && lut[1] == 0x03E0 && lut[2] == 0x001F && lut[3] == 0x0421,
+          "red, green and blue land in their fields");
+}
+
+/* Test 2: vectorised conversion matches a per-pixel lookup */
+void test_convert(void) {
+    printf("\n=== Test 2: Conversion ===\n");
+
+    static uint8_t shades[PIXELS + 2];
+    static uint16_t out[PIXELS + 2];
+    static const size_t lengths[] = { 0, 1, 7, 8, 9, 15, 16, 17, LCD_WIDTH - 1, LCD_WIDTH, PIXELS - 3, PIXELS };
+    static const uint32_t custom[4] = { 0x123456, 0x789ABC, 0xDEF012, 0x345678 };
+
+    /* Every byte value, so bits above the shade must be ignored too */
+    srand(1);
+    for (size_t i = 0; i < sizeof(shades); i++) {
+        shades[i] = (uint8_t)(i < 256 ? (int)i : rand());
+    }
+
+    for (int p = 0; p <= palette_num_presets; p++) {
+        const uint32_t *rgb = p < palette_num_presets ? palette_presets[p].rgb : custom;
+        uint16_t lut[4];
+        palette_lut_1555(rgb, lut);
+
+        int bad = 0;
+        for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+            for (int off = 0; off < 2; off++) {
+                size_t n = lengths[l];
+                /* A sentinel past the end catches overruns */
+                memset(out, 0xAA, sizeof(out));
+                palette_convert(shades + off, out + off, n, lut);
+                for (size_t i = 0; i < n; i++) {
+                    if (out[off + i] != lut[shades[off + i] & 0x03]) bad++;
+                }
+                if (out[off + n] != 0xAAAA || (off && out[0] != 0xAAAA)) bad++;
+            }
+        }
+
+        char what[64];
+        snprintf(what, sizeof(what), "%s: matches the per-pixel lookup",
+                 p < palette_num_presets ? palette_presets[p].name : "custom");
+        check(bad == 0, what);
+    }
+}
+
+/* Test 3: palette strings */
+void test_parse(void) {
+    printf("\n=== Test 3: Parsing ===\n");
+
+    uint32_t rgb[4];
+    int names = 1;
+    for (int p = 0; p < palette_num_presets; p++) {
+        if (palette_parse(palette_presets[p].name, rgb) != 0 ||
+            memcmp(rgb, palette_presets[p].rgb, sizeof(rgb)) != 0) names = 0;
+    }
+    check(names, "presets by name");
+
+    check(palette_parse("FFFFFF,aaBB0c,000001,9bbc0f", rgb) == 0 &&
+          rgb[0] == 0xFFFFFF && rgb[1] == 0xAABB0C && rgb[2] == 0x000001 && rgb[3] == 0x9BBC0F,
+          "four hex colours, either case");
+
+    static const char *const bad[] = {
+        "", "grey", "Green", "gray ",
+        "FFFFFF,AAAAAA,555555",                 /* three colours */
+        "FFFFFF,AAAAAA,555555,000000,",         /* trailing comma */
+        "FFFFFF,AAAAAA,555555,000000,111111",   /* five colours */
+        "FFFFFF,AAAAAA,555555,0000000",         /* seven digits */
+        "FFFFFF,AAAAAA,555555,00000",           /* five digits */
+        "FFFFFF,AAAAAA,55555,0000000",          /* digits moved across a comma */
+        "FFFFFF;AAAAAA;555555;000000",          /* wrong separator */
+        "FFFFFF, AAAAA,555555,000000",          /* space */
+        " FFFFF,AAAAAA,555555,000000",
+        "-00001,AAAAAA,555555,000000",          /* sign */
+        "+FFFFF,AAAAAA,555555,000000",
+        "0xFFFF,AAAAAA,555555,000000",          /* prefix */
+        "GGGGGG,AAAAAA,555555,000000",          /* not hex */
+    };
+    int rejected = 1;
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        static const uint32_t keep[4] = { 1, 2, 3, 4 };
+        memcpy(rgb, keep, sizeof(rgb));
+        if (palette_parse(bad[i], rgb) != -1 || memcmp(rgb, keep, sizeof(rgb)) != 0) {
+            printf("  accepted: \"%s\"\n", bad[i]);
+            rejected = 0;
+        }
+    }
+    check(rejected, "malformed strings rejected, colours left alone");
+}
+
+int main(void) {
+    printf("Palette Test Suite\n");
+    printf("==================\n");
+
+    test_lut();
+    test_convert();
+    test_parse();
+
+    return test_summary("palette");
+}
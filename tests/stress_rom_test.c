@@ -0,0 +1,229 @@
+/**
+ * stress_rom_test.c - Regression tests using the synthetic stress ROMs
+ *
+ * Builds every ROM from bench/stress_rom.c, checks its header, runs it for
+ * a number of frames and checks the workload did what it is meant to.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gb_types.h"
+#include "cpu.h"
+#include "memory.h"
+#include "gpu.h"
+#include "stress_rom.h"
+#include "test_check.h"
+
+#define TEST_FRAMES 30
+#define INIT_FRAMES 10  // Init code (tile fill etc.) takes a few frames
+
+/* Counts lines drawn so the PPU workloads can be checked */
+static uint32_t lines_seen;
+
+static void lcd_draw_line(struct gb_s *gb, const uint8_t *pixels, uint8_t line) {
+    (void)gb; (void)pixels; (void)line;
+    lines_seen++;
+}
+
+/* Per-machine hash of every line drawn, for comparing two renderers */
+static struct gb_s *hashed[2];
+static uint64_t line_hash[2];
+
+static void hash_draw_line(struct gb_s *gb, const uint8_t *pixels, uint8_t line) {
+    int i = gb == hashed[1];
+    uint64_t h = line_hash[i] ^ line;
+
+    for (int x = 0; x < LCD_WIDTH; x++) {
+        h = (h ^ pixels[x]) * 0x100000001B3ULL;
+    }
+    line_hash[i] = h;
+}
+
+static void run_frames(struct gb_s *gb, int frames) {
+    for (int f = 0; f < frames; f++) {
+        gb->gb_frame = 0;
+        while (!gb->gb_frame) {
+            cpu_step(gb);
+        }
+    }
+}
+
+/* Test 1: every ROM has a valid header */
+void test_headers(void) {
+    printf("\n=== Test 1: Headers ===\n");
+
+    for (int k = 0; k < STRESS_NUM_KINDS; k++) {
+        uint8_t *rom = NULL;
+        size_t size = stress_rom_build((enum stress_rom_kind)k, &rom);
+        char what[64];
+
+        uint8_t hdr = 0;
+        for (uint32_t i = 0x0134; i <= 0x014C; i++) {
+            hdr = (uint8_t)(hdr - rom[i] - 1);
+        }
+
+        snprintf(what, sizeof(what), "%s: %zu KB, header checksum 0x%02X",
+                 stress_rom_name((enum stress_rom_kind)k), size / 1024, rom[0x014D]);
+        check(size >= 0x8000 && rom[0x0104] == 0xCE && rom[0x0133] == 0x3E && hdr == rom[0x014D], what);
+
+        free(rom);
+    }
+}
+
+/* Test 2: every ROM runs without emulator errors and draws every line */
+void test_runs_clean(void) {
+    printf("\n=== Test 2: Run %d frames ===\n", TEST_FRAMES);
+
+    for (int k = 0; k < STRESS_NUM_KINDS; k++) {
+        struct gb_s *gb = malloc(sizeof(struct gb_s));
+        uint8_t *rom = NULL;
+        size_t size = stress_rom_build((enum stress_rom_kind)k, &rom);
+        char what[64];
+
+        stress_rom_attach(gb, rom, size);
+        gb->display.lcd_draw_line = lcd_draw_line;
+        gb->direct.joypad = 0xFF;
+        lines_seen = 0;
+
+        run_frames(gb, TEST_FRAMES);
+
+        snprintf(what, sizeof(what), "%s: %u errors, %u lines drawn",
+                 stress_rom_name((enum stress_rom_kind)k), stress_rom_errors(), lines_seen);
+        /* The first frame is partly spent in init with the LCD off */
+        check(stress_rom_errors() == 0 && lines_seen >= (TEST_FRAMES - 2) * LCD_HEIGHT, what);
+
+        free(gb);
+        free(rom);
+    }
+}
+
+/* Test 3: workload-specific results */
+void test_workloads(void) {
+    printf("\n=== Test 3: Workload Results ===\n");
+
+    struct gb_s *gb = malloc(sizeof(struct gb_s));
+    uint8_t *rom = NULL;
+    size_t size;
+
+    /* sprites: DMA'd images end up in OAM with 8x16 sprites enabled */
+    size = stress_rom_build(STRESS_SPRITES, &rom);
+    stress_rom_attach(gb, rom, size);
+    gb->display.lcd_draw_line = lcd_draw_line;
+    run_frames(gb, TEST_FRAMES);
+    check((gb->hram_io[IO_LCDC] & LCDC_OBJ_SIZE) && gb->oam[1] == 8 && gb->oam[4 * 9 + 1] == 8 + 9 * 16,
+          "sprites: OAM filled by DMA, 8x16 sprites enabled");
+    free(rom);
+
+    /* mbc1: bank marker and cart RAM read-back land in WRAM */
+    size = stress_rom_build(STRESS_MBC1, &rom);
+    stress_rom_attach(gb, rom, size);
+    gb->display.lcd_draw_line = lcd_draw_line;
+    run_frames(gb, TEST_FRAMES);
+    uint8_t bank = mmu_read(gb, STRESS_WRAM_BANK);
+    check(bank >= 1 && bank <= 7 && gb->selected_rom_bank >= 1, "mbc1: switched-bank marker read back");
+    check(gb->enable_cart_ram && gb->cart_mode_select, "mbc1: RAM enabled, banking mode 1");
+    free(rom);
+
+    /* halt: the VBlank and LY=LYC ISRs each run once per frame */
+    size = stress_rom_build(STRESS_HALT, &rom);
+    stress_rom_attach(gb, rom, size);
+    gb->display.lcd_draw_line = lcd_draw_line;
+    run_frames(gb, INIT_FRAMES);
+    uint8_t vblanks = mmu_read(gb, STRESS_WRAM_VBLANKS);
+    uint8_t lycs = mmu_read(gb, STRESS_WRAM_LYCS);
+    run_frames(gb, TEST_FRAMES);
+    vblanks = (uint8_t)(mmu_read(gb, STRESS_WRAM_VBLANKS) - vblanks);
+    lycs = (uint8_t)(mmu_read(gb, STRESS_WRAM_LYCS) - lycs);
+    printf("  halt: %u VBlank and %u LY=LYC interrupts in %d frames\n", vblanks, lycs, TEST_FRAMES);
+    check(vblanks == TEST_FRAMES, "halt: VBlank interrupts serviced");
+    check(lycs == TEST_FRAMES, "halt: STAT LY=LYC interrupts serviced");
+    free(rom);
+
+    /* busywait: the LY poll loop sees every frame */
+    size = stress_rom_build(STRESS_BUSYWAIT, &rom);
+    stress_rom_attach(gb, rom, size);
+    gb->display.lcd_draw_line = lcd_draw_line;
+    run_frames(gb, INIT_FRAMES);
+    uint8_t frames = mmu_read(gb, STRESS_WRAM_FRAMES);
+    run_frames(gb, TEST_FRAMES);
+    frames = (uint8_t)(mmu_read(gb, STRESS_WRAM_FRAMES) - frames);
+    printf("  busywait: %u frames counted in %d frames\n", frames, TEST_FRAMES);
+    check(frames == TEST_FRAMES, "busywait: LY poll loop counted frames");
+    free(rom);
+
+    free(gb);
+}
+
+/* Test 4: the background cache draws what VRAM holds, whatever changes it */
+void test_bg_cache(void) {
+    printf("\n=== Test 4: Background Cache ===\n");
+
+    static struct gpu_bg_cache_s cache;
+    struct gb_s *gb[2] = { malloc(sizeof(struct gb_s)), malloc(sizeof(struct gb_s)) };
+    uint64_t hits = 0, misses = 0, uncached = 0;
+
+    for (int k = 0; k < STRESS_NUM_KINDS; k++) {
+        uint8_t *rom = NULL;
+        size_t size = stress_rom_build((enum stress_rom_kind)k, &rom);
+        int mismatch = -1;
+        char what[80];
+
+        for (int i = 0; i < 2; i++) {
+            stress_rom_attach(gb[i], rom, size);
+            gb[i]->display.lcd_draw_line = hash_draw_line;
+            hashed[i] = gb[i];
+            line_hash[i] = 0;
+        }
+        gpu_bg_cache_attach(gb[1], &cache);
+
+        for (int f = 0; f < TEST_FRAMES && mismatch < 0; f++) {
+            /* Mid-frame, change an on-screen tile, a map entry, and now and
+               then the addressing mode and BG map, the same way on both */
+            uint8_t ly = (uint8_t)(f * 17 % LCD_HEIGHT);
+            for (int i = 0; i < 2; i++) {
+                while (gb[i]->hram_io[IO_LY] != ly) cpu_step(gb[i]);
+                uint8_t lcdc = gb[i]->hram_io[IO_LCDC];
+                uint8_t idx = mmu_read(gb[i], (uint16_t)(((lcdc & LCDC_BG_MAP) ? 0x9C00 : 0x9800) +
+                                                         f % 18 * 32 + f % 20));
+                uint16_t tile = (lcdc & LCDC_TILE_SELECT) ? 0x8000 + idx * 16 : 0x9000 + (int8_t)idx * 16;
+                mmu_write(gb[i], (uint16_t)(tile + f % 16), (uint8_t)(f * 29));
+                mmu_write(gb[i], (uint16_t)(0x9800 + f * 53 % 0x800), (uint8_t)(f * 71));
+                if (f % 7 == 3) {
+                    mmu_write(gb[i], 0xFF40, gb[i]->hram_io[IO_LCDC] ^ (LCDC_TILE_SELECT | LCDC_BG_MAP));
+                }
+            }
+            for (int i = 0; i < 2; i++) {
+                run_frames(gb[i], 1);
+            }
+            if (line_hash[0] != line_hash[1]) mismatch = f;
+        }
+
+        snprintf(what, sizeof(what), "%s: cached lines match VRAM rendering%s",
+                 stress_rom_name((enum stress_rom_kind)k), mismatch < 0 ? "" : " (differs)");
+        check(mismatch < 0, what);
+
+        hits += gb[1]->stats.bg_cache_hits;
+        misses += gb[1]->stats.bg_cache_misses;
+        uncached += gb[0]->stats.bg_cache_hits + gb[0]->stats.bg_cache_misses;
+        gpu_bg_cache_attach(gb[1], NULL);
+        free(rom);
+    }
+
+    check(hits > misses && misses > 0 && uncached == 0, "hit/miss counters track cache lookups only");
+
+    free(gb[0]);
+    free(gb[1]);
+}
+
+int main(void) {
+    printf("Stress ROM Test Suite\n");
+    printf("=====================\n");
+
+    test_headers();
+    test_runs_clean();
+    test_workloads();
+    test_bg_cache();
+
+    return test_summary("stress ROM");
+}
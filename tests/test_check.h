@@ -0,0 +1,36 @@
+/**
+ * test_check.h - Pass/fail reporting for the unit tests
+ *
+ * check() prints one ✓/✗ line per assertion and counts the failures;
+ * test_summary() prints the totals and gives main() its exit status. Each
+ * test program is a single translation unit, so everything here is static.
+ */
+
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+#include <stdio.h>
+
+static int failures = 0;
+
+static inline void check(int ok, const char *what) {
+    if (ok) {
+        printf("✓ %s\n", what);
+    } else {
+        printf("✗ %s\n", what);
+        failures++;
+    }
+}
+
+/* Print the summary and return the exit status */
+static inline int test_summary(const char *suite) {
+    printf("\n=== Summary ===\n");
+    if (failures == 0) {
+        printf("✓ All %s tests passed\n", suite);
+        return 0;
+    }
+    printf("✗ %d %s test(s) failed\n", failures, suite);
+    return 1;
+}
+
+#endif /* TEST_CHECK_H */
@@ -0,0 +1,69 @@
+/**
+ * test_machine.h - Shared fixture for the core unit tests
+ *
+ * A bare machine running from test_rom[] with 8 KB of cart RAM in
+ * test_ram[], powered on at $0100 with interrupts off. check() and the
+ * pass/fail summary come from test_check.h. Each test program is a single
+ * translation unit, so everything here is static.
+ */
+
+#ifndef TEST_MACHINE_H
+#define TEST_MACHINE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gb_types.h"
+#include "cpu.h"
+#include "memory.h"
+#include "test_check.h"
+
+static uint8_t test_rom[0x8000];
+static uint8_t test_ram[0x2000];
+static int errors = 0;      // gb_error() calls (invalid opcodes etc.)
+
+static inline uint8_t rom_read(struct gb_s *gb, uint32_t addr) {
+    (void)gb;
+    return addr < sizeof(test_rom) ? test_rom[addr] : 0xFF;
+}
+
+static inline uint8_t cart_ram_read(struct gb_s *gb, uint32_t addr) {
+    (void)gb;
+    return addr < sizeof(test_ram) ? test_ram[addr] : 0xFF;
+}
+
+static inline void cart_ram_write(struct gb_s *gb, uint32_t addr, uint8_t val) {
+    (void)gb;
+    if (addr < sizeof(test_ram)) test_ram[addr] = val;
+}
+
+static inline void error_handler(struct gb_s *gb, enum gb_error_e error, uint16_t addr) {
+    (void)gb; (void)error; (void)addr;
+    errors++;
+}
+
+/* Reset @gb to a powered-on machine at $0100 with IME off */
+static inline void machine_init(struct gb_s *gb) {
+    memset(gb, 0, sizeof(*gb));
+    gb->gb_rom_read = rom_read;
+    gb->gb_cart_ram_read = cart_ram_read;
+    gb->gb_cart_ram_write = cart_ram_write;
+    gb->gb_error = error_handler;
+    mmu_init(gb);
+    cpu_init(gb);
+    gb->gb_ime = false;
+    gb->cpu_reg.pc.reg = 0x0100;
+}
+
+/* Allocate and initialise a machine; free() it when done */
+static inline struct gb_s *machine_new(void) {
+    struct gb_s *gb = malloc(sizeof(*gb));
+    if (!gb) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    machine_init(gb);
+    return gb;
+}
+
+#endif /* TEST_MACHINE_H */
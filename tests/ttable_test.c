@@ -0,0 +1,114 @@
+/**
+ * ttable_test.c - Tests for the transposition table
+ *
+ * Checks set semantics (including key 0), that a full probe run drops the
+ * key instead of overwriting one, and that when threads insert the same
+ * keys at once, each key is reported new exactly once.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ttable.h"
+#include "test_check.h"
+
+#define THREADS     4
+#define KEYS        20000
+
+/* Distinct, well-spread keys like a state hash gives */
+static uint64_t key_of(uint64_t i) {
+    uint64_t x = (i + 1) * 0x9E3779B97F4A7C15ULL;
+    x ^= x >> 31;
+    return x * 0xBF58476D1CE4E5B9ULL;
+}
+
+/* Test 1: set semantics */
+void test_basic(void) {
+    printf("\n=== Test 1: Insert and Lookup ===\n");
+
+    struct ttable_s *t = ttable_create(1000);
+    check(t != NULL && ttable_count(t) == 0, "created empty");
+
+    check(!ttable_insert(t, 42) && ttable_insert(t, 42), "second insert reports the key as seen");
+    check(ttable_contains(t, 42) && !ttable_contains(t, 43), "lookup finds only inserted keys");
+    check(!ttable_insert(t, 0) && ttable_insert(t, 0) && ttable_contains(t, 0), "key 0 is a key like any other");
+    check(ttable_count(t) == 2, "count");
+
+    ttable_clear(t);
+    check(ttable_count(t) == 0 && !ttable_contains(t, 42), "clear empties it");
+    ttable_destroy(t);
+}
+
+/* Test 2: a full neighbourhood drops keys, never evicts */
+void test_full(void) {
+    printf("\n=== Test 2: Full Probe Run ===\n");
+
+    struct ttable_s *t = ttable_create(64);
+
+    /* All land on slot 5 */
+    for (uint64_t i = 0; i < TTABLE_PROBES + 4; i++) {
+        ttable_insert(t, 5 + (i << 32));
+    }
+    check(ttable_count(t) == TTABLE_PROBES && ttable_dropped(t) == 4, "probe limit reached, extra keys dropped");
+    check(ttable_contains(t, 5) && ttable_contains(t, 5 + ((uint64_t)(TTABLE_PROBES - 1) << 32)),
+          "stored keys are kept");
+    check(!ttable_contains(t, 5 + ((uint64_t)TTABLE_PROBES << 32)), "dropped keys are not found");
+    ttable_destroy(t);
+}
+
+struct worker_s {
+    struct ttable_s *t;
+    int id;
+    int fresh;      // Inserts that reported a new key
+};
+
+static void *worker(void *arg) {
+    struct worker_s *w = arg;
+    /* Same keys on every thread, in a different order */
+    for (int i = 0; i < KEYS; i++) {
+        int k = (i * 7919 + w->id * 104729) % KEYS;
+        if (!ttable_insert(w->t, key_of((uint64_t)k))) w->fresh++;
+    }
+    return NULL;
+}
+
+/* Test 3: concurrent inserts */
+void test_concurrent(void) {
+    printf("\n=== Test 3: Concurrent Inserts ===\n");
+
+    struct ttable_s *t = ttable_create(4 * KEYS);
+    struct worker_s w[THREADS];
+    pthread_t th[THREADS];
+
+    for (int i = 0; i < THREADS; i++) {
+        w[i] = (struct worker_s){ t, i, 0 };
+        pthread_create(&th[i], NULL, worker, &w[i]);
+    }
+    int fresh = 0;
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(th[i], NULL);
+        fresh += w[i].fresh;
+    }
+
+    check(ttable_dropped(t) == 0 && ttable_count(t) == KEYS, "every key stored once");
+    check(fresh == KEYS, "each key reported new to exactly one thread");
+
+    int all = 1;
+    for (int i = 0; i < KEYS; i++) {
+        if (!ttable_contains(t, key_of((uint64_t)i))) all = 0;
+    }
+    check(all, "all keys found afterwards");
+    ttable_destroy(t);
+}
+
+int main(void) {
+    printf("Transposition Table Test Suite\n");
+    printf("==============================\n");
+
+    test_basic();
+    test_full();
+    test_concurrent();
+
+    return test_summary("transposition table");
+}